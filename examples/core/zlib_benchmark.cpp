@@ -0,0 +1,94 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       zlib_benchmark.cpp - description                       ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+// This example compares single-threaded and multi-threaded gzip compression throughput.
+
+#include <iostream>
+#include <iomanip>
+#include <sptk5/Buffer.h>
+#include <sptk5/ZLib.h>
+#include <sptk5/threads/ThreadPool.h>
+
+using namespace std;
+using namespace sptk;
+
+static double elapsedSeconds(chrono::steady_clock::time_point started)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - started).count();
+}
+
+static void printResult(const String& title, const Buffer& source, const Buffer& compressed, double seconds)
+{
+    cout << left << setw(28) << title
+         << right << setw(12) << compressed.bytes() << " bytes, "
+         << fixed << setprecision(3) << setw(8) << seconds << " sec, "
+         << setprecision(1) << setw(8) << source.bytes() / seconds / 1E6 << " MB/sec" << endl;
+}
+
+int main(int argc, const char* argv[])
+{
+    try {
+        size_t megabytes = argc > 1 ? (size_t) string2int(argv[1]) : 64;
+
+        // Semi-random text data, compressible about as well as typical exports
+        Buffer testData;
+        testData.reserve(megabytes * 1024 * 1024 + 128);
+        uint32_t seed = 1;
+        while (testData.bytes() < megabytes * 1024 * 1024) {
+            seed = seed * 1103515245 + 12345;
+            testData.append("record " + int2string(seed % 100000) + ", value " + int2string(seed >> 16) + "\n");
+        }
+        cout << "Test data: " << testData.bytes() << " bytes" << endl;
+
+        Buffer compressed;
+        auto started = chrono::steady_clock::now();
+        ZLib::compress(compressed, testData);
+        printResult("Single thread", testData, compressed, elapsedSeconds(started));
+
+        unsigned maxThreads = max(4U, thread::hardware_concurrency());
+        ThreadPool threadPool(maxThreads);
+        for (unsigned threads = 2; threads <= maxThreads; threads *= 2) {
+            compressed.reset();
+            started = chrono::steady_clock::now();
+            ZLib::compress(compressed, testData, threadPool, threads);
+            printResult(int2string(threads) + " threads", testData, compressed, elapsedSeconds(started));
+        }
+        threadPool.stop();
+
+        Buffer decompressed;
+        ZLib::decompress(decompressed, compressed);
+        if (decompressed.bytes() != testData.bytes() || memcmp(decompressed.data(), testData.data(), testData.bytes()) != 0)
+            throw Exception("Decompressed data doesn't match the original");
+        cout << "Decompressed data matches the original" << endl;
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
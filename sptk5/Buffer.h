@@ -31,6 +31,7 @@
 
 #include <sptk5/sptk.h>
 #include <sptk5/Exception.h>
+#include <sptk5/BufferAllocator.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -48,17 +49,39 @@ namespace sptk
 /**
  * @brief Memory data buffer
  *
- * Generic buffer with a special memory-allocation strategy for effective append() operation
+ * Generic buffer with a special memory-allocation strategy for effective append() operation.
+ * The buffer capacity grows geometrically, and the memory is obtained through
+ * the buffer allocator (by default, the thread-local size-class pool).
  */
 class SP_EXPORT Buffer
 {
 
     /**
-     * @brief Resizes current buffer
+     * @brief Grows current buffer geometrically
      * @param sz size_t, required memory size
      */
     void adjustSize(size_t sz);
 
+    /**
+     * @brief Changes the buffer capacity exactly to required size
+     *
+     * Preserves the buffer content, up to the new capacity.
+     * @param sz size_t, required capacity
+     */
+    void resizeStorage(size_t sz);
+
+    /**
+     * @brief Releases buffer memory, unless it is an inline storage
+     */
+    void releaseStorage() noexcept;
+
+    /**
+     * @brief Allocates buffer memory and copies the data into it
+     * @param data const void*, data to copy, or nullptr to zero-fill the buffer
+     * @param sz size_t, data size
+     */
+    void init(const void* data, size_t sz);
+
 protected:
 
     /**
@@ -76,6 +99,30 @@ protected:
      */
     char*       m_buffer { nullptr };
 
+    /**
+     * Memory allocator
+     */
+    BufferAllocator*    m_allocator { &BufferAllocator::defaultAllocator() };
+
+    /**
+     * Inline storage provided by derived class, or nullptr
+     */
+    char*       m_inlineStorage { nullptr };
+
+    /**
+     * Inline storage capacity
+     */
+    size_t      m_inlineCapacity { 0 };
+
+    /**
+     * @brief Constructor for buffers with inline storage
+     *
+     * Creates an empty buffer that uses the storage provided by derived class,
+     * until the data outgrows it.
+     * @param inlineStorage char*, inline storage
+     * @param inlineCapacity size_t, inline storage size, minus one byte for terminating zero
+     */
+    Buffer(char* inlineStorage, size_t inlineCapacity) noexcept;
 
 public:
 
@@ -88,6 +135,16 @@ public:
      */
     explicit Buffer(size_t sz = 16);
 
+    /**
+     * @brief Constructor
+     *
+     * Creates an empty buffer that uses the allocator.
+     * The allocator must outlive the buffer.
+     * @param sz size_t, buffer size to be pre-allocated
+     * @param allocator BufferAllocator&, memory allocator
+     */
+    Buffer(size_t sz, BufferAllocator& allocator);
+
     /**
      * @brief Constructor
      *
@@ -132,7 +189,7 @@ public:
     /**
      * @brief Copy constructor
      *
-     * Creates a buffer from another buffer.
+     * Creates a buffer from another buffer, using the same allocator.
      * @param other const Buffer&, data buffer
      */
     Buffer(const Buffer& other);
@@ -148,10 +205,14 @@ public:
     /**
      * @brief Destructor
      */
-    ~Buffer()
+    ~Buffer();
+
+    /**
+     * @brief Returns memory allocator of the buffer
+     */
+    BufferAllocator& allocator() const
     {
-        if (m_buffer)
-            free(m_buffer);
+        return *m_allocator;
     }
 
     /**
@@ -190,6 +251,26 @@ public:
             adjustSize(sz);
     }
 
+    /**
+     * @brief Makes sure the buffer capacity is at least sz bytes
+     *
+     * Unlike checkSize(), allocates exactly the required size (rounded up by allocator).
+     * @param sz size_t, required capacity
+     */
+    void reserve(size_t sz)
+    {
+        if (sz > m_capacity)
+            resizeStorage(sz);
+    }
+
+    /**
+     * @brief Releases unused buffer capacity
+     *
+     * Reduces the capacity to the data size (rounded up by allocator).
+     * The buffer using an inline storage returns to it if the data fits.
+     */
+    void shrink_to_fit();
+
     /**
      * @brief Copies the external data of size sz into the current buffer.
      *
@@ -446,6 +527,96 @@ public:
     }
 };
 
+/**
+ * @brief Memory data buffer with inline storage
+ *
+ * Keeps up to N bytes of data inside the object, without any memory allocation.
+ * Larger data is stored in the memory obtained from the buffer allocator.
+ * Intended for short-lived buffers, such as protocol lines and headers.
+ */
+template <size_t N>
+class InlineBuffer : public Buffer
+{
+    /**
+     * Inline storage, with an extra byte for terminating zero
+     */
+    char    m_inlineData[N + 1];
+
+public:
+    /**
+     * @brief Default constructor
+     */
+    InlineBuffer() noexcept
+    : Buffer(m_inlineData, N)
+    {
+    }
+
+    /**
+     * @brief Constructor
+     * @param data const void*, data to copy
+     * @param sz size_t, data size
+     */
+    InlineBuffer(const void* data, size_t sz)
+    : Buffer(m_inlineData, N)
+    {
+        set((const char*) data, sz);
+    }
+
+    /**
+     * @brief Constructor
+     * @param str const std::string&, string to copy
+     */
+    explicit InlineBuffer(const std::string& str)
+    : Buffer(m_inlineData, N)
+    {
+        set(str);
+    }
+
+    /**
+     * @brief Copy constructor
+     * @param other const InlineBuffer&, buffer to copy
+     */
+    InlineBuffer(const InlineBuffer& other)
+    : Buffer(m_inlineData, N)
+    {
+        set(other);
+    }
+
+    /**
+     * @brief Move constructor
+     *
+     * Inline data is copied, allocated memory is moved.
+     * @param other InlineBuffer&&, buffer to move
+     */
+    InlineBuffer(InlineBuffer&& other) noexcept
+    : Buffer(m_inlineData, N)
+    {
+        Buffer::operator = (std::move(other));
+    }
+
+    /**
+     * @brief Assignment
+     * @param other const InlineBuffer&, buffer to copy
+     */
+    InlineBuffer& operator = (const InlineBuffer& other)
+    {
+        Buffer::operator = (other);
+        return *this;
+    }
+
+    /**
+     * @brief Move assignment
+     * @param other InlineBuffer&&, buffer to move
+     */
+    InlineBuffer& operator = (InlineBuffer&& other) noexcept
+    {
+        Buffer::operator = (std::move(other));
+        return *this;
+    }
+
+    using Buffer::operator =;
+};
+
 /**
  * Print buffer to ostream as hexadecimal dump
   */
@@ -0,0 +1,261 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       BufferAllocator.h - description                        ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_BUFFER_ALLOCATOR_H__
+#define __SPTK_BUFFER_ALLOCATOR_H__
+
+#include <sptk5/sptk.h>
+#include <sptk5/Exception.h>
+
+#include <vector>
+
+namespace sptk
+{
+
+/**
+ * @addtogroup utility Utility Classes
+ * @{
+ */
+
+/**
+ * @brief Memory allocation policy for Buffer
+ *
+ * Buffer obtains and releases its memory only through an allocator.
+ * The allocator may round the requested block size up, and reports
+ * the actual usable block size back to the buffer.
+ */
+class SP_EXPORT BufferAllocator
+{
+public:
+    /**
+     * @brief Destructor
+     */
+    virtual ~BufferAllocator() = default;
+
+    /**
+     * @brief Allocates memory block
+     * @param size size_t&, required block size, on return - actual block size
+     * @returns memory block, or nullptr if memory can't be allocated
+     */
+    virtual char* allocate(size_t& size) = 0;
+
+    /**
+     * @brief Resizes memory block
+     *
+     * Similar to realloc(), the content of the block is preserved up to the lesser of the old and new sizes.
+     * @param block char*, memory block allocated by this allocator
+     * @param oldSize size_t, current block size, as returned by allocate() or reallocate()
+     * @param newSize size_t&, required block size, on return - actual block size
+     * @returns memory block, or nullptr if memory can't be allocated (the original block remains valid)
+     */
+    virtual char* reallocate(char* block, size_t oldSize, size_t& newSize) = 0;
+
+    /**
+     * @brief Releases memory block
+     * @param block char*, memory block allocated by this allocator
+     * @param size size_t, block size, as returned by allocate() or reallocate()
+     */
+    virtual void deallocate(char* block, size_t size) noexcept = 0;
+
+    /**
+     * @brief Returns the allocator used by buffers by default
+     *
+     * The default allocator is the process-wide instance of PooledBufferAllocator.
+     */
+    static BufferAllocator& defaultAllocator();
+};
+
+/**
+ * @brief Plain heap allocator
+ *
+ * Uses malloc(), realloc() and free() directly.
+ */
+class SP_EXPORT HeapBufferAllocator : public BufferAllocator
+{
+public:
+    /**
+     * @brief Returns the process-wide instance of the allocator
+     */
+    static HeapBufferAllocator& instance();
+
+    char* allocate(size_t& size) override;
+    char* reallocate(char* block, size_t oldSize, size_t& newSize) override;
+    void deallocate(char* block, size_t size) noexcept override;
+};
+
+/**
+ * @brief Size-class pooling allocator
+ *
+ * Block sizes up to MaxPooledBlockSize are rounded up to the next power of two,
+ * and released blocks are kept in thread-local free lists for the reuse.
+ * Larger blocks are allocated from the heap directly.
+ *
+ * The allocator has no shared state, so it doesn't need any locking.
+ * A block released by another thread simply joins the free list of that thread.
+ */
+class SP_EXPORT PooledBufferAllocator : public BufferAllocator
+{
+public:
+    /**
+     * The smallest block size
+     */
+    static constexpr size_t MinPooledBlockSize = 32;
+
+    /**
+     * The largest block size that is pooled
+     */
+    static constexpr size_t MaxPooledBlockSize = 65536;
+
+    /**
+     * Maximum number of bytes kept in a single thread's free list of a single size class
+     */
+    static constexpr size_t MaxCachedBytes = 131072;
+
+    /**
+     * @brief Returns the process-wide instance of the allocator
+     */
+    static PooledBufferAllocator& instance();
+
+    char* allocate(size_t& size) override;
+    char* reallocate(char* block, size_t oldSize, size_t& newSize) override;
+    void deallocate(char* block, size_t size) noexcept override;
+
+    /**
+     * @brief Returns the number of the free blocks cached by the current thread
+     */
+    static size_t cachedBlocks();
+
+    /**
+     * @brief Releases the free blocks cached by the current thread
+     */
+    static void releaseCachedBlocks() noexcept;
+};
+
+/**
+ * @brief Arena allocator
+ *
+ * Allocates blocks sequentially from large memory chunks.
+ * Releasing a block only returns the memory to the arena if it is the last allocated block,
+ * otherwise the memory is released when the arena is cleared or destroyed.
+ * Buffers using this allocator must not outlive the arena.
+ *
+ * This allocator is not thread-safe: it's intended for the buffers that share the lifetime
+ * of a single request or document, processed by a single thread.
+ */
+class SP_EXPORT ArenaBufferAllocator : public BufferAllocator
+{
+    /**
+     * Memory chunks
+     */
+    std::vector<char*>  m_chunks;
+
+    /**
+     * Size of the regular memory chunk
+     */
+    size_t              m_chunkSize;
+
+    /**
+     * Current chunk, or nullptr if there is none
+     */
+    char*               m_currentChunk {nullptr};
+
+    /**
+     * Offset of the free space in current chunk
+     */
+    size_t              m_offset {0};
+
+    /**
+     * Last block allocated from current chunk, may be resized in place
+     */
+    char*               m_lastBlock {nullptr};
+
+    /**
+     * Total size of the blocks allocated from the arena
+     */
+    size_t              m_allocated {0};
+
+public:
+    /**
+     * @brief Constructor
+     * @param chunkSize size_t, size of the regular memory chunk
+     */
+    explicit ArenaBufferAllocator(size_t chunkSize = 65536);
+
+    ArenaBufferAllocator(const ArenaBufferAllocator&) = delete;
+    ArenaBufferAllocator& operator = (const ArenaBufferAllocator&) = delete;
+
+    /**
+     * @brief Move constructor
+     *
+     * The memory allocated by other arena is transferred to this arena
+     * @param other ArenaBufferAllocator&&, Arena to move from
+     */
+    ArenaBufferAllocator(ArenaBufferAllocator&& other) noexcept;
+
+    /**
+     * @brief Destructor
+     *
+     * Releases all the memory allocated by the arena
+     */
+    ~ArenaBufferAllocator() override;
+
+    char* allocate(size_t& size) override;
+    char* reallocate(char* block, size_t oldSize, size_t& newSize) override;
+    void deallocate(char* block, size_t size) noexcept override;
+
+    /**
+     * @brief Allocates memory block without alignment
+     *
+     * Intended for character data, packed without gaps. The block can't be resized or released.
+     * @param size size_t, required block size
+     * @return allocated block
+     * @throw Exception if memory can't be allocated
+     */
+    char* allocateUnaligned(size_t size);
+
+    /**
+     * @brief Releases all the memory allocated by the arena
+     *
+     * All the buffers using the arena must be destroyed before this call.
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Returns total size of the blocks allocated from the arena
+     */
+    size_t allocated() const
+    {
+        return m_allocated;
+    }
+};
+
+/**
+ * @}
+ */
+}
+#endif
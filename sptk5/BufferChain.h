@@ -0,0 +1,185 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       BufferChain.h - description                            ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Tuesday October 20 2026                                ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_BUFFER_CHAIN_H__
+#define __SPTK_BUFFER_CHAIN_H__
+
+#include <sptk5/SharedBuffer.h>
+#include <deque>
+
+namespace sptk
+{
+
+/**
+ * @addtogroup utility Utility Classes
+ * @{
+ */
+
+/**
+ * @brief Chain of shared buffer slices
+ *
+ * Composes data from several buffers without concatenating them.
+ * Sockets write the chain with a single gather (writev) operation.
+ */
+class SP_EXPORT BufferChain
+{
+public:
+    /**
+     * Segment list type
+     */
+    typedef std::deque<SharedBuffer> Segments;
+
+    /**
+     * Segment list const iterator
+     */
+    typedef Segments::const_iterator const_iterator;
+
+private:
+    /**
+     * Chain segments
+     */
+    Segments    m_segments;
+
+    /**
+     * Total size of the segments
+     */
+    size_t      m_bytes {0};
+
+public:
+    /**
+     * @brief Default constructor
+     */
+    BufferChain() = default;
+
+    /**
+     * @brief Appends a slice to the end of the chain, without copying the data
+     * @param segment const SharedBuffer&, slice to append
+     */
+    void append(const SharedBuffer& segment);
+
+    /**
+     * @brief Appends a buffer to the end of the chain
+     *
+     * Takes over the buffer memory, without copying the data.
+     * @param buffer Buffer&&, buffer to append
+     */
+    void append(Buffer&& buffer)
+    {
+        append(SharedBuffer(std::move(buffer)));
+    }
+
+    /**
+     * @brief Appends a copy of the data to the end of the chain
+     * @param data const char*, data to append
+     * @param sz size_t, data size
+     */
+    void append(const char* data, size_t sz)
+    {
+        append(SharedBuffer(data, sz));
+    }
+
+    /**
+     * @brief Appends a copy of the string to the end of the chain
+     * @param str const std::string&, string to append
+     */
+    void append(const std::string& str)
+    {
+        append(SharedBuffer(str));
+    }
+
+    /**
+     * @brief Inserts a slice in front of the chain, without copying the data
+     * @param segment const SharedBuffer&, slice to insert
+     */
+    void prepend(const SharedBuffer& segment);
+
+    /**
+     * @brief Removes the data from the beginning of the chain
+     *
+     * Typically used after a partial write of the chain.
+     * @param sz size_t, number of bytes to remove
+     */
+    void consume(size_t sz);
+
+    /**
+     * @brief Copies the content of the chain into a single buffer
+     * @param destination Buffer&, output buffer
+     */
+    void copyTo(Buffer& destination) const;
+
+    /**
+     * @brief Removes all the segments
+     */
+    void clear();
+
+    /**
+     * @brief Returns total size of the chain data
+     */
+    size_t bytes() const
+    {
+        return m_bytes;
+    }
+
+    /**
+     * @brief Returns true if the chain has no data
+     */
+    bool empty() const
+    {
+        return m_bytes == 0;
+    }
+
+    /**
+     * @brief Returns number of the segments
+     */
+    size_t size() const
+    {
+        return m_segments.size();
+    }
+
+    /**
+     * @brief Returns const iterator on the first segment
+     */
+    const_iterator begin() const
+    {
+        return m_segments.begin();
+    }
+
+    /**
+     * @brief Returns const iterator past the last segment
+     */
+    const_iterator end() const
+    {
+        return m_segments.end();
+    }
+};
+
+/**
+ * @}
+ */
+}
+#endif
@@ -0,0 +1,171 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       SharedBuffer.h - description                           ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Tuesday October 20 2026                                ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_SHARED_BUFFER_H__
+#define __SPTK_SHARED_BUFFER_H__
+
+#include <sptk5/Buffer.h>
+#include <memory>
+
+namespace sptk
+{
+
+/**
+ * @addtogroup utility Utility Classes
+ * @{
+ */
+
+/**
+ * @brief Reference-counted read-only slice of a memory buffer
+ *
+ * Copying a shared buffer, or taking a sub-range of it, doesn't copy the data:
+ * all the slices share the same storage, that is released with the last slice.
+ * Unlike Buffer, the data of a slice isn't zero-terminated.
+ */
+class SP_EXPORT SharedBuffer
+{
+    /**
+     * Shared storage
+     */
+    std::shared_ptr<const Buffer>   m_storage;
+
+    /**
+     * Start of the slice data
+     */
+    const char*                     m_data {nullptr};
+
+    /**
+     * Slice size
+     */
+    size_t                          m_bytes {0};
+
+public:
+    /**
+     * @brief Default constructor
+     *
+     * Creates an empty slice
+     */
+    SharedBuffer() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * Takes over the buffer memory, without copying the data.
+     * @param buffer Buffer&&, buffer to take over
+     */
+    explicit SharedBuffer(Buffer&& buffer);
+
+    /**
+     * @brief Constructor
+     *
+     * Copies the data once into the shared storage.
+     * @param buffer const Buffer&, data to copy
+     */
+    explicit SharedBuffer(const Buffer& buffer);
+
+    /**
+     * @brief Constructor
+     *
+     * Copies the data once into the shared storage.
+     * @param data const char*, data to copy
+     * @param sz size_t, data size
+     */
+    SharedBuffer(const char* data, size_t sz);
+
+    /**
+     * @brief Constructor
+     *
+     * Copies the string once into the shared storage.
+     * @param str const std::string&, string to copy
+     */
+    explicit SharedBuffer(const std::string& str);
+
+    /**
+     * @brief Returns a sub-range of this slice, sharing the same storage
+     *
+     * Throws an exception if the offset is outside of the slice.
+     * @param offset size_t, sub-range offset in this slice
+     * @param length size_t, sub-range length, truncated to the end of this slice
+     */
+    SharedBuffer slice(size_t offset, size_t length = size_t(-1)) const;
+
+    /**
+     * @brief Returns pointer on the slice data
+     */
+    const char* data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * @brief Returns the size of the slice
+     */
+    size_t bytes() const
+    {
+        return m_bytes;
+    }
+
+    /**
+     * @brief Returns true if the slice is empty
+     */
+    bool empty() const
+    {
+        return m_bytes == 0;
+    }
+
+    /**
+     * @brief Returns number of the slices sharing the storage
+     */
+    long useCount() const
+    {
+        return m_storage.use_count();
+    }
+
+    /**
+     * @brief Access the chars by index
+     * @param index size_t, character index
+     */
+    const char& operator[](size_t index) const
+    {
+        return m_data[index];
+    }
+
+    /**
+     * @brief Convertor to std::string
+     */
+    operator std::string() const
+    {
+        return std::string(m_data, m_bytes);
+    }
+};
+
+/**
+ * @}
+ */
+}
+#endif
@@ -30,8 +30,11 @@
 #define __SPTK_SHAREDSTRINGS_H__
 
 #include <sptk5/Exception.h>
+#include <cstring>
 #include <string>
-#include <set>
+#include <deque>
+#include <vector>
+#include <initializer_list>
 
 namespace sptk {
 
@@ -44,19 +47,93 @@ namespace sptk {
  * @brief Shared strings table
  *
  * Contains a table of shared strings for the use with different objects
- * such as XML node, ListView, etc
+ * such as XML node, ListView, etc.
+ *
+ * Strings are interned in an open-addressing hash table. The address of a shared
+ * string is stable until the table is cleared, so it may be used as a string handle:
+ * two handles from the same table are equal if and only if the strings are equal.
+ * Each shared string also keeps its precomputed hash, see hash().
+ *
+ * Names known in advance (for instance, element names of the classes generated by wsdl2cxx)
+ * may be registered in the process-wide static names table, see registerStaticNames().
+ * Every shared strings table looks up the static names first, so such names
+ * are never copied into the document tables.
  */
 class SP_EXPORT SharedStrings
 {
     /**
-     * String set type
+     * @brief Shared string with precomputed hash
+     */
+    class Entry : public std::string
+    {
+    public:
+        /**
+         * String hash
+         */
+        size_t  m_hash;
+
+        /**
+         * @brief Constructor
+         * @param str const char*, string
+         * @param len size_t, string length
+         * @param hash size_t, string hash
+         */
+        Entry(const char* str, size_t len, size_t hash)
+        : std::string(str, len), m_hash(hash)
+        {
+        }
+    };
+
+    /**
+     * Shared strings storage, chunks of entries with stable addresses
+     */
+    std::deque<Entry>           m_entries;
+
+    /**
+     * Hash table of the entries, open addressing with linear probing.
+     * The size is a power of two.
+     */
+    std::vector<const Entry*>   m_table;
+
+    /**
+     * Process-wide static names, consulted before this table, or nullptr
+     */
+    const SharedStrings*        m_staticNames {nullptr};
+
+    /**
+     * @brief Looks up the string in this table only
+     * @param str const char*, string
+     * @param len size_t, string length
+     * @param hash size_t, string hash
+     * @returns shared string, or nullptr if not found
+     */
+    const Entry* lookup(const char* str, size_t len, size_t hash) const;
+
+    /**
+     * @brief Adds new string to this table
+     * @param str const char*, string
+     * @param len size_t, string length
+     * @param hash size_t, string hash
+     * @returns shared string
+     */
+    const Entry& insert(const char* str, size_t len, size_t hash);
+
+    /**
+     * @brief Doubles the hash table size
+     */
+    void rehash();
+
+    /**
+     * @brief Constructor of the static names table
+     * @param useStaticNames bool, if true then process-wide static names are used
+     * @param tableSize size_t, initial hash table size, must be a power of two
      */
-    typedef std::set<std::string> Set;
+    SharedStrings(bool useStaticNames, size_t tableSize);
 
     /**
-     * Set of shared strings
+     * @brief Returns process-wide static names table
      */
-    Set     m_strings;
+    static SharedStrings& staticNames();
 
 public:
     /**
@@ -64,44 +141,138 @@ public:
      */
     SharedStrings();
 
+    /**
+     * @brief Copy constructor is disabled: shared strings are referenced by address
+     */
+    SharedStrings(const SharedStrings&) = delete;
+
+    /**
+     * @brief Assignment is disabled: shared strings are referenced by address
+     */
+    SharedStrings& operator = (const SharedStrings&) = delete;
+
+    /**
+     * @brief Move constructor
+     *
+     * Shared strings keep their addresses, and now belong to this object.
+     * Other object is left empty.
+     * @param other SharedStrings&&, object to move from
+     */
+    SharedStrings(SharedStrings&& other);
+
     /**
      * @brief Find a shared string
      *
-     * Looks for an existing shared string, and returns a const std::string&
+     * Looks for an existing shared string, and returns a const std::string*
+     * to it. If a shared string not found, returns nullptr.
+     * @param str const char *, a string to find
+     * @param len size_t, string length
+     */
+    const std::string* findString(const char *str, size_t len) const;
+
+    /**
+     * @brief Find a shared string
+     *
+     * Looks for an existing shared string, and returns a const std::string*
      * to it. If a shared string not found, returns nullptr.
      * @param str const char *, a string to find
      */
-    const std::string* findString(const char *str) const;
-    
+    const std::string* findString(const char *str) const
+    {
+        return findString(str, strlen(str));
+    }
+
+    /**
+     * @brief Find a shared string
+     *
+     * Looks for an existing shared string, and returns a const std::string*
+     * to it. If a shared string not found, returns nullptr.
+     * @param str const std::string&, a string to find
+     */
+    const std::string* findString(const std::string& str) const
+    {
+        return findString(str.c_str(), str.length());
+    }
+
+    /**
+     * @brief Obtain a shared string
+     *
+     * Looks for an existing shared string, and returns a const std::string&
+     * to it. If a shared string not found, it's created.
+     * @param str const char *, a string to share
+     * @param len size_t, string length
+     */
+    const std::string& shareString(const char *str, size_t len);
+
     /**
      * @brief Obtain a shared string
      *
      * Looks for an existing shared string, and returns a const std::string&
-     * to it. If a shared string not found, it's created with reference count one.
-     * For an existing shared string, every call of this method encreases string
-     * reference counter by one
+     * to it. If a shared string not found, it's created.
      * @param str const char *, a string to share
      */
-    const std::string& shareString(const char *str);
+    const std::string& shareString(const char *str)
+    {
+        return shareString(str, strlen(str));
+    }
 
     /**
      * @brief Obtain a shared string
      *
-     * Looks for an existing shared string, and returns a const char *pointer
-     * to it. If a shared string not found, it's created with reference count one.
-     * For an existing shared string, every call of this method encreases string
-     * reference counter by one
+     * Looks for an existing shared string, and returns a const std::string&
+     * to it. If a shared string not found, it's created.
      * @param str const std::string&, a string to share
      */
-    const std::string& shareString(const std::string& str) 
+    const std::string& shareString(const std::string& str)
     {
-        return shareString(str.c_str());
+        return shareString(str.c_str(), str.length());
     }
-    
+
+    /**
+     * @brief Returns precomputed hash of a shared string
+     *
+     * The string must be obtained from shareString() or findString().
+     * @param sharedString const std::string*, shared string
+     */
+    static size_t hash(const std::string* sharedString)
+    {
+        return static_cast<const Entry*>(sharedString)->m_hash;
+    }
+
+    /**
+     * @brief Computes the hash of a string
+     * @param str const char*, string
+     * @param len size_t, string length
+     */
+    static size_t hash(const char* str, size_t len);
+
+    /**
+     * @brief Returns number of strings in this table, not including static names
+     */
+    size_t stringCount() const
+    {
+        return m_entries.size();
+    }
+
     /**
      * @brief Clear shared starings
+     *
+     * Static names stay valid.
      */
     void clear();
+
+    /**
+     * @brief Registers names in the process-wide static names table
+     *
+     * Static names are frozen when the first shared strings table is created,
+     * so the names must be registered during the program initialization
+     * (typically, by static objects of the generated code).
+     * Later registrations are ignored: such names are simply shared
+     * by every table separately.
+     * @param names std::initializer_list<const char*>, names to register
+     * @returns true if names are registered, false if static names are already frozen
+     */
+    static bool registerStaticNames(std::initializer_list<const char*> names);
 };
 
 /**
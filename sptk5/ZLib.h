@@ -34,24 +34,193 @@
 #if HAVE_ZLIB
 
 #include <sptk5/Buffer.h>
+#include <memory>
+
+struct z_stream_s;
 
 namespace sptk
 {
 
+class ThreadPool;
+
+/**
+ * Incremental compression or decompression stream.
+ *
+ * Input data may be fed in any portions. The output is produced directly
+ * into the destination buffer, that is extended as needed.
+ */
+class SP_EXPORT ZLibStream
+{
+public:
+    /**
+     * Stream direction
+     */
+    enum Mode : uint8_t
+    {
+        COMPRESS,       ///< Compress data
+        DECOMPRESS      ///< Decompress data
+    };
+
+    /**
+     * Compressed data format
+     */
+    enum Format : uint8_t
+    {
+        GZIP,           ///< gzip format (RFC 1952)
+        ZLIB,           ///< zlib format (RFC 1950), aka HTTP 'deflate'
+        RAW,            ///< Raw deflate data (RFC 1951)
+        AUTO            ///< Decompression only: gzip or zlib format, detected by header
+    };
+
+    static constexpr int NoCompression = 0;         ///< Compression level, same as Z_NO_COMPRESSION
+    static constexpr int BestSpeed = 1;             ///< Compression level, same as Z_BEST_SPEED
+    static constexpr int BestCompression = 9;       ///< Compression level, same as Z_BEST_COMPRESSION
+    static constexpr int DefaultCompression = -1;   ///< Compression level, same as Z_DEFAULT_COMPRESSION
+    static constexpr int DefaultStrategy = 0;       ///< Compression strategy, same as Z_DEFAULT_STRATEGY
+
+private:
+    std::unique_ptr<z_stream_s> m_stream;   ///< ZLib stream state
+    Mode        m_mode;             ///< Stream direction
+    bool        m_finished {false}; ///< True if the end of compressed stream is reached or written
+
+    /**
+     * Runs deflate() or inflate() on the input, appending the output to destination buffer
+     * @param dest              Destination buffer
+     * @param data              Input data
+     * @param size              Input data size
+     * @param flush             ZLib flush mode
+     */
+    void process(Buffer& dest, const char* data, size_t size, int flush);
+
+public:
+    /**
+     * Constructor
+     * @param mode              Compress or decompress
+     * @param format            Compressed data format
+     * @param level             Compression level, from NoCompression(0) to BestCompression(9), or DefaultCompression
+     * @param strategy          ZLib compression strategy: Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, or Z_FIXED
+     */
+    explicit ZLibStream(Mode mode, Format format = GZIP, int level = DefaultCompression, int strategy = DefaultStrategy);
+
+    ZLibStream(const ZLibStream&) = delete;
+    ZLibStream& operator = (const ZLibStream&) = delete;
+
+    /**
+     * Destructor
+     */
+    ~ZLibStream();
+
+    /**
+     * Sets preset dictionary for raw deflate compression or decompression.
+     *
+     * For compression, must be called before any data is written.
+     * @param data              Dictionary data
+     * @param size              Dictionary data size
+     */
+    void setDictionary(const char* data, size_t size);
+
+    /**
+     * Feeds input data to the stream.
+     *
+     * Produced output is appended to destination buffer.
+     * When decompressing, data after the end of compressed stream is ignored.
+     * @param dest              Destination buffer
+     * @param data              Input data
+     * @param size              Input data size
+     */
+    void write(Buffer& dest, const char* data, size_t size);
+
+    /**
+     * Feeds input data to the stream.
+     *
+     * Produced output is appended to destination buffer.
+     * @param dest              Destination buffer
+     * @param src               Input data
+     */
+    void write(Buffer& dest, const Buffer& src)
+    {
+        write(dest, src.data(), src.bytes());
+    }
+
+    /**
+     * Flushes all pending compressed output to destination buffer.
+     *
+     * The compressed stream stays open for more data.
+     * @param dest              Destination buffer
+     */
+    void flush(Buffer& dest);
+
+    /**
+     * Completes the stream
+     *
+     * When compressing, writes the rest of compressed data and the stream trailer.
+     * When decompressing, throws an exception if the compressed stream is incomplete.
+     * @param dest              Destination buffer
+     */
+    void finish(Buffer& dest);
+
+    /**
+     * Returns true if the end of the compressed stream is reached (decompression)
+     * or written (compression)
+     */
+    bool finished() const
+    {
+        return m_finished;
+    }
+
+    /**
+     * Resets the stream to start a new compressed stream with the same parameters
+     */
+    void reset();
+
+    /**
+     * Total number of the input bytes processed
+     */
+    size_t totalIn() const;
+
+    /**
+     * Total number of the output bytes produced
+     */
+    size_t totalOut() const;
+};
+
 /**
  * Simple wrapper for ZLib functions
  */
-class ZLib
+class SP_EXPORT ZLib
 {
 public:
+    /**
+     * Default size of the data block compressed by a single thread in parallel compression
+     */
+    static constexpr size_t ParallelBlockSize = 128 * 1024;
+
     /**
      * Compress data using gzip format.
      * 
      * Compressed data is appended to destination buffer
      * @param dest Buffer&, Destination buffer
      * @param src const Buffer&, Source buffer
+     * @param level int, Compression level, from ZLibStream::NoCompression(0) to ZLibStream::BestCompression(9), or ZLibStream::DefaultCompression
+     */
+    static void compress(Buffer& dest, const Buffer& src, int level = ZLibStream::DefaultCompression);
+
+    /**
+     * Compress data using gzip format, using multiple threads.
+     *
+     * Source data is split to blocks that are compressed independently in the thread pool.
+     * Every block uses the tail of the preceding block as a preset dictionary, so compression
+     * ratio is close to single-threaded compression. The result is a standard gzip stream.
+     * Compressed data is appended to destination buffer
+     * @param dest Buffer&, Destination buffer
+     * @param src const Buffer&, Source buffer
+     * @param threadPool ThreadPool&, Thread pool to execute compression tasks
+     * @param threads size_t, Maximum number of threads to use, 0 means the number of CPU cores
+     * @param level int, Compression level, from ZLibStream::NoCompression(0) to ZLibStream::BestCompression(9), or ZLibStream::DefaultCompression
+     * @param blockSize size_t, Size of the data block compressed by a single thread
      */
-    static void compress(Buffer& dest, const Buffer& src);
+    static void compress(Buffer& dest, const Buffer& src, ThreadPool& threadPool, size_t threads = 0,
+                         int level = ZLibStream::DefaultCompression, size_t blockSize = ParallelBlockSize);
 
     /**
      * Uncompress data in gzip format
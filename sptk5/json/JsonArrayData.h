@@ -68,7 +68,7 @@ protected:
     /**
      * Document this object belongs to
      */
-    const Document*         m_document;
+    Document*               m_document;
 
     /**
      * Parent JSON element
@@ -93,7 +93,7 @@ public:
      * @param document          Document this object belongs to
      * @param parent            Parent JSON element
      */
-    explicit ArrayData(const Document* document, Element* parent = NULL);
+    explicit ArrayData(Document* document, Element* parent = NULL);
 
     /**
      * Destructor
@@ -114,7 +114,7 @@ public:
      */
     template <typename T> void add(T value)
     {
-        add(new Element(value));
+        add(new (m_document) Element(m_document, value));
     }
 
     /**
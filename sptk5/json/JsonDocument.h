@@ -31,8 +31,12 @@
 
 #include "JsonElement.h"
 #include "JsonArrayData.h"
+#include "JsonWriter.h"
+#include "JsonMessagePack.h"
 #include <istream>
+#include <map>
 #include <sptk5/Buffer.h>
+#include <sptk5/BufferAllocator.h>
 
 namespace sptk { namespace json {
 
@@ -45,23 +49,51 @@ namespace sptk { namespace json {
 class Document
 {
     friend class ObjectData;
+    friend class ArrayData;
     friend class Element;
+    friend class JsonReader;
+    friend class StreamReader;
+    friend class MessagePackReader;
 
     /**
      * Root element of the document
      */
     Element*        m_root;
 
+    /**
+     * Shared strings for element names
+     */
     SharedStrings   m_sharedStrings;
 
+    /**
+     * Storage for the elements and their string values
+     */
+    ArenaBufferAllocator    m_arena;
+
+    /**
+     * List of released element memory blocks, available for reuse
+     */
+    void*           m_freeElements {nullptr};
+
+    /**
+     * Released string value memory blocks, available for reuse, by block size
+     */
+    std::multimap<size_t, char*>    m_freeStrings;
+
+    /**
+     * Source data referenced by string values, if document is loaded without copying them
+     */
+    Buffer          m_source;
+
     const Element   m_emptyElement;
 
     /**
      * Parse JSON text, replacing current document content
-     * @param json const std::string&, JSON text
+     * @param json const char*, JSON text, doesn't have to be zero-terminated
+     * @param length size_t, JSON text length
      * @throw Exception if there is a problem parsing JSON document
      */
-    void parse(const std::string& json);
+    void parse(const char* json, size_t length);
 
     /**
      * Disable copy constructor
@@ -109,6 +141,25 @@ public:
      */
     void load(const char* json);
 
+    /**
+     * Load document from JSON text, replacing existing document
+     *
+     * JSON text is parsed in place, without making a copy of it.
+     * @param json const char*, JSON text, doesn't have to be zero-terminated
+     * @param length size_t, JSON text length
+     * @throw Exception if there is a problem parsing JSON document
+     */
+    void load(const char* json, size_t length);
+
+    /**
+     * Load document from JSON text, replacing existing document
+     *
+     * JSON text is parsed in place, without making a copy of it.
+     * @param json const Buffer&, JSON text
+     * @throw Exception if there is a problem parsing JSON document
+     */
+    void load(const Buffer& json);
+
     /**
      * Load document from JSON text, replacing existing document
      * @param json std::istream&, JSON text
@@ -116,6 +167,37 @@ public:
      */
     void load(std::istream& json);
 
+    /**
+     * Load document from MessagePack data, replacing existing document
+     *
+     * String values are copied into the document.
+     * @param data const char*, MessagePack data
+     * @param length size_t, MessagePack data length
+     * @throw Exception if there is a problem decoding MessagePack data
+     */
+    void loadMessagePack(const char* data, size_t length);
+
+    /**
+     * Load document from MessagePack data, replacing existing document
+     *
+     * String values are copied into the document.
+     * @param data const Buffer&, MessagePack data
+     * @throw Exception if there is a problem decoding MessagePack data
+     */
+    void loadMessagePack(const Buffer& data)
+    {
+        loadMessagePack(data.c_str(), data.bytes());
+    }
+
+    /**
+     * Load document from MessagePack data, replacing existing document
+     *
+     * Document takes ownership of the data, and string values reference it without copying.
+     * @param data Buffer&&, MessagePack data
+     * @throw Exception if there is a problem decoding MessagePack data
+     */
+    void loadMessagePack(Buffer&& data);
+
     /**
      * Export JSON element (and all children) to stream
      * @param stream std::ostream&, Stream to export JSON
@@ -137,6 +219,12 @@ public:
      */
     void exportTo(xml::Document& document, const std::string& rootNodeName="data") const;
 
+    /**
+     * Export JSON element (and all children) to buffer, in MessagePack format
+     * @param buffer sptk::Buffer&, Buffer to export MessagePack data, the existing content is replaced
+     */
+    void exportMessagePack(Buffer& buffer) const;
+
     /**
      * Get document root element
      */
@@ -152,6 +240,14 @@ public:
      */
     void clear();
 
+    /**
+     * Get total size of memory blocks allocated for the document elements and string values
+     */
+    size_t allocated() const
+    {
+        return m_arena.allocated();
+    }
+
 protected:
 
     /**
@@ -182,6 +278,63 @@ protected:
     {
         return &m_sharedStrings.shareString(str);
     }
+
+    /**
+     * Get shared string matching passed string
+     * @param str               String
+     * @param length            String length
+     * @return shared string
+     */
+    const std::string* getString(const char* str, size_t length)
+    {
+        return &m_sharedStrings.shareString(str, length);
+    }
+
+    /**
+     * Find shared string matching passed string, without creating it
+     * @param str               String
+     * @return shared string, or nullptr if not found
+     */
+    const std::string* findString(const std::string& str) const
+    {
+        return m_sharedStrings.findString(str);
+    }
+
+    /**
+     * Allocate memory for an element from the document storage
+     * @return element memory
+     */
+    void* allocateElement();
+
+    /**
+     * Return element memory to the document storage
+     * @param element           Element memory
+     */
+    void releaseElement(void* element) noexcept;
+
+    /**
+     * Destroy element created in the document storage, and release its memory
+     * @param element           Element to destroy
+     */
+    void destroyElement(Element* element) noexcept;
+
+    /**
+     * Store a copy of string value in the document
+     *
+     * The copy is zero-terminated, and exists until it's released, or the document is cleared or destroyed.
+     * Memory of released strings is reused.
+     * @param str               String
+     * @param length            String length
+     * @return stored string
+     */
+    const char* storeString(const char* str, size_t length);
+
+    /**
+     * Release string value, stored in the document, so its memory can be reused
+     * @param str               String returned by storeString()
+     * @param length            String length, no more than the length passed to storeString()
+     */
+    void releaseString(const char* str, size_t length) noexcept;
 };
 
 }}
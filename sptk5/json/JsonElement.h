@@ -30,10 +30,12 @@
 #define __JSON__ELEMENT_H__
 
 #include <sptk5/cxml>
+#include <sptk5/Buffer.h>
 #include <sptk5/Strings.h>
 #include <sptk5/Exception.h>
 #include <sptk5/json/JsonObjectData.h>
 #include <set>
+#include <functional>
 
 namespace sptk { namespace json {
 
@@ -46,6 +48,12 @@ namespace sptk { namespace json {
  */
 typedef std::vector<Element*> ElementSet;
 
+/**
+ * Callback for JSON elements matched in select() method.
+ * Returns false to stop selection.
+ */
+typedef std::function<bool(Element&)> ElementVisitor;
+
 /**
  * JSON Element type
  */
@@ -59,6 +67,11 @@ enum Type {
 };
 
 class ArrayData;
+class JsonReader;
+class StreamReader;
+class MessagePack;
+class MessagePackReader;
+class Writer;
 
 /**
  * JSON Element
@@ -69,6 +82,11 @@ class Element
 {
     friend class Document;
     friend class Parser;
+    friend class JsonReader;
+    friend class StreamReader;
+    friend class MessagePack;
+    friend class MessagePackReader;
+    friend class Writer;
     friend class ArrayData;
     friend class ObjectData;
 protected:
@@ -87,29 +105,46 @@ protected:
      */
     Type            m_type;
 
+    /**
+     * String value length, for JDT_STRING element
+     */
+    uint32_t        m_stringLength : 31;
+
+    /**
+     * String value is stored in the document, and its memory may be reused
+     */
+    uint32_t        m_stringOwned : 1;
+
     /**
      * JSON element data
      */
     union {
         double              m_number;
-        const std::string*  m_string;
+        const char*         m_string;   ///< String value, stored in the document or in its source data
         bool                m_boolean;
         ArrayData*          m_array;
         ObjectData*         m_object;
     } m_data;
 
+public:
+    /**
+     * Maximum length of string value
+     */
+    static constexpr size_t MaxStringLength = 0x7FFFFFFF;
+
     /**
      * XPath element
      */
     struct XPathElement {
         String          name;       ///< Path element name
         int             index {0};  ///< Path element index(position) from start: 1..N - element index, -1 - last element, 0 - don't use
+        bool            matchAny {false};   ///< Path element name is '*'
         /**
          * Constructor
          * @param name          Path element name
          * @param index         Path element index(position) from start: 1..N - element index, -1 - last element, 0 - don't use
          */
-        XPathElement(const String& name, int index) : name(name), index(index) {}
+        XPathElement(const String& name, int index) : name(name), index(index), matchAny(name == "*") {}
 
         /**
          * Copy constructor
@@ -119,7 +154,11 @@ protected:
     };
 
     /**
-     * XPath
+     * Compiled XPath
+     *
+     * Parsing of XPath expression is done once, and the compiled XPath
+     * may be used to select elements from any number of documents.
+     * As in XPath, element position starts from 1, so position [0] is rejected.
      */
     struct XPath : public std::vector<XPathElement>
     {
@@ -131,14 +170,7 @@ protected:
         explicit XPath(const String& xpath);
     };
 
-    /**
-     * Append matched element to element set
-     * @param elements          Matched element set
-     * @param xpathElement      Current XPath element
-     * @param element           Current element
-     */
-    void appendMatchedElement(ElementSet& elements, const Element::XPathElement& xpathElement, Element* element);
-
+protected:
     /**
      * Clear JSON element.
      * Releases memory allocated by string, array, or object data,
@@ -154,17 +186,31 @@ protected:
 
     /**
      * Move element
+     *
+     * Strings and child elements of the element from another document are
+     * stored in that document's memory, so they are copied into this document.
      * @param other Element&&, Element to move from
      */
-    void moveElement(Element&& other) noexcept;
+    void moveElement(Element&& other);
+
+    /**
+     * Set the document this element and its child elements belong to
+     * @param document          Parent JSON document
+     */
+    void setDocument(Document* document);
 
     /**
-     * Export JSON element to text format
-     * @param stream            Output stream
-     * @param formatted         If true then output JSON text is indented. Otherwise, it is using minimal formatting (elements separated with single space).
-     * @param indent            Formatting indent
+     * Set string value, storing a copy of it in the document.
+     * If the current string value is stored in the document and the new value fits, its memory is reused.
+     * @param value             String value
+     * @param length            String value length
      */
-    void exportValueTo(std::ostream& stream, bool formatted, size_t indent) const;
+    void setString(const char* value, size_t length);
+
+    /**
+     * Return memory of the string value to the document, if the value is stored in the document
+     */
+    void releaseString() noexcept;
 
     /**
      * Export JSON element to XML element
@@ -198,6 +244,16 @@ public:
     void selectElements(ElementSet& elements, const XPath& xpath, size_t xpathPosition, bool rootOnly);
 
 private:
+    /**
+     * Find all child elements matching particular xpath element
+     * @param xpath             Xpath elements
+     * @param xpathPosition     Position in xpath currently being checked
+     * @param rootOnly          Flag indicating that only root level elements are checked
+     * @param visitor           Callback for matched elements, returns false to stop
+     * @return false if visitor stopped selection
+     */
+    template <typename Visitor>
+    bool selectElements(const XPath& xpath, size_t xpathPosition, bool rootOnly, Visitor& visitor);
 
     /**
      * Blocked constructor
@@ -255,14 +311,14 @@ public:
      * @param document          Parent document
      * @param value             String value
      */
-    Element(Document* document,const String& value) noexcept;
+    Element(Document* document,const String& value);
 
     /**
      * Constructor
      * @param document          Parent document
      * @param value             String value
      */
-    Element(Document* document,const char* value) noexcept;
+    Element(Document* document,const char* value);
 
     /**
      * Constructor
@@ -308,13 +364,35 @@ public:
      * @param document          Parent JSON document
      * @param other             Element to assign from
      */
-    Element(Document* document, Element&& other) noexcept;
+    Element(Document* document, Element&& other);
 
     /**
      * Destructor
      */
     ~Element();
 
+    /**
+     * Allocate memory for the element from the document storage.
+     *
+     * Elements are created as new (document) Element(document, ...),
+     * and destroyed by the document.
+     * @param size              Element size
+     * @param document          Document the element belongs to
+     */
+    static void* operator new(size_t size, Document* document);
+
+    /**
+     * Release element memory, if element constructor throws an exception
+     * @param element           Element memory
+     * @param document          Document the element belongs to
+     */
+    static void operator delete(void* element, Document* document) noexcept;
+
+    /**
+     * Elements can't be deleted directly, they are destroyed by the document
+     */
+    static void operator delete(void* element) = delete;
+
     /**
      * Assignment operator (template)
      * @tparam T                Data type to assign
@@ -338,7 +416,7 @@ public:
      * Assignment operator
      * @param other             Element to assign from
      */
-    Element& operator = (Element&& other) noexcept;
+    Element& operator = (Element&& other);
 
     /**
      * Add array element to JSON array
@@ -372,7 +450,7 @@ public:
      */
     void set(const String& name)
     {
-        add(name, new Element(m_document));
+        add(name, new (m_document) Element(m_document));
     }
 
     /**
@@ -382,7 +460,7 @@ public:
      */
     template <typename T> void set(const String& name, T value)
     {
-        add(name, new Element(m_document, value));
+        add(name, new (m_document) Element(m_document, value));
     }
 
     /**
@@ -390,7 +468,7 @@ public:
      */
     void push_back()
     {
-        add(new Element(m_document));
+        add(new (m_document) Element(m_document));
     }
 
     /**
@@ -399,7 +477,7 @@ public:
      */
     template <typename T> void push_back(T value)
     {
-        add(new Element(m_document, value));
+        add(new (m_document) Element(m_document, value));
     }
 
 protected:
@@ -427,7 +505,7 @@ protected:
      */
     Element* add(const String& name, int value)
     {
-        return add(name, new Element(m_document, value));
+        return add(name, new (m_document) Element(m_document, value));
     }
 
     /**
@@ -437,7 +515,7 @@ protected:
      */
     Element* add(const String& name, int64_t value)
     {
-        return add(name, new Element(m_document, value));
+        return add(name, new (m_document) Element(m_document, value));
     }
 
     /**
@@ -447,7 +525,7 @@ protected:
      */
     Element* add(const String& name, double value)
     {
-        return add(name, new Element(m_document, value));
+        return add(name, new (m_document) Element(m_document, value));
     }
 
     /**
@@ -457,7 +535,7 @@ protected:
      */
     Element* add(const String& name, const std::string& value)
     {
-        return add(name, new Element(m_document, value));
+        return add(name, new (m_document) Element(m_document, value));
     }
 
     /**
@@ -467,7 +545,7 @@ protected:
      */
     Element* add(const String& name, const char* value)
     {
-        return add(name, new Element(m_document, value));
+        return add(name, new (m_document) Element(m_document, value));
     }
 
     /**
@@ -477,7 +555,7 @@ protected:
      */
     Element* add(const String& name, bool value)
     {
-        return add(name, new Element(m_document, value));
+        return add(name, new (m_document) Element(m_document, value));
     }
 
     /**
@@ -487,7 +565,7 @@ protected:
      */
     Element* add(const String& name, ArrayData* value)
     {
-        return add(name, new Element(m_document, value));
+        return add(name, new (m_document) Element(m_document, value));
     }
 
     /**
@@ -498,7 +576,7 @@ protected:
      */
     Element* add(const String& name, ObjectData* value)
     {
-        return add(name, new Element(m_document, value));
+        return add(name, new (m_document) Element(m_document, value));
     }
 
 public:
@@ -598,6 +676,12 @@ public:
      */
     String getString(const String& name="") const;
 
+    /**
+     * Format number as text, the same way as getString() does for number elements
+     * @param number            Number to format
+     */
+    static String formatNumber(double number);
+
     /**
      * Get value of JSON element
      * @param name              Optional name of the element in the object element. Otherwise, use this element.
@@ -647,6 +731,13 @@ public:
      */
     void exportTo(std::ostream& stream, bool formatted=true) const;
 
+    /**
+     * Export JSON element (and all children) to buffer
+     * @param buffer            Buffer to export JSON, the existing content is replaced
+     * @param formatted         If true then JSON text is nicely formatted, but takes more space
+     */
+    void exportTo(Buffer& buffer, bool formatted=true) const;
+
     /**
      * Export JSON element (and all children) to XML element
      * @param name              Parent element name
@@ -666,6 +757,22 @@ public:
      */
     void select(ElementSet& elements, const String& xpath);
 
+    /**
+     * Selects elements as defined by compiled XPath
+     * @param elements          The resulting list of elements
+     * @param xpath             Compiled xpath for elements
+     */
+    void select(ElementSet& elements, const XPath& xpath);
+
+    /**
+     * Selects elements as defined by compiled XPath, without collecting them
+     *
+     * Matched elements are passed to visitor as they are found.
+     * @param xpath             Compiled xpath for elements
+     * @param visitor           Callback for matched elements, returns false to stop selection
+     */
+    void select(const XPath& xpath, const ElementVisitor& visitor);
+
     /**
      * Element type check
      * @return true if element is a number
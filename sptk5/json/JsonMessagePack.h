@@ -0,0 +1,85 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       JsonMessagePack.h - description                        ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __JSON__MESSAGE_PACK_H__
+#define __JSON__MESSAGE_PACK_H__
+
+#include <sptk5/Buffer.h>
+#include <sptk5/json/JsonElement.h>
+
+namespace sptk { namespace json {
+
+/// @addtogroup JSON
+/// @{
+
+/**
+ * MessagePack binary encoding of JSON elements
+ *
+ * MessagePack (https://msgpack.org) is a compact binary representation of JSON data,
+ * that is faster to produce and to parse than JSON text.
+ * Numbers are encoded as integers when they have no fractional part.
+ * When decoding, binary values are stored as strings, and extension types are not supported.
+ */
+class MessagePack
+{
+public:
+    /**
+     * MIME type of MessagePack content
+     */
+    static const char* const ContentType;
+
+    /**
+     * Encode JSON element (and all children)
+     * @param output            Output buffer, encoded data is appended to it
+     * @param element           JSON element to encode
+     */
+    static void write(Buffer& output, const Element& element);
+
+    /**
+     * Decode JSON element (and all children)
+     *
+     * Element should have JDT_NULL type (empty element) before calling this method.
+     * @param element           JSON element to decode into
+     * @param data              MessagePack data
+     * @param length            MessagePack data length
+     * @param copyStrings       If true then string values are copied into the element's document.
+     *                          Otherwise, they reference the data that must exist as long as the document.
+     */
+    static void read(Element& element, const char* data, size_t length, bool copyStrings=true);
+
+    /**
+     * Check if content type is MessagePack
+     * @param contentType       Content type, for instance from Content-Type HTTP header
+     */
+    static bool isContentType(const String& contentType);
+};
+
+/// @}
+}}
+
+#endif
@@ -31,8 +31,9 @@
 
 #include <sptk5/sptk.h>
 #include <sptk5/Exception.h>
-#include <set>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace sptk { namespace json {
 
@@ -44,6 +45,10 @@ class Document;
 
 /**
  * Map of names to JSON Element objects
+ *
+ * Child elements are stored in insertion order, as a flat vector of name and element pairs.
+ * Since most JSON objects have just a few elements, lookup is a linear scan of shared name pointers.
+ * When the number of elements exceeds IndexThreshold, a hash index is built for lookups.
  */
 class ObjectData
 {
@@ -53,19 +58,29 @@ class ObjectData
 
 public:
     /**
-     * Type definition: map of element names to elements
+     * Type definition: element name and element pair
      */
-    typedef std::unordered_map<const std::string*, Element*> Map;
+    typedef std::pair<const std::string*, Element*> Item;
 
     /**
-     * Type definition: map of element names to elements iterator
+     * Type definition: vector of element names and elements
      */
-    typedef Map::iterator                       iterator;
+    typedef std::vector<Item>                   Items;
 
     /**
-     * Type definition: map of element names to elements const iterator
+     * Type definition: child elements iterator
      */
-    typedef Map::const_iterator                 const_iterator;
+    typedef Items::iterator                     iterator;
+
+    /**
+     * Type definition: child elements const iterator
+     */
+    typedef Items::const_iterator               const_iterator;
+
+    /**
+     * Number of elements, after which lookups use hash index
+     */
+    static constexpr size_t IndexThreshold = 16;
 
 protected:
 
@@ -77,13 +92,43 @@ protected:
     /**
      * Child JSON elements
      */
-    Map                                         m_items;
+    Items                                       m_items;
+
+    /**
+     * Index of child elements positions by shared name, or nullptr if there are not many elements
+     */
+    std::unique_ptr<std::unordered_map<const std::string*, size_t>> m_index;
 
     /**
      * Set parent JSON element
      */
     void setParent(Element *parent);
 
+    /**
+     * Find position of child element
+     * @param sharedName        Shared child element name
+     * @returns Child element position, or m_items.size() if not found
+     */
+    size_t findPosition(const std::string* sharedName) const;
+
+    /**
+     * Find position of child element
+     * @param name              Child element name
+     * @returns Child element position, or m_items.size() if not found
+     */
+    size_t findPosition(const std::string& name) const;
+
+    /**
+     * Remove child element at position
+     * @param position          Child element position
+     */
+    void erase(size_t position);
+
+    /**
+     * Build the index of child elements, if there are enough of them
+     */
+    void buildIndex();
+
 public:
 
     /**
@@ -31,8 +31,14 @@
 
 #include <sptk5/json/JsonElement.h>
 #include <sptk5/json/JsonArrayData.h>
+#include <chrono>
+#include <istream>
 
-namespace sptk { namespace json {
+namespace sptk {
+
+class BaseSocket;
+
+namespace json {
 
 /// @addtogroup JSON
 /// @{
@@ -58,7 +64,243 @@ public:
      * @param jsonElement Element&, JSON element
      * @param json const std::string&, JSON text
      */
-    void parse(Element& jsonElement, const std::string& json);
+    void parse(Element& jsonElement, const std::string& json)
+    {
+        parse(jsonElement, json.c_str(), json.length());
+    }
+
+    /**
+     * Parse JSON text in place
+     *
+     * JSON text doesn't have to be zero-terminated. String values are decoded
+     * directly into the storage of the element's document.
+     * Root element should have JDT_NULL type (empty element) before calling this method.
+     * @param jsonElement Element&, JSON element
+     * @param json const char*, JSON text
+     * @param length size_t, JSON text length
+     */
+    void parse(Element& jsonElement, const char* json, size_t length);
+};
+
+/**
+ * Streaming JSON reader
+ *
+ * Reads JSON text from memory, stream, or socket as a sequence of events,
+ * without building the document tree. Only a small window of the input is kept in memory,
+ * so the size of the input is not limited by available memory.
+ *
+ * A large array of records can be processed one record at a time:
+ * @code
+ * std::ifstream file("records.json");
+ * json::StreamReader reader(file);
+ * json::Document record;
+ * while (reader.readArrayItem(record)) {
+ *     // Process record.root()
+ * }
+ * @endcode
+ */
+class StreamReader
+{
+public:
+    /**
+     * JSON reader events
+     */
+    enum Event : uint8_t
+    {
+        NONE,               ///< Nothing is read yet
+        BEGIN_OBJECT,       ///< Start of object
+        END_OBJECT,         ///< End of object
+        BEGIN_ARRAY,        ///< Start of array
+        END_ARRAY,          ///< End of array
+        KEY,                ///< Object element name, available with name()
+        STRING,             ///< String value, available with getString()
+        NUMBER,             ///< Number value, available with getNumber()
+        BOOLEAN,            ///< Boolean value, available with getBoolean()
+        NULL_VALUE,         ///< Null value
+        END_OF_DATA         ///< End of JSON text
+    };
+
+    /**
+     * Default size of the input block
+     */
+    static constexpr size_t DefaultBlockSize = 65536;
+
+    /**
+     * Constructor
+     *
+     * JSON text should be available until reading is completed.
+     * @param json              JSON text
+     * @param length            JSON text length
+     */
+    StreamReader(const char* json, size_t length);
+
+    /**
+     * Constructor
+     *
+     * JSON text should be available until reading is completed.
+     * @param json              JSON text
+     */
+    explicit StreamReader(const Buffer& json)
+    : StreamReader(json.c_str(), json.bytes())
+    {}
+
+    /**
+     * Constructor
+     * @param stream            Input stream, for instance, a file
+     * @param blockSize         Size of the block read from the stream
+     */
+    explicit StreamReader(std::istream& stream, size_t blockSize=DefaultBlockSize);
+
+    /**
+     * Constructor
+     * @param socket            Input socket
+     * @param timeout           Read timeout
+     * @param blockSize         Maximum size of the block read from the socket
+     */
+    explicit StreamReader(BaseSocket& socket, std::chrono::milliseconds timeout=std::chrono::seconds(30),
+                          size_t blockSize=DefaultBlockSize);
+
+    /**
+     * Read next event
+     * @return event type
+     */
+    Event next();
+
+    /**
+     * Last event type
+     */
+    Event event() const
+    {
+        return m_event;
+    }
+
+    /**
+     * Object element name, from the last KEY event
+     */
+    const String& name() const
+    {
+        return m_name;
+    }
+
+    /**
+     * String value, from the last STRING event
+     */
+    const String& getString() const
+    {
+        return m_string;
+    }
+
+    /**
+     * Number value, from the last NUMBER event
+     */
+    double getNumber() const
+    {
+        return m_number;
+    }
+
+    /**
+     * Boolean value, from the last BOOLEAN event
+     */
+    bool getBoolean() const
+    {
+        return m_boolean;
+    }
+
+    /**
+     * Current nesting level of objects and arrays
+     */
+    size_t depth() const
+    {
+        return m_scopes.size();
+    }
+
+    /**
+     * Read the value that starts with the last event into element.
+     *
+     * If the last event is BEGIN_OBJECT or BEGIN_ARRAY, the whole object or array is read.
+     * Existing element content is replaced.
+     * @param element           Element to read value into
+     */
+    void read(Element& element);
+
+    /**
+     * Skip the rest of the object or array, if the last event is BEGIN_OBJECT or BEGIN_ARRAY
+     */
+    void skip();
+
+    /**
+     * Read next item of the array into document root.
+     *
+     * If nothing is read yet, JSON text must start with array. Otherwise, the reader
+     * should be positioned inside the array, for instance after BEGIN_ARRAY event.
+     * Previous document content is released, so memory use is limited by the size of a single item.
+     * @param document          Document to read array item into
+     * @return false if the end of array is reached
+     */
+    bool readArrayItem(Document& document);
+
+private:
+
+    /**
+     * Reader state within the current object or array
+     */
+    enum State : uint8_t
+    {
+        EXPECT_VALUE,       ///< Value is expected
+        FIRST_ITEM,         ///< Just entered object or array
+        OBJECT_VALUE,       ///< Object element name is read, value is expected
+        AFTER_VALUE         ///< Value is read, separator or end of object or array is expected
+    };
+
+    std::istream*           m_stream {nullptr};     ///< Input stream, if reading from stream
+    BaseSocket*             m_socket {nullptr};     ///< Input socket, if reading from socket
+    std::chrono::milliseconds m_timeout {0};        ///< Socket read timeout
+    size_t                  m_blockSize {0};        ///< Input block size
+    Buffer                  m_buffer;               ///< Input window, if reading from stream or socket
+    const char*             m_start;                ///< Start of input window
+    const char*             m_pos;                  ///< Current read position
+    const char*             m_end;                  ///< End of input window
+    size_t                  m_offset {0};           ///< Offset of input window start in JSON text
+    std::vector<char>       m_scopes;               ///< Stack of open objects and arrays
+    State                   m_state {EXPECT_VALUE}; ///< Reader state
+    Event                   m_event {NONE};         ///< Last event
+    String                  m_name;                 ///< Last object element name
+    String                  m_string;               ///< Last string value
+    double                  m_number {0};           ///< Last number value
+    bool                    m_boolean {false};      ///< Last boolean value
+
+    /**
+     * Read next block of input, keeping unread data
+     * @return false if no more data
+     */
+    bool fill();
+
+    /**
+     * Make sure that at least size bytes are available at the current position
+     * @param size              Required number of bytes
+     * @return false if input ends before that
+     */
+    bool ensure(size_t size);
+
+    /**
+     * Skip spaces, and return next character
+     * @return next character, or -1 if no more data
+     */
+    int nextChar();
+
+    [[noreturn]] void throwError(const String& message) const;
+
+    [[noreturn]] void throwUnexpectedCharacterError(char expected) const;
+
+    void readString(String& output);
+
+    void readNumber();
+
+    void readLiteral(const char* literal, size_t length);
+
+    Event readValue(int firstChar);
+
+    void readElement(Element& element);
 };
 
 }}
@@ -0,0 +1,277 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       JsonWriter.h - description                             ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __JSON__WRITER_H__
+#define __JSON__WRITER_H__
+
+#include <sptk5/Buffer.h>
+#include <sptk5/json/JsonElement.h>
+#include <vector>
+
+namespace sptk {
+
+class BaseSocket;
+
+namespace json {
+
+/// @addtogroup JSON
+/// @{
+
+/**
+ * JSON writer
+ *
+ * Renders JSON text directly into a buffer, or a socket.
+ * May be used to render a JSON element, or to produce JSON text without
+ * building a document, with beginObject(), key(), value(), and endObject() calls:
+ * @code
+ * Buffer output;
+ * json::Writer writer(output);
+ * writer.beginObject();
+ * writer.key("name");
+ * writer.value("John");
+ * writer.key("skills");
+ * writer.beginArray();
+ * writer.value("C++");
+ * writer.endArray();
+ * writer.endObject();
+ * @endcode
+ */
+class Writer
+{
+    /**
+     * State of open JSON object or array
+     */
+    struct Scope
+    {
+        bool    isObject;       ///< True for object, false for array
+        size_t  count;          ///< Number of elements written
+    };
+
+    Buffer                  m_buffer;               ///< Output buffer used for writing to socket
+    Buffer&                 m_output;               ///< Output buffer
+    BaseSocket*             m_socket {nullptr};     ///< Output socket, or nullptr
+    size_t                  m_flushSize {0};        ///< Output buffer size that triggers writing to socket
+    bool                    m_formatted;            ///< If true then JSON text is indented
+    bool                    m_expectingValue {false};   ///< True if key is written, and value is expected
+    std::vector<Scope>      m_scopes;               ///< Open objects and arrays
+
+    /**
+     * Prepare writing a value: write separator and indentation, and check that value is expected
+     */
+    void beforeValue();
+
+    /**
+     * Write new line and indentation, for formatted output
+     * @param depth             Indentation depth
+     */
+    void newLine(size_t depth);
+
+    /**
+     * Write output to socket if output buffer is large enough
+     */
+    void checkFlush()
+    {
+        if (m_socket != nullptr && m_output.bytes() >= m_flushSize)
+            flush();
+    }
+
+    /**
+     * Close object or array
+     * @param isObject          True for object, false for array
+     * @param bracket           Closing bracket
+     */
+    void endScope(bool isObject, char bracket);
+
+public:
+    /**
+     * Constructor
+     *
+     * JSON text is appended to the output buffer.
+     * @param output            Output buffer
+     * @param formatted         If true then JSON text is nicely formatted, but takes more space
+     */
+    explicit Writer(Buffer& output, bool formatted = false);
+
+    /**
+     * Constructor
+     *
+     * JSON text is written to the socket every time when the output exceeds flushSize,
+     * and when flush() is called.
+     * @param socket            Output socket
+     * @param formatted         If true then JSON text is nicely formatted, but takes more space
+     * @param flushSize         Size of the output that is written to socket at once
+     */
+    Writer(BaseSocket& socket, bool formatted = false, size_t flushSize = 16384);
+
+    /**
+     * Start JSON object
+     */
+    void beginObject();
+
+    /**
+     * End JSON object
+     */
+    void endObject();
+
+    /**
+     * Start JSON array
+     */
+    void beginArray();
+
+    /**
+     * End JSON array
+     */
+    void endArray();
+
+    /**
+     * Write the name of the next element of JSON object
+     * @param name              Element name
+     * @param length            Element name length
+     */
+    void key(const char* name, size_t length);
+
+    /**
+     * Write the name of the next element of JSON object
+     * @param name              Element name
+     */
+    void key(const std::string& name)
+    {
+        key(name.c_str(), name.length());
+    }
+
+    /**
+     * Write the name of the next element of JSON object
+     * @param name              Element name
+     */
+    void key(const char* name)
+    {
+        key(name, strlen(name));
+    }
+
+    /**
+     * Write string value
+     * @param str               String value
+     * @param length            String value length
+     */
+    void value(const char* str, size_t length);
+
+    /**
+     * Write string value
+     * @param str               String value
+     */
+    void value(const std::string& str)
+    {
+        value(str.c_str(), str.length());
+    }
+
+    /**
+     * Write string value
+     * @param str               String value
+     */
+    void value(const char* str)
+    {
+        value(str, strlen(str));
+    }
+
+    /**
+     * Write number value
+     * @param number            Number value
+     */
+    void value(double number);
+
+    /**
+     * Write number value
+     * @param number            Number value
+     */
+    void value(int number)
+    {
+        value(int64_t(number));
+    }
+
+    /**
+     * Write number value
+     * @param number            Number value
+     */
+    void value(int64_t number);
+
+    /**
+     * Write number value
+     * @param number            Number value
+     */
+    void value(uint64_t number);
+
+    /**
+     * Write boolean value
+     * @param boolean           Boolean value
+     */
+    void value(bool boolean);
+
+    /**
+     * Write null value
+     */
+    void null();
+
+    /**
+     * Write JSON element, and all its children
+     * @param element           JSON element
+     */
+    void value(const Element& element);
+
+    /**
+     * Write buffered output to socket
+     */
+    void flush();
+
+    /**
+     * Append quoted and escaped JSON string to buffer
+     * @param output            Output buffer
+     * @param str               String
+     * @param length            String length
+     */
+    static void appendString(Buffer& output, const char* str, size_t length);
+
+    /**
+     * Append JSON number to buffer, in the shortest form that reads back to the same value
+     * @param output            Output buffer
+     * @param number            Number
+     */
+    static void appendNumber(Buffer& output, double number);
+
+    /**
+     * Append JSON integer number to buffer
+     * @param output            Output buffer
+     * @param number            Number
+     */
+    static void appendNumber(Buffer& output, int64_t number);
+};
+
+/// @}
+
+}}
+
+#endif
@@ -70,6 +70,7 @@
 #include <sptk5/net/Host.h>
 #include <sptk5/Strings.h>
 #include <sptk5/Buffer.h>
+#include <sptk5/BufferChain.h>
 
 namespace sptk
 {
@@ -183,8 +184,23 @@ public:
     * @param openMode          SOM_CREATE for UDP socket, SOM_BIND for the server socket, and SOM_CONNECT for the client socket
     * @param addr              Defines socket address/port information
     * @param timeout           Connection timeout. If 0 the wait forever;
+    * @param backlog           Maximum length of pending connections queue, for SOM_BIND mode
     */
-    void open_addr(CSocketOpenMode openMode = SOM_CREATE, const sockaddr_in* addr = nullptr, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+    void open_addr(CSocketOpenMode openMode = SOM_CREATE, const sockaddr_in* addr = nullptr, std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
+                   int backlog = SOMAXCONN);
+
+    /**
+    * @brief Opens the socket connection by IPv4 or IPv6 address.
+    *
+    * The socket is created in the address family, rather than in the socket domain.
+    * @param openMode          SOM_CREATE for UDP socket, SOM_BIND for the server socket, and SOM_CONNECT for the client socket
+    * @param addr              Defines socket address/port information
+    * @param addrLength        Size of the address structure
+    * @param timeout           Connection timeout. If 0 the wait forever;
+    * @param backlog           Maximum length of pending connections queue, for SOM_BIND mode
+    */
+    void open_addr(CSocketOpenMode openMode, const sockaddr* addr, socklen_t addrLength, std::chrono::milliseconds timeout,
+                   int backlog = SOMAXCONN);
 
 public:
     /**
@@ -274,9 +290,13 @@ public:
 
     /**
      * @brief Opens the server socket connection on port (binds/listens)
+     *
+     * If port number is 0, then the port is selected by the system, and defined in host() after the call.
      * @param portNumber        The port number
+     * @param bindAddress       Local IP address or host name, or empty string if any
+     * @param backlog           Maximum length of pending connections queue
      */
-    void listen(uint16_t portNumber = 0);
+    void listen(uint16_t portNumber = 0, const String& bindAddress = "", int backlog = SOMAXCONN);
 
     /**
      * @brief In server mode, waits for the incoming connection.
@@ -366,6 +386,16 @@ public:
      */
     virtual size_t read(String& buffer, size_t size, sockaddr_in* from = nullptr);
 
+    /**
+     * @brief Reads data from the socket into several memory buffers (scatter read)
+     *
+     * The buffers are filled in order, each up to its capacity.
+     * Buffer bytes() is set to number of bytes read into that buffer.
+     * @param buffers           The memory buffers
+     * @returns the total number of bytes read from the socket
+     */
+    virtual size_t read(const std::vector<Buffer*>& buffers);
+
     /**
      * @brief Writes data to the socket
      *
@@ -393,6 +423,15 @@ public:
      */
     virtual size_t write(const String& buffer, const sockaddr_in* peer = nullptr);
 
+    /**
+     * @brief Writes the chain of buffers to the socket (gather write)
+     *
+     * The segments are sent with as few writev() calls as possible, without concatenating them.
+     * @param chain             The chain of buffers
+     * @returns the number of bytes written to the socket
+     */
+    virtual size_t write(const BufferChain& chain);
+
     /**
      * @brief Reports true if socket is ready for reading from it
      * @param timeout           Read timeout
@@ -0,0 +1,179 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       DNSResolver.h - description                            ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __DNSRESOLVER_H__
+#define __DNSRESOLVER_H__
+
+#include <sptk5/sptk.h>
+#include <sptk5/Strings.h>
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#else
+#include <winsock2.h>
+#include <WS2tcpip.h>
+#endif
+
+namespace sptk {
+
+/**
+ * @addtogroup utility Utility Classes
+ * @{
+ */
+
+/**
+ * Host name resolver with cache
+ *
+ * Resolves host names into the lists of IPv4 and IPv6 addresses, in the order returned by getaddrinfo().
+ * Lookups of different host names are executed concurrently, and concurrent lookups
+ * of the same host name share a single getaddrinfo() call.
+ * Successful lookups are cached for positive TTL, and failed lookups are cached for negative TTL.
+ * Since getaddrinfo() doesn't return DNS record TTL, cache TTLs are defined by resolver settings.
+ */
+class SP_EXPORT DNSResolver
+{
+public:
+    /**
+     * Resolved host addresses. Port number in resolved addresses is 0.
+     */
+    typedef std::vector<sockaddr_storage> Addresses;
+
+private:
+    /**
+     * Cached or in-progress lookup
+     */
+    struct CacheEntry
+    {
+        std::shared_future<Addresses>           addresses;  ///< Lookup result, or lookup error
+        std::chrono::steady_clock::time_point   expires;    ///< Cache entry expiration time
+        uint64_t                                id;         ///< Unique lookup id
+    };
+
+    mutable std::mutex                  m_mutex;            ///< Mutex that protects internal data
+    std::map<String, CacheEntry>        m_cache;            ///< Lookup cache, by lower case host name
+    std::chrono::seconds                m_positiveTTL;      ///< Time to cache successful lookups
+    std::chrono::seconds                m_negativeTTL;      ///< Time to cache failed lookups
+    uint64_t                            m_lookupId {0};     ///< Last lookup id
+
+    /**
+     * Executes getaddrinfo()
+     * @param hostname          Host name or IP address
+     * @return host addresses
+     */
+    static Addresses getAddresses(const String& hostname);
+
+    /**
+     * Sets expiration time of the completed lookup
+     * @param hostname          Cache key
+     * @param id                Lookup id
+     * @param ttl               Time to cache the lookup
+     */
+    void expire(const String& hostname, uint64_t id, std::chrono::seconds ttl);
+
+    /**
+     * Removes the cache entry of the lookup that failed unexpectedly
+     * @param hostname          Cache key
+     * @param id                Lookup id
+     */
+    void forget(const String& hostname, uint64_t id);
+
+    /**
+     * Removes expired cache entries. Should be called with locked mutex.
+     */
+    void purge();
+
+public:
+    /**
+     * Maximum number of cache entries before expired entries are purged
+     */
+    static const size_t MaxCacheSize = 4096;
+
+    /**
+     * Constructor
+     * @param positiveTTL       Time to cache successful lookups
+     * @param negativeTTL       Time to cache failed lookups
+     */
+    explicit DNSResolver(std::chrono::seconds positiveTTL = std::chrono::seconds(60),
+                         std::chrono::seconds negativeTTL = std::chrono::seconds(5));
+
+    /**
+     * Returns process-wide resolver, used by Host
+     */
+    static DNSResolver& global();
+
+    /**
+     * Resolves host name, or returns cached result
+     *
+     * If the same host name is being resolved by another thread, waits for that lookup.
+     * Throws exception if host name can't be resolved.
+     * @param hostname          Host name or IP address. IPv6 address may be enclosed in square brackets.
+     * @return host addresses
+     */
+    Addresses resolve(const String& hostname);
+
+    /**
+     * Resolves host name in the worker thread
+     *
+     * Resolver must stay alive until the returned future is ready.
+     * @param hostname          Host name or IP address. IPv6 address may be enclosed in square brackets.
+     * @return future host addresses
+     */
+    std::shared_future<Addresses> resolveAsync(const String& hostname);
+
+    /**
+     * Defines cache TTLs for consequent lookups
+     * @param positiveTTL       Time to cache successful lookups
+     * @param negativeTTL       Time to cache failed lookups
+     */
+    void setTTL(std::chrono::seconds positiveTTL, std::chrono::seconds negativeTTL);
+
+    /**
+     * Removes all cached lookups
+     */
+    void clear();
+
+    /**
+     * Returns number of cached and in-progress lookups
+     */
+    size_t size() const;
+};
+
+/**
+ * @}
+ */
+}
+
+#endif
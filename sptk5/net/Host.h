@@ -31,6 +31,7 @@
 
 #include <sptk5/Strings.h>
 #include <sptk5/threads/Locks.h>
+#include <sptk5/net/DNSResolver.h>
 #include <cstring>
 #include <mutex>
 #include <sstream>
@@ -63,10 +64,11 @@ class Host
         struct sockaddr	    any;
         struct sockaddr_in  ip_v4;
         struct sockaddr_in6 ip_v6;
-    } m_address {{}};                   ///< Host address
+    } m_address {{}};                   ///< Preferred host address: the first IPv4 address, if any
+    DNSResolver::Addresses m_addresses; ///< All host addresses, in resolver order
 
     /**
-     * Get host address
+     * Get host addresses, using global DNS resolver
      */
     void getHostAddress();
 
@@ -195,6 +197,17 @@ public:
         SharedLock(m_mutex);
         memcpy(&address, &m_address.ip_v6, sizeof(address));
     }
+
+    /**
+     * Get all host addresses, IPv4 and IPv6, with port number
+     *
+     * Multiple addresses allow to fall back to the next address, if connection to the previous one fails.
+     */
+    DNSResolver::Addresses addresses() const
+    {
+        SharedLock(m_mutex);
+        return m_addresses;
+    }
 };
 
 /**
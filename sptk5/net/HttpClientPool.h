@@ -0,0 +1,262 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       HttpClientPool.h - description                         ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __HTTP_CLIENT_POOL_H__
+#define __HTTP_CLIENT_POOL_H__
+
+#include <sptk5/net/HttpConnect.h>
+#include <sptk5/threads/ThreadPool.h>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+
+namespace sptk
+{
+
+/**
+ * @addtogroup utility Utility Classes
+ * @{
+ */
+
+/**
+ * @brief Pool of keep-alive HTTP client connections
+ *
+ * Connections are grouped by scheme, host and port. A connection that completed
+ * its last response and wasn't closed by the server is kept idle for reuse.
+ * Idle connections are discarded when idle timeout expires, or if the server
+ * closed them (the connection becomes readable while idle).
+ * The number of connections per host is limited: when the limit is reached,
+ * the request waits until another request to the same host releases its connection.
+ */
+class SP_EXPORT HttpClientPool
+{
+public:
+    /**
+     * @brief Pooled connection
+     */
+    struct Connection
+    {
+        String                                  key;        ///< Pool key: scheme, host and port
+        std::unique_ptr<TCPSocket>              socket;     ///< Connection socket, TCPSocket or SSLSocket
+        std::chrono::steady_clock::time_point   idleSince;  ///< Time when connection was returned to pool
+        size_t                                  reuses {0}; ///< Number of times connection was reused from the pool
+    };
+
+    /**
+     * @brief HTTP request function, executed by submit()
+     */
+    typedef std::function<int(HttpConnect&)> Request;
+
+private:
+    /**
+     * @brief Connections to the same scheme, host and port
+     */
+    struct HostConnections
+    {
+        std::list<Connection*>  idle;               ///< Idle connections, the most recently used last
+        size_t                  connections {0};    ///< Number of open or opening connections, including idle
+    };
+
+    mutable std::mutex                      m_mutex;                ///< Mutex that protects internal data
+    std::condition_variable                 m_connectionReleased;   ///< Signaled when connection is released or closed
+    std::map<String, HostConnections>       m_hosts;                ///< Connections by pool key
+    size_t                                  m_maxConnectionsPerHost;///< Maximum number of connections per host
+    std::chrono::milliseconds               m_idleTimeout;          ///< Maximum idle time of pooled connection
+    std::chrono::milliseconds               m_connectTimeout;       ///< Connection timeout
+    std::unique_ptr<ThreadPool>             m_threadPool;           ///< Thread pool for submitted requests, created on demand
+    std::list<std::unique_ptr<Runable>>     m_tasks;                ///< Submitted requests
+    std::atomic_bool                        m_closing {false};      ///< True when pool is destroyed
+
+    /**
+     * @brief Returns true if idle connection can't be reused
+     * @param connection        Idle connection
+     * @param now               Current time
+     */
+    bool stale(const Connection& connection, std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief Opens new connection
+     * @param host              Host name and port
+     * @param https             True for HTTPS connection
+     * @param key               Pool key
+     */
+    Connection* openConnection(const Host& host, bool https, const String& key);
+
+    /**
+     * @brief Closes connection, and releases its place in the host connections limit
+     *
+     * Mutex should not be locked by caller.
+     * @param connection        Connection to close
+     */
+    void closeConnection(Connection* connection);
+
+public:
+    /**
+     * @brief Constructor
+     * @param maxConnectionsPerHost Maximum number of connections to the same scheme, host and port
+     * @param idleTimeout       Maximum time connection may stay idle in the pool
+     * @param connectTimeout    Connection timeout
+     */
+    explicit HttpClientPool(size_t maxConnectionsPerHost = 8,
+                            std::chrono::milliseconds idleTimeout = std::chrono::seconds(60),
+                            std::chrono::milliseconds connectTimeout = std::chrono::seconds(30));
+
+    /**
+     * @brief Destructor
+     *
+     * Waits for running requests, and closes idle connections.
+     * Submitted requests that didn't start yet fail with exception.
+     * All connections should be released before the pool is destroyed.
+     */
+    ~HttpClientPool();
+
+    /**
+     * @brief Returns pool key for host
+     * @param host              Host name and port
+     * @param https             True for HTTPS connection
+     */
+    static String key(const Host& host, bool https);
+
+    /**
+     * @brief Gets idle connection to host from the pool, or opens new connection
+     *
+     * If the per host connection limit is reached, waits for released connection.
+     * @param host              Host name and port
+     * @param https             True for HTTPS connection
+     * @param timeout           Maximum wait time for released connection
+     * @returns connection that must be released with releaseConnection()
+     */
+    Connection* getConnection(const Host& host, bool https = false,
+                              std::chrono::milliseconds timeout = std::chrono::seconds(60));
+
+    /**
+     * @brief Returns connection to the pool
+     * @param connection        Connection acquired with getConnection()
+     * @param reusable          True if connection completed its last response and may be reused
+     */
+    void releaseConnection(Connection* connection, bool reusable);
+
+    /**
+     * @brief Submits request for asynchronous execution
+     *
+     * Request is executed in the pool's thread pool, with a pooled connection to host.
+     * @param host              Host name and port
+     * @param https             True for HTTPS connection
+     * @param request           Request function, returning HTTP status code
+     * @returns future HTTP status code, or exception thrown by request
+     */
+    std::future<int> submit(const Host& host, bool https, const Request& request);
+
+    /**
+     * @brief Number of idle connections in the pool
+     */
+    size_t idleConnections() const;
+
+    /**
+     * @brief Number of open connections to host, including idle connections
+     * @param host              Host name and port
+     * @param https             True for HTTPS connection
+     */
+    size_t connections(const Host& host, bool https = false) const;
+};
+
+/**
+ * @brief HTTP connection that is automatically acquired from HttpClientPool, and returned to the pool
+ */
+class SP_EXPORT AutoHttpConnection
+{
+    /**
+     * Connection pool
+     */
+    HttpClientPool&             m_pool;
+
+    /**
+     * Pooled connection
+     */
+    HttpClientPool::Connection* m_connection;
+
+    /**
+     * HTTP connection, using pooled connection socket
+     */
+    std::unique_ptr<HttpConnect> m_http;
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * Gets connection from the connection pool
+     * @param pool              Connection pool
+     * @param host              Host name and port
+     * @param https             True for HTTPS connection
+     */
+    AutoHttpConnection(HttpClientPool& pool, const Host& host, bool https = false);
+
+    /**
+     * @brief Destructor
+     *
+     * Returns connection to the pool. Connection is reused only if its last response is completed
+     * and server didn't close connection.
+     */
+    ~AutoHttpConnection();
+
+    AutoHttpConnection(const AutoHttpConnection&) = delete;
+    AutoHttpConnection& operator = (const AutoHttpConnection&) = delete;
+
+    /**
+     * @brief HTTP connection
+     */
+    HttpConnect& http()
+    {
+        return *m_http;
+    }
+
+    /**
+     * @brief HTTP connection
+     */
+    HttpConnect* operator -> ()
+    {
+        return m_http.get();
+    }
+
+    /**
+     * @brief Returns true if connection was reused from the pool, rather than opened
+     */
+    bool reused() const
+    {
+        return m_connection->reuses != 0;
+    }
+};
+
+/**
+ * @}
+ */
+}
+
+#endif
@@ -38,6 +38,10 @@
 namespace sptk
 {
 
+namespace json {
+class Document;
+}
+
 /**
  * @addtogroup utility Utility Classes
  * @{
@@ -163,6 +167,23 @@ public:
     int cmd_post(const sptk::String& pageName, const HttpParams& parameters, const Buffer& content, bool gzipContent,
                  Buffer& output, std::chrono::milliseconds timeout = std::chrono::seconds(60));
 
+    /**
+     * @brief Sends the POST command with JSON document to the server
+     *
+     * The document is sent as MessagePack data, or as JSON text. Request headers Content-Type and Accept
+     * are set to the selected content type. The server response is decoded according to its Content-Type.
+     * @param pageName          Page URL without the server name.
+     * @param parameters        HTTP request parameters
+     * @param content           The document to post to the server
+     * @param output            Response document
+     * @param messagePack       If true then the document is sent in MessagePack format
+     * @param timeout           Response timeout
+     * @return HTTP result code
+     */
+    int cmd_post(const sptk::String& pageName, const HttpParams& parameters, const json::Document& content,
+                 json::Document& output, bool messagePack = false,
+                 std::chrono::milliseconds timeout = std::chrono::seconds(60));
+
     /**
      * @brief Sends the PUT command to the server
      *
@@ -197,6 +218,14 @@ public:
      */
     String responseHeader(const sptk::String& headerName) const;
 
+    /**
+     * @brief Returns true if connection may be used for the next request
+     *
+     * Connection may be reused if the last response is completely read,
+     * and server didn't close connection.
+     */
+    bool keepAlive() const;
+
     /**
      * @brief Get the request execution status code
      * @return request execution status code
@@ -31,11 +31,15 @@
 
 #include <sptk5/Buffer.h>
 #include <sptk5/net/TCPSocket.h>
-#include <sptk5/RegularExpression.h>
 #include <mutex>
+#include <memory>
 
 namespace sptk {
 
+#if HAVE_ZLIB
+class ZLibStream;
+#endif
+
 struct caseInsensitiveCompare : public std::binary_function<String, String, bool>
 {
     bool operator()(const String &lhs, const String &rhs) const
@@ -55,7 +59,13 @@ typedef std::map<String, String, caseInsensitiveCompare> HttpHeaders;
 /**
  * HTTP response reader
  *
- * Designed to be able accepting asynchronous data
+ * Resumable response decoder. Status line, headers, chunk size lines and trailers
+ * are parsed in place, in the socket read buffer. Response content is received
+ * directly into the output buffer, or decompressed as it arrives if it's gzip or
+ * deflate encoded.
+ *
+ * Reader may be driven by read(), that performs no more than one socket receive per call,
+ * or by feed() with the data received by the caller (for instance, from an event loop).
  */
 class HttpReader
 {
@@ -73,6 +83,28 @@ public:
 
 private:
 
+    /**
+     * Response content framing
+     */
+    enum DataState : uint8_t {
+        IDENTITY,               ///< Content-Length sized content
+        UNTIL_CLOSE,            ///< Content ends when connection is closed
+        CHUNK_SIZE,             ///< Reading chunk size line
+        CHUNK_DATA,             ///< Reading chunk data
+        CHUNK_DATA_END,         ///< Reading CRLF after chunk data
+        TRAILERS                ///< Reading trailer headers after the last chunk
+    };
+
+    /**
+     * Maximum length of status, header, or chunk size line
+     */
+    static constexpr size_t MaxLineLength = 65536;
+
+    /**
+     * Maximum size of content received directly into output buffer by a single receive
+     */
+    static constexpr size_t MaxDirectReadSize = 256 * 1024;
+
     /**
      * State of the response reader
      */
@@ -113,34 +145,31 @@ private:
     size_t              m_contentReceivedLength;
 
     /**
-     * Current chunk size
+     * Remaining bytes of Content-Length sized content, or current chunk
      */
-    size_t              m_currentChunkSize;
+    size_t              m_remaining;
 
     /**
-     * Chunked content (as defined in responce headers)
+     * Response content framing
      */
-    bool                m_contentIsChunked;
+    DataState           m_dataState;
 
     /**
-     * HTTP response headers
+     * HTTP response headers, and trailers of chunked response
      */
     HttpHeaders         m_responseHeaders;
 
-    /**
-     * Regular expression parsing protocol and response code
-     */
-    RegularExpression   m_matchProtocolAndResponseCode;
-
     /**
      * Output data buffer
      */
     Buffer&             m_output;
 
+#if HAVE_ZLIB
     /**
-     * Read buffer
+     * Decompressor for gzip or deflate encoded content, or nullptr
      */
-    Buffer              m_read_buffer;
+    std::unique_ptr<ZLibStream> m_decompressor;
+#endif
 
 public:
 
@@ -158,23 +187,85 @@ public:
 private:
 
     /**
-     * Read HTTP status
-     * @param socket            Socket to read from
-     * @return true if status is read
+     * Parses received data
+     * @param data              Received data
+     * @param size              Received data size
+     * @return number of bytes consumed
      */
-    bool readStatus(TCPSocket& socket);
+    size_t processData(const char* data, size_t size);
 
     /**
-     * Read headers that can be read completely
-     * @param socket            Socket to read from
+     * Processes complete status, header, chunk size, or trailer line
+     * @param line              Line start
+     * @param length            Line length, without line end
      */
-    bool readHeaders(TCPSocket& socket);
+    void processLine(const char* line, size_t length);
 
     /**
-     * Read headers that can be read completely
-     * @param socket            Socket to read from
+     * Parses HTTP status line
+     * @param line              Line start
+     * @param length            Line length, without line end
+     */
+    void parseStatus(const char* line, size_t length);
+
+    /**
+     * Parses header or trailer line, and adds it to response headers
+     * @param line              Line start
+     * @param length            Line length, without line end
      */
-    bool readData(TCPSocket& socket);
+    void parseHeader(const char* line, size_t length);
+
+    /**
+     * Parses chunk size line
+     * @param line              Line start
+     * @param length            Line length, without line end
+     */
+    void parseChunkSize(const char* line, size_t length);
+
+    /**
+     * Called when response headers are read, selects content framing
+     */
+    void headersCompleted();
+
+    /**
+     * Accounts for received content bytes, and advances the content framing state
+     * @param size              Received content size
+     */
+    void contentReceived(size_t size);
+
+    /**
+     * Completes the response
+     */
+    void complete();
+
+    /**
+     * Marks the reader as failed, and throws an exception
+     * @param message           Error message
+     */
+    [[noreturn]] void readError(const String& message);
+
+    /**
+     * Appends received content to output buffer, decompressing it if content is compressed
+     * @param data              Received data
+     * @param size              Received data size
+     */
+    void appendContent(const char* data, size_t size);
+
+    /**
+     * Returns the size of content that can be received directly into output buffer, or 0
+     */
+    size_t directReadSize() const;
+
+    /**
+     * Processes data buffered in the socket reader
+     * @param reader            Socket reader
+     */
+    void processBuffered(TCPSocketReader& reader);
+
+    /**
+     * Handles the end of data, when connection is closed by server
+     */
+    void endOfData();
 
 public:
     /**
@@ -184,11 +275,38 @@ public:
     HttpReader(Buffer& output);
 
     /**
-     * Read data that can be read completely
+     * Destructor
+     */
+    ~HttpReader();
+
+    /**
+     * @brief Reads and processes the response data, that is available in socket
+     *
+     * Performs no more than one receive from the socket. If the socket
+     * read buffer already contains data, that data is processed first.
      * @param socket            Socket to read from
      */
     void read(TCPSocket& socket);
 
+    /**
+     * @brief Processes the response data, received by the caller
+     *
+     * Allows to drive the reader from an event loop. Data that isn't consumed
+     * contains an incomplete line, and should be passed again with more data appended.
+     * @param data              Received data
+     * @param size              Received data size
+     * @return number of bytes consumed
+     */
+    size_t feed(const char* data, size_t size);
+
+    /**
+     * @brief Notifies the reader, driven by feed(), that connection is closed
+     *
+     * Completes the response which content ends with connection close,
+     * otherwise throws an exception.
+     */
+    void connectionClosed();
+
     /**
      * Status code getter
      * @return status code
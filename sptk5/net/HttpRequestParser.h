@@ -0,0 +1,339 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       HttpRequestParser.h - description                      ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __HTTP_REQUEST_PARSER_H__
+#define __HTTP_REQUEST_PARSER_H__
+
+#include <sptk5/Buffer.h>
+#include <sptk5/net/HttpReader.h>
+#include <string_view>
+#include <vector>
+
+namespace sptk {
+
+/**
+ * @addtogroup utility Utility Classes
+ * @{
+ */
+
+/**
+ * @brief Incremental HTTP/1.1 request parser
+ *
+ * Server side parser, designed to work over the data already received into
+ * a socket read buffer. The request line and headers are not copied:
+ * parser keeps only the offsets of the request line parts and header names
+ * and values, relative to the start of the request. The views returned by
+ * the parser point into the last data passed to parseHead(), so the caller
+ * may move or grow its buffer between calls, as long as the data from the start
+ * of the request is preserved.
+ *
+ * Both parseHead() and parseBody() may be fed partial data, as it arrives
+ * from the socket or event loop. Request body may be sized with Content-Length,
+ * or use chunked transfer encoding. Any other transfer coding is rejected.
+ *
+ * Requests that can't be served are reported with HTTPException, carrying
+ * the HTTP status of the response that should be sent to the client.
+ */
+class SP_EXPORT HttpRequestParser
+{
+public:
+    /**
+     * State of the request parser
+     */
+    enum State : unsigned {
+        REQUEST_LINE,           ///< Parsing request line
+        HEADERS,                ///< Parsing headers
+        BODY,                   ///< Reading Content-Length sized body
+        CHUNK_SIZE,             ///< Reading chunk size line
+        CHUNK_DATA,             ///< Reading chunk data
+        CHUNK_DATA_END,         ///< Reading CRLF after chunk data
+        TRAILERS,               ///< Reading trailer headers after the last chunk
+        COMPLETE                ///< Request is complete
+    };
+
+    /**
+     * Header name and value, pointing into request data
+     */
+    struct Header
+    {
+        std::string_view    name;   ///< Header name
+        std::string_view    value;  ///< Header value, without surrounding white space
+    };
+
+    /**
+     * Maximum size of request line and headers, accepted by parser
+     */
+    static constexpr size_t MaxHeadSize = 65536;
+
+    /**
+     * Default maximum size of request body, accepted by parser
+     */
+    static constexpr size_t DefaultMaxBodySize = 64 * 1024 * 1024;
+
+    /**
+     * @brief Constructor
+     */
+    HttpRequestParser() = default;
+
+    /**
+     * @brief Prepares parser for the next request
+     *
+     * Maximum body size is preserved.
+     */
+    void reset();
+
+    /**
+     * @brief Sets maximum size of request body
+     *
+     * Request with larger Content-Length, or chunked request with larger decoded body,
+     * is rejected with HTTP status 413.
+     * @param maxBodySize       Maximum body size, bytes
+     */
+    void setMaxBodySize(size_t maxBodySize)
+    {
+        m_maxBodySize = maxBodySize;
+    }
+
+    /**
+     * @brief Returns maximum size of request body
+     */
+    size_t maxBodySize() const
+    {
+        return m_maxBodySize;
+    }
+
+    /**
+     * @brief Parses request line and headers
+     *
+     * The data must start from the first byte of the request. If the data doesn't
+     * contain complete request head yet, the call should be repeated with more
+     * data appended: already parsed lines are not parsed again.
+     * Throws an exception if request is malformed. Throws HTTPException with
+     * status 400 if Transfer-Encoding doesn't end with chunked, 501 if it uses
+     * other transfer codings, and 413 if Content-Length exceeds maximum body size.
+     * @param data              Request data
+     * @param length            Request data length
+     * @returns length of request head, including empty line, or 0 if more data is required
+     */
+    size_t parseHead(const char* data, size_t length);
+
+    /**
+     * @brief Parses request body
+     *
+     * Decoded body data is appended to the output buffer. Chunked body
+     * parsing stops at an incomplete chunk size or trailer line, so the unconsumed
+     * data should be passed again, with more data appended.
+     * Throws an exception if request body is malformed, or HTTPException (413)
+     * if the body exceeds maximum body size.
+     * @param data              Request body data
+     * @param length            Request body data length
+     * @param body              Output buffer
+     * @returns number of bytes consumed
+     */
+    size_t parseBody(const char* data, size_t length, Buffer& body);
+
+    /**
+     * @brief Returns current parser state
+     */
+    State state() const
+    {
+        return m_state;
+    }
+
+    /**
+     * @brief Returns true if request head is parsed
+     */
+    bool headComplete() const
+    {
+        return m_state > HEADERS;
+    }
+
+    /**
+     * @brief Returns true if the whole request is parsed
+     */
+    bool complete() const
+    {
+        return m_state == COMPLETE;
+    }
+
+    /**
+     * @brief Request method, such as GET or POST
+     */
+    std::string_view method() const
+    {
+        return view(m_method);
+    }
+
+    /**
+     * @brief Request target (URL)
+     */
+    std::string_view url() const
+    {
+        return view(m_url);
+    }
+
+    /**
+     * @brief Request protocol version, such as HTTP/1.1
+     */
+    std::string_view version() const
+    {
+        return view(m_version);
+    }
+
+    /**
+     * @brief Number of parsed headers
+     */
+    size_t headerCount() const
+    {
+        return m_headers.size();
+    }
+
+    /**
+     * @brief Returns header by index
+     * @param index             Header index, in request order
+     */
+    Header header(size_t index) const;
+
+    /**
+     * @brief Returns value of the first header with matching name
+     *
+     * Name comparison is case-insensitive.
+     * @param name              Header name
+     * @returns header value, or empty view if header isn't found
+     */
+    std::string_view header(std::string_view name) const;
+
+    /**
+     * @brief Copies parsed headers into headers map
+     * @param headers           Output headers map
+     */
+    void exportHeaders(HttpHeaders& headers) const;
+
+    /**
+     * @brief Returns true if request body uses chunked transfer encoding
+     */
+    bool chunked() const
+    {
+        return m_chunked;
+    }
+
+    /**
+     * @brief Request body length, as defined by Content-Length header, or 0
+     */
+    size_t contentLength() const
+    {
+        return m_contentLength;
+    }
+
+    /**
+     * @brief Returns true if client expects 100 Continue response before sending body
+     */
+    bool expectContinue() const
+    {
+        return m_expectContinue;
+    }
+
+private:
+    /**
+     * Part of the request data, relative to request start
+     */
+    struct Span
+    {
+        uint32_t    offset {0};     ///< Offset from request start
+        uint32_t    length {0};     ///< Length
+    };
+
+    /**
+     * Header name and value spans
+     */
+    struct HeaderSpan
+    {
+        Span        name;           ///< Header name
+        Span        value;          ///< Header value
+    };
+
+    State                   m_state {REQUEST_LINE};     ///< Parser state
+    const char*             m_data {nullptr};           ///< Request data, passed to the last parseHead() call
+    size_t                  m_scanOffset {0};           ///< Offset of the first unparsed line in request head
+    Span                    m_method;                   ///< Request method
+    Span                    m_url;                      ///< Request URL
+    Span                    m_version;                  ///< Request protocol version
+    std::vector<HeaderSpan> m_headers;                  ///< Request headers
+    size_t                  m_contentLength {0};        ///< Content length, or 0
+    size_t                  m_remaining {0};            ///< Remaining bytes in body or current chunk
+    size_t                  m_bodySize {0};             ///< Decoded chunked body size
+    size_t                  m_maxBodySize {DefaultMaxBodySize}; ///< Maximum body size
+    bool                    m_chunked {false};          ///< Chunked transfer encoding
+    bool                    m_transferEncoding {false}; ///< Request has Transfer-Encoding header
+    bool                    m_otherCodings {false};     ///< Transfer-Encoding has codings other than chunked
+    bool                    m_expectContinue {false};   ///< Client sent Expect: 100-continue
+
+    /**
+     * @brief Returns view of request data part
+     * @param span              Request data part
+     */
+    std::string_view view(const Span& span) const
+    {
+        return std::string_view(m_data + span.offset, span.length);
+    }
+
+    /**
+     * @brief Parses request line
+     * @param start             Line start offset
+     * @param end               Line end offset, excluding line end
+     */
+    void parseRequestLine(size_t start, size_t end);
+
+    /**
+     * @brief Parses header line, and interprets headers that define request body
+     * @param start             Line start offset
+     * @param end               Line end offset, excluding line end
+     */
+    void parseHeaderLine(size_t start, size_t end);
+
+    /**
+     * @brief Parses Transfer-Encoding header value
+     *
+     * Transfer codings are checked when request head is parsed:
+     * only a single chunked transfer coding is supported.
+     * @param value             Header value
+     */
+    void parseTransferEncoding(std::string_view value);
+
+    /**
+     * @brief Called when request head is parsed, selects body parsing state
+     */
+    void headParsed();
+};
+
+/**
+ * @}
+ */
+}
+
+#endif
@@ -32,6 +32,10 @@
 #include <sptk5/sptk.h>
 #include <sptk5/String.h>
 #include <openssl/ssl.h>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
 #include <mutex>
 #include <sptk5/threads/Locks.h>
 
@@ -57,6 +61,96 @@ class SSLContext : public SharedMutex
      */
     String          m_password;
 
+    /**
+     * Session ticket encryption key
+     */
+    struct TicketKey
+    {
+        unsigned char   name[16];       ///< Key name, identifies key in the ticket
+        unsigned char   hmacKey[32];    ///< HMAC-SHA256 key
+        unsigned char   aesKey[32];     ///< AES-256 key
+    };
+
+    /**
+     * Mutex that protects client sessions and ticket keys
+     */
+    std::mutex                              m_sessionMutex;
+
+    /**
+     * Cached client session
+     */
+    typedef std::pair<String, SSL_SESSION*> ClientSession;
+
+    /**
+     * Client sessions, the most recently used first
+     */
+    std::list<ClientSession>                m_clientSessionList;
+
+    /**
+     * Client sessions, by host (and SNI host name), for session resumption
+     */
+    std::map<String, std::list<ClientSession>::iterator>   m_clientSessions;
+
+    /**
+     * Maximum number of cached client sessions
+     */
+    size_t                                  m_clientSessionCacheSize {1024};
+
+    /**
+     * Current session ticket key, and the key it replaced
+     */
+    TicketKey                               m_ticketKeys[2] {};
+
+    /**
+     * True if ticket keys are generated by rotateTicketKeys()
+     */
+    bool                                    m_hasTicketKeys {false};
+
+    /**
+     * Ticket key rotation interval, or 0 if keys are not rotated automatically
+     */
+    std::chrono::seconds                    m_ticketKeyLifetime {0};
+
+    /**
+     * Time when the current ticket key was created
+     */
+    std::chrono::steady_clock::time_point   m_ticketKeyCreated;
+
+    /**
+     * Number of full handshakes
+     */
+    std::atomic<size_t>                     m_fullHandshakes {0};
+
+    /**
+     * Number of resumed handshakes
+     */
+    std::atomic<size_t>                     m_resumedHandshakes {0};
+
+    /**
+     * Generates new ticket key, keeping current key for decryption of existing tickets.
+     * Session mutex should be locked by caller.
+     */
+    void generateTicketKey();
+
+    /**
+     * Removes the least recently used client session.
+     * Session mutex should be locked by caller.
+     */
+    void evictClientSession();
+
+    /**
+     * New client session callback function
+     */
+    static int newSessionCallback(SSL* ssl, SSL_SESSION* session);
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    /**
+     * Session ticket key callback function
+     */
+    static int ticketKeyCallback(SSL* ssl, unsigned char keyName[16], unsigned char* iv, EVP_CIPHER_CTX* cipherContext,
+                                 EVP_MAC_CTX* macContext, int encrypt);
+#endif
+
     /**
      * Password auto-reply callback function
      */
@@ -101,6 +195,82 @@ public:
      * Returns SSL context handle
      */
     SSL_CTX* handle();
+
+    /**
+     * @brief Configures server side session cache
+     * @param cacheSize             Maximum number of cached sessions, 0 is unlimited
+     * @param timeout               Session lifetime
+     */
+    void setSessionCache(size_t cacheSize, std::chrono::seconds timeout);
+
+    /**
+     * @brief Enables or disables stateless session resumption with session tickets (RFC 5077)
+     * @param enable                True to enable session tickets
+     */
+    void setSessionTickets(bool enable);
+
+    /**
+     * @brief Sets session ticket key rotation interval
+     *
+     * Session tickets are encrypted with the current key. Tickets, encrypted with
+     * the previous key, are still accepted (and renewed) until the next rotation.
+     * @param interval              Key rotation interval, 0 disables automatic rotation
+     */
+    void setTicketKeyRotation(std::chrono::seconds interval);
+
+    /**
+     * @brief Replaces session ticket encryption key with a new random key
+     */
+    void rotateTicketKeys();
+
+    /**
+     * @brief Sets the maximum number of client sessions, cached for session resumption
+     *
+     * If the cache is full, the least recently used session is evicted.
+     * @param cacheSize             Maximum number of cached client sessions, 0 disables client session cache
+     */
+    void setClientSessionCacheSize(size_t cacheSize);
+
+    /**
+     * @brief Returns cached client session for the host
+     * @param sessionKey            Host (and SNI host name)
+     * @returns session that should be released with SSL_SESSION_free(), or nullptr if there is no resumable session
+     */
+    SSL_SESSION* getClientSession(const String& sessionKey);
+
+    /**
+     * @brief Removes cached client session for the host
+     * @param sessionKey            Host (and SNI host name)
+     */
+    void removeClientSession(const String& sessionKey);
+
+    /**
+     * @brief Counts completed handshake
+     * @param resumed               True if session was resumed
+     */
+    void handshakeCompleted(bool resumed)
+    {
+        if (resumed)
+            m_resumedHandshakes++;
+        else
+            m_fullHandshakes++;
+    }
+
+    /**
+     * @brief Number of full handshakes, on both client and server connections
+     */
+    size_t fullHandshakes() const
+    {
+        return m_fullHandshakes;
+    }
+
+    /**
+     * @brief Number of resumed handshakes, on both client and server connections
+     */
+    size_t resumedHandshakes() const
+    {
+        return m_resumedHandshakes;
+    }
 };
 
 /**
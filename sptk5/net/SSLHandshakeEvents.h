@@ -0,0 +1,163 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       SSLHandshakeEvents.h - description                     ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SSLHANDSHAKEEVENTS_H__
+#define __SSLHANDSHAKEEVENTS_H__
+
+#include <sptk5/net/SSLSocket.h>
+#include <sptk5/net/SocketPool.h>
+#include <sptk5/threads/Thread.h>
+#include <functional>
+#include <set>
+
+namespace sptk {
+
+/**
+ * @addtogroup utility Utility Classes
+ * @{
+ */
+
+/**
+ * Event-driven SSL handshakes
+ *
+ * Completes handshakes of non-blocking SSL sockets, prepared with SSLSocket::startAccept()
+ * or SSLSocket::startConnect(), on a single thread. Every handshake step is executed
+ * when the socket becomes ready to read or write, so pending handshakes don't occupy threads.
+ * The callback is executed once for every added socket, when its handshake is completed,
+ * failed, or timed out.
+ */
+class SP_EXPORT SSLHandshakeEvents : public Thread
+{
+public:
+    /**
+     * Handshake completion callback
+     *
+     * Callback is executed from the thread that added the socket, if the handshake completes immediately,
+     * or from the handshake events thread otherwise. Socket is no longer monitored when callback is executed.
+     * @param socket            SSL socket
+     * @param error             Error message, or empty string if the handshake succeeded
+     */
+    typedef std::function<void(SSLSocket& socket, const String& error)> Callback;
+
+private:
+    /**
+     * Pending handshake
+     */
+    struct Handshake
+    {
+        SSLSocket*          socket;                     ///< SSL socket
+        Callback            callback;                   ///< Handshake completion callback
+        DateTime            expires;                    ///< Handshake timeout
+        bool                watchWrite;                 ///< True if socket write readiness is monitored
+        SSLHandshakeEvents* owner;                      ///< Handshake events this handshake belongs to
+    };
+
+    SocketPool                  m_socketPool;           ///< OS-specific event manager
+    std::mutex                  m_mutex;                ///< Mutex that protects pending handshakes
+    std::set<Handshake*>        m_handshakes;           ///< Pending handshakes
+    std::chrono::milliseconds   m_timeout;              ///< Handshake timeout
+
+    /**
+     * Socket event callback
+     * @param userData          Pending handshake
+     * @param eventType         Socket event type
+     */
+    static void eventCallback(void* userData, SocketEventType eventType);
+
+    /**
+     * Executes the next handshake step upon socket event
+     * @param handshake         Pending handshake
+     * @param eventType         Socket event type
+     */
+    void processEvent(Handshake* handshake, SocketEventType eventType);
+
+    /**
+     * Stops monitoring of the socket. Should be called with locked mutex.
+     * @param handshake         Pending handshake
+     */
+    void forget(Handshake* handshake);
+
+    /**
+     * Executes handshake callback and destroys handshake
+     * @param handshake         Completed or failed handshake
+     * @param error             Error message, or empty string if the handshake succeeded
+     */
+    static void notify(Handshake* handshake, const String& error);
+
+    /**
+     * Fails pending handshakes
+     * @param expiredOnly       If true then only timed out handshakes are failed
+     * @param error             Error message
+     */
+    void failHandshakes(bool expiredOnly, const String& error);
+
+protected:
+    /**
+     * Event monitoring thread
+     */
+    void threadFunction() override;
+
+public:
+    /**
+     * Constructor
+     *
+     * Starts the handshake events thread.
+     * @param timeout           Handshake timeout
+     */
+    explicit SSLHandshakeEvents(std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+    /**
+     * Destructor
+     *
+     * Stops the handshake events thread, and fails pending handshakes.
+     */
+    ~SSLHandshakeEvents() override;
+
+    /**
+     * Starts or continues the handshake of non-blocking SSL socket
+     *
+     * The first handshake step is executed immediately. If the handshake can't complete
+     * without waiting, the socket is monitored until it can.
+     * Socket must stay alive until the callback is executed.
+     * @param socket            SSL socket, prepared with SSLSocket::startAccept() or SSLSocket::startConnect()
+     * @param callback          Handshake completion callback
+     */
+    void add(SSLSocket& socket, Callback callback);
+
+    /**
+     * Returns number of pending handshakes
+     */
+    size_t size();
+};
+
+/**
+ * @}
+ */
+}
+
+#endif
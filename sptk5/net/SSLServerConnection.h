@@ -30,6 +30,7 @@
 #define __SSLSERVERCONNECTION_H__
 
 #include <sptk5/net/ServerConnection.h>
+#include <sptk5/net/SSLSocket.h>
 
 namespace sptk
 {
@@ -54,8 +55,11 @@ public:
     SSLServerConnection(SOCKET connectionSocket)
     : ServerConnection(connectionSocket, "SSLServerConnection")
     {
-        m_socket = new SSLSocket;
-        m_socket->attach(connectionSocket);
+        auto* socket = new SSLSocket;
+        m_socket = socket;
+
+        // Handshake is completed by the server, before the connection thread starts
+        socket->startAccept(connectionSocket);
     }
 
     /**
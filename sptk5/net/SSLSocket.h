@@ -46,8 +46,21 @@ namespace sptk {
  */
 class SSLSocket: public TCPSocket, public std::mutex
 {
-    SSLContext* m_sslContext;                           ///< SSL context
+public:
+    /**
+     * Result of a single non-blocking handshake step
+     */
+    enum HandshakeStatus : uint8_t
+    {
+        HANDSHAKE_WANT_READ,                            ///< Handshake waits until socket is ready to read
+        HANDSHAKE_WANT_WRITE,                           ///< Handshake waits until socket is ready to write
+        HANDSHAKE_COMPLETED                             ///< Handshake is completed
+    };
+
+private:
+    SSLContext* m_sslContext { nullptr };               ///< SSL context
     SSL*        m_ssl;                                  ///< SSL socket
+    bool        m_sslFailed { false };                  ///< True if connection had SSL error, and can't be shut down cleanly
 
     String      m_keyFileName;                          ///< Private key file name
     String      m_certificateFileName;                  ///< Certificate file name
@@ -57,6 +70,8 @@ class SSLSocket: public TCPSocket, public std::mutex
     int         m_verifyDepth { 0 };                    ///< SSL verify depth
 
     String      m_sniHostName;                          ///< SNI host name (optional)
+    String      m_sessionKey;                           ///< Client session cache key: host and SNI host name
+    bool        m_sessionKeyFromHost { false };         ///< True if session key is defined by host, rather than address
 
 public:
     /**
@@ -143,6 +158,54 @@ protected:
      */
     void initContextAndSocket();
 
+    /**
+     * Defines host and client session cache key for the next connection
+     * @param host                  Host name and port
+     * @return host address
+     */
+    sockaddr_in setHost(const Host& host);
+
+    /**
+     * Opens TCP connection and prepares client side of SSL handshake
+     * @param address               Address and port
+     * @param openMode              Socket open mode
+     * @param timeout               Connection timeout. The default is 0 (wait forever)
+     */
+    void openConnection(const struct sockaddr_in& address, CSocketOpenMode openMode, std::chrono::milliseconds timeout);
+
+    /**
+     * Opens TCP connection by IPv6 address and prepares client side of SSL handshake
+     * @param address               Address and port
+     * @param openMode              Socket open mode
+     * @param timeout               Connection timeout. The default is 0 (wait forever)
+     */
+    void openConnection(const struct sockaddr_in6& address, CSocketOpenMode openMode, std::chrono::milliseconds timeout);
+
+    /**
+     * Attaches connected socket to SSL and restores the cached client session, if any
+     */
+    void prepareConnect();
+
+    /**
+     * Completes client side of SSL handshake
+     * @param timeoutAt             Handshake deadline, if timeout is not 0
+     * @param blockingMode          Socket blocking (true) on non-blocking (false) mode after handshake
+     * @param timeout               Connection timeout. If 0, handshake is blocking
+     */
+    void connectHandshake(const DateTime& timeoutAt, bool blockingMode, std::chrono::milliseconds timeout);
+
+    /**
+     * Attaches accepted socket handle and prepares server side of SSL handshake
+     * @param socketHandle          External socket handle
+     */
+    void prepareAccept(SOCKET socketHandle);
+
+    /**
+     * Attaches socket to SSL, so that writing to the socket closed by peer doesn't raise SIGPIPE
+     * @param socketHandle          Socket handle
+     */
+    void attachSSL(SOCKET socketHandle);
+
     /**
      * opens the socket connection by host and port
      *
@@ -164,6 +227,15 @@ protected:
      */
     void _open(const struct sockaddr_in& address, CSocketOpenMode openMode, bool blockingMode, std::chrono::milliseconds timeout) override;
 
+    /**
+     * Opens the client socket connection by IPv6 address and port
+     * @param address               Address and port
+     * @param openMode              Socket open mode
+     * @param blockingMode          Socket blocking (true) on non-blocking (false) mode
+     * @param timeout               Connection timeout. The default is 0 (wait forever)
+     */
+    void _open(const struct sockaddr_in6& address, CSocketOpenMode openMode, bool blockingMode, std::chrono::milliseconds timeout) override;
+
 public:
 
     /**
@@ -174,13 +246,76 @@ public:
      */
     void attach(SOCKET socketHandle) override;
 
+    /**
+     * Attaches socket handle without performing the handshake
+     *
+     * This method is designed to only attach socket handles obtained with accept().
+     * Socket is switched to non-blocking mode, and server side handshake is completed
+     * with consequent calls of handshake(), when the socket is ready to read or write.
+     * @param socketHandle          External socket handle.
+     */
+    void startAccept(SOCKET socketHandle);
+
+    /**
+     * Opens TCP connection to the host without performing the handshake
+     *
+     * Socket is switched to non-blocking mode, and client side handshake is completed
+     * with consequent calls of handshake(), when the socket is ready to read or write.
+     * @param host                  Host name and port
+     * @param timeout               TCP connection timeout. The default is 0 (wait forever)
+     */
+    void startConnect(const Host& host, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    /**
+     * Performs the next step of SSL handshake
+     *
+     * In non-blocking mode, the method should be called again when the socket is ready
+     * to read or write, as defined by the returned status.
+     * @return handshake status
+     */
+    HandshakeStatus handshake();
+
+    /**
+     * Returns true if socket is attached or connected, but SSL handshake isn't completed yet
+     */
+    bool handshakePending() const;
+
     /**
      * Closes the socket connection
      *
+     * Session of the connection that is closed after SSL error isn't resumable.
      * This method is not thread-safe.
      */
     void close() noexcept override;
 
+    using TCPSocket::write;
+
+    /**
+     * Writes the chain of buffers to the socket
+     *
+     * Small segments are coalesced into SSL records of up to 16K, instead of
+     * encrypting every segment as a separate record.
+     * @param chain                 The chain of buffers
+     * @returns the number of bytes written to the socket
+     */
+    size_t write(const BufferChain& chain) override;
+
+    /**
+     * Returns SSL context, shared by sockets with the same keys
+     *
+     * SSL context is defined after socket is opened or attached.
+     * SSL context provides session cache settings, and handshake counters.
+     */
+    SSLContext* context()
+    {
+        return m_sslContext;
+    }
+
+    /**
+     * Returns true if the last handshake resumed the previous session
+     */
+    bool sessionReused() const;
+
     /**
      * Returns SSL handle
      */
@@ -29,6 +29,7 @@
 #ifndef __SPTK_SOCKETEVENTS_H__
 #define __SPTK_SOCKETEVENTS_H__
 
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <sptk5/Exception.h>
@@ -68,6 +69,11 @@ class SocketEvents : public Thread
      */
     std::chrono::milliseconds   m_timeout;
 
+    /**
+     * Number of completed event monitoring cycles
+     */
+    std::atomic<uint64_t>       m_cycles {0};
+
 protected:
 
     /**
@@ -100,6 +106,32 @@ public:
      * @param socket	            Socket to remove
      */
     void remove(BaseSocket& socket);
+
+    /**
+     * Enable or disable ET_HAS_DATA events for the socket in collection
+     * @param socket	            Socket from collection
+     * @param enable	            If true then socket read readiness is monitored
+     */
+    void watchRead(BaseSocket& socket, bool enable);
+
+    /**
+     * Enable or disable ET_CAN_WRITE events for the socket in collection
+     * @param socket	            Socket from collection
+     * @param enable	            If true then socket write readiness is monitored
+     */
+    void watchWrite(BaseSocket& socket, bool enable);
+
+    /**
+     * @brief Number of completed event monitoring cycles
+     *
+     * Events that are received before socket is removed from collection may still be
+     * delivered until the current cycle is completed. After the number of cycles
+     * has changed, user data of the removed socket is no longer used.
+     */
+    uint64_t cycles() const
+    {
+        return m_cycles;
+    }
 };
 
 }
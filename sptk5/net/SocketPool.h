@@ -52,7 +52,11 @@ typedef enum {
     /**
      * Peer closed connection
      */
-    ET_CONNECTION_CLOSED
+    ET_CONNECTION_CLOSED,
+    /**
+     * Socket is ready to write, reported only for sockets with write watch enabled
+     */
+    ET_CAN_WRITE
 } SocketEventType;
 
 /**
@@ -109,6 +113,7 @@ private:
 #ifdef _WIN32
     EventWindow*                m_pool;
     std::thread::id             m_threadId;
+    std::map<BaseSocket*,long>  m_socketEvents;     ///< Monitored events of sockets
 #else
     /**
      * Socket that controls other sockets events
@@ -167,6 +172,25 @@ public:
      * @param socket BaseSocket&, Socket from this pool
      */
     void forgetSocket(BaseSocket& socket);
+
+    /**
+     * Enable or disable monitoring of socket read readiness
+     *
+     * Sockets are monitored for read when added to the pool. If read monitoring is disabled,
+     * peer half-close isn't reported, but connection errors and full close may still be reported.
+     * @param socket BaseSocket&, Socket from this pool
+     * @param enable bool, If true then ET_HAS_DATA events are reported for the socket
+     */
+    void watchRead(BaseSocket& socket, bool enable);
+
+    /**
+     * Enable or disable monitoring of socket write readiness
+     *
+     * A socket that is ready for both read and write is reported as having data.
+     * @param socket BaseSocket&, Socket from this pool
+     * @param enable bool, If true then ET_CAN_WRITE events are reported for the socket
+     */
+    void watchWrite(BaseSocket& socket, bool enable);
 };
 
 }
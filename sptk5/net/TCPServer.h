@@ -32,6 +32,7 @@
 #include <sptk5/net/ServerConnection.h>
 #include <sptk5/Logger.h>
 #include <set>
+#include <vector>
 #include <iostream>
 #include <sptk5/threads/SynchronizedQueue.h>
 
@@ -39,6 +40,7 @@ namespace sptk
 {
 
 class TCPServerListener;
+class SSLHandshakeEvents;
 
 /**
  * @addtogroup net Networking Classes
@@ -61,9 +63,9 @@ class TCPServer : protected Thread
     mutable SharedMutex                     m_mutex;
 
     /**
-     * Server listener object
+     * Server listener objects, sharing the same port
      */
-    TCPServerListener*                      m_listenerThread;
+    std::vector<TCPServerListener*>         m_listenerThreads;
 
     /**
      * Optional logger
@@ -85,6 +87,27 @@ class TCPServer : protected Thread
      */
     mutable SharedMutex                     m_connectionThreadsLock;
 
+    /**
+     * Event-driven SSL handshakes of incoming connections, created upon the first SSL connection
+     */
+    SSLHandshakeEvents*                     m_handshakeEvents;
+
+    /**
+     * @brief Starts connection thread
+     *
+     * If connection socket is SSL socket with pending handshake,
+     * the connection thread is started after the handshake is completed
+     * by handshake events thread, and failed connection is deleted.
+     * This method is called from the listener threads.
+     * @param connection        Newly created connection thread
+     */
+    void startConnection(ServerConnection* connection);
+
+    /**
+     * @brief Stops and deletes listener threads
+     */
+    void stopListeners();
+
 protected:
     /**
      * @brief Screens incoming connection request
@@ -146,11 +169,22 @@ public:
      */
     uint16_t port() const;
 
+    /**
+     * @brief Returns number of accepted connections, per acceptor thread
+     */
+    std::vector<size_t> acceptedConnections() const;
+
     /**
      * @brief Starts listener
-     * @param port              Listener port number
+     *
+     * Every acceptor thread owns a listener socket, bound to the same port with SO_REUSEPORT.
+     * Incoming connections are balanced between acceptor threads by the kernel.
+     * @param port              Listener port number, or 0 if selected by the system
+     * @param bindAddress       Local IP address or host name to bind, or empty string if any
+     * @param acceptorCount     Number of acceptor threads
+     * @param backlog           Maximum length of pending connections queue, per acceptor
      */
-    void listen(uint16_t port);
+    void listen(uint16_t port, const String& bindAddress = "", size_t acceptorCount = 1, int backlog = SOMAXCONN);
 
     /**
      * @brief Stops listener
@@ -162,7 +196,7 @@ public:
      */
     bool active() const
     {
-        return m_listenerThread != NULL;
+        return !m_listenerThreads.empty();
     }
 
     /**
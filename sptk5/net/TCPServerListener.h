@@ -32,6 +32,7 @@
 #include <sptk5/net/ServerConnection.h>
 #include <sptk5/Logger.h>
 #include <set>
+#include <atomic>
 #include <iostream>
 #include <sptk5/threads/SynchronizedQueue.h>
 
@@ -47,6 +48,9 @@ class TCPServer;
 
 /**
  * @brief Internal TCP server listener thread
+ *
+ * Server may run several listeners on the same port. Every listener owns a listener socket,
+ * bound with SO_REUSEPORT, so incoming connections are balanced between listeners by the kernel.
  */
 class TCPServerListener: public Thread, public std::mutex
 {
@@ -65,13 +69,55 @@ class TCPServerListener: public Thread, public std::mutex
      */
     String          m_error;
 
+    /**
+     * Listener port number, or 0 if selected by the system
+     */
+    uint16_t        m_port;
+
+    /**
+     * Local IP address or host name to bind, or empty string if any
+     */
+    String          m_bindAddress;
+
+    /**
+     * Maximum length of pending connections queue
+     */
+    int             m_backlog;
+
+    /**
+     * Number of accepted connections
+     */
+    std::atomic<size_t> m_acceptedConnections {0};
+
+    /**
+     * @brief Accepts pending connection, if any
+     * @param connectionFD      Accepted connection socket
+     * @param connectionInfo    Accepted connection information
+     * @return false if there are no pending connections
+     */
+    bool acceptConnection(SOCKET& connectionFD, sockaddr_in& connectionInfo);
+
+    /**
+     * @brief Creates and starts connection for accepted connection socket
+     * @param connectionFD      Accepted connection socket
+     * @param connectionInfo    Accepted connection information
+     */
+    void startConnection(SOCKET connectionFD, sockaddr_in& connectionInfo);
+
 public:
+    /**
+     * Maximum number of connections accepted per wakeup
+     */
+    static const size_t AcceptBatchSize = 32;
+
     /**
      * @brief Constructor
      * @param server CTCPServer*, TCP server created connection
      * @param port int, Listener port number
+     * @param bindAddress       Local IP address or host name to bind, or empty string if any
+     * @param backlog           Maximum length of pending connections queue
      */
-    TCPServerListener(TCPServer* server, uint16_t port);
+    TCPServerListener(TCPServer* server, uint16_t port, const String& bindAddress = "", int backlog = SOMAXCONN);
 
     /**
      * @brief Thread function
@@ -88,7 +134,8 @@ public:
      */
     void listen()
     {
-        m_listenerSocket.listen();
+        m_listenerSocket.listen(m_port, m_bindAddress, m_backlog);
+        m_listenerSocket.blockingMode(false);
     }
 
     /**
@@ -99,6 +146,14 @@ public:
         return m_listenerSocket.host().port();
     }
 
+    /**
+     * @brief Returns number of connections accepted by this listener
+     */
+    size_t acceptedConnections() const
+    {
+        return m_acceptedConnections;
+    }
+
     /**
      * @brief Returns latest socket error (if any)
      */
@@ -99,6 +99,16 @@ class SP_EXPORT TCPSocketReader: protected Buffer
      */
     int32_t bufferedRead(char *destination, size_t sz, char delimiter, bool readLine, struct sockaddr_in* from = NULL);
 
+    /**
+     * @brief Reads data from the opened socket directly into destination, bypassing the internal buffer
+     *
+     * Used for large reads when the internal buffer is empty
+     * @param destination       Destination buffer
+     * @param sz                Size of the destination buffer
+     * @returns number of bytes read
+     */
+    size_t directRead(char *destination, size_t sz);
+
 public:
 
     /**
@@ -141,6 +151,41 @@ public:
      * Returns number of bytes available to read
      */
     size_t availableBytes() const;
+
+    /**
+     * @brief Returns pointer to the data available to read, without copying it
+     *
+     * The pointer is valid until the next read operation.
+     */
+    const char* readPosition() const
+    {
+        return m_buffer + m_readOffset;
+    }
+
+    /**
+     * @brief Advances the read position, marking the data as read
+     * @param bytes             Number of bytes to skip, no more than availableBytes()
+     */
+    void consume(size_t bytes);
+
+    /**
+     * @brief Reads up to sz bytes, with no more than one receive from the socket
+     *
+     * If the internal buffer is empty, data is received directly into destination.
+     * @param destination       Destination buffer
+     * @param sz                Size of the destination buffer
+     * @returns number of bytes read, or 0 if connection is closed
+     */
+    size_t readSome(char* destination, size_t sz);
+
+    /**
+     * @brief Receives more data from the socket, appending it to the data available to read
+     *
+     * The data available to read is moved to the start of the internal buffer,
+     * and the buffer grows if it is full.
+     * @returns number of bytes received, or 0 if connection is closed
+     */
+    size_t readMore();
 };
 
 /**
@@ -180,6 +225,15 @@ protected:
      */
     void _open(const struct sockaddr_in& address, CSocketOpenMode openMode, bool blockingMode, std::chrono::milliseconds timeout) override;
 
+    /**
+     * @brief Opens the client socket connection by IPv6 address and port
+     * @param address           Address and port
+     * @param openMode          Socket open mode
+     * @param blockingMode      Socket blocking (true) on non-blocking (false) mode
+     * @param timeout           Connection timeout. The default is 0 (wait forever)
+     */
+    virtual void _open(const struct sockaddr_in6& address, CSocketOpenMode openMode, bool blockingMode, std::chrono::milliseconds timeout);
+
 public:
     /**
     * @brief Constructor
@@ -213,6 +267,16 @@ public:
      */
     size_t socketBytes() override;
 
+    /**
+     * @brief Socket buffered reader
+     *
+     * Allows to parse the received data in place.
+     */
+    TCPSocketReader& reader()
+    {
+        return m_reader;
+    }
+
     /**
      * @brief Reports true if socket is ready for reading from it
      * @param timeout           Read timeout
@@ -284,6 +348,16 @@ public:
      * @returns the number of bytes read from the socket
      */
     size_t read(String& buffer, size_t size, sockaddr_in* from = nullptr) override;
+
+    /**
+     * @brief Reads data from the socket into several memory buffers
+     *
+     * Each buffer is filled up to its capacity, unless the connection is closed.
+     * Buffer bytes() is set to number of bytes read into that buffer.
+     * @param buffers           The memory buffers
+     * @returns the total number of bytes read from the socket
+     */
+    size_t read(const std::vector<Buffer*>& buffers) override;
 };
 
 /**
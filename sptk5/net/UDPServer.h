@@ -0,0 +1,159 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       UDPServer.h - description                              ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __UDPSERVER_H__
+#define __UDPSERVER_H__
+
+#include <sptk5/net/UDPSocket.h>
+#include <sptk5/Logger.h>
+#include <mutex>
+#include <vector>
+
+namespace sptk
+{
+
+class UDPServerWorker;
+
+/**
+ * @addtogroup net Networking Classes
+ * @{
+ */
+
+/**
+ * @brief Multi-threaded UDP server
+ *
+ * Every worker thread owns a UDP socket, bound to the same port with SO_REUSEPORT,
+ * so incoming datagrams are balanced between workers by the kernel.
+ * Workers receive datagrams in batches, and pass every batch to datagramsReceived().
+ */
+class SP_EXPORT UDPServer
+{
+    friend class UDPServerWorker;
+
+    /**
+     * Mutex protecting internal data
+     */
+    mutable std::mutex              m_mutex;
+
+    /**
+     * Optional logger
+     */
+    Logger*                         m_logger;
+
+    /**
+     * Maximum number of datagrams received with one system call
+     */
+    size_t                          m_batchSize;
+
+    /**
+     * Datagram buffer size
+     */
+    size_t                          m_datagramSize;
+
+    /**
+     * Receive coalesced datagrams (GRO), if supported by the system
+     */
+    bool                            m_gro;
+
+    /**
+     * Worker threads
+     */
+    std::vector<UDPServerWorker*>   m_workers;
+
+    /**
+     * Server port number
+     */
+    uint16_t                        m_port {0};
+
+protected:
+    /**
+     * @brief Processes received datagrams
+     *
+     * Method is called from worker threads concurrently.
+     * The socket may be used to send replies.
+     * @param socket            Worker socket that received datagrams
+     * @param datagrams         Received datagrams
+     * @param count             Number of received datagrams
+     */
+    virtual void datagramsReceived(UDPSocket& socket, std::vector<UDPDatagram>& datagrams, size_t count) = 0;
+
+public:
+    /**
+     * @brief Constructor
+     * @param logger            Optional logger
+     * @param batchSize         Maximum number of datagrams received with one system call
+     * @param datagramSize      Datagram buffer size. If GRO is enabled, buffers are at least 64K.
+     * @param gro               Receive coalesced datagrams (GRO), if supported by the system
+     */
+    explicit UDPServer(Logger* logger = nullptr, size_t batchSize = 32, size_t datagramSize = 2048, bool gro = false);
+
+    /**
+     * @brief Destructor
+     *
+     * Derived class should call stop() in its destructor, since workers call datagramsReceived().
+     */
+    virtual ~UDPServer();
+
+    /**
+     * @brief Starts worker threads
+     * @param port              Server port number, or 0 if selected by the system
+     * @param bindAddress       Local IP address to bind, or empty string if any
+     * @param workerCount       Number of worker threads
+     */
+    void listen(uint16_t port, const String& bindAddress = "", size_t workerCount = 1);
+
+    /**
+     * @brief Stops worker threads
+     */
+    void stop();
+
+    /**
+     * @brief Returns server port number
+     */
+    uint16_t port() const;
+
+    /**
+     * @brief Returns server state
+     */
+    bool active() const;
+
+    /**
+     * @brief Server operation log
+     */
+    void log(LogPriority priority, const std::string& message)
+    {
+        if (m_logger)
+            m_logger->log(priority, message);
+    }
+};
+
+/**
+ * @}
+ */
+}
+#endif
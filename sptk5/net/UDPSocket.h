@@ -31,6 +31,7 @@
 
 #include <sptk5/net/BaseSocket.h>
 #include <sptk5/Buffer.h>
+#include <vector>
 
 namespace sptk {
 
@@ -39,6 +40,41 @@ namespace sptk {
  * @{
  */
 
+/**
+ * @brief Datagram for batched UDP I/O
+ */
+struct SP_EXPORT UDPDatagram
+{
+    /**
+     * Datagram data. For read, preallocated buffer capacity defines maximum datagram size.
+     */
+    Buffer          data;
+
+    /**
+     * Source address for read, or destination address for write
+     */
+    sockaddr_in     address {};
+
+    /**
+     * Segment size, if data contains several datagrams of the same size (GRO or GSO), or 0
+     */
+    size_t          segmentSize {0};
+
+    /**
+     * Set by read if datagram was larger than data buffer capacity, and only its beginning was received
+     */
+    bool            truncated {false};
+
+    /**
+     * @brief Constructor
+     * @param capacity          Preallocated data buffer size
+     */
+    explicit UDPDatagram(size_t capacity = 2048)
+    : data(capacity)
+    {
+    }
+};
+
 /**
  * @brief UDP Socket
  *
@@ -47,6 +83,18 @@ namespace sptk {
  */
 class UDPSocket : public BaseSocket
 {
+#ifdef __linux__
+    std::vector<struct mmsghdr>     m_messages;     ///< Batch message headers, reused between batches
+    std::vector<struct iovec>       m_vectors;      ///< Batch data vectors, reused between batches
+    std::vector<char>               m_control;      ///< Batch control messages, reused between batches
+
+    /**
+     * @brief Makes sure batch structures can hold count messages
+     * @param count                 Number of messages in batch
+     */
+    void reserveBatch(size_t count);
+#endif
+
 public:
     /**
      * @brief Constructor
@@ -67,6 +115,41 @@ public:
      * @returns the number of bytes read from the socket
      */
     virtual size_t read(char *buffer,size_t size,sockaddr_in* from=NULL);
+
+    /**
+     * @brief Reads up to datagrams.size() datagrams from the socket with one system call
+     *
+     * Waits for the first datagram, and then reads datagrams that are already received, if any.
+     * Every datagram is received into its preallocated buffer, and datagram source address is stored
+     * into datagram address. If GRO is enabled, datagram may contain several segments of segmentSize bytes,
+     * so buffers should be able to hold 64K. Datagram data is zero-terminated. Datagrams that don't fit
+     * into the buffer are received partially, and marked as truncated.
+     * On systems without recvmmsg(), reads a single datagram.
+     * @param datagrams             Datagrams with preallocated buffers
+     * @returns the number of datagrams read
+     */
+    size_t readBatch(std::vector<UDPDatagram>& datagrams);
+
+    /**
+     * @brief Writes up to count datagrams to the socket with one system call
+     *
+     * Every datagram is sent to its address. If datagram segment size is not 0 and GSO is available,
+     * datagram data is sent as a sequence of datagrams of segmentSize bytes (the last one may be shorter).
+     * On systems without sendmmsg(), writes datagrams one by one.
+     * @param datagrams             Datagrams
+     * @param count                 Number of datagrams to send, or 0 to send all datagrams
+     * @returns the number of datagrams written
+     */
+    size_t writeBatch(const std::vector<UDPDatagram>& datagrams, size_t count = 0);
+
+    /**
+     * @brief Enables or disables receiving of coalesced datagrams (GRO)
+     *
+     * If GRO isn't supported by the system, the method returns false.
+     * @param enable                True to enable GRO
+     * @returns true if GRO setting was applied
+     */
+    bool enableGRO(bool enable);
 };
 
 /**
@@ -0,0 +1,116 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       TestCounter.h - description                            ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Thursday May 25 2000                                   ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_TEST_COUNTER_H__
+#define __SPTK_TEST_COUNTER_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace sptk {
+
+/**
+ * Counter of events that happen in other threads, that a test can wait for
+ */
+class TestCounter
+{
+    mutable std::mutex              m_mutex;
+    std::condition_variable         m_changed;
+    long                            m_value {0};
+
+public:
+    /**
+     * Constructor
+     * @param value             Initial value
+     */
+    explicit TestCounter(long value = 0)
+    : m_value(value)
+    {
+    }
+
+    /**
+     * Current value
+     */
+    operator long () const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_value;
+    }
+
+    /**
+     * Set value
+     * @param value             New value
+     */
+    TestCounter& operator = (long value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_value = value;
+        m_changed.notify_all();
+        return *this;
+    }
+
+    /**
+     * Add to value, and wake up waiting threads
+     * @param delta             Value to add
+     */
+    void add(long delta)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_value += delta;
+        m_changed.notify_all();
+    }
+
+    TestCounter& operator ++ ()
+    {
+        add(1);
+        return *this;
+    }
+
+    TestCounter& operator -- ()
+    {
+        add(-1);
+        return *this;
+    }
+
+    /**
+     * Wait until counter reaches the value
+     * @param value             Expected value
+     * @param timeout           Wait timeout
+     * @return true if counter has the expected value
+     */
+    bool waitFor(long value, std::chrono::milliseconds timeout = std::chrono::seconds(3))
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_changed.wait_for(lock, timeout, [this, value]() { return m_value == value; });
+    }
+};
+
+} // namespace sptk
+
+#endif
@@ -0,0 +1,146 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       TestListener.h - description                           ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Thursday May 25 2000                                   ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_TEST_LISTENER_H__
+#define __SPTK_TEST_LISTENER_H__
+
+#include <sptk5/net/BaseSocket.h>
+#include <sptk5/net/Host.h>
+#include <poll.h>
+
+namespace sptk {
+
+/**
+ * Loopback listener socket on a free port, for tests that accept connections without TCPServer
+ */
+class TestListener
+{
+    SOCKET      m_socket;           ///< Listening socket
+    int         m_family;           ///< Address family, AF_INET or AF_INET6
+    uint16_t    m_port {0};         ///< Listening port
+
+public:
+    /**
+     * Constructor, starts listening on loopback address.
+     * Throws an exception if address family isn't available.
+     * @param family            Address family, AF_INET or AF_INET6
+     * @param backlog           Listen queue size
+     */
+    explicit TestListener(int family = AF_INET, int backlog = 16)
+    : m_family(family)
+    {
+        m_socket = ::socket(family, SOCK_STREAM, 0);
+        if (m_socket == INVALID_SOCKET)
+            THROW_SOCKET_ERROR("Can't create listener socket");
+
+        sockaddr_storage address = {};
+        socklen_t addressLength;
+        if (family == AF_INET6) {
+            auto* address6 = (sockaddr_in6*) &address;
+            address6->sin6_family = AF_INET6;
+            address6->sin6_addr = in6addr_loopback;
+            addressLength = sizeof(sockaddr_in6);
+        } else {
+            auto* address4 = (sockaddr_in*) &address;
+            address4->sin_family = AF_INET;
+            address4->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addressLength = sizeof(sockaddr_in);
+        }
+
+        if (::bind(m_socket, (sockaddr*) &address, addressLength) != 0 || ::listen(m_socket, backlog) != 0) {
+            ::close(m_socket);
+            THROW_SOCKET_ERROR("Can't listen");
+        }
+
+        getsockname(m_socket, (sockaddr*) &address, &addressLength);
+        m_port = ntohs(family == AF_INET6 ? ((sockaddr_in6*) &address)->sin6_port : ((sockaddr_in*) &address)->sin_port);
+    }
+
+    TestListener(const TestListener&) = delete;
+    TestListener& operator = (const TestListener&) = delete;
+
+    /**
+     * Destructor, closes listener socket
+     */
+    ~TestListener()
+    {
+        ::close(m_socket);
+    }
+
+    /**
+     * Listening port
+     */
+    uint16_t port() const
+    {
+        return m_port;
+    }
+
+    /**
+     * Loopback host and port to connect to the listener
+     */
+    Host host() const
+    {
+        return Host(m_family == AF_INET6 ? "[::1]" : "127.0.0.1", m_port);
+    }
+
+    /**
+     * Accepts connection
+     *
+     * Accepted socket is blocking, and its reads time out after the same timeout,
+     * so that a failing test doesn't hang.
+     * @param timeout           Connection wait timeout
+     * @return accepted socket
+     */
+    SOCKET accept(std::chrono::milliseconds timeout = std::chrono::seconds(5))
+    {
+        pollfd pfd = {m_socket, POLLIN, 0};
+        int rc = ::poll(&pfd, 1, int(timeout.count()));
+        if (rc == 0)
+            throw TimeoutException("Connection wasn't accepted");
+
+        SOCKET socket = ::accept(m_socket, nullptr, nullptr);
+        if (socket == INVALID_SOCKET)
+            THROW_SOCKET_ERROR("Can't accept");
+
+        timeval readTimeout = {time_t(timeout.count() / 1000), suseconds_t(timeout.count() % 1000 * 1000)};
+        setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &readTimeout, sizeof(readTimeout));
+        return socket;
+    }
+
+    /**
+     * Stops listening, so that accept() in another thread fails
+     */
+    void shutdown()
+    {
+        ::shutdown(m_socket, SHUT_RDWR);
+    }
+};
+
+} // namespace sptk
+
+#endif
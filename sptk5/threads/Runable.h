@@ -90,6 +90,13 @@ public:
      */
     void execute();
 
+    /**
+     * @brief Waits until current execution of the task, if any, is finished
+     *
+     * Doesn't wait for the task that is queued but not started yet.
+     */
+    void waitCompleted();
+
     /**
      * @brief Requests execution termination
      */
@@ -260,6 +260,12 @@ public:
      */
     String className() const;
 
+    /**
+     * Collects names of the elements and attributes used by this type and its child elements
+     * @param names             Output set of names
+     */
+    void collectNames(std::set<String>& names) const;
+
     /**
      * Multiplicity flag
      */
@@ -29,6 +29,8 @@
 #ifndef __SPTK_XML_DOC_TYPE_H__
 #define __SPTK_XML_DOC_TYPE_H__
 
+#include <sptk5/Buffer.h>
+#include <sptk5/String.h>
 #include <sptk5/xml/Entities.h>
 
 #include <string>
@@ -136,6 +138,17 @@ public:
      */
     bool encodeEntities(const char* str, Buffer& ret);
 
+    /**
+     * @brief Encodes string to XML representation.
+     *
+     * Converts "<test>" to "&lt;test&gt;"
+     * @returns true, any entities replaced.
+     * @param str const char *, string to convert
+     * @param sz size_t, string length
+     * @param ret CBuffer&, converted text is appended here
+     */
+    bool encodeEntities(const char* str, size_t sz, Buffer& ret);
+
     /**
      * @brief Decodes entities in string to their actual values.
      *
@@ -146,6 +159,16 @@ public:
      */
     void decodeEntities(const char* str, uint32_t sz, Buffer& ret);
 
+    /**
+     * @brief Decodes entities in string to their actual values.
+     *
+     * Allows decoding directly into the string that is used as node value.
+     * @param str const char*, text to convert
+     * @param sz size_t, text length
+     * @param ret String&, converted text is stored here
+     */
+    void decodeEntities(const char* str, size_t sz, String& ret);
+
     /**
      * @brief Searches for entity with given name
      *
@@ -172,6 +195,16 @@ public:
      */
     const char* getReplacement(const char* name, uint32_t& replacementLength);
 
+    /**
+     * @brief Returnes replacement value for named entity.
+     *
+     * If entity is not found, nullptr is returned.
+     * @param name const char *, entity name, not necessarily zero-terminated
+     * @param nameLength size_t, entity name length
+     * @param replacementLength uint32_t&, the length of the replacement
+     */
+    const char* getReplacement(const char* name, size_t nameLength, uint32_t& replacementLength);
+
     /**
      * @brief Adds an entity to the map
      *
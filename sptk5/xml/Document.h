@@ -140,14 +140,6 @@ public:
         clear();
     }
 
-    /**
-     * Returns node type
-     */
-    virtual NodeType type() const override
-    {
-        return DOM_DOCUMENT;
-    }
-
     /**
      * Destroys all nodes in document
      */
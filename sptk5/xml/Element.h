@@ -55,11 +55,33 @@ class Document;
 class SP_EXPORT Element : public NamedItem
 {
     friend class Document;
+    friend class NamedItem;
+
+    /**
+     * Index of child elements, see findChild()
+     */
+    struct ChildIndex;
+
     /**
      * The list of subnodes
      */
     NodeList       m_nodes;
 
+    /**
+     * Index of child elements, built on the first lookup, and released when children are changed
+     */
+    mutable ChildIndex* m_childIndex {nullptr};
+
+    /**
+     * Returns child index, building it if necessary
+     */
+    const ChildIndex& childIndex() const;
+
+    /**
+     * Releases child index, after children are changed
+     */
+    void resetChildIndex();
+
 
 protected:
     /**
@@ -75,7 +97,9 @@ protected:
      */
     explicit Element(Document& doc)
     : NamedItem(doc), m_attributes(this)
-    {}
+    {
+        m_type = DOM_ELEMENT;
+    }
 
 public:
     /**
@@ -86,7 +110,9 @@ public:
      */
     Element(Node& parent, const char* tagname)
     : NamedItem(parent,tagname), m_attributes(this)
-    {}
+    {
+        m_type = DOM_ELEMENT;
+    }
 
     /**
      * @brief Constructor
@@ -96,7 +122,9 @@ public:
      */
     Element(Node* parent, const char* tagname)
     : NamedItem(*parent,tagname), m_attributes(this)
-    {}
+    {
+        m_type = DOM_ELEMENT;
+    }
 
     /**
      * @brief Constructor
@@ -106,15 +134,52 @@ public:
      */
     Element(Node& parent, const std::string& tagname)
     : NamedItem(parent,tagname), m_attributes(this)
-    {}
+    {
+        m_type = DOM_ELEMENT;
+    }
 
     /**
-     * @brief Returns node type
+     * @brief Destructor
      */
-    NodeType type() const override
-    {
-        return DOM_ELEMENT;
-    }
+    ~Element() override;
+
+    /**
+     * @brief Minimal number of children that are indexed for findChild()
+     *
+     * Elements with less children are searched by linear scan.
+     */
+    static constexpr size_t IndexedChildrenThreshold = 16;
+
+    /**
+     * @brief Finds the first child element with the given name
+     *
+     * If element has many children, they are indexed on the first lookup,
+     * so repeated lookups don't scan the children.
+     * @param name              Element name, including namespace prefix if any
+     * @returns child element, or nullptr if not found
+     */
+    Element* findChild(const std::string& name) const;
+
+    /**
+     * @brief Finds the first child element with the given namespace URI and local name
+     *
+     * Namespace prefixes of child elements are resolved with lookupNamespaceURI(),
+     * so the lookup doesn't depend on prefixes used in the document.
+     * Namespace declarations are resolved when the index is built.
+     * @param nameSpaceURI      Namespace URI, or empty string for elements without namespace
+     * @param localName         Element name without namespace prefix
+     * @returns child element, or nullptr if not found
+     */
+    Element* findChild(const std::string& nameSpaceURI, const std::string& localName) const;
+
+    /**
+     * @brief Returns namespace URI for namespace prefix
+     *
+     * Namespace is searched in xmlns attributes of this element and its ancestors.
+     * @param prefix            Namespace prefix, or empty string for default namespace
+     * @returns namespace URI, or empty string if namespace isn't declared
+     */
+    String lookupNamespaceURI(const std::string& prefix) const;
 
     /**
      * @brief Returns the first subnode iterator
@@ -0,0 +1,134 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       JsonConverter.h - description                          ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_XML_JSON_CONVERTER_H__
+#define __SPTK_XML_JSON_CONVERTER_H__
+
+#include <sptk5/Buffer.h>
+#include <sptk5/json/JsonParser.h>
+#include <sptk5/xml/Writer.h>
+#include <istream>
+
+namespace sptk {
+namespace xml {
+
+/**
+ * @addtogroup XML
+ * @{
+ */
+
+/**
+ * @brief Direct converter between XML and JSON text
+ *
+ * Converts XML text to JSON text, and JSON text to XML text, in a single pass,
+ * without building XML or JSON documents. Conversion rules are the same as for
+ * xml::Document::exportTo(json::Element&) and json::Document::exportTo(xml::Document&):
+ * - XML element with attributes or child elements becomes JSON object, attributes are stored in "attributes" object
+ * - XML element that has only text becomes JSON string, or number if text is a number
+ * - repeated XML elements become JSON array, and an object with the only "item" array is replaced with the array
+ * - JSON array items become <item> elements, and JSON null becomes <null/> element
+ *
+ * Repeated XML elements are merged into an array even if other elements are between them.
+ * As in json::Element, the array takes the position of the second element with the same name.
+ */
+class SP_EXPORT JsonConverter
+{
+public:
+    /**
+     * Convert XML text to JSON text
+     * @param output            Output JSON text
+     * @param xml               XML text
+     * @param length            XML text length
+     */
+    static void toJSON(Buffer& output, const char* xml, size_t length);
+
+    /**
+     * Convert XML text to JSON text
+     * @param output            Output JSON text
+     * @param xml               XML text
+     */
+    static void toJSON(Buffer& output, const Buffer& xml)
+    {
+        toJSON(output, xml.c_str(), xml.bytes());
+    }
+
+    /**
+     * Convert XML text to JSON text
+     *
+     * XML is read by blocks, so only output JSON text is kept in memory.
+     * @param output            Output JSON text
+     * @param xml               Input stream with XML text
+     * @param blockSize         Size of the block read from the stream
+     */
+    static void toJSON(Buffer& output, std::istream& xml, size_t blockSize = json::StreamReader::DefaultBlockSize);
+
+    /**
+     * Convert JSON text to XML text
+     *
+     * JSON root value becomes XML root element with the name rootNodeName.
+     * @param output            XML writer
+     * @param input             JSON reader, positioned before JSON root value
+     * @param rootNodeName      XML root element name
+     */
+    static void toXML(Writer& output, json::StreamReader& input, const String& rootNodeName = "data");
+
+    /**
+     * Convert JSON text to XML text
+     *
+     * Output starts with XML declaration, as in xml::Document::save().
+     * @param output            Output XML text
+     * @param json              JSON text
+     * @param length            JSON text length
+     * @param rootNodeName      XML root element name
+     * @param indentSpaces      Indent spaces per nesting level
+     */
+    static void toXML(Buffer& output, const char* json, size_t length, const String& rootNodeName = "data",
+                      int indentSpaces = 2);
+
+    /**
+     * Convert JSON text to XML text
+     *
+     * Output starts with XML declaration, as in xml::Document::save().
+     * @param output            Output XML text
+     * @param json              JSON text
+     * @param rootNodeName      XML root element name
+     * @param indentSpaces      Indent spaces per nesting level
+     */
+    static void toXML(Buffer& output, const Buffer& json, const String& rootNodeName = "data", int indentSpaces = 2)
+    {
+        toXML(output, json.c_str(), json.bytes(), rootNodeName, indentSpaces);
+    }
+};
+
+/**
+ * @}
+ */
+}
+}
+
+#endif
@@ -223,6 +223,14 @@ private:
      */
     void parent(Node* p);
 
+    /**
+     * @brief Finds the first subnode with the given name (internal)
+     * @param sharedName        The name to find, as shared string, or nullptr if name isn't shared
+     * @param name              The name to find
+     * @param recursively       If true, also search in all subnodes
+     */
+    Node* findFirst(const std::string* sharedName, const std::string& name, bool recursively) const;
+
     /**
      * @brief Checks if any descendent node matches the path element (internal)
      * @param nodes             Output list of matched nodes
@@ -285,6 +293,11 @@ protected:
      */
 	Node* m_parent {nullptr};
 
+    /**
+     * Node type, set by derived class constructor
+     */
+    NodeType m_type {DOM_UNDEFINED};
+
 
     /**
      * @brief Protected constructor - for derived classes
@@ -349,8 +362,13 @@ public:
 
     /**
      * @brief Returns node type
+     *
+     * Node type is stored in the node, so it may be used instead of dynamic_cast in hot loops.
      */
-    virtual NodeType type() const = 0;
+    NodeType type() const
+    {
+        return m_type;
+    }
 
     /**
      * @brief Selects nodes as defined by XPath
@@ -712,6 +730,7 @@ protected:
     explicit NamedItem(Document& doc)
     : Node(doc)
     {
+        m_type = DOM_ATTRIBUTE;
     }
 
     /**
@@ -733,6 +752,7 @@ public:
     NamedItem(Node& parent, const char* tagname)
     : Node(parent)
     {
+        m_type = DOM_ATTRIBUTE;
         name(tagname);
     }
 
@@ -745,6 +765,7 @@ public:
     NamedItem(Node* parent, const char* tagname)
     : Node(*parent)
     {
+        m_type = DOM_ATTRIBUTE;
         name(tagname);
     }
 
@@ -757,6 +778,7 @@ public:
     NamedItem(Node& parent, const std::string& tagname)
     : Node(parent)
     {
+        m_type = DOM_ATTRIBUTE;
         name(tagname);
     }
 
@@ -801,14 +823,6 @@ public:
      * @param name              New node name
      */
     virtual void name(const char* name);
-
-    /**
-     * @brief Returns node type
-     */
-    virtual NodeType type() const
-    {
-        return DOM_ATTRIBUTE;
-    }
 };
 
 /**
@@ -837,6 +851,16 @@ public:
         value(data);
     }
 
+    /**
+     * @brief Constructor
+     *
+     * Takes over the storage of the value.
+     */
+    BaseTextNode(Node* parent, String&& data)
+            : Node(*parent), m_value(std::move(data))
+    {
+    }
+
     /**
      * @brief Returns the value of the node
      *
@@ -919,6 +943,7 @@ public:
     Text(Node& parent, const char* data)
             : BaseTextNode(&parent, data)
     {
+        m_type = DOM_TEXT;
     }
 
     /**
@@ -930,6 +955,7 @@ public:
     Text(Node* parent, const char* data)
             : BaseTextNode(parent, data)
     {
+        m_type = DOM_TEXT;
     }
 
     /**
@@ -941,14 +967,19 @@ public:
     Text(Node& parent, const std::string& data)
             : BaseTextNode(&parent, data.c_str())
     {
+        m_type = DOM_TEXT;
     }
 
     /**
-     * @brief Returns node type
+     * @brief Constructor
+     *
+     * @param parent            Parent node.
+     * @param data              Text, moved into the node
      */
-    virtual NodeType type() const
+    Text(Node* parent, String&& data)
+            : BaseTextNode(parent, std::move(data))
     {
-        return DOM_TEXT;
+        m_type = DOM_TEXT;
     }
 };
 
@@ -973,6 +1004,7 @@ public:
     Comment(Node& parent, const char* data)
             : BaseTextNode(&parent, data)
     {
+        m_type = DOM_COMMENT;
     }
 
     /**
@@ -984,6 +1016,7 @@ public:
     Comment(Node* parent, const char* data)
             : BaseTextNode(parent, data)
     {
+        m_type = DOM_COMMENT;
     }
 
     /**
@@ -995,14 +1028,7 @@ public:
     Comment(Node& parent, const std::string& data)
             : BaseTextNode(&parent, data.c_str())
     {
-    }
-
-    /**
-     * @brief Returns node type
-     */
-    virtual NodeType type() const
-    {
-        return DOM_COMMENT;
+        m_type = DOM_COMMENT;
     }
 };
 
@@ -1027,6 +1053,7 @@ public:
     CDataSection(Node& parent, const char* data)
             : BaseTextNode(&parent, data)
     {
+        m_type = DOM_CDATA_SECTION;
     }
 
     /**
@@ -1038,6 +1065,7 @@ public:
     CDataSection(Node* parent, const char* data)
             : BaseTextNode(parent, data)
     {
+        m_type = DOM_CDATA_SECTION;
     }
 
     /**
@@ -1049,14 +1077,7 @@ public:
     CDataSection(Node& parent, const std::string& data)
             : BaseTextNode(&parent, data.c_str())
     {
-    }
-
-    /**
-     * @brief Returns node type
-     */
-    virtual NodeType type() const
-    {
-        return DOM_CDATA_SECTION;
+        m_type = DOM_CDATA_SECTION;
     }
 };
 
@@ -1070,6 +1091,16 @@ class SP_EXPORT PI : public BaseTextNode
      */
 	const std::string* m_name {nullptr};
 
+protected:
+    /**
+     * @brief Returns true if node name pointer (from SST) matches aname pointer
+     * @param sstName           Node name pointer to compare with this node name pointer
+     */
+    virtual bool nameIs(const std::string* sstName) const
+    {
+        return sstName == m_name;
+    }
+
 public:
     /**
      * @brief Constructor
@@ -1081,6 +1112,7 @@ public:
     PI(Node& parent, std::string target, const char* data)
     : BaseTextNode(&parent, data)
     {
+        m_type = DOM_PI;
         name(target);
     }
 
@@ -1094,6 +1126,7 @@ public:
     PI(Node* parent, std::string target, const char* data)
     : BaseTextNode(parent, data)
     {
+        m_type = DOM_PI;
         name(target);
     }
 
@@ -1107,6 +1140,7 @@ public:
     PI(Node& parent, std::string target, const std::string& data)
     : BaseTextNode(&parent, data.c_str())
     {
+        m_type = DOM_PI;
         name(target);
     }
 
@@ -1131,14 +1165,6 @@ public:
      * @param name              New node name
      */
     virtual void name(const char* name);
-
-    /**
-     * @brief Returns node type
-     */
-    virtual NodeType type() const
-    {
-        return DOM_PI;
-    }
 };
 
 /**
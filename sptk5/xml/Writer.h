@@ -0,0 +1,243 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       Writer.h - description                                 ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_XML_WRITER_H__
+#define __SPTK_XML_WRITER_H__
+
+#include <sptk5/Buffer.h>
+#include <sptk5/xml/Node.h>
+#include <vector>
+
+namespace sptk {
+
+class BaseSocket;
+
+namespace xml {
+
+/**
+ * @addtogroup XML
+ * @{
+ */
+
+class DocType;
+
+/**
+ * @brief XML writer
+ *
+ * Renders XML directly into a buffer, or a socket.
+ * May be used to render XML document or node, or to produce XML without
+ * building a document, with beginElement(), attribute(), text(), and endElement() calls:
+ * @code
+ * Buffer output;
+ * xml::Writer writer(output);
+ * writer.beginElement("person");
+ * writer.attribute("id", "1");
+ * writer.beginElement("name");
+ * writer.text("John");
+ * writer.endElement();
+ * writer.endElement();
+ * @endcode
+ */
+class SP_EXPORT Writer
+{
+    /**
+     * State of open element
+     */
+    struct Scope
+    {
+        std::string     name;           ///< Element name
+        bool            hasChildren;    ///< True if element has child elements or other non-text nodes
+    };
+
+    Buffer                  m_buffer;               ///< Output buffer, if writing to socket
+    Buffer&                 m_output;               ///< Output buffer
+    BaseSocket*             m_socket {nullptr};     ///< Output socket, or nullptr
+    size_t                  m_flushSize {0};        ///< Buffer size that triggers writing to socket
+    int                     m_indentSpaces;         ///< Indent spaces per nesting level
+    DocType*                m_docType {nullptr};    ///< Document type with custom entities, used for encoding text
+    bool                    m_startTagOpen {false}; ///< True if start tag is written, but not closed with '>'
+    std::vector<Scope>      m_scopes;               ///< Open elements
+
+    /**
+     * Append indentation spaces
+     * @param indent            Number of spaces
+     */
+    void appendIndent(size_t indent);
+
+    /**
+     * Returns true if output is empty, or ends with new line
+     */
+    bool atLineStart() const
+    {
+        return m_output.bytes() == 0 || m_output.c_str()[m_output.bytes() - 1] == '\n';
+    }
+
+    /**
+     * Prepare writing a child node that takes a separate line: close start tag, and write indentation
+     */
+    void beginChildLine();
+
+    /**
+     * Write text, encoding special characters
+     * @param text              Text
+     * @param length            Text length
+     */
+    void appendText(const char* text, size_t length);
+
+    /**
+     * Write text, encoding special characters
+     * @param text              Text
+     */
+    void appendText(const String& text);
+
+    /**
+     * Write XML element node
+     * @param node              Element node
+     * @param indent            Current indent
+     */
+    void writeElement(const Node& node, int indent);
+
+    /**
+     * Write XML document node
+     * @param document          Document
+     */
+    void writeDocument(const Node& document);
+
+    /**
+     * Write to socket, if buffer size is over the limit
+     */
+    void checkFlush()
+    {
+        if (m_socket != nullptr && m_output.bytes() >= m_flushSize)
+            flush();
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param output            Output buffer, rendered XML is appended to it
+     * @param indentSpaces      Indent spaces per nesting level
+     */
+    explicit Writer(Buffer& output, int indentSpaces = 2);
+
+    /**
+     * @brief Constructor
+     *
+     * Rendered XML is accumulated in internal buffer, and written to socket every time the buffer size
+     * reaches flushSize, and when flush() is called.
+     * @param socket            Output socket
+     * @param indentSpaces      Indent spaces per nesting level
+     * @param flushSize         Buffer size that triggers writing to socket
+     */
+    Writer(BaseSocket& socket, int indentSpaces = 2, size_t flushSize = 16384);
+
+    /**
+     * @brief Write XML node and all its children
+     *
+     * If node is a document, then XML declaration and DOCTYPE are written as well.
+     * @param node              XML node
+     * @param indent            Current indent
+     */
+    void write(const Node& node, int indent = 0);
+
+    /**
+     * @brief Write element start tag
+     * @param name              Element name
+     */
+    void beginElement(const String& name);
+
+    /**
+     * @brief Write element attribute.
+     *
+     * Must follow beginElement(), or other attribute() call.
+     * @param name              Attribute name
+     * @param value             Attribute value
+     */
+    void attribute(const String& name, const String& value);
+
+    /**
+     * @brief Write element end tag
+     */
+    void endElement();
+
+    /**
+     * @brief Write text
+     * @param text              Text
+     * @param length            Text length
+     */
+    void text(const char* text, size_t length);
+
+    /**
+     * @brief Write text
+     * @param text              Text
+     */
+    void text(const String& text)
+    {
+        this->text(text.c_str(), text.length());
+    }
+
+    /**
+     * @brief Write CDATA section
+     * @param text              CDATA section text
+     */
+    void cdata(const String& text);
+
+    /**
+     * @brief Write comment
+     * @param text              Comment text
+     */
+    void comment(const String& text);
+
+    /**
+     * @brief Write processing instruction
+     * @param name              Processing instruction name
+     * @param value             Processing instruction value
+     */
+    void processingInstruction(const String& name, const String& value);
+
+    /**
+     * @brief Write buffered output to socket
+     */
+    void flush();
+
+    /**
+     * @brief Append text to buffer, replacing XML special characters with entities
+     * @param output            Output buffer
+     * @param text              Text
+     * @param length            Text length
+     */
+    static void appendEscaped(Buffer& output, const char* text, size_t length);
+};
+
+/**
+ * @}
+ */
+}
+}
+
+#endif
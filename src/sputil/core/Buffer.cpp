@@ -36,121 +36,146 @@ using namespace sptk;
 
 Buffer::Buffer(size_t sz)
 {
-    m_buffer = (char*)calloc(1, sz + 1);
+    init(nullptr, sz);
+}
 
-    if (m_buffer != nullptr)
-        m_capacity = sz;
-    else
-        m_capacity = 0;
+Buffer::Buffer(size_t sz, BufferAllocator& allocator)
+: m_allocator(&allocator)
+{
+    init(nullptr, sz);
+}
 
-    m_bytes = 0;
+Buffer::Buffer(char* inlineStorage, size_t inlineCapacity) noexcept
+: m_capacity(inlineCapacity), m_buffer(inlineStorage),
+  m_inlineStorage(inlineStorage), m_inlineCapacity(inlineCapacity)
+{
+    m_buffer[0] = 0;
 }
 
 Buffer::Buffer(const void* data, size_t sz)
 {
-    m_buffer = (char*)malloc(sz + 1);
-
-    if (m_buffer != nullptr)
-    {
-        memcpy(m_buffer, data, sz);
-        m_capacity = sz;
-        m_bytes = sz;
-        m_buffer[sz] = 0;
-    }
-    else
-        m_capacity = m_bytes = 0;
+    init(data, sz);
 }
 
 Buffer::Buffer(const char* str)
 {
-    size_t sz = (size_t) strlen(str) + 1;
-    m_buffer = (char*)malloc(sz );
-
-    if (m_buffer != nullptr) {
-        memcpy(m_buffer, str, sz);
-        m_capacity = sz;
-        m_bytes = sz - 1;
-    } else {
-        m_capacity = 0;
-        m_bytes = 0;
-    }
+    init(str, strlen(str));
 }
 
 Buffer::Buffer(const string& str)
 {
-    size_t sz = (size_t) str.length() + 1;
-    m_buffer = (char*)malloc(sz);
-
-    if (m_buffer != nullptr) {
-        if (sz > 1)
-            memcpy(m_buffer, str.c_str(), sz);
-        else m_buffer[0] = 0;
-
-        m_capacity = sz;
-        m_bytes = sz - 1;
-    } else {
-        m_capacity = 0;
-        m_bytes = 0;
-    }
+    init(str.c_str(), str.length());
 }
 
 Buffer::Buffer(const String& str)
 {
-    size_t sz = (size_t) str.length() + 1;
-    m_buffer = (char*)malloc(sz);
+    init(str.c_str(), str.length());
+}
 
-    if (m_buffer != nullptr) {
-        if (sz > 1)
-            memcpy(m_buffer, str.c_str(), sz);
-        else m_buffer[0] = 0;
+Buffer::Buffer(const Buffer& buffer)
+: m_allocator(buffer.m_allocator)
+{
+    init(buffer.data(), buffer.bytes());
+}
 
-        m_capacity = sz;
-        m_bytes = sz - 1;
-    } else {
-        m_capacity = 0;
-        m_bytes = 0;
+Buffer::Buffer(Buffer&& other) noexcept
+: m_allocator(other.m_allocator)
+{
+    if (other.m_buffer != nullptr && other.m_buffer == other.m_inlineStorage) {
+        // Inline data can't be moved
+        init(other.m_buffer, other.m_bytes);
+        other.m_bytes = 0;
+        other.m_buffer[0] = 0;
+        return;
     }
+
+    m_bytes = other.m_bytes;
+    m_capacity = other.m_capacity;
+    m_buffer = other.m_buffer;
+
+    other.m_bytes = 0;
+    other.m_capacity = other.m_inlineCapacity;
+    other.m_buffer = other.m_inlineStorage;
+    if (other.m_buffer != nullptr)
+        other.m_buffer[0] = 0;
 }
 
-Buffer::Buffer(const Buffer& buffer)
+Buffer::~Buffer()
+{
+    releaseStorage();
+}
+
+void Buffer::init(const void* data, size_t sz)
 {
-    size_t sz = buffer.bytes() + 1;
-    m_buffer = (char*)malloc(sz);
+    size_t blockSize = sz + 1;
+    m_buffer = m_allocator->allocate(blockSize);
+
+    if (m_buffer == nullptr)
+        throw Exception("Can't allocate a buffer");
 
-    if (m_buffer != nullptr) {
-        memcpy(m_buffer, buffer.data(), sz);
-        m_capacity = sz;
-        m_bytes = sz - 1;
+    m_capacity = blockSize - 1;
+
+    if (data != nullptr) {
+        memcpy(m_buffer, data, sz);
+        m_buffer[sz] = 0;
+        m_bytes = sz;
     } else {
-        m_capacity = 0;
+        memset(m_buffer, 0, sz + 1);
         m_bytes = 0;
     }
 }
 
-Buffer::Buffer(Buffer&& other) noexcept
+void Buffer::releaseStorage() noexcept
 {
-    if (m_buffer != nullptr)
-        free(m_buffer);
+    if (m_buffer != nullptr && m_buffer != m_inlineStorage)
+        m_allocator->deallocate(m_buffer, m_capacity + 1);
+}
 
-    m_bytes = other.m_bytes;
-    m_capacity = other.m_capacity;
-    m_buffer = other.m_buffer;
+void Buffer::resizeStorage(size_t sz)
+{
+    size_t blockSize = sz + 1;
+    char* block;
 
-    other.m_bytes = 0;
-    other.m_capacity = 0;
-    other.m_buffer = nullptr;
+    if (m_buffer == nullptr || m_buffer == m_inlineStorage) {
+        block = m_allocator->allocate(blockSize);
+        if (block != nullptr && m_buffer != nullptr)
+            memcpy(block, m_buffer, (m_capacity < blockSize ? m_capacity + 1 : blockSize));
+    } else
+        block = m_allocator->reallocate(m_buffer, m_capacity + 1, blockSize);
+
+    if (block == nullptr)
+        throw Exception("Can't reallocate a buffer");
+
+    m_buffer = block;
+    m_capacity = blockSize - 1;
 }
 
 void Buffer::adjustSize(size_t sz)
 {
-    size_t newSize = sz / 3 * 4 + 16;
-    auto p = (char*) realloc(m_buffer, newSize + 1);
+    size_t newSize = m_capacity + m_capacity / 2;
+    if (newSize < sz)
+        newSize = sz;
+    resizeStorage(newSize);
+}
 
-    if (p == nullptr)
-        throw Exception("Can't reallocate a buffer");
+void Buffer::shrink_to_fit()
+{
+    if (m_buffer == nullptr || m_buffer == m_inlineStorage)
+        return;
+
+    if (m_inlineStorage != nullptr && m_bytes <= m_inlineCapacity) {
+        memcpy(m_inlineStorage, m_buffer, m_bytes);
+        m_inlineStorage[m_bytes] = 0;
+        releaseStorage();
+        m_buffer = m_inlineStorage;
+        m_capacity = m_inlineCapacity;
+        return;
+    }
+
+    if (m_bytes < m_capacity)
+        resizeStorage(m_bytes);
 
-    m_buffer = p;
-    m_capacity = newSize;
+    m_buffer[m_bytes] = 0;
 }
 
 void Buffer::set(const char* data, size_t sz)
@@ -207,15 +232,8 @@ void Buffer::fill(char c, size_t count)
 
 void Buffer::reset(size_t sz)
 {
-    if (sz != 0) {
-        auto p = (char*)realloc(m_buffer, sz + 1);
-
-        if (p == nullptr)
-            throw Exception("Can't reallocate a buffer");
-
-        m_buffer = p;
-        m_capacity = sz;
-    }
+    if (sz != 0 || m_buffer == nullptr)
+        resizeStorage(sz);
 
     m_buffer[0] = 0;
     m_bytes = 0;
@@ -255,16 +273,30 @@ void Buffer::saveToFile(const String& fileName) const
 
 Buffer& Buffer::operator = (Buffer&& b) DOESNT_THROW
 {
-    if (m_buffer != nullptr)
-        free(m_buffer);
+    if (&b == this)
+        return *this;
+
+    if (b.m_buffer != nullptr && b.m_buffer == b.m_inlineStorage) {
+        // Inline data can't be moved
+        set(b.m_buffer, b.m_bytes);
+        b.m_bytes = 0;
+        b.m_buffer[0] = 0;
+        return *this;
+    }
+
+    releaseStorage();
 
     m_bytes = b.m_bytes;
     m_capacity = b.m_capacity;
     m_buffer = b.m_buffer;
+    m_allocator = b.m_allocator;
 
     b.m_bytes = 0;
-    b.m_capacity = 0;
-    b.m_buffer = nullptr;
+    b.m_capacity = b.m_inlineCapacity;
+    b.m_buffer = b.m_inlineStorage;
+    if (b.m_buffer != nullptr)
+        b.m_buffer[0] = 0;
+
     return *this;
 }
 
@@ -423,4 +455,68 @@ TEST(SPTK_Buffer, reset)
     EXPECT_TRUE(buffer1.capacity() > 0);
 }
 
+TEST(SPTK_Buffer, reserveShrink)
+{
+    Buffer  buffer1(testPhrase);
+
+    buffer1.reserve(1000);
+    EXPECT_TRUE(buffer1.capacity() >= 1000);
+    EXPECT_STREQ(testPhrase, buffer1.c_str());
+
+    buffer1.shrink_to_fit();
+    EXPECT_TRUE(buffer1.capacity() < 1000);
+    EXPECT_STREQ(testPhrase, buffer1.c_str());
+    EXPECT_EQ(strlen(testPhrase), buffer1.bytes());
+}
+
+TEST(SPTK_Buffer, inlineBuffer)
+{
+    InlineBuffer<32> buffer1;
+
+    buffer1.append(testPhrase);
+    const char* inlineData = buffer1.data();
+    EXPECT_EQ(size_t(32), buffer1.capacity());
+
+    // Outgrow inline storage
+    for (int i = 0; i < 4; i++)
+        buffer1.append(testPhrase);
+    EXPECT_NE(inlineData, buffer1.data());
+    EXPECT_EQ(strlen(testPhrase) * 5, buffer1.bytes());
+
+    // Move allocated memory out, the buffer returns to inline storage
+    Buffer buffer2(std::move(buffer1));
+    EXPECT_EQ(strlen(testPhrase) * 5, buffer2.bytes());
+    EXPECT_EQ(inlineData, buffer1.data());
+    EXPECT_EQ(size_t(0), buffer1.bytes());
+
+    buffer1 = testPhrase;
+    InlineBuffer<32> buffer3(std::move(buffer1));
+    EXPECT_STREQ(testPhrase, buffer3.c_str());
+    EXPECT_NE(inlineData, buffer3.data());
+
+    buffer2.reset();
+    buffer2.append(testPhrase);
+    buffer3 = std::move(buffer2);
+    buffer3.shrink_to_fit();
+    EXPECT_STREQ(testPhrase, buffer3.c_str());
+    EXPECT_EQ(size_t(32), buffer3.capacity());
+}
+
+TEST(SPTK_Buffer, arenaAllocator)
+{
+    ArenaBufferAllocator arena;
+    {
+        Buffer  buffer1(16, arena);
+        Buffer  buffer2(16, arena);
+        for (int i = 0; i < 100; i++) {
+            buffer1.append(testPhrase);
+            buffer2.append(testPhrase);
+        }
+        EXPECT_EQ(strlen(testPhrase) * 100, buffer1.bytes());
+        EXPECT_EQ(0, memcmp(buffer1.data(), buffer2.data(), buffer1.bytes()));
+        EXPECT_EQ(&arena, &buffer1.allocator());
+    }
+    EXPECT_TRUE(arena.allocated() > 0);
+}
+
 #endif
@@ -0,0 +1,421 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       BufferAllocator.cpp - description                      ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/BufferAllocator.h>
+#include <cstring>
+
+using namespace std;
+using namespace sptk;
+
+BufferAllocator& BufferAllocator::defaultAllocator()
+{
+    return PooledBufferAllocator::instance();
+}
+
+HeapBufferAllocator& HeapBufferAllocator::instance()
+{
+    static HeapBufferAllocator allocator;
+    return allocator;
+}
+
+char* HeapBufferAllocator::allocate(size_t& size)
+{
+    return (char*) malloc(size);
+}
+
+char* HeapBufferAllocator::reallocate(char* block, size_t, size_t& newSize)
+{
+    return (char*) realloc(block, newSize);
+}
+
+void HeapBufferAllocator::deallocate(char* block, size_t) noexcept
+{
+    free(block);
+}
+
+namespace {
+
+    /**
+     * Free block in the size class list.
+     * The link is stored in the released block itself.
+     */
+    struct FreeBlock
+    {
+        FreeBlock*  next;
+    };
+
+    constexpr size_t SizeClassCount = 12;   // 32 bytes to 64K
+
+    /**
+     * Free lists of the current thread
+     */
+    struct ThreadFreeLists
+    {
+        FreeBlock*  head[SizeClassCount] {};
+        size_t      count[SizeClassCount] {};
+
+        ~ThreadFreeLists();
+
+        void release() noexcept
+        {
+            for (size_t sizeClass = 0; sizeClass < SizeClassCount; sizeClass++) {
+                while (head[sizeClass] != nullptr) {
+                    FreeBlock* block = head[sizeClass];
+                    head[sizeClass] = block->next;
+                    free(block);
+                }
+                count[sizeClass] = 0;
+            }
+        }
+    };
+
+    /**
+     * Set when the thread's free lists are destroyed, blocks released after that go to the heap directly.
+     * Trivially destructible, so it stays accessible during the thread (or process) shutdown.
+     */
+    thread_local bool threadFreeListsDestroyed = false;
+
+    thread_local ThreadFreeLists threadFreeLists;
+
+    ThreadFreeLists::~ThreadFreeLists()
+    {
+        threadFreeListsDestroyed = true;
+        release();
+    }
+
+    inline size_t sizeClassIndex(size_t size)
+    {
+        size_t sizeClass = 0;
+        size_t blockSize = PooledBufferAllocator::MinPooledBlockSize;
+        while (blockSize < size) {
+            blockSize <<= 1;
+            sizeClass++;
+        }
+        return sizeClass;
+    }
+
+    inline size_t sizeClassBlockSize(size_t sizeClass)
+    {
+        return PooledBufferAllocator::MinPooledBlockSize << sizeClass;
+    }
+}
+
+PooledBufferAllocator& PooledBufferAllocator::instance()
+{
+    static PooledBufferAllocator allocator;
+    return allocator;
+}
+
+char* PooledBufferAllocator::allocate(size_t& size)
+{
+    if (size > MaxPooledBlockSize)
+        return (char*) malloc(size);
+
+    size_t sizeClass = sizeClassIndex(size);
+    size = sizeClassBlockSize(sizeClass);
+
+    if (!threadFreeListsDestroyed) {
+        ThreadFreeLists& lists = threadFreeLists;
+        FreeBlock* block = lists.head[sizeClass];
+        if (block != nullptr) {
+            lists.head[sizeClass] = block->next;
+            lists.count[sizeClass]--;
+            return (char*) block;
+        }
+    }
+
+    return (char*) malloc(size);
+}
+
+char* PooledBufferAllocator::reallocate(char* block, size_t oldSize, size_t& newSize)
+{
+    if (oldSize > MaxPooledBlockSize && newSize > MaxPooledBlockSize)
+        return (char*) realloc(block, newSize);
+
+    if (newSize <= oldSize && oldSize <= MaxPooledBlockSize && sizeClassIndex(newSize) == sizeClassIndex(oldSize)) {
+        newSize = oldSize;
+        return block;
+    }
+
+    char* newBlock = allocate(newSize);
+    if (newBlock == nullptr)
+        return nullptr;
+
+    memcpy(newBlock, block, oldSize < newSize ? oldSize : newSize);
+    deallocate(block, oldSize);
+
+    return newBlock;
+}
+
+void PooledBufferAllocator::deallocate(char* block, size_t size) noexcept
+{
+    if (block == nullptr)
+        return;
+
+    if (size > MaxPooledBlockSize || threadFreeListsDestroyed) {
+        free(block);
+        return;
+    }
+
+    size_t sizeClass = sizeClassIndex(size);
+    ThreadFreeLists& lists = threadFreeLists;
+    if (lists.count[sizeClass] * sizeClassBlockSize(sizeClass) >= MaxCachedBytes) {
+        free(block);
+        return;
+    }
+
+    auto freeBlock = (FreeBlock*) block;
+    freeBlock->next = lists.head[sizeClass];
+    lists.head[sizeClass] = freeBlock;
+    lists.count[sizeClass]++;
+}
+
+size_t PooledBufferAllocator::cachedBlocks()
+{
+    if (threadFreeListsDestroyed)
+        return 0;
+
+    size_t total = 0;
+    for (size_t count: threadFreeLists.count)
+        total += count;
+
+    return total;
+}
+
+void PooledBufferAllocator::releaseCachedBlocks() noexcept
+{
+    if (!threadFreeListsDestroyed)
+        threadFreeLists.release();
+}
+
+static inline size_t alignBlockSize(size_t size)
+{
+    constexpr size_t alignment = alignof(max_align_t);
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+ArenaBufferAllocator::ArenaBufferAllocator(size_t chunkSize)
+: m_chunkSize(alignBlockSize(chunkSize))
+{
+}
+
+ArenaBufferAllocator::ArenaBufferAllocator(ArenaBufferAllocator&& other) noexcept
+: m_chunks(move(other.m_chunks)),
+  m_chunkSize(other.m_chunkSize),
+  m_currentChunk(other.m_currentChunk),
+  m_offset(other.m_offset),
+  m_lastBlock(other.m_lastBlock),
+  m_allocated(other.m_allocated)
+{
+    other.m_chunks.clear();
+    other.m_currentChunk = nullptr;
+    other.m_lastBlock = nullptr;
+    other.m_offset = 0;
+    other.m_allocated = 0;
+}
+
+ArenaBufferAllocator::~ArenaBufferAllocator()
+{
+    clear();
+}
+
+char* ArenaBufferAllocator::allocate(size_t& size)
+{
+    size = alignBlockSize(size);
+
+    if (size > m_chunkSize / 2) {
+        // Large blocks get the chunk of their own, keeping the current chunk in use
+        auto chunk = (char*) malloc(size);
+        if (chunk == nullptr)
+            return nullptr;
+        m_chunks.push_back(chunk);
+        m_allocated += size;
+        return chunk;
+    }
+
+    // Unaligned allocations may leave current offset unaligned
+    m_offset = alignBlockSize(m_offset);
+
+    if (m_currentChunk == nullptr || m_offset + size > m_chunkSize) {
+        auto chunk = (char*) malloc(m_chunkSize);
+        if (chunk == nullptr)
+            return nullptr;
+        m_chunks.push_back(chunk);
+        m_currentChunk = chunk;
+        m_offset = 0;
+    }
+
+    m_lastBlock = m_currentChunk + m_offset;
+    m_offset += size;
+    m_allocated += size;
+
+    return m_lastBlock;
+}
+
+char* ArenaBufferAllocator::allocateUnaligned(size_t size)
+{
+    char* block;
+    if (size > m_chunkSize / 2) {
+        block = allocate(size);
+    } else {
+        if (m_currentChunk == nullptr || m_offset + size > m_chunkSize) {
+            auto chunk = (char*) malloc(m_chunkSize);
+            if (chunk != nullptr) {
+                m_chunks.push_back(chunk);
+                m_currentChunk = chunk;
+                m_offset = 0;
+            }
+            block = chunk;
+        } else
+            block = m_currentChunk + m_offset;
+        if (block != nullptr) {
+            m_offset += size;
+            m_allocated += size;
+            m_lastBlock = nullptr;
+        }
+    }
+    if (block == nullptr)
+        throw Exception("Can't allocate " + to_string(size) + " bytes");
+    return block;
+}
+
+char* ArenaBufferAllocator::reallocate(char* block, size_t oldSize, size_t& newSize)
+{
+    if (block == m_lastBlock && block != nullptr) {
+        size_t blockOffset = size_t(block - m_currentChunk);
+        size_t alignedSize = alignBlockSize(newSize);
+        if (blockOffset + alignedSize <= m_chunkSize) {
+            // Resize the last block in place
+            m_offset = blockOffset + alignedSize;
+            m_allocated = m_allocated - oldSize + alignedSize;
+            newSize = alignedSize;
+            return block;
+        }
+    }
+
+    if (newSize <= oldSize) {
+        newSize = oldSize;
+        return block;
+    }
+
+    char* newBlock = allocate(newSize);
+    if (newBlock == nullptr)
+        return nullptr;
+
+    memcpy(newBlock, block, oldSize);
+    deallocate(block, oldSize);
+
+    return newBlock;
+}
+
+void ArenaBufferAllocator::deallocate(char* block, size_t size) noexcept
+{
+    if (block != nullptr && block == m_lastBlock) {
+        m_offset = size_t(block - m_currentChunk);
+        m_allocated -= size;
+        m_lastBlock = nullptr;
+    }
+}
+
+void ArenaBufferAllocator::clear() noexcept
+{
+    for (char* chunk: m_chunks)
+        free(chunk);
+    m_chunks.clear();
+    m_currentChunk = nullptr;
+    m_lastBlock = nullptr;
+    m_offset = 0;
+    m_allocated = 0;
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_BufferAllocator, pooledReuse)
+{
+    PooledBufferAllocator& allocator = PooledBufferAllocator::instance();
+    PooledBufferAllocator::releaseCachedBlocks();
+
+    size_t size = 100;
+    char* block1 = allocator.allocate(size);
+    EXPECT_EQ(size_t(128), size);
+    allocator.deallocate(block1, size);
+    EXPECT_EQ(size_t(1), PooledBufferAllocator::cachedBlocks());
+
+    size = 90;
+    char* block2 = allocator.allocate(size);
+    EXPECT_EQ(block1, block2);
+    EXPECT_EQ(size_t(0), PooledBufferAllocator::cachedBlocks());
+
+    strcpy(block2, "test");
+    size_t newSize = 1000;
+    block2 = allocator.reallocate(block2, size, newSize);
+    EXPECT_EQ(size_t(1024), newSize);
+    EXPECT_STREQ("test", block2);
+    allocator.deallocate(block2, newSize);
+
+    PooledBufferAllocator::releaseCachedBlocks();
+    EXPECT_EQ(size_t(0), PooledBufferAllocator::cachedBlocks());
+}
+
+TEST(SPTK_BufferAllocator, arena)
+{
+    ArenaBufferAllocator arena(1024);
+
+    size_t size1 = 10;
+    char* block1 = arena.allocate(size1);
+    size_t size2 = 100;
+    char* block2 = arena.allocate(size2);
+    EXPECT_EQ(block1 + size1, block2);
+
+    // The last block grows in place
+    strcpy(block2, "test");
+    size_t newSize = 200;
+    EXPECT_EQ(block2, arena.reallocate(block2, size2, newSize));
+    EXPECT_STREQ("test", block2);
+
+    // Large block gets the chunk of its own
+    size_t largeSize = 4096;
+    char* largeBlock = arena.allocate(largeSize);
+    EXPECT_TRUE(largeBlock != nullptr);
+    EXPECT_EQ(size1 + newSize + largeSize, arena.allocated());
+
+    arena.clear();
+    EXPECT_EQ(size_t(0), arena.allocated());
+
+    // Unaligned blocks are packed without gaps, and don't break alignment of regular blocks
+    char* text1 = arena.allocateUnaligned(3);
+    char* text2 = arena.allocateUnaligned(5);
+    EXPECT_EQ(text1 + 3, text2);
+    size_t size3 = 16;
+    char* block3 = arena.allocate(size3);
+    EXPECT_EQ(size_t(0), size_t(block3 - text1) % alignof(max_align_t));
+    EXPECT_EQ(size_t(8 + 16), arena.allocated());
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       BufferChain.cpp - description                          ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Tuesday October 20 2026                                ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/BufferChain.h>
+
+using namespace std;
+using namespace sptk;
+
+void BufferChain::append(const SharedBuffer& segment)
+{
+    if (segment.empty())
+        return;
+    m_segments.push_back(segment);
+    m_bytes += segment.bytes();
+}
+
+void BufferChain::prepend(const SharedBuffer& segment)
+{
+    if (segment.empty())
+        return;
+    m_segments.push_front(segment);
+    m_bytes += segment.bytes();
+}
+
+void BufferChain::consume(size_t sz)
+{
+    while (sz > 0 && !m_segments.empty()) {
+        SharedBuffer& segment = m_segments.front();
+        if (sz < segment.bytes()) {
+            segment = segment.slice(sz);
+            m_bytes -= sz;
+            return;
+        }
+        sz -= segment.bytes();
+        m_bytes -= segment.bytes();
+        m_segments.pop_front();
+    }
+}
+
+void BufferChain::copyTo(Buffer& destination) const
+{
+    destination.reset();
+    destination.reserve(m_bytes + 1);
+    for (auto& segment: m_segments)
+        destination.append(segment.data(), segment.bytes());
+}
+
+void BufferChain::clear()
+{
+    m_segments.clear();
+    m_bytes = 0;
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_BufferChain, compose)
+{
+    BufferChain chain;
+
+    chain.append(string("Content-Length: 14\n\n"));
+    chain.append(Buffer("This is a test"));
+    chain.prepend(SharedBuffer(string("HTTP/1.1 200 OK\n")));
+    EXPECT_EQ(size_t(3), chain.size());
+    EXPECT_EQ(size_t(50), chain.bytes());
+
+    Buffer output;
+    chain.copyTo(output);
+    EXPECT_STREQ("HTTP/1.1 200 OK\nContent-Length: 14\n\nThis is a test", output.c_str());
+
+    chain.consume(20);
+    EXPECT_EQ(size_t(2), chain.size());
+    chain.copyTo(output);
+    EXPECT_STREQ("ent-Length: 14\n\nThis is a test", output.c_str());
+
+    chain.consume(100);
+    EXPECT_TRUE(chain.empty());
+    EXPECT_EQ(size_t(0), chain.size());
+}
+
+#endif
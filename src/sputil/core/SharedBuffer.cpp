@@ -0,0 +1,97 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       SharedBuffer.cpp - description                         ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Tuesday October 20 2026                                ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/SharedBuffer.h>
+
+using namespace std;
+using namespace sptk;
+
+SharedBuffer::SharedBuffer(Buffer&& buffer)
+: m_storage(make_shared<Buffer>(move(buffer)))
+{
+    m_data = m_storage->data();
+    m_bytes = m_storage->bytes();
+}
+
+SharedBuffer::SharedBuffer(const Buffer& buffer)
+: SharedBuffer(buffer.data(), buffer.bytes())
+{
+}
+
+SharedBuffer::SharedBuffer(const char* data, size_t sz)
+: m_storage(make_shared<Buffer>(data, sz))
+{
+    m_data = m_storage->data();
+    m_bytes = m_storage->bytes();
+}
+
+SharedBuffer::SharedBuffer(const string& str)
+: SharedBuffer(str.c_str(), str.length())
+{
+}
+
+SharedBuffer SharedBuffer::slice(size_t offset, size_t length) const
+{
+    if (offset > m_bytes)
+        throw Exception("Slice offset is outside of the buffer");
+
+    if (length > m_bytes - offset)
+        length = m_bytes - offset;
+
+    SharedBuffer result;
+    result.m_storage = m_storage;
+    result.m_data = m_data + offset;
+    result.m_bytes = length;
+
+    return result;
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_SharedBuffer, slice)
+{
+    Buffer buffer("This is a test");
+    const char* data = buffer.data();
+
+    SharedBuffer shared(move(buffer));
+    EXPECT_EQ(data, shared.data());
+    EXPECT_EQ(size_t(14), shared.bytes());
+
+    SharedBuffer slice = shared.slice(5, 4);
+    EXPECT_EQ(data + 5, slice.data());
+    EXPECT_STREQ("is a", string(slice).c_str());
+    EXPECT_EQ(2, shared.useCount());
+
+    SharedBuffer tail = slice.slice(3);
+    EXPECT_STREQ("a", string(tail).c_str());
+
+    EXPECT_THROW(shared.slice(15), Exception);
+}
+
+#endif
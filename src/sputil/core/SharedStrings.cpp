@@ -28,39 +28,153 @@
 
 #include <sptk5/sptk.h>
 #include <sptk5/SharedStrings.h>
+#include <mutex>
+#include <string_view>
 
 using namespace std;
 using namespace sptk;
 
+namespace {
+    mutex   staticNamesMutex;
+    bool    staticNamesFrozen = false;
+}
+
+SharedStrings& SharedStrings::staticNames()
+{
+    // Never destroyed: shared strings of static documents may outlive any other static object
+    static auto names = new SharedStrings(false, 256);
+    return *names;
+}
+
+SharedStrings::SharedStrings(bool useStaticNames, size_t tableSize)
+: m_table(tableSize, nullptr)
+{
+    if (useStaticNames) {
+        SharedStrings& names = staticNames();
+        lock_guard<mutex> lock(staticNamesMutex);
+        staticNamesFrozen = true;
+        m_staticNames = &names;
+    }
+}
+
 SharedStrings::SharedStrings()
+: SharedStrings(true, 64)
 {
-    shareString("");
+    shareString("", 0);
 }
 
-const std::string* SharedStrings::findString(const char *str) const
+SharedStrings::SharedStrings(SharedStrings&& other)
+: m_entries(move(other.m_entries)),
+  m_table(move(other.m_table)),
+  m_staticNames(other.m_staticNames)
 {
-    string s(str);
-    auto itor = m_strings.find(s);
-    if (itor == m_strings.end()) 
-        return nullptr;
-    return &(*itor);
+    other.m_entries.clear();
+    other.m_table.assign(64, nullptr);
+    other.shareString("", 0);
 }
 
-const string& SharedStrings::shareString(const char* str)
+size_t SharedStrings::hash(const char* str, size_t len)
 {
-    string s(str);
-    auto itor = m_strings.find(s);
-    if (itor == m_strings.end()) {
-        pair<Set::iterator, bool> insertResult = m_strings.insert(s);
-        itor = insertResult.first;
+    return std::hash<string_view>()(string_view(str, len));
+}
+
+const SharedStrings::Entry* SharedStrings::lookup(const char* str, size_t len, size_t hash) const
+{
+    size_t mask = m_table.size() - 1;
+    for (size_t index = hash & mask; ; index = (index + 1) & mask) {
+        const Entry* entry = m_table[index];
+        if (entry == nullptr)
+            return nullptr;
+        if (entry->m_hash == hash && entry->length() == len && memcmp(entry->c_str(), str, len) == 0)
+            return entry;
     }
-    return *itor;
+}
+
+const SharedStrings::Entry& SharedStrings::insert(const char* str, size_t len, size_t hash)
+{
+    // Keep load factor under 1/2
+    if ((m_entries.size() + 1) * 2 > m_table.size())
+        rehash();
+
+    m_entries.emplace_back(str, len, hash);
+    const Entry* entry = &m_entries.back();
+
+    size_t mask = m_table.size() - 1;
+    size_t index = hash & mask;
+    while (m_table[index] != nullptr)
+        index = (index + 1) & mask;
+    m_table[index] = entry;
+
+    return *entry;
+}
+
+void SharedStrings::rehash()
+{
+    vector<const Entry*> table(m_table.size() * 2, nullptr);
+    size_t mask = table.size() - 1;
+    for (auto& entry: m_entries) {
+        size_t index = entry.m_hash & mask;
+        while (table[index] != nullptr)
+            index = (index + 1) & mask;
+        table[index] = &entry;
+    }
+    m_table.swap(table);
+}
+
+const std::string* SharedStrings::findString(const char* str, size_t len) const
+{
+    size_t strHash = hash(str, len);
+
+    if (m_staticNames != nullptr) {
+        const Entry* entry = m_staticNames->lookup(str, len, strHash);
+        if (entry != nullptr)
+            return entry;
+    }
+
+    return lookup(str, len, strHash);
+}
+
+const string& SharedStrings::shareString(const char* str, size_t len)
+{
+    size_t strHash = hash(str, len);
+
+    if (m_staticNames != nullptr) {
+        const Entry* entry = m_staticNames->lookup(str, len, strHash);
+        if (entry != nullptr)
+            return *entry;
+    }
+
+    const Entry* entry = lookup(str, len, strHash);
+    if (entry != nullptr)
+        return *entry;
+
+    return insert(str, len, strHash);
 }
 
 void SharedStrings::clear()
 {
-    m_strings.clear();
-    shareString("");
+    m_entries.clear();
+    fill(m_table.begin(), m_table.end(), nullptr);
+    shareString("", 0);
+}
+
+bool SharedStrings::registerStaticNames(initializer_list<const char*> names)
+{
+    SharedStrings& staticNamesTable = staticNames();
+    lock_guard<mutex> lock(staticNamesMutex);
+    if (staticNamesFrozen) {
+        // Names still work, but every table shares them separately
+        return false;
+    }
+
+    for (const char* name: names) {
+        size_t len = strlen(name);
+        size_t nameHash = hash(name, len);
+        if (staticNamesTable.lookup(name, len, nameHash) == nullptr)
+            staticNamesTable.insert(name, len, nameHash);
+    }
+
+    return true;
 }
 
 #if USE_GTEST
@@ -76,6 +190,38 @@ TEST(SPTK_SharedStrings, match)
 
     EXPECT_STREQ("This", strings.findString("This")->c_str());
     EXPECT_STREQ("test", strings.findString("test")->c_str());
+    EXPECT_TRUE(strings.findString("missing") == nullptr);
+}
+
+TEST(SPTK_SharedStrings, handles)
+{
+    SharedStrings strings;
+
+    const string* handle = &strings.shareString("element");
+    EXPECT_EQ(handle, &strings.shareString(string("element")));
+    EXPECT_EQ(handle, strings.findString("element", 7));
+    EXPECT_EQ(SharedStrings::hash("element", 7), SharedStrings::hash(handle));
+
+    // Grow the table through several rehashes, the handles must stay valid
+    for (int i = 0; i < 1000; i++)
+        strings.shareString("name" + to_string(i));
+    EXPECT_EQ(handle, strings.findString("element"));
+    EXPECT_STREQ("name500", strings.findString("name500")->c_str());
+    EXPECT_EQ(size_t(1002), strings.stringCount());
+
+    strings.clear();
+    EXPECT_TRUE(strings.findString("element") == nullptr);
+    EXPECT_STREQ("", strings.findString("")->c_str());
+}
+
+TEST(SPTK_SharedStrings, staticNames)
+{
+    // Static names are frozen once shared string tables exist
+    SharedStrings strings1;
+    EXPECT_FALSE(SharedStrings::registerStaticNames({ "static" }));
+
+    SharedStrings strings2;
+    EXPECT_NE(&strings1.shareString("static"), &strings2.shareString("static"));
 }
 
 #endif
\ No newline at end of file
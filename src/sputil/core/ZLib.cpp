@@ -28,127 +28,402 @@
 
 #include <sptk5/Exception.h>
 #include <sptk5/ZLib.h>
-#include "zlib.h"
+#include <sptk5/threads/ThreadPool.h>
+#include <zlib.h>
 
 using namespace std;
 using namespace sptk;
 
 #define CHUNK 16384
+#define DEFAULT_MEM_LEVEL 8
+#define MAX_PORTION (1U << 30)
 
-void ZLib::compress(Buffer& dest, const Buffer& src)
-{
-    int ret, flush;
-    unsigned have;
-    z_stream strm = {};
-    unsigned char in[CHUNK];
-    unsigned char out[CHUNK];
-
-    /* allocate deflate state */
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
-    ret = deflateInit2(&strm,
-                       Z_DEFAULT_COMPRESSION,
-                       Z_DEFLATED,
-                       MAX_WBITS + 16,
-                       ZLIB_VER_MAJOR,
-                       Z_DEFAULT_STRATEGY);
-    if (ret != Z_OK)
-        throw Exception("deflateInit() error");
+static_assert(ZLibStream::NoCompression == Z_NO_COMPRESSION && ZLibStream::BestSpeed == Z_BEST_SPEED &&
+              ZLibStream::BestCompression == Z_BEST_COMPRESSION && ZLibStream::DefaultCompression == Z_DEFAULT_COMPRESSION &&
+              ZLibStream::DefaultStrategy == Z_DEFAULT_STRATEGY, "ZLibStream constants must match zlib");
 
-    bool eof = false;
-    size_t readPosition = 0;
-    /* compress until end of file */
-    do {
-        auto bytesToRead = uInt(src.bytes() - readPosition);
-        if (bytesToRead > CHUNK)
-            bytesToRead = CHUNK;
-        else
-            eof = true;
-        memcpy(in, src.c_str() + readPosition, bytesToRead);
-        readPosition += bytesToRead;
-        strm.avail_in = bytesToRead;
-        flush = eof ? Z_FINISH : Z_NO_FLUSH;
-        strm.next_in = in;
-
-        /* run deflate() on input until output buffer not full, finish
-           compression if all of source has been read in */
-        do {
-            strm.avail_out = CHUNK;
-            strm.next_out = out;
-            ret = deflate(&strm, flush);    /* no bad return value */
-            if (ret == Z_STREAM_ERROR)  /* state not clobbered */
-                throw Exception("compressed data error");
-            have = CHUNK - strm.avail_out;
-            dest.append((char*) out, have);
-        } while (strm.avail_out == 0);
-        //assert(strm.avail_in == 0);     /* all input will be used */
-
-        /* done when last data in file processed */
-    } while (flush != Z_FINISH);
-    //assert(ret == Z_STREAM_END);        /* stream will be complete */
-
-    /* clean up and return */
-    (void)deflateEnd(&strm);
+static int windowBits(ZLibStream::Format format)
+{
+    switch (format) {
+        case ZLibStream::GZIP:
+            return MAX_WBITS + 16;
+        case ZLibStream::ZLIB:
+            return MAX_WBITS;
+        case ZLibStream::RAW:
+            return -MAX_WBITS;
+        default:
+            return MAX_WBITS + 32;
+    }
 }
 
-void ZLib::decompress(Buffer& dest, const Buffer& src)
+ZLibStream::ZLibStream(Mode mode, Format format, int level, int strategy)
+: m_stream(new z_stream {}), m_mode(mode)
 {
     int ret;
-    unsigned have;
-    z_stream strm = {};
-    unsigned char in[CHUNK];
-    unsigned char out[CHUNK];
-
-    /* allocate inflate state */
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
-    strm.avail_in = 0;
-    strm.next_in = Z_NULL;
-    ret = inflateInit2(&strm, 16+MAX_WBITS);
-    if (ret != Z_OK)
-        throw Exception("inflateInit() error");
+    if (m_mode == COMPRESS) {
+        if (format == AUTO)
+            throw Exception("Compressed data format must be specified for compression");
+        ret = deflateInit2(m_stream.get(), level, Z_DEFLATED, windowBits(format), DEFAULT_MEM_LEVEL, strategy);
+        if (ret != Z_OK)
+            throw Exception("deflateInit() error");
+    } else {
+        ret = inflateInit2(m_stream.get(), windowBits(format));
+        if (ret != Z_OK)
+            throw Exception("inflateInit() error");
+    }
+}
+
+ZLibStream::~ZLibStream()
+{
+    if (m_mode == COMPRESS)
+        (void) deflateEnd(m_stream.get());
+    else
+        (void) inflateEnd(m_stream.get());
+}
+
+void ZLibStream::process(Buffer& dest, const char* data, size_t size, int flush)
+{
+    if (m_finished) {
+        if (m_mode == COMPRESS && size != 0)
+            throw Exception("Can't write to finished compressed stream");
+        return;
+    }
+
+    m_stream->next_in = (Bytef*) data;
+    bool moreInput;
 
-    uInt readPosition = 0;
-    /* decompress until deflate stream ends or end of file */
     do {
-        auto bytesToRead = uInt(src.bytes() - readPosition);
-        if (bytesToRead > CHUNK)
-            bytesToRead = CHUNK;
-        memcpy(in, src.c_str() + readPosition, bytesToRead);
-        readPosition += bytesToRead;
-        strm.avail_in = bytesToRead;
-        if (strm.avail_in == 0)
-            break;
-        strm.next_in = in;
-
-        /* run inflate() on input until output buffer not full */
-        do {
-            strm.avail_out = CHUNK;
-            strm.next_out = out;
-            ret = inflate(&strm, Z_NO_FLUSH);
-            if (ret == Z_STREAM_ERROR)  /* state not clobbered */
-                throw Exception("compressed data error");
+        // zlib counts input in uInt, so very large inputs are fed in portions
+        size_t portion = size > MAX_PORTION ? MAX_PORTION : size;
+        m_stream->avail_in = uInt(portion);
+        size -= portion;
+        moreInput = size != 0;
+        int portionFlush = moreInput ? Z_NO_FLUSH : flush;
+
+        for (;;) {
+            // Output goes directly into destination buffer, keeping a byte for zero terminator
+            dest.checkSize(dest.bytes() + CHUNK + 1);
+            size_t available = dest.capacity() - dest.bytes() - 1;
+            if (available > MAX_PORTION)
+                available = MAX_PORTION;
+
+            m_stream->next_out = (Bytef*) dest.data() + dest.bytes();
+            m_stream->avail_out = uInt(available);
+
+            int ret = m_mode == COMPRESS ? deflate(m_stream.get(), portionFlush) : inflate(m_stream.get(), portionFlush);
+
+            dest.bytes(dest.bytes() + available - m_stream->avail_out);
+            dest.data()[dest.bytes()] = 0;
+
+            if (ret == Z_STREAM_END) {
+                m_finished = true;
+                return;
+            }
+
             switch (ret) {
+                case Z_OK:
+                case Z_BUF_ERROR: // No progress possible, more input is needed
+                    break;
                 case Z_NEED_DICT:
                 case Z_DATA_ERROR:
+                    throw Exception("compressed data error");
                 case Z_MEM_ERROR:
-                    (void)inflateEnd(&strm);
-                    throw Exception("premature compressed data error");
+                    throw Exception("Not enough memory for compression");
                 default:
-                    break;
+                    throw Exception("compressed stream error");
+            }
+
+            // Output space left means zlib has consumed all the input and flushed what it could
+            if (m_stream->avail_out != 0)
+                break;
+        }
+    } while (moreInput);
+}
+
+void ZLibStream::write(Buffer& dest, const char* data, size_t size)
+{
+    process(dest, data, size, Z_NO_FLUSH);
+}
+
+size_t ZLibStream::totalIn() const
+{
+    return (size_t) m_stream->total_in;
+}
+
+size_t ZLibStream::totalOut() const
+{
+    return (size_t) m_stream->total_out;
+}
+
+void ZLibStream::setDictionary(const char* data, size_t size)
+{
+    int ret;
+    if (m_mode == COMPRESS)
+        ret = deflateSetDictionary(m_stream.get(), (const Bytef*) data, uInt(size));
+    else
+        ret = inflateSetDictionary(m_stream.get(), (const Bytef*) data, uInt(size));
+    if (ret != Z_OK)
+        throw Exception("Can't set compression dictionary");
+}
+
+void ZLibStream::flush(Buffer& dest)
+{
+    if (m_mode == COMPRESS)
+        process(dest, nullptr, 0, Z_SYNC_FLUSH);
+}
+
+void ZLibStream::finish(Buffer& dest)
+{
+    if (m_mode == COMPRESS)
+        process(dest, nullptr, 0, Z_FINISH);
+    else if (!m_finished)
+        throw Exception("premature end of compressed data");
+}
+
+void ZLibStream::reset()
+{
+    if (m_mode == COMPRESS)
+        (void) deflateReset(m_stream.get());
+    else
+        (void) inflateReset(m_stream.get());
+    m_finished = false;
+}
+
+void ZLib::compress(Buffer& dest, const Buffer& src, int level)
+{
+    ZLibStream stream(ZLibStream::COMPRESS, ZLibStream::GZIP, level);
+    dest.checkSize(dest.bytes() + src.bytes() / 2 + 64);
+    stream.write(dest, src);
+    stream.finish(dest);
+}
+
+void ZLib::decompress(Buffer& dest, const Buffer& src)
+{
+    ZLibStream stream(ZLibStream::DECOMPRESS, ZLibStream::GZIP);
+    dest.checkSize(dest.bytes() + src.bytes() * 3);
+    stream.write(dest, src);
+    stream.finish(dest);
+}
+
+namespace {
+
+/**
+ * Shared state of parallel gzip compression
+ */
+class ParallelCompression
+{
+    static constexpr size_t DictionarySize = 32768;
+
+    const Buffer&           m_source;
+    size_t                  m_blockSize;
+    size_t                  m_blockCount;
+    int                     m_level;
+    std::vector<Buffer>     m_output;           ///< Compressed blocks
+    std::vector<uLong>      m_crc;              ///< CRC32 of uncompressed blocks
+    std::atomic<size_t>     m_nextBlock {0};    ///< Next block to compress
+    std::mutex              m_errorMutex;
+    String                  m_error;            ///< First error occured in compression tasks
+
+    void compressBlock(size_t index)
+    {
+        size_t offset = index * m_blockSize;
+        size_t size = min(m_blockSize, m_source.bytes() - offset);
+        const char* data = m_source.data() + offset;
+
+        ZLibStream stream(ZLibStream::COMPRESS, ZLibStream::RAW, m_level);
+        if (offset > 0) {
+            size_t dictionarySize = min(offset, DictionarySize);
+            stream.setDictionary(data - dictionarySize, dictionarySize);
+        }
+
+        Buffer& output = m_output[index];
+        output.checkSize(size / 2 + 64);
+        stream.write(output, data, size);
+        if (index + 1 == m_blockCount)
+            stream.finish(output);
+        else
+            stream.flush(output); // Ends on a byte boundary, so blocks can be concatenated
+
+        m_crc[index] = crc32(0, (const Bytef*) data, uInt(size));
+    }
+
+    Semaphore               m_completed;        ///< Posted when a task has no more blocks to compress
+
+public:
+    ParallelCompression(const Buffer& source, size_t blockSize, int level)
+    : m_source(source), m_blockSize(blockSize), m_level(level)
+    {
+        m_blockCount = (source.bytes() + blockSize - 1) / blockSize;
+        m_output.resize(m_blockCount);
+        m_crc.resize(m_blockCount);
+    }
+
+    size_t blockCount() const
+    {
+        return m_blockCount;
+    }
+
+    void compressBlocks()
+    {
+        for (size_t index = m_nextBlock++; index < m_blockCount; index = m_nextBlock++) {
+            try {
+                compressBlock(index);
             }
-            have = CHUNK - strm.avail_out;
-            dest.append((char*) out, have);
-        } while (strm.avail_out == 0);
+            catch (const exception& e) {
+                lock_guard<mutex> lock(m_errorMutex);
+                if (m_error.empty())
+                    m_error = e.what();
+                m_nextBlock = m_blockCount;
+            }
+        }
+    }
+
+    void taskCompleted()
+    {
+        m_completed.post();
+    }
+
+    /**
+     * Waits until queued tasks are completed
+     * @param taskCount         Number of queued tasks
+     * @param timeout           Maximum time to wait for the next task to complete
+     * @return false if timeout occured
+     */
+    bool waitTasksCompleted(size_t taskCount, chrono::milliseconds timeout)
+    {
+        for (; taskCount > 0; taskCount--) {
+            if (!m_completed.sleep_for(timeout))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Releases compressed blocks, compression state may still be kept by abandoned tasks
+     */
+    void releaseBlocks()
+    {
+        m_output.clear();
+        m_output.shrink_to_fit();
+    }
+
+    /**
+     * Writes gzip stream to destination buffer, and releases compressed blocks
+     * @param dest              Destination buffer
+     */
+    void writeTo(Buffer& dest)
+    {
+        if (!m_error.empty()) {
+            releaseBlocks();
+            throw Exception(m_error);
+        }
+
+        static const uint8_t gzipHeader[10] = { 0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xFF };
+
+        size_t compressedSize = sizeof(gzipHeader) + 8;
+        for (auto& block: m_output)
+            compressedSize += block.bytes();
+        dest.checkSize(dest.bytes() + compressedSize + 1);
+
+        dest.append((const char*) gzipHeader, sizeof(gzipHeader));
+        uLong crc = crc32(0, Z_NULL, 0);
+        for (size_t index = 0; index < m_blockCount; index++) {
+            dest.append(m_output[index]);
+            size_t size = min(m_blockSize, m_source.bytes() - index * m_blockSize);
+            crc = crc32_combine(crc, m_crc[index], z_off_t(size));
+        }
+
+        // gzip trailer: CRC32 and uncompressed size modulo 2^32, both little-endian
+        uint8_t trailer[8];
+        auto isize = uint32_t(m_source.bytes());
+        for (int i = 0; i < 4; i++) {
+            trailer[i] = uint8_t(crc >> (i * 8));
+            trailer[i + 4] = uint8_t(isize >> (i * 8));
+        }
+        dest.append((const char*) trailer, sizeof(trailer));
+
+        releaseBlocks();
+    }
+};
 
-        /* done when inflate() says it's done */
-    } while (ret != Z_STREAM_END);
+class BlockCompressionTask : public Runable
+{
+    shared_ptr<ParallelCompression> m_compression;
+    atomic_bool                     m_started {false};
+public:
+    explicit BlockCompressionTask(const shared_ptr<ParallelCompression>& compression)
+    : m_compression(compression)
+    {}
+
+    void run() override
+    {
+        m_started = true;
+        m_compression->compressBlocks();
+        m_compression->taskCompleted();
+    }
+
+    bool started() const
+    {
+        return m_started;
+    }
+};
+
+/**
+ * Maximum time to wait for the next queued compression task to complete,
+ * after the calling thread has compressed the remaining blocks
+ */
+constexpr chrono::seconds TaskCompletionTimeout {10};
+
+}
+
+void ZLib::compress(Buffer& dest, const Buffer& src, ThreadPool& threadPool, size_t threads, int level, size_t blockSize)
+{
+    if (blockSize == 0)
+        throw Exception("Invalid compression block size");
 
-    /* clean up and return */
-    (void)inflateEnd(&strm);
-    //return ret == Z_STREAM_END ? Z_OK : Z_DATA_ERROR;
+    if (threads == 0)
+        threads = thread::hardware_concurrency();
+
+    if (threads < 2 || src.bytes() <= blockSize) {
+        compress(dest, src, level);
+        return;
+    }
+
+    // Compression state is shared with the tasks, so a task that starts late never refers to this stack frame
+    auto compression = make_shared<ParallelCompression>(src, blockSize, level);
+    if (threads > compression->blockCount())
+        threads = compression->blockCount();
+
+    // Calling thread is one of the compression threads
+    vector<unique_ptr<BlockCompressionTask>> tasks;
+    for (size_t i = 1; i < threads; i++) {
+        unique_ptr<BlockCompressionTask> task(new BlockCompressionTask(compression));
+        try {
+            threadPool.execute(task.get());
+        }
+        catch (const exception&) {
+            // Task isn't queued, remaining blocks are compressed by queued tasks and calling thread
+            break;
+        }
+        tasks.push_back(move(task));
+    }
+
+    // When calling thread completes, all the blocks are compressed or being compressed,
+    // and tasks that start after that don't access the source buffer.
+    compression->compressBlocks();
+
+    bool completed = compression->waitTasksCompleted(tasks.size(), TaskCompletionTimeout);
+    for (auto& task: tasks) {
+        if (completed || task->started())
+            task->waitCompleted();
+        else {
+            // Thread pool didn't start the task, and may never start it.
+            // Abandoned task keeps the compression state, that no longer refers to the source.
+            task.release();
+        }
+    }
+
+    compression->writeTo(dest);
 }
 
 #if USE_GTEST
@@ -184,4 +459,103 @@ TEST(SPTK_ZLib, decompress)
     EXPECT_STREQ(originalTestString.c_str(), decompressed.c_str());
 }
 
+TEST(SPTK_ZLib, streamRoundTrip)
+{
+    Buffer original;
+    for (int i = 0; i < 20000; i++)
+        original.append("Line " + int2string(i) + " of the compression test\n");
+
+    for (auto format: { ZLibStream::GZIP, ZLibStream::ZLIB, ZLibStream::RAW }) {
+        Buffer compressed;
+        ZLibStream compressor(ZLibStream::COMPRESS, format, Z_BEST_SPEED);
+        // Feed the data in uneven portions, with a flush in the middle
+        size_t offset = 0;
+        for (size_t portion = 1; offset < original.bytes(); portion = portion * 3 + 7) {
+            if (portion > original.bytes() - offset)
+                portion = original.bytes() - offset;
+            compressor.write(compressed, original.data() + offset, portion);
+            offset += portion;
+            if (offset > original.bytes() / 2 && offset - portion <= original.bytes() / 2)
+                compressor.flush(compressed);
+        }
+        compressor.finish(compressed);
+        EXPECT_TRUE(compressor.finished());
+        EXPECT_LT(compressed.bytes(), original.bytes() / 4);
+
+        Buffer decompressed;
+        ZLibStream decompressor(ZLibStream::DECOMPRESS, format == ZLibStream::RAW ? ZLibStream::RAW : ZLibStream::AUTO);
+        for (offset = 0; offset < compressed.bytes(); offset += 100) {
+            size_t portion = compressed.bytes() - offset > 100 ? 100 : compressed.bytes() - offset;
+            decompressor.write(decompressed, compressed.data() + offset, portion);
+        }
+        decompressor.finish(decompressed);
+        EXPECT_EQ(original.bytes(), decompressed.bytes());
+        EXPECT_EQ(0, memcmp(original.data(), decompressed.data(), original.bytes()));
+    }
+}
+
+TEST(SPTK_ZLib, streamErrors)
+{
+    Buffer compressed, decompressed;
+    Base64::decode(compressed, originalTestStringBase64);
+
+    ZLibStream decompressor(ZLibStream::DECOMPRESS);
+    decompressor.write(decompressed, compressed.data(), compressed.bytes() / 2);
+    EXPECT_FALSE(decompressor.finished());
+    EXPECT_THROW(decompressor.finish(decompressed), Exception);
+
+    decompressor.reset();
+    decompressed.reset();
+    decompressor.write(decompressed, compressed);
+    decompressor.finish(decompressed);
+    EXPECT_STREQ(originalTestString.c_str(), decompressed.c_str());
+
+    ZLibStream corrupted(ZLibStream::DECOMPRESS);
+    Buffer garbage("This is not compressed data");
+    EXPECT_THROW(corrupted.write(decompressed, garbage), Exception);
+}
+
+TEST(SPTK_ZLib, parallelCompress)
+{
+    Buffer original;
+    for (int i = 0; i < 50000; i++)
+        original.append("Line " + int2string(i) + " of the parallel compression test\n");
+
+    ThreadPool threadPool(4);
+
+    Buffer compressed;
+    ZLib::compress(compressed, original, threadPool, 4, Z_DEFAULT_COMPRESSION, 64 * 1024);
+
+    Buffer singleThreadCompressed;
+    ZLib::compress(singleThreadCompressed, original);
+    // Preset dictionaries keep compression ratio close to single-threaded compression
+    EXPECT_LT(compressed.bytes(), singleThreadCompressed.bytes() * 11 / 10);
+
+    Buffer decompressed;
+    ZLib::decompress(decompressed, compressed);
+    EXPECT_EQ(original.bytes(), decompressed.bytes());
+    EXPECT_EQ(0, memcmp(original.data(), decompressed.data(), original.bytes()));
+
+    threadPool.stop();
+}
+
+TEST(SPTK_ZLib, parallelCompressStoppedPool)
+{
+    Buffer original;
+    for (int i = 0; i < 10000; i++)
+        original.append("Line " + int2string(i) + " of the parallel compression test\n");
+
+    ThreadPool threadPool(4);
+    threadPool.stop();
+
+    // Tasks can't be queued, so calling thread compresses all the blocks
+    Buffer compressed;
+    ZLib::compress(compressed, original, threadPool, 4, Z_DEFAULT_COMPRESSION, 16 * 1024);
+
+    Buffer decompressed;
+    ZLib::decompress(decompressed, compressed);
+    EXPECT_EQ(original.bytes(), decompressed.bytes());
+    EXPECT_EQ(0, memcmp(original.data(), decompressed.data(), original.bytes()));
+}
+
 #endif
\ No newline at end of file
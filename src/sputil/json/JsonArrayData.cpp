@@ -28,12 +28,13 @@
 
 #include <sptk5/json/JsonElement.h>
 #include <sptk5/json/JsonArrayData.h>
+#include <sptk5/json/JsonDocument.h>
 
 using namespace std;
 using namespace sptk;
 using namespace sptk::json;
 
-ArrayData::ArrayData(const Document* document, Element* parent)
+ArrayData::ArrayData(Document* document, Element* parent)
 : m_document(document), m_parent(parent)
 {
 }
@@ -41,7 +42,7 @@ ArrayData::ArrayData(const Document* document, Element* parent)
 ArrayData::~ArrayData()
 {
     for (Element* element: m_items)
-        delete element;
+        m_document->destroyElement(element);
 }
 
 void ArrayData::setParent(Element* parent)
@@ -77,6 +78,6 @@ void ArrayData::remove(size_t index)
 {
     if (index >= m_items.size())
         return;
-    delete m_items[index];
+    m_document->destroyElement(m_items[index]);
     m_items.erase(m_items.begin() + index);
 }
@@ -38,77 +38,161 @@ void Document::clear()
     json::Type elementType = JDT_NULL;
     if (m_root != nullptr) {
         elementType = m_root->type();
-        delete m_root;
+        destroyElement(m_root);
     }
+    m_arena.clear();
+    m_freeElements = nullptr;
+    m_freeStrings.clear();
+    m_source = Buffer();
 
     if (elementType == JDT_ARRAY)
-        m_root = new Element(this, (ArrayData*)nullptr);
+        m_root = new (this) Element(this, new ArrayData(this));
     else
-        m_root = new Element(this, (ObjectData*)nullptr);
+        m_root = new (this) Element(this, new ObjectData(this));
 }
 
-void Document::parse(const string& json)
+void Document::parse(const char* json, size_t length)
 {
-    delete m_root;
+    destroyElement(m_root);
+    m_arena.clear();
+    m_freeElements = nullptr;
+    m_freeStrings.clear();
+    m_source = Buffer();
 
-    m_root = new Element(this);
+    m_root = new (this) Element(this);
 
-    if (json.empty())
+    if (length == 0)
         return;
 
     Parser parser;
-    parser.parse(*m_root, json);
+    parser.parse(*m_root, json, length);
+}
+
+void Document::loadMessagePack(const char* data, size_t length)
+{
+    parse(nullptr, 0);
+    MessagePack::read(*m_root, data, length);
+}
+
+void Document::loadMessagePack(Buffer&& data)
+{
+    parse(nullptr, 0);
+    m_source = move(data);
+    MessagePack::read(*m_root, m_source.c_str(), m_source.bytes(), false);
+}
+
+void* Document::allocateElement()
+{
+    if (m_freeElements != nullptr) {
+        void* element = m_freeElements;
+        m_freeElements = *(void**) element;
+        return element;
+    }
+    size_t size = sizeof(Element);
+    void* element = m_arena.allocate(size);
+    if (element == nullptr)
+        throw Exception("Can't allocate JSON element");
+    return element;
+}
+
+void Document::releaseElement(void* element) noexcept
+{
+    *(void**) element = m_freeElements;
+    m_freeElements = element;
+}
+
+void Document::destroyElement(Element* element) noexcept
+{
+    element->~Element();
+    releaseElement(element);
+}
+
+const char* Document::storeString(const char* str, size_t length)
+{
+    if (length == 0)
+        return "";
+
+    char* stored = nullptr;
+
+    // Reuse released block, unless it's much bigger than needed
+    auto itor = m_freeStrings.lower_bound(length + 1);
+    if (itor != m_freeStrings.end() && itor->first <= 2 * (length + 1)) {
+        stored = itor->second;
+        m_freeStrings.erase(itor);
+    } else
+        stored = m_arena.allocateUnaligned(length + 1);
+
+    memcpy(stored, str, length);
+    stored[length] = 0;
+    return stored;
+}
+
+void Document::releaseString(const char* str, size_t length) noexcept
+{
+    try {
+        m_freeStrings.emplace(length + 1, const_cast<char*>(str));
+    }
+    catch (...) {
+        // Block isn't reused
+    }
 }
 
 Document::Document(bool isObject)
 : m_emptyElement(this, "")
 {
     if (isObject)
-        m_root = new Element(this, new ObjectData(this));
+        m_root = new (this) Element(this, new ObjectData(this));
     else
-        m_root = new Element(this, new ArrayData(this));
+        m_root = new (this) Element(this, new ArrayData(this));
 }
 
 Document::Document(Document&& other) noexcept
-: m_root(other.m_root), m_emptyElement(this, "")
+: m_root(other.m_root), m_sharedStrings(move(other.m_sharedStrings)), m_arena(move(other.m_arena)), m_freeElements(other.m_freeElements), m_freeStrings(move(other.m_freeStrings)), m_source(move(other.m_source)), m_emptyElement(this, "")
 {
+    // Elements now belong to this document
+    m_root->setDocument(this);
+
+    other.m_freeElements = nullptr;
     if (m_root->type() == JDT_OBJECT)
-        other.m_root = new Element(this, new ObjectData(this));
+        other.m_root = new (&other) Element(&other, new ObjectData(&other));
     else
-        other.m_root = new Element(this, new ArrayData(this));
+        other.m_root = new (&other) Element(&other, new ArrayData(&other));
 }
 
 Document::~Document()
 {
-    delete m_root;
+    destroyElement(m_root);
 }
 
 void Document::load(const string& json)
 {
-    parse(json);
+    parse(json.c_str(), json.length());
 }
 
 void Document::load(const char* json)
 {
-    string json_str(json);
-    parse(json_str);
+    parse(json, strlen(json));
+}
+
+void Document::load(const char* json, size_t length)
+{
+    parse(json, length);
+}
+
+void Document::load(const Buffer& json)
+{
+    parse(json.data(), json.bytes());
 }
 
 void Document::load(istream& json)
 {
-    stringstream    buffer;
-    string          row;
-    for (;;) {
-        getline(json, row);
-        if (json.eof()) {
-            buffer << row << "\n";
-            break;
-        }
-        if (!json.good())
-            throw Exception("Error reading JSON data from stream");
-        buffer << row << "\n";
-    }
-    load(buffer.str());
+    Buffer buffer;
+    char readBuffer[16384];
+    while (json.read(readBuffer, sizeof(readBuffer)) || json.gcount() > 0)
+        buffer.append(readBuffer, (size_t) json.gcount());
+    if (json.bad())
+        throw Exception("Error reading JSON data from stream");
+    parse(buffer.data(), buffer.bytes());
 }
 
 void Document::exportTo(std::ostream& stream, bool formatted) const
@@ -118,9 +202,13 @@ void Document::exportTo(std::ostream& stream, bool formatted) const
 
 void Document::exportTo(Buffer& buffer, bool formatted) const
 {
-    stringstream stream;
-    m_root->exportTo(stream, formatted);
-    buffer.set(stream.str());
+    m_root->exportTo(buffer, formatted);
+}
+
+void Document::exportMessagePack(Buffer& buffer) const
+{
+    buffer.bytes(0);
+    MessagePack::write(buffer, *m_root);
 }
 
 void Document::exportTo(xml::Document& document, const string& rootNodeName) const
@@ -234,6 +322,57 @@ TEST(SPTK_JsonDocument, remove)
     EXPECT_FALSE(root.find("address"));
 }
 
+TEST(SPTK_JsonDocument, reuseStrings)
+{
+    json::Document document;
+    json::Element& root = document.root();
+    root["status"] = "running";
+    root["counter"] = "value 0";
+
+    size_t allocated = document.allocated();
+    for (int i = 1; i < 1000; i++) {
+        root["status"] = i % 2 ? "stopped" : "running";
+        root["counter"] = "value " + int2string(i);
+        root["status"] = root["counter"];
+    }
+    EXPECT_LT(document.allocated() - allocated, size_t(256));
+    EXPECT_STREQ("value 999", root.getString("status").c_str());
+    EXPECT_STREQ("value 999", root.getString("counter").c_str());
+
+    // Strings, moved from another document, aren't reused
+    json::Document other;
+    other.root()["name"] = "other document";
+    root["status"] = move(other.root()["name"]);
+    root["status"] = "short";
+    EXPECT_STREQ("short", root.getString("status").c_str());
+    EXPECT_TRUE(other.root()["name"].isNull());
+}
+
+TEST(SPTK_JsonDocument, moveFromOtherDocument)
+{
+    json::Document document;
+    {
+        json::Document other;
+        other.load(testJSON);
+        document.root()["name"] = move(other.root()["name"]);
+        document.root()["person"] = move(other.root());
+        EXPECT_TRUE(other.root().isNull());
+    }
+
+    // Moved elements don't refer to memory of destroyed document
+    json::Element& root = document.root();
+    json::Element& person = root["person"];
+    EXPECT_STREQ("John", root.getString("name").c_str());
+    EXPECT_EQ(33, (int) person.getNumber("age"));
+    EXPECT_STREQ("Motorbike", person["skills"][2].getString().c_str());
+    EXPECT_TRUE(person["address"].getBoolean("married"));
+    EXPECT_EQ(&root, person.parent());
+    EXPECT_EQ(&person, person["address"].parent());
+
+    person["address"]["city"] = "Melbourne";
+    EXPECT_STREQ("Melbourne", person["address"].getString("city").c_str());
+}
+
 TEST(SPTK_JsonDocument, save)
 {
     json::Document document;
@@ -246,4 +385,17 @@ TEST(SPTK_JsonDocument, save)
     verifyDocument(document);
 }
 
+TEST(SPTK_JsonDocument, move)
+{
+    json::Document document;
+    document.load(testJSON);
+
+    json::Document movedDocument(move(document));
+    verifyDocument(movedDocument);
+    EXPECT_EQ(size_t(0), document.root().size());
+
+    movedDocument.root()["name"] = "Jane";
+    EXPECT_STREQ("Jane", movedDocument.root().getString("name").c_str());
+}
+
 #endif
@@ -29,97 +29,175 @@
 #include <sptk5/json/JsonElement.h>
 #include <sptk5/json/JsonArrayData.h>
 #include <sptk5/json/JsonDocument.h>
+#include <sptk5/json/JsonWriter.h>
 #include <cstring>
 
 using namespace std;
 using namespace sptk;
 using namespace sptk::json;
 
+constexpr size_t Element::MaxStringLength;
+
 Element::Element(Document* document, double value) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_NUMBER)
+: m_document(document), m_parent(nullptr), m_type(JDT_NUMBER), m_stringLength(0), m_stringOwned(0)
 {
     m_data.m_number = value;
 }
 
 Element::Element(Document* document, int value) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_NUMBER)
+: m_document(document), m_parent(nullptr), m_type(JDT_NUMBER), m_stringLength(0), m_stringOwned(0)
 {
     m_data.m_number = value;
 }
 
 Element::Element(Document* document, int64_t value) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_NUMBER)
+: m_document(document), m_parent(nullptr), m_type(JDT_NUMBER), m_stringLength(0), m_stringOwned(0)
 {
     m_data.m_number = (double) value;
 }
 
-Element::Element(Document* document, const String& value) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_STRING)
+Element::Element(Document* document, const String& value)
+: m_document(document), m_parent(nullptr), m_type(JDT_STRING), m_stringLength(0), m_stringOwned(0)
 {
-    m_data.m_string = m_document->getString(value);
+    setString(value.c_str(), value.length());
 }
 
-Element::Element(Document* document, const char* value) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_STRING)
+Element::Element(Document* document, const char* value)
+: m_document(document), m_parent(nullptr), m_type(JDT_STRING), m_stringLength(0), m_stringOwned(0)
 {
-    m_data.m_string = m_document->getString(value);
+    setString(value, strlen(value));
 }
 
 Element::Element(Document* document, bool value) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_BOOLEAN)
+: m_document(document), m_parent(nullptr), m_type(JDT_BOOLEAN), m_stringLength(0), m_stringOwned(0)
 {
     m_data.m_boolean = value;
 }
 
 Element::Element(Document* document, ArrayData* value) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_ARRAY)
+: m_document(document), m_parent(nullptr), m_type(JDT_ARRAY), m_stringLength(0), m_stringOwned(0)
 {
     m_data.m_array = value;
-    for (Element* jsonElement: *m_data.m_array)
-        jsonElement->m_parent = this;
+    if (m_data.m_array)
+        m_data.m_array->setParent(this);
 }
 
 Element::Element(Document* document, ObjectData* value) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_OBJECT)
+: m_document(document), m_parent(nullptr), m_type(JDT_OBJECT), m_stringLength(0), m_stringOwned(0)
 {
     m_data.m_object = value;
-    for (auto itor: *m_data.m_object)
-        itor.second->m_parent = this;
+    if (m_data.m_object)
+        m_data.m_object->setParent(this);
 }
 
 Element::Element(Document* document) noexcept
-: m_document(document), m_parent(nullptr), m_type(JDT_NULL)
+: m_document(document), m_parent(nullptr), m_type(JDT_NULL), m_stringLength(0), m_stringOwned(0)
 {
     m_data.m_boolean = false;
 }
 
 Element::Element(Document* document, const Element& other)
-: m_document(document), m_parent(nullptr), m_type(JDT_NULL)
+: m_document(document), m_parent(nullptr), m_type(JDT_NULL), m_stringLength(0), m_stringOwned(0)
 {
     assign(other);
 }
 
-void Element::moveElement(Element&& other) noexcept
+void Element::setString(const char* value, size_t length)
 {
+    if (length > MaxStringLength)
+        throw Exception("JSON string value is too long");
+
+    if (m_stringOwned != 0) {
+        if (length <= m_stringLength) {
+            auto str = const_cast<char*>(m_data.m_string);
+            memmove(str, value, length);
+            str[length] = 0;
+            m_stringLength = uint32_t(length);
+            return;
+        }
+        releaseString();
+    }
+
+    m_data.m_string = m_document->storeString(value, length);
+    m_stringLength = uint32_t(length);
+    m_stringOwned = length != 0;
+}
+
+void Element::releaseString() noexcept
+{
+    if (m_stringOwned != 0) {
+        m_document->releaseString(m_data.m_string, m_stringLength);
+        m_stringOwned = 0;
+    }
+}
+
+void Element::moveElement(Element&& other)
+{
+    if (&other == this)
+        return;
+
     clear();
+
+    if (other.m_document != m_document) {
+        switch (other.m_type) {
+            case JDT_STRING:
+                setString(other.m_data.m_string, other.m_stringLength);
+                m_type = JDT_STRING;
+                break;
+
+            case JDT_ARRAY:
+                m_data.m_array = new ArrayData(m_document, this);
+                m_type = JDT_ARRAY;
+                if (other.m_data.m_array) {
+                    for (Element* element: *other.m_data.m_array)
+                        m_data.m_array->add(new (m_document) Element(m_document, move(*element)));
+                }
+                break;
+
+            case JDT_OBJECT:
+                m_data.m_object = new ObjectData(m_document, this);
+                m_type = JDT_OBJECT;
+                if (other.m_data.m_object) {
+                    for (auto& itor: *other.m_data.m_object)
+                        m_data.m_object->add(*itor.first, new (m_document) Element(m_document, move(*itor.second)));
+                }
+                break;
+
+            default:
+                m_type = other.m_type;
+                memcpy(&m_data, &other.m_data, sizeof(m_data));
+                break;
+        }
+        other.clear();
+        return;
+    }
+
     m_type = other.m_type;
-    m_parent = other.m_parent;
+    m_stringLength = other.m_stringLength;
+    m_stringOwned = other.m_stringOwned;
     memcpy(&m_data, &other.m_data, sizeof(m_data));
+    if (m_type == JDT_ARRAY && m_data.m_array)
+        m_data.m_array->setParent(this);
+    else if (m_type == JDT_OBJECT && m_data.m_object)
+        m_data.m_object->setParent(this);
     other.m_type = JDT_NULL;
+    other.m_stringOwned = 0;
 }
 
-Element::Element(Document*document, Element&& other) noexcept
-: m_document(document), m_type(JDT_NULL)
+Element::Element(Document*document, Element&& other)
+: m_document(document), m_parent(nullptr), m_type(JDT_NULL), m_stringLength(0), m_stringOwned(0)
 {
     moveElement(move(other));
 }
 
 void Element::assign(const Element& other)
 {
+    if (other.m_type != JDT_STRING)
+        releaseString();
     m_type = other.m_type;
     switch (m_type) {
         case JDT_STRING:
-            m_data.m_string = new string(*other.m_data.m_string);
+            setString(other.m_data.m_string, other.m_stringLength);
             break;
 
         case JDT_ARRAY:
@@ -138,7 +216,7 @@ Element& Element::operator=(const Element& other)
     return *this;
 }
 
-Element& Element::operator=(Element&& other) noexcept
+Element& Element::operator=(Element&& other)
 {
     moveElement(move(other));
     return *this;
@@ -147,6 +225,10 @@ Element& Element::operator=(Element&& other) noexcept
 void Element::clear()
 {
     switch (m_type) {
+        case JDT_STRING:
+            releaseString();
+            break;
+
         case JDT_ARRAY:
             delete m_data.m_array;
             break;
@@ -166,6 +248,41 @@ Element::~Element()
     clear();
 }
 
+void* Element::operator new(size_t, Document* document)
+{
+    return document->allocateElement();
+}
+
+void Element::operator delete(void* element, Document* document) noexcept
+{
+    document->releaseElement(element);
+}
+
+void Element::setDocument(Document* document)
+{
+    m_document = document;
+    switch (m_type) {
+        case JDT_ARRAY:
+            if (m_data.m_array) {
+                m_data.m_array->m_document = document;
+                for (Element* element: *m_data.m_array)
+                    element->setDocument(document);
+            }
+            break;
+
+        case JDT_OBJECT:
+            if (m_data.m_object) {
+                m_data.m_object->m_document = document;
+                for (auto& itor: *m_data.m_object)
+                    itor.second->setDocument(document);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
 Element* Element::add(Element* element)
 {
     element->m_document = m_document;
@@ -204,7 +321,7 @@ Element* Element::add(const String& name, Element* element)
 
     m_data.m_object->move(name);
     auto* arrayData = new ArrayData(m_document);
-    auto* array = new Element(m_document, arrayData);
+    auto* array = new (m_document) Element(m_document, arrayData);
     array->add(sameNameExistingElement);
     array->add(element);
     add(name, array);
@@ -286,8 +403,8 @@ Element& Element::operator[](size_t index)
     if (!m_data.m_array)
         m_data.m_array = new ArrayData(m_document, this);
 
-    while (index <= m_data.m_array->size())
-        m_data.m_array->add(new Element(m_document, ""));
+    while (index >= m_data.m_array->size())
+        m_data.m_array->add(new (m_document) Element(m_document, ""));
 
     return (*m_data.m_array)[index];
 }
@@ -358,31 +475,35 @@ double Element::getNumber(const String& name) const
 #define INT64_FORMAT "%lld"
 #endif
 
+String Element::formatNumber(double number)
+{
+    long len;
+    char buffer[64];
+    if (number == (int64_t) number)
+        len = snprintf(buffer, sizeof(buffer) - 1, INT64_FORMAT, (long long) number);
+    else {
+        len = snprintf(buffer, sizeof(buffer) - 1, "%1.8f", number);
+        const char* ptr = buffer + len - 1;
+        while (*ptr == '0')
+            ptr--;
+        len = ptr - buffer + 1;
+    }
+    return String(buffer, (size_t) len);
+}
+
 String Element::getString(const String& name) const
 {
     auto& element = getChild(name);
 
     if (element.m_type == JDT_STRING)
-        return *element.m_data.m_string;
+        return String(element.m_data.m_string, (size_t) element.m_stringLength);
 
     switch (element.m_type) {
-        case JDT_NUMBER: {
-            long len;
-            char buffer[64];
-            if (element.m_data.m_number == (int64_t) element.m_data.m_number)
-                len = snprintf(buffer, sizeof(buffer) - 1, INT64_FORMAT, (long long) element.m_data.m_number);
-            else {
-                len = snprintf(buffer, sizeof(buffer) - 1, "%1.8f", element.m_data.m_number);
-                const char* ptr = buffer + len - 1;
-                while (*ptr == '0')
-                    ptr--;
-				len = ptr - buffer + 1;
-            }
-            return String(buffer, (size_t) len);
-        }
+        case JDT_NUMBER:
+            return formatNumber(element.m_data.m_number);
 
         case JDT_STRING:
-            return *element.m_data.m_string;
+            return String(element.m_data.m_string, (size_t) element.m_stringLength);
 
         case JDT_BOOLEAN:
             return element.m_data.m_boolean ? string("true", 4) : string("false", 5);
@@ -394,16 +515,16 @@ String Element::getString(const String& name) const
             break;
     }
 
-    stringstream output;
-    exportValueTo(output, false, 0);
-    return output.str();
+    Buffer output;
+    element.exportTo(output, false);
+    return String(output.c_str(), output.bytes());
 }
 
 bool Element::getBoolean(const String& name) const
 {
     auto& element = getChild(name);
     if (element.m_type == JDT_STRING)
-        return *element.m_data.m_string == "true";
+        return element.m_stringLength == 4 && memcmp(element.m_data.m_string, "true", 4) == 0;
     else if (element.m_type == JDT_BOOLEAN)
         return element.m_data.m_boolean;
     throw Exception("Not a boolean");
@@ -441,79 +562,6 @@ const json::ObjectData& Element::getObject(const String& name) const
     throw Exception("Not an object");
 }
 
-void Element::exportValueTo(ostream& stream, bool formatted, size_t indent) const
-{
-    string indentSpaces, newLineChar, firstElement, betweenElements(",");
-    if (formatted && m_type & (JDT_ARRAY | JDT_OBJECT)) {
-        if (indent)
-            indentSpaces = string(indent, ' ');
-        newLineChar = "\n";
-        firstElement = "\n    " + indentSpaces;
-        betweenElements = ",\n    " + indentSpaces;
-    }
-
-    auto saveFlags = stream.flags();
-
-    switch (m_type) {
-        case JDT_NUMBER:
-            if (m_data.m_number == (long) m_data.m_number)
-                stream << fixed << (long) m_data.m_number;
-            else
-                stream << fixed << m_data.m_number;
-            break;
-
-        case JDT_STRING:
-            stream << "\"" << escape(*m_data.m_string) << "\"";
-            break;
-
-        case JDT_BOOLEAN:
-            stream << (m_data.m_boolean ? "true" : "false");
-            break;
-
-        case JDT_ARRAY:
-            stream << "[";
-            if (m_data.m_array) {
-                bool first = true;
-                for (Element* element: *m_data.m_array) {
-                    if (first) {
-                        first = false;
-                        stream << firstElement;
-                    } else
-                        stream << betweenElements;
-                    element->exportValueTo(stream, formatted, indent + 4);
-                }
-                stream << " ";
-            }
-            stream << "]";
-            break;
-
-        case JDT_OBJECT:
-            stream << "{";
-            if (m_data.m_object) {
-                bool first = true;
-                for (auto& itor: *m_data.m_object) {
-                    if (first) {
-                        first = false;
-                        stream << firstElement;
-                    } else
-                        stream << betweenElements;
-                    stream << "\"" << *itor.first << "\":";
-                    if (formatted)
-                        stream << " ";
-                    itor.second->exportValueTo(stream, formatted, indent + 4);
-                }
-                //stream << " ";
-            }
-            stream << newLineChar << indentSpaces << "}";
-            break;
-
-        case JDT_NULL:
-            stream << "null";
-            break;
-    }
-    stream.flags(saveFlags);
-}
-
 void Element::exportValueTo(const String& name, xml::Element& parentNode) const
 {
     auto node = new xml::Element(parentNode, name);
@@ -546,7 +594,16 @@ void Element::exportValueTo(const String& name, xml::Element& parentNode) const
 
 void Element::exportTo(ostream& stream, bool formatted) const
 {
-    exportValueTo(stream, formatted, 0);
+    Buffer output;
+    exportTo(output, formatted);
+    stream.write(output.c_str(), (streamsize) output.bytes());
+}
+
+void Element::exportTo(Buffer& buffer, bool formatted) const
+{
+    buffer.bytes(0);
+    Writer writer(buffer, formatted);
+    writer.value(*this);
 }
 
 void Element::exportTo(const string& name, xml::Element& parentNode) const
@@ -693,102 +750,151 @@ string Element::decode(const string& text)
     return result;
 }
 
-void Element::appendMatchedElement(ElementSet& elements, const Element::XPathElement& xpathElement, json::Element* element)
-{
-    if (element->type() == JDT_ARRAY) {
-        ArrayData& arrayData = element->getArray();
-        if (!arrayData.empty()) {
-            switch (xpathElement.index) {
-                case 0:
-                    for (auto item: arrayData)
-                        elements.push_back(item);
-                    break;
-                case -1:
-                    elements.push_back(&arrayData[arrayData.size() - 1]);
-                    break;
-                default:
-                    elements.push_back(&arrayData[xpathElement.index - 1]);
-                    break;
+/**
+ * Pass matched element to visitor. If element is array, pass its items selected by index.
+ * @param xpathElement          Current XPath element
+ * @param element               Matched element
+ * @param visitor               Callback for matched elements
+ * @return false if visitor stopped selection
+ */
+template <typename Visitor>
+static bool visitMatchedElement(const Element::XPathElement& xpathElement, Element* element, Visitor& visitor)
+{
+    if (element->type() != JDT_ARRAY)
+        return visitor(*element);
+
+    ArrayData& arrayData = element->getArray();
+    if (arrayData.empty())
+        return true;
+
+    switch (xpathElement.index) {
+        case 0:
+            for (auto item: arrayData) {
+                if (!visitor(*item))
+                    return false;
             }
-        }
+            return true;
+        case -1:
+            return visitor(arrayData[arrayData.size() - 1]);
+        default:
+            if (size_t(xpathElement.index) > arrayData.size())
+                return true;
+            return visitor(arrayData[size_t(xpathElement.index) - 1]);
     }
-    else
-        elements.push_back(element);
 }
 
-void Element::selectElements(ElementSet& elements, const XPath& xpath, size_t xpathPosition, bool rootOnly)
+template <typename Visitor>
+bool Element::selectElements(const XPath& xpath, size_t xpathPosition, bool rootOnly, Visitor& visitor)
 {
     const XPathElement& xpathElement(xpath[xpathPosition]);
-    bool matchAnyElement = xpathElement.name == String("*", 1);
     bool lastPosition = xpath.size() == xpathPosition + 1;
 
     if (m_type == JDT_ARRAY) {
         for (Element* element: *m_data.m_array) {
             // Continue to match children
-            //if (!matchAnyElement)
-            //    xpathPosition = 0; // Start over to match children
-            element->selectElements(elements, xpath, xpathPosition, false);
+            if (!element->selectElements(xpath, xpathPosition, false, visitor))
+                return false;
         }
     } else if (m_type == JDT_OBJECT) {
-        if (!matchAnyElement) {
+        if (!xpathElement.matchAny) {
             Element* element = find(xpathElement.name);
             if (element) {
                 if (lastPosition) {
                     // Full xpath match
-                    appendMatchedElement(elements, xpathElement, element);
+                    if (!visitMatchedElement(xpathElement, element, visitor))
+                        return false;
                 } else {
                     // Continue to match children
-                    element->selectElements(elements, xpath, xpathPosition + 1, false);
+                    if (!element->selectElements(xpath, xpathPosition + 1, false, visitor))
+                        return false;
                 }
             }
         } else {
             for (auto& itor: *m_data.m_object) {
                 if (lastPosition) {
                     // Full xpath match
-                    Element* element = itor.second;
-                    appendMatchedElement(elements, xpathElement, element);
+                    if (!visitMatchedElement(xpathElement, itor.second, visitor))
+                        return false;
                 } else {
                     // Continue to match children
-                    itor.second->selectElements(elements, xpath, xpathPosition + 1, false);
+                    if (!itor.second->selectElements(xpath, xpathPosition + 1, false, visitor))
+                        return false;
                 }
             }
         }
 
         if (!rootOnly) {
             for (auto& itor: *m_data.m_object) {
-                if (itor.second->m_type == JDT_OBJECT || itor.second->m_type == JDT_ARRAY)
-                    itor.second->selectElements(elements, xpath, 0, false);
+                if (itor.second->m_type == JDT_OBJECT || itor.second->m_type == JDT_ARRAY) {
+                    if (!itor.second->selectElements(xpath, 0, false, visitor))
+                        return false;
+                }
             }
         }
     }
+    return true;
+}
+
+void Element::selectElements(ElementSet& elements, const XPath& xpath, size_t xpathPosition, bool rootOnly)
+{
+    auto appendElement = [&elements](Element& element) {
+        elements.push_back(&element);
+        return true;
+    };
+    selectElements(xpath, xpathPosition, rootOnly, appendElement);
 }
 
-Element::XPath::XPath(const sptk::String& _xpath)
+Element::XPath::XPath(const sptk::String& xpath)
 {
-    String xpath(_xpath);
+    size_t position = 0;
     if (xpath[0] == '/') {
-        xpath = xpath.substr(1);
-        if (xpath[0] == '/')
-            xpath = xpath.substr(1);
+        position = 1;
+        if (xpath[1] == '/')
+            position = 2;
         else
             rootOnly = true;
     }
-    Strings pathElements(xpath, "/");
-    RegularExpression parsePathElement(R"(([^\[]+)(\[(\d+|last\(\))\])?)");
-    for (auto& pathElement: pathElements) {
-        Strings matches;
-        if (!parsePathElement.m(pathElement, matches))
-            throw Exception("Unsupported XPath element");
+
+    while (position < xpath.length()) {
+        size_t end = xpath.find('/', position);
+        if (end == string::npos)
+            end = xpath.length();
+        if (end == position) {
+            position++;
+            continue;
+        }
+
+        String pathElement(xpath.substr(position, end - position));
+        position = end + 1;
+
         int index = 0;
-        if (matches.size() > 2)
-            index = matches[2] == "last()" ? -1 : string2int(matches[2]);
-        emplace_back(matches[0], index);
+        size_t bracket = pathElement.find('[');
+        if (bracket != string::npos) {
+            if (bracket == 0 || pathElement.back() != ']')
+                throw Exception("Unsupported XPath element");
+            String indexStr(pathElement.substr(bracket + 1, pathElement.length() - bracket - 2));
+            if (indexStr == "last()")
+                index = -1;
+            else {
+                if (indexStr.empty() || indexStr.length() > 9 || indexStr.find_first_not_of("0123456789") != string::npos)
+                    throw Exception("Unsupported XPath element");
+                index = string2int(indexStr);
+                if (index == 0)
+                    throw Exception("XPath element position starts from 1");
+            }
+            pathElement.resize(bracket);
+        }
+        emplace_back(pathElement, index);
     }
 }
 
 void Element::select(ElementSet& elements, const String& xPath)
 {
-    XPath xpath(xPath);
+    select(elements, XPath(xPath));
+}
+
+void Element::select(ElementSet& elements, const XPath& xpath)
+{
     elements.clear();
     if (xpath.empty()) {
         elements.push_back(this);
@@ -798,6 +904,16 @@ void Element::select(ElementSet& elements, const String& xPath)
     selectElements(elements, xpath, 0, xpath.rootOnly);
 }
 
+void Element::select(const XPath& xpath, const ElementVisitor& visitor)
+{
+    if (xpath.empty()) {
+        visitor(*this);
+        return;
+    }
+
+    selectElements(xpath, 0, xpath.rootOnly, visitor);
+}
+
 size_t Element::size() const
 {
     if (m_type == JDT_OBJECT)
@@ -836,28 +952,28 @@ void Element::optimizeArrays(const std::string& name)
 
 Element* Element::push_array()
 {
-    auto arrayElement = new Element(m_document, new ArrayData(m_document));
+    auto arrayElement = new (m_document) Element(m_document, new ArrayData(m_document));
     add(arrayElement);
     return arrayElement;
 }
 
 Element* Element::set_array(const String& name)
 {
-    auto arrayElement = new Element(m_document, new ArrayData(m_document));
+    auto arrayElement = new (m_document) Element(m_document, new ArrayData(m_document));
     add(name, arrayElement);
     return arrayElement;
 }
 
 Element* Element::push_object()
 {
-    auto objectElement = new Element(m_document, new ObjectData(m_document));
+    auto objectElement = new (m_document) Element(m_document, new ObjectData(m_document));
     add(objectElement);
     return objectElement;
 }
 
 Element* Element::set_object(const String& name)
 {
-    auto objectElement = new Element(m_document, new ObjectData(m_document));
+    auto objectElement = new (m_document) Element(m_document, new ObjectData(m_document));
     add(name, objectElement);
     return objectElement;
 }
@@ -937,4 +1053,52 @@ TEST(SPTK_JsonElement, select4)
     EXPECT_STREQ("4", elementSet[0]->getString().c_str());
 }
 
+TEST(SPTK_JsonElement, selectCompiled)
+{
+    const json::Element::XPath xpath("//DDD/BBB");
+    json::Element::XPath outOfRange("/AAA/BBB[5]");
+
+    for (auto* text: {&testJSON2, &testJSON3}) {
+        json::Document document;
+        document.load(*text);
+
+        json::ElementSet elementSet;
+        document.root().select(elementSet, xpath);
+
+        size_t visited = 0;
+        document.root().select(xpath, [&visited](json::Element&) {
+            visited++;
+            return true;
+        });
+        EXPECT_EQ(elementSet.size(), visited);
+
+        // Stop after the first match
+        visited = 0;
+        document.root().select(xpath, [&visited](json::Element&) {
+            visited++;
+            return false;
+        });
+        EXPECT_EQ(size_t(1), visited);
+    }
+
+    json::Document document;
+    document.load(testJSON4);
+    json::ElementSet elementSet;
+    document.root().select(elementSet, outOfRange);
+    EXPECT_EQ(size_t(0), elementSet.size());
+
+    EXPECT_THROW(json::Element::XPath("/AAA/BBB[x]"), Exception);
+    EXPECT_THROW(json::Element::XPath("/AAA/BBB[0]"), Exception);
+    EXPECT_THROW(json::Element::XPath("/AAA/BBB[99999999999]"), Exception);
+
+    // Position selects the array item, starting from 1
+    document.root().select(elementSet, json::Element::XPath("/AAA/BBB[1]"));
+    ASSERT_EQ(size_t(1), elementSet.size());
+    EXPECT_STREQ("1", elementSet[0]->getString().c_str());
+
+    document.root().selectElements(elementSet, json::Element::XPath("/AAA/BBB[last()]"), 0, true);
+    ASSERT_EQ(size_t(2), elementSet.size());
+    EXPECT_STREQ("4", elementSet[1]->getString().c_str());
+}
+
 #endif
@@ -0,0 +1,461 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       JsonMessagePack.cpp - description                      ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/json/JsonMessagePack.h>
+#include <sptk5/json/JsonDocument.h>
+#include <cmath>
+
+using namespace std;
+using namespace sptk;
+using namespace sptk::json;
+
+const char* const MessagePack::ContentType = "application/msgpack";
+
+namespace sptk { namespace json {
+
+/**
+ * MessagePack data reader.
+ *
+ * Reads MessagePack data within the data boundaries.
+ */
+class MessagePackReader
+{
+    Document*       m_document;
+    const char*     m_data;         ///< Start of data
+    const char*     m_end;          ///< End of data
+    const char*     m_pos;          ///< Current read position
+    bool            m_copyStrings;  ///< If true then string values are copied into the document
+
+public:
+    MessagePackReader(Document* document, const char* data, size_t length, bool copyStrings)
+    : m_document(document), m_data(data), m_end(data + length), m_pos(data), m_copyStrings(copyStrings)
+    {}
+
+    [[noreturn]] void throwError(const String& message) const
+    {
+        throw Exception(message + ", in MessagePack data position " + int2string(uint64_t(m_pos - m_data)));
+    }
+
+    const char* take(size_t size)
+    {
+        if (size_t(m_end - m_pos) < size)
+            throwError("Premature end of data");
+        const char* data = m_pos;
+        m_pos += size;
+        return data;
+    }
+
+    uint64_t readUnsigned(size_t size)
+    {
+        auto* data = (const uint8_t*) take(size);
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; i++)
+            value = (value << 8) | data[i];
+        return value;
+    }
+
+    int64_t readSigned(size_t size)
+    {
+        uint64_t value = readUnsigned(size);
+        unsigned shift = unsigned(64 - size * 8);
+        return int64_t(value << shift) >> shift;
+    }
+
+    double readFloat()
+    {
+        auto bits = (uint32_t) readUnsigned(4);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double readDouble()
+    {
+        uint64_t bits = readUnsigned(8);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void readString(Element& element, size_t length)
+    {
+        if (length > Element::MaxStringLength)
+            throwError("String value is too long");
+        const char* str = take(length);
+        element.m_type = JDT_STRING;
+        if (m_copyStrings)
+            element.setString(str, length);
+        else {
+            element.m_data.m_string = str;
+            element.m_stringLength = uint32_t(length);
+        }
+    }
+
+    void readArray(Element& element, size_t size);
+
+    void readMap(Element& element, size_t size);
+
+    void readElement(Element& element);
+
+    void readRoot(Element& root);
+};
+
+void MessagePackReader::readArray(Element& element, size_t size)
+{
+    element.m_type = JDT_ARRAY;
+    element.m_data.m_array = new ArrayData(m_document, &element);
+    for (size_t i = 0; i < size; i++) {
+        auto* child = new (m_document) Element(m_document);
+        try {
+            readElement(*child);
+        }
+        catch (...) {
+            m_document->destroyElement(child);
+            throw;
+        }
+        element.add(child);
+    }
+}
+
+void MessagePackReader::readMap(Element& element, size_t size)
+{
+    element.m_type = JDT_OBJECT;
+    element.m_data.m_object = new ObjectData(m_document, &element);
+    String elementName; // Reused for all the elements of this object
+    for (size_t i = 0; i < size; i++) {
+        auto type = (uint8_t) *take(1);
+        size_t length;
+        if ((type & 0xE0) == 0xA0)
+            length = type & 0x1F;
+        else if (type == 0xD9)
+            length = readUnsigned(1);
+        else if (type == 0xDA)
+            length = readUnsigned(2);
+        else if (type == 0xDB)
+            length = readUnsigned(4);
+        else
+            throwError("Map key is not a string");
+        elementName.assign(take(length), length);
+
+        auto* child = new (m_document) Element(m_document);
+        try {
+            readElement(*child);
+        }
+        catch (...) {
+            m_document->destroyElement(child);
+            throw;
+        }
+        element.add(elementName, child);
+    }
+}
+
+void MessagePackReader::readElement(Element& element)
+{
+    auto type = (uint8_t) *take(1);
+
+    if (type <= 0x7F) {
+        element.m_type = JDT_NUMBER;
+        element.m_data.m_number = type;
+        return;
+    }
+    if (type >= 0xE0) {
+        element.m_type = JDT_NUMBER;
+        element.m_data.m_number = int8_t(type);
+        return;
+    }
+
+    switch (type & 0xF0) {
+        case 0x80:
+            readMap(element, type & 0x0F);
+            return;
+        case 0x90:
+            readArray(element, type & 0x0F);
+            return;
+        case 0xA0:
+        case 0xB0:
+            readString(element, type & 0x1F);
+            return;
+        default:
+            break;
+    }
+
+    switch (type) {
+        case 0xC0:
+            element.m_type = JDT_NULL;
+            break;
+        case 0xC2:
+        case 0xC3:
+            element.m_type = JDT_BOOLEAN;
+            element.m_data.m_boolean = type == 0xC3;
+            break;
+        case 0xC4: // bin 8
+        case 0xD9: // str 8
+            readString(element, readUnsigned(1));
+            break;
+        case 0xC5: // bin 16
+        case 0xDA: // str 16
+            readString(element, readUnsigned(2));
+            break;
+        case 0xC6: // bin 32
+        case 0xDB: // str 32
+            readString(element, readUnsigned(4));
+            break;
+        case 0xCA:
+            element.m_type = JDT_NUMBER;
+            element.m_data.m_number = readFloat();
+            break;
+        case 0xCB:
+            element.m_type = JDT_NUMBER;
+            element.m_data.m_number = readDouble();
+            break;
+        case 0xCC:
+        case 0xCD:
+        case 0xCE:
+        case 0xCF:
+            element.m_type = JDT_NUMBER;
+            element.m_data.m_number = double(readUnsigned(size_t(1) << (type - 0xCC)));
+            break;
+        case 0xD0:
+        case 0xD1:
+        case 0xD2:
+        case 0xD3:
+            element.m_type = JDT_NUMBER;
+            element.m_data.m_number = double(readSigned(size_t(1) << (type - 0xD0)));
+            break;
+        case 0xDC:
+            readArray(element, readUnsigned(2));
+            break;
+        case 0xDD:
+            readArray(element, readUnsigned(4));
+            break;
+        case 0xDE:
+            readMap(element, readUnsigned(2));
+            break;
+        case 0xDF:
+            readMap(element, readUnsigned(4));
+            break;
+        default:
+            m_pos--;
+            throwError("Unsupported MessagePack type");
+    }
+}
+
+void MessagePackReader::readRoot(Element& root)
+{
+    if (root.m_type != JDT_NULL)
+        throw Exception("Can't execute on non-null JSON element");
+    readElement(root);
+    if (m_pos != m_end)
+        throwError("Unexpected data after the end of MessagePack value");
+}
+
+}}
+
+static void appendUnsigned(Buffer& output, uint8_t type, uint64_t value, size_t size)
+{
+    uint8_t data[9];
+    data[0] = type;
+    for (size_t i = size; i > 0; i--) {
+        data[i] = uint8_t(value);
+        value >>= 8;
+    }
+    output.append((const char*) data, size + 1);
+}
+
+static void appendLength(Buffer& output, size_t length, uint8_t fixType, size_t fixMaxLength, uint8_t type8, uint8_t type16)
+{
+    if (length <= fixMaxLength)
+        output.append(char(fixType | length));
+    else if (length <= UINT8_MAX && type8 != 0)
+        appendUnsigned(output, type8, length, 1);
+    else if (length <= UINT16_MAX)
+        appendUnsigned(output, type16, length, 2);
+    else if (length <= UINT32_MAX)
+        appendUnsigned(output, uint8_t(type16 + 1), length, 4);
+    else
+        throw Exception("Value is too large for MessagePack");
+}
+
+static void appendString(Buffer& output, const char* str, size_t length)
+{
+    appendLength(output, length, 0xA0, 31, 0xD9, 0xDA);
+    output.append(str, length);
+}
+
+static void appendNumber(Buffer& output, double number)
+{
+    if (number >= -9.2E18 && number <= 1.8E19 && number == trunc(number)) {
+        if (number >= 0) {
+            auto value = uint64_t(number);
+            if (value <= 0x7F)
+                output.append(char(value));
+            else if (value <= UINT8_MAX)
+                appendUnsigned(output, 0xCC, value, 1);
+            else if (value <= UINT16_MAX)
+                appendUnsigned(output, 0xCD, value, 2);
+            else if (value <= UINT32_MAX)
+                appendUnsigned(output, 0xCE, value, 4);
+            else
+                appendUnsigned(output, 0xCF, value, 8);
+        } else {
+            auto value = int64_t(number);
+            if (value >= -32)
+                output.append(char(value));
+            else if (value >= INT8_MIN)
+                appendUnsigned(output, 0xD0, uint64_t(value), 1);
+            else if (value >= INT16_MIN)
+                appendUnsigned(output, 0xD1, uint64_t(value), 2);
+            else if (value >= INT32_MIN)
+                appendUnsigned(output, 0xD2, uint64_t(value), 4);
+            else
+                appendUnsigned(output, 0xD3, uint64_t(value), 8);
+        }
+        return;
+    }
+
+    auto singlePrecision = float(number);
+    if (double(singlePrecision) == number) {
+        uint32_t bits;
+        memcpy(&bits, &singlePrecision, sizeof(bits));
+        appendUnsigned(output, 0xCA, bits, 4);
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        appendUnsigned(output, 0xCB, bits, 8);
+    }
+}
+
+void MessagePack::write(Buffer& output, const Element& element)
+{
+    switch (element.m_type) {
+        case JDT_NUMBER:
+            appendNumber(output, element.m_data.m_number);
+            break;
+
+        case JDT_STRING:
+            appendString(output, element.m_data.m_string, element.m_stringLength);
+            break;
+
+        case JDT_BOOLEAN:
+            output.append(char(element.m_data.m_boolean ? 0xC3 : 0xC2));
+            break;
+
+        case JDT_ARRAY:
+            if (element.m_data.m_array == nullptr) {
+                output.append(char(0x90));
+                break;
+            }
+            appendLength(output, element.m_data.m_array->size(), 0x90, 15, 0, 0xDC);
+            for (const Element* item: *element.m_data.m_array)
+                write(output, *item);
+            break;
+
+        case JDT_OBJECT:
+            if (element.m_data.m_object == nullptr) {
+                output.append(char(0x80));
+                break;
+            }
+            appendLength(output, element.m_data.m_object->size(), 0x80, 15, 0, 0xDE);
+            for (auto& itor: *element.m_data.m_object) {
+                appendString(output, itor.first->c_str(), itor.first->length());
+                write(output, *itor.second);
+            }
+            break;
+
+        case JDT_NULL:
+            output.append(char(0xC0));
+            break;
+    }
+}
+
+void MessagePack::read(Element& element, const char* data, size_t length, bool copyStrings)
+{
+    MessagePackReader reader(element.getDocument(), data, length, copyStrings);
+    reader.readRoot(element);
+}
+
+bool MessagePack::isContentType(const String& contentType)
+{
+    String type = contentType.toLowerCase();
+    return type.startsWith("application/msgpack") || type.startsWith("application/x-msgpack");
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+static const char* testJSON =
+    R"({"name":"John","age":33,"temperature":33.6,"timestamp":1519005758000,"offset":-1000000,)"
+    R"("skills":["C++","Java","Motorbike"],"married":false,"nothing":null,"small":-5,"ratio":0.5,)"
+    R"("description":"A long text that doesn't fit into the fixed length MessagePack string",)"
+    R"("address":{"married":true,"employed":false}})";
+
+TEST(SPTK_JsonMessagePack, roundTrip)
+{
+    json::Document document;
+    document.load(testJSON);
+
+    Buffer encoded;
+    document.exportMessagePack(encoded);
+
+    Buffer jsonText;
+    document.exportTo(jsonText, false);
+    EXPECT_LT(encoded.bytes(), jsonText.bytes());
+
+    json::Document copied;
+    copied.loadMessagePack(encoded);
+    Buffer copiedText;
+    copied.exportTo(copiedText, false);
+    EXPECT_STREQ(jsonText.c_str(), copiedText.c_str());
+
+    // Zero-copy decoding: string values reference encoded data, owned by the document
+    json::Document referenced;
+    referenced.loadMessagePack(move(encoded));
+    Buffer referencedText;
+    referenced.exportTo(referencedText, false);
+    EXPECT_STREQ(jsonText.c_str(), referencedText.c_str());
+    EXPECT_STREQ("John", referenced.root().getString("name").c_str());
+}
+
+TEST(SPTK_JsonMessagePack, encoding)
+{
+    json::Document document(false);
+    document.root().push_back(1);
+    document.root().push_back(-1);
+    document.root().push_back(256);
+    document.root().push_back("abc");
+    document.root().push_back(true);
+
+    Buffer encoded;
+    document.exportMessagePack(encoded);
+    EXPECT_EQ(string("\x95\x01\xFF\xCD\x01\x00\xA3" "abc\xC3", 11), string(encoded.c_str(), encoded.bytes()));
+
+    EXPECT_THROW(document.loadMessagePack(encoded.c_str(), encoded.bytes() - 1), Exception);
+    EXPECT_THROW(document.loadMessagePack("\xC7\x01\x01\x00", 4), Exception);
+}
+
+#endif
@@ -42,7 +42,7 @@ ObjectData::ObjectData(Document* document, Element* parent)
 ObjectData::~ObjectData()
 {
     for (auto& itor: m_items)
-        delete itor.second;
+        m_document->destroyElement(itor.second);
 }
 
 void ObjectData::setParent(Element* parent)
@@ -54,71 +54,172 @@ void ObjectData::setParent(Element* parent)
     }
 }
 
+size_t ObjectData::findPosition(const string* sharedName) const
+{
+    if (m_index) {
+        auto itor = m_index->find(sharedName);
+        return itor == m_index->end() ? m_items.size() : itor->second;
+    }
+
+    // Names are shared, so comparing pointers is enough
+    size_t position = 0;
+    for (auto& item: m_items) {
+        if (item.first == sharedName)
+            break;
+        position++;
+    }
+    return position;
+}
+
+size_t ObjectData::findPosition(const string& name) const
+{
+    // If the name isn't shared yet, there is no element with such name
+    const string* sharedName = m_document->findString(name);
+    if (sharedName == nullptr)
+        return m_items.size();
+    return findPosition(sharedName);
+}
+
+void ObjectData::buildIndex()
+{
+    if (m_items.size() <= IndexThreshold) {
+        m_index.reset();
+        return;
+    }
+    if (!m_index)
+        m_index = make_unique<unordered_map<const string*, size_t>>();
+    else
+        m_index->clear();
+    m_index->reserve(m_items.size() * 2);
+    for (size_t position = 0; position < m_items.size(); position++)
+        (*m_index)[m_items[position].first] = position;
+}
+
+void ObjectData::erase(size_t position)
+{
+    const string* sharedName = m_items[position].first;
+    m_items.erase(m_items.begin() + position);
+
+    if (!m_index)
+        return;
+
+    if (m_items.size() <= IndexThreshold) {
+        m_index.reset();
+        return;
+    }
+
+    // Only the elements after removed one change their positions
+    m_index->erase(sharedName);
+    for (size_t i = position; i < m_items.size(); i++)
+        (*m_index)[m_items[i].first] = i;
+}
+
 void ObjectData::add(const string& name, Element* element)
 {
     element->m_parent = m_parent;
     const string* sharedName = m_document->getString(name);
-    auto itor = m_items.find(sharedName);
-    if (itor != m_items.end())
+    if (findPosition(sharedName) != m_items.size())
         throw Exception("Element " + name + " conflicts with same name object");
-    m_items[sharedName] = element;
+    m_items.emplace_back(sharedName, element);
+    if (m_index)
+        (*m_index)[sharedName] = m_items.size() - 1;
+    else if (m_items.size() > IndexThreshold)
+        buildIndex();
 }
 
 Element* ObjectData::find(const string& name)
 {
-    const string* sharedName = m_document->getString(name);
-    auto itor = m_items.find(sharedName);
-    if (itor == m_items.end())
+    size_t position = findPosition(name);
+    if (position == m_items.size())
         return nullptr;
-    return itor->second;
+    return m_items[position].second;
 }
 
 Element& ObjectData::operator[](const string& name)
 {
-    const string* sharedName = m_document->getString(name);
-    auto itor = m_items.find(sharedName);
-    Element* element;
-    if (itor == m_items.end()) {
-        element = new Element(m_document);
-        element->m_parent = m_parent;
-        m_items[sharedName] = element;
-    } else
-        element = itor->second;
-
+    Element* element = find(name);
+    if (element == nullptr) {
+        element = new (m_document) Element(m_document);
+        add(name, element);
+    }
     return *element;
 }
 
 const Element* ObjectData::find(const string& name) const
 {
-    const string* sharedName = m_document->getString(name);
-    auto itor = m_items.find(sharedName);
-    if (itor == m_items.end())
-        throw Exception("Element name isn't found");
-    return itor->second;
+    size_t position = findPosition(name);
+    if (position == m_items.size())
+        return nullptr;
+    return m_items[position].second;
 }
 
 const Element& ObjectData::operator[](const string& name) const
 {
-    return *find(name);
+    const Element* element = find(name);
+    if (element == nullptr)
+        throw Exception("Element name isn't found");
+    return *element;
 }
 
 void ObjectData::remove(const string& name)
 {
-    const string* sharedName = m_document->getString(name);
-    auto itor = m_items.find(sharedName);
-    if (itor == m_items.end())
+    size_t position = findPosition(name);
+    if (position == m_items.size())
         return;
-    delete itor->second;
-    m_items.erase(itor);
+    m_document->destroyElement(m_items[position].second);
+    erase(position);
 }
 
 Element* ObjectData::move(const string& name)
 {
-    const string* sharedName = m_document->getString(name);
-    auto itor = m_items.find(sharedName);
-    if (itor == m_items.end())
+    size_t position = findPosition(name);
+    if (position == m_items.size())
         return nullptr;
-    Element* data = itor->second;
-    m_items.erase(itor);
+    Element* data = m_items[position].second;
+    erase(position);
     return data;
 }
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_JsonObjectData, index)
+{
+    json::Document document;
+    json::Element& root = document.root();
+
+    // Object grows from flat lookup to indexed lookup
+    for (int i = 0; i < 40; i++) {
+        root["field" + int2string(i)] = i;
+        EXPECT_DOUBLE_EQ(i, root.getNumber("field" + int2string(i)));
+    }
+    EXPECT_EQ(size_t(40), root.size());
+    EXPECT_EQ(nullptr, root.find("unknown"));
+
+    // Elements are kept in insertion order
+    int expected = 0;
+    for (auto& item: root.getObject())
+        EXPECT_STREQ(("field" + int2string(expected++)).c_str(), item.first->c_str());
+
+    for (int i = 0; i < 40; i += 2)
+        root.remove("field" + int2string(i));
+    EXPECT_EQ(size_t(20), root.size());
+    for (int i = 0; i < 40; i++)
+        EXPECT_EQ(i % 2 == 1, root.find("field" + int2string(i)) != nullptr);
+
+    // Removing from the middle keeps the index consistent
+    root.remove("field21");
+    EXPECT_EQ(size_t(19), root.size());
+    EXPECT_EQ(nullptr, root.find("field21"));
+    for (int i = 23; i < 40; i += 2)
+        EXPECT_DOUBLE_EQ(i, root.getNumber("field" + int2string(i)));
+    root["field21"] = 21;
+    EXPECT_DOUBLE_EQ(21, root.getNumber("field21"));
+
+    const json::Element& constRoot = root;
+    EXPECT_EQ(nullptr, constRoot.find("field0"));
+    EXPECT_TRUE(constRoot["field0"].getString().empty());
+    EXPECT_DOUBLE_EQ(39, constRoot["field39"].getNumber());
+}
+
+#endif
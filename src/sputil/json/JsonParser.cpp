@@ -27,333 +27,898 @@
 */
 
 #include <sptk5/json/JsonParser.h>
+#include <sptk5/json/JsonDocument.h>
+#include <sptk5/net/BaseSocket.h>
 
 using namespace std;
 using namespace sptk;
 using namespace sptk::json;
 
-namespace sptk {
-    namespace json {
-        void skipSpaces(const char* json, const char*& readPosition);
-        string readJsonString(const char* json, const char*& readPosition);
-        string readJsonName(const char* json, const char*& readPosition);
-        void readJsonNull(const char* json, const char*& readPosition);
-        bool readJsonBoolean(const char* json, const char*& readPosition);
-        double readJsonNumber(const char* json, const char*& readPosition);
-        void readArrayData(Element* parent, const char* json, const char*& readPosition);
-        void readObjectData(Element* parent, const char* json, const char*& readPosition);
+#define ERROR_CONTEXT_CHARS 65
+
+namespace sptk { namespace json {
+
+/**
+ * JSON text reader.
+ *
+ * Reads JSON text in place, within the text boundaries.
+ * Element names are shared by the document, and string values are stored in the document.
+ */
+class JsonReader
+{
+    Document*       m_document;
+    const char*     m_json;         ///< Start of JSON text
+    const char*     m_end;          ///< End of JSON text
+    const char*     m_pos;          ///< Current read position
+    std::string     m_decoded;      ///< Decoded text of the current string with escape sequences
+
+public:
+    JsonReader(Document* document, const char* json, size_t length)
+    : m_document(document), m_json(json), m_end(json + length), m_pos(json)
+    {}
+
+    [[noreturn]] void throwError(const string& message, const char* position) const;
+
+    [[noreturn]] void throwUnexpectedCharacterError(char expected) const;
+
+    void skipSpaces()
+    {
+        while (m_pos < m_end && (unsigned char) *m_pos <= 32)
+            m_pos++;
+        if (m_pos == m_end)
+            throwError("Premature end of data", m_pos);
     }
-}
 
-#define ERROR_CONTEXT_CHARS 65
+    void readString(const char*& str, size_t& length);
+
+    void readEscapedString(const char* start);
+
+    double readNumber();
+
+    bool readBoolean();
+
+    void readNull();
+
+    Element* readValue();
+
+    void readArrayData(Element* parent);
+
+    void readObjectData(Element* parent);
 
-void throwError(const string& message, const char* json, size_t position)
+    void readRoot(Element& root);
+};
+
+void JsonReader::throwError(const string& message, const char* position) const
 {
     stringstream error;
     error << message;
-    if (position > 0) {
-        error << ", in position " << position;
-        char context[ERROR_CONTEXT_CHARS];
-        const char* contextStart = json + position - ERROR_CONTEXT_CHARS / 2;
-        if (contextStart < json)
-            contextStart = json;
-        size_t pretextLen = json + position - contextStart;
-        strncpy(context, contextStart, pretextLen);
-        context[pretextLen] = 0;
-        error << " in context: '" << context << ">" << json[position] << "<";
-        strncpy(context, json + position + 1, ERROR_CONTEXT_CHARS / 2);
-        error << context << "'";
+    auto offset = size_t(position - m_json);
+    if (offset > 0) {
+        const char* contextStart = position - ERROR_CONTEXT_CHARS / 2;
+        if (contextStart < m_json)
+            contextStart = m_json;
+        if (position < m_end) {
+            const char* contextEnd = position + 1 + ERROR_CONTEXT_CHARS / 2;
+            if (contextEnd > m_end)
+                contextEnd = m_end;
+            error << ", in position " << offset << " in context: '" << string(contextStart, position)
+                  << ">" << *position << "<" << string(position + 1, contextEnd) << "'";
+        } else
+            error << ", after position " << offset;
     }
-    else if ((int)position < 0)
-        error << ", after position " << -int(position);
     throw Exception(error.str());
 }
 
-void throwUnexpectedCharacterError(char character, char expected, const char* json, size_t position)
+void JsonReader::throwUnexpectedCharacterError(char expected) const
 {
     stringstream msg;
-    msg << "Unexpected character '" << character << "'";
+    msg << "Unexpected character '" << *m_pos << "'";
     if (expected != 0)
         msg << " while expected '" << expected << "'";
-    throwError(msg.str(), json, position);
+    throwError(msg.str(), m_pos);
 }
 
-void Parser::parse(Element& jsonElement, const string& jsonStr)
+static void appendUTF8(std::string& output, unsigned cp)
 {
-    const char* json = jsonStr.c_str();
-    const char* pos = json;
-    skipSpaces(json, pos);
-
-    if (jsonElement.m_type != JDT_NULL)
-        throwError("Can't execute on non-null JSON element", json, 0);
-
-    switch (*pos) {
-        case '{':
-            jsonElement.m_type = JDT_OBJECT;
-            jsonElement.m_data.m_object = new ObjectData(jsonElement.getDocument(), &jsonElement);
-            readObjectData(&jsonElement, json, pos);
-            break;
-        case '[':
-            jsonElement.m_type = JDT_ARRAY;
-            jsonElement.m_data.m_array = new ArrayData(jsonElement.getDocument(), &jsonElement);
-            readArrayData(&jsonElement, json, pos);
-            break;
-        default:
-            throwUnexpectedCharacterError(*pos, 0, json, pos - json);
-            break;
+    // based on description from http://en.wikipedia.org/wiki/UTF-8
+    if (cp <= 0x7F)
+        output += char(cp);
+    else if (cp <= 0x7FF) {
+        output += char(0xC0 | (cp >> 6));
+        output += char(0x80 | (cp & 0x3F));
+    } else if (cp <= 0xFFFF) {
+        output += char(0xE0 | (cp >> 12));
+        output += char(0x80 | ((cp >> 6) & 0x3F));
+        output += char(0x80 | (cp & 0x3F));
+    } else if (cp <= 0x10FFFF) {
+        output += char(0xF0 | (cp >> 18));
+        output += char(0x80 | ((cp >> 12) & 0x3F));
+        output += char(0x80 | ((cp >> 6) & 0x3F));
+        output += char(0x80 | (cp & 0x3F));
     }
 }
 
-namespace sptk { namespace json {
-
-inline void skipSpaces(const char* json, const char*& readPosition)
+void JsonReader::readString(const char*& str, size_t& length)
 {
-    while ((unsigned char) *readPosition <= 32) {
-        if (*readPosition == 0)
-            throwError("Premature end of data", json, readPosition - json);
-        readPosition++;
+    // Fast path: string without escape sequences is used directly from JSON text
+    const char* start = m_pos + 1;
+    const char* pos = start;
+    while (pos < m_end && *pos != '"' && *pos != '\\')
+        pos++;
+
+    if (pos == m_end)
+        throwError("Premature end of data, expecting '\"'", m_pos);
+
+    if (*pos == '"') {
+        str = start;
+        length = size_t(pos - start);
+        m_pos = pos + 1;
+    } else {
+        m_decoded.assign(start, pos);
+        m_pos = pos;
+        readEscapedString(start);
+        str = m_decoded.c_str();
+        length = m_decoded.length();
     }
+
+    skipSpaces();
 }
 
-string readJsonString(const char* json, const char*& readPosition)
+void JsonReader::readEscapedString(const char* start)
 {
-    const char* pos = readPosition + 1;
-    while (true) {
-        pos = strpbrk(pos, "\\\"");
-        if (pos == nullptr)
-            throwError("Premature end of data, expecting '\"'", json, readPosition - json);
-        else {
-            char ch = *pos;
-            if (ch == '"')
+    while (m_pos < m_end) {
+        char ch = *m_pos;
+        if (ch == '"') {
+            m_pos++;
+            return;
+        }
+        if (ch != '\\') {
+            m_decoded += ch;
+            m_pos++;
+            continue;
+        }
+        if (++m_pos == m_end)
+            break;
+        switch (*m_pos) {
+            case '"':  m_decoded += '"'; break;
+            case '\\': m_decoded += '\\'; break;
+            case '/':  m_decoded += '/'; break;
+            case 'b':  m_decoded += '\b'; break;
+            case 'f':  m_decoded += '\f'; break;
+            case 'n':  m_decoded += '\n'; break;
+            case 'r':  m_decoded += '\r'; break;
+            case 't':  m_decoded += '\t'; break;
+            case 'u': {
+                if (m_end - m_pos < 5)
+                    throwError("Premature end of data, expecting Unicode character code", m_pos);
+                char ucharCodeStr[5] = {};
+                memcpy(ucharCodeStr, m_pos + 1, 4);
+                char* codeEnd;
+                auto ucharCode = (unsigned) strtoul(ucharCodeStr, &codeEnd, 16);
+                if (codeEnd != ucharCodeStr + 4)
+                    throwError("Invalid Unicode character code", m_pos);
+                m_pos += 4;
+                // Surrogate pair
+                if (ucharCode >= 0xD800 && ucharCode <= 0xDBFF && m_end - m_pos >= 7 && m_pos[1] == '\\' && m_pos[2] == 'u') {
+                    memcpy(ucharCodeStr, m_pos + 3, 4);
+                    auto lowSurrogate = (unsigned) strtoul(ucharCodeStr, &codeEnd, 16);
+                    if (codeEnd == ucharCodeStr + 4 && lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) {
+                        ucharCode = 0x10000 + ((ucharCode - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                        m_pos += 6;
+                    }
+                }
+                appendUTF8(m_decoded, ucharCode);
                 break;
-            if (ch == '\\')
-                pos++;
-            pos++;
+            }
+            default:
+                throwError("Unknown escape character", m_pos);
         }
+        m_pos++;
     }
-    string str = Element::decode(string(readPosition + 1, pos - readPosition - 1));
-
-    readPosition = pos + 1;
-
-    skipSpaces(json, readPosition);
-
-    return str;
+    throwError("Premature end of data, expecting '\"'", start - 1);
 }
 
-string readJsonName(const char* json, const char*& readPosition)
+double JsonReader::readNumber()
 {
-    if (*readPosition != '"')
-        throwUnexpectedCharacterError(*readPosition, '"', json, readPosition - json);
-    string name = readJsonString(json, readPosition);
-    if (*readPosition != ':')
-        throwUnexpectedCharacterError(*readPosition, ':', json, readPosition - json);
-    readPosition++;
-    skipSpaces(json, readPosition);
-    return name;
-}
+    const char* start = m_pos;
+    const char* pos = start;
+    bool negative = *pos == '-';
+    if (negative)
+        pos++;
+
+    // Fast path: integer that fits into double mantissa
+    int64_t integer = 0;
+    const char* digitsStart = pos;
+    while (pos < m_end && isdigit((unsigned char) *pos) && pos - digitsStart < 15) {
+        integer = integer * 10 + (*pos - '0');
+        pos++;
+    }
+    if (pos > digitsStart && (pos == m_end || !strchr("0123456789.eE", *pos))) {
+        m_pos = pos;
+        skipSpaces();
+        return negative ? -double(integer) : double(integer);
+    }
 
-double readJsonNumber(const char* json, const char*& readPosition)
-{
-    char* pos;
+    // Generic number: strtod() needs zero-terminated text
+    while (pos < m_end && strchr("0123456789+-.eE", *pos) != nullptr)
+        pos++;
+    char number[64];
+    auto length = size_t(pos - start);
+    if (length >= sizeof(number))
+        throwError("Invalid value", start);
+    memcpy(number, start, length);
+    number[length] = 0;
+
+    char* numberEnd;
     errno = 0;
-    double value = strtod(readPosition, &pos);
-    if (errno != 0)
-        throwError("Invalid value", json, readPosition - json);
-    readPosition = pos;
-    skipSpaces(json, readPosition);
+    double value = strtod(number, &numberEnd);
+    if (errno != 0 || numberEnd != number + length)
+        throwError("Invalid value", start);
+
+    m_pos = pos;
+    skipSpaces();
     return value;
 }
 
-bool readJsonBoolean(const char* json, const char*& readPosition)
+bool JsonReader::readBoolean()
 {
-    const char* pos = strchr(readPosition + 1, 'e');
-    if (pos == nullptr)
-        throwError("Premature end of data, expecting boolean value", json, readPosition - json);
-    pos++;
     bool result = false;
-    if (strncmp(readPosition, "true", 4) == 0)
+    size_t available = size_t(m_end - m_pos);
+    if (available >= 4 && memcmp(m_pos, "true", 4) == 0) {
         result = true;
-    else if (strncmp(readPosition, "false", 4) == 0)
-        result = false;
+        m_pos += 4;
+    } else if (available >= 5 && memcmp(m_pos, "false", 5) == 0)
+        m_pos += 5;
     else
-        throwError("Unexpected value, expecting boolean", json, readPosition - json);
-    readPosition = pos;
-    skipSpaces(json, readPosition);
+        throwError("Unexpected value, expecting boolean", m_pos);
+    skipSpaces();
     return result;
 }
 
-void readJsonNull(const char* json, const char*& readPosition)
+void JsonReader::readNull()
 {
-    if (strncmp(readPosition, "null", 4) != 0)
-        throwError("Unexpected value, expecting 'null'", json, readPosition - json);
-    readPosition += 4;
-    if (*readPosition == ',')
-        readPosition++;
-    skipSpaces(json, readPosition);
+    if (m_end - m_pos < 4 || memcmp(m_pos, "null", 4) != 0)
+        throwError("Unexpected value, expecting 'null'", m_pos);
+    m_pos += 4;
+    skipSpaces();
 }
 
-void readArrayData(Element* parent, const char* json, const char*& readPosition)
+Element* JsonReader::readValue()
 {
-    if (*readPosition != '[')
-        throwUnexpectedCharacterError(*readPosition, '[', json, readPosition - json);
+    char firstChar = *m_pos;
+    if (isdigit((unsigned char) firstChar))
+        firstChar = '0';
 
-    readPosition++;
+    switch (firstChar) {
+        case '[':
+        {
+            auto* element = new (m_document) Element(m_document, new ArrayData(m_document));
+            try {
+                readArrayData(element);
+            }
+            catch (...) {
+                m_document->destroyElement(element);
+                throw;
+            }
+            return element;
+        }
 
-    while (*readPosition != ']') {
-        skipSpaces(json, readPosition);
+        case '{':
+        {
+            auto* element = new (m_document) Element(m_document, new ObjectData(m_document));
+            try {
+                readObjectData(element);
+            }
+            catch (...) {
+                m_document->destroyElement(element);
+                throw;
+            }
+            return element;
+        }
 
-        char firstChar = *readPosition;
-        if (isdigit(firstChar))
-            firstChar = '0';
+        case '0':
+        case '-':
+            return new (m_document) Element(m_document, readNumber());
+
+        case 't':
+        case 'f':
+            return new (m_document) Element(m_document, readBoolean());
+
+        case 'n':
+            readNull();
+            return new (m_document) Element(m_document);
+
+        case '"':
+        {
+            const char* str;
+            size_t length;
+            readString(str, length);
+            auto* element = new (m_document) Element(m_document);
+            element->m_type = JDT_STRING;
+            element->setString(str, length);
+            return element;
+        }
 
-        switch (firstChar) {
-            case ']':
-                // Close bracket
-                break;
+        default:
+            throwUnexpectedCharacterError(0);
+    }
+}
 
-            case '[':
-            {
-                auto* jsonArrayElement = parent->push_array();
-                readArrayData(jsonArrayElement, json, readPosition);
-            }
-            break;
+void JsonReader::readArrayData(Element* parent)
+{
+    if (*m_pos != '[')
+        throwUnexpectedCharacterError('[');
 
-            case '{':
-            {
-                auto* jsonObjectElement = parent->push_object();
-                readObjectData(jsonObjectElement, json, readPosition);
-            }
-            break;
+    m_pos++;
 
-            case '0':
-            case '-':
-            {
-                // Number
-                double number = readJsonNumber(json, readPosition);
-                parent->push_back(number);
-            }
-            break;
+    for (;;) {
+        skipSpaces();
 
-            case 't':
-            case 'f':
-            {
-                // Boolean
-                bool value = readJsonBoolean(json, readPosition);
-                parent->push_back(value);
-            }
+        if (*m_pos == ']')
             break;
 
-            case 'n':
-            {
-                // Null
-                readJsonNull(json, readPosition);
-                parent->push_back();
-            }
+        if (*m_pos == ',') {
+            m_pos++;
+            continue;
+        }
+
+        parent->add(readValue());
+    }
+    m_pos++;
+}
+
+void JsonReader::readObjectData(Element* parent)
+{
+    if (*m_pos != '{')
+        throwUnexpectedCharacterError('{');
+
+    m_pos++;
+
+    String elementName; // Reused for all the elements of this object
+
+    for (;;) {
+        skipSpaces();
+
+        if (*m_pos == '}')
             break;
 
-            case '"':
-            {
-                // String
-                string str = readJsonString(json, readPosition);
-                parent->push_back(str);
-            }
+        if (*m_pos == ',') {
+            m_pos++;
+            continue;
+        }
+
+        if (*m_pos != '"')
+            throwUnexpectedCharacterError('"');
+        const char* name;
+        size_t nameLength;
+        readString(name, nameLength);
+        if (*m_pos != ':')
+            throwUnexpectedCharacterError(':');
+        m_pos++;
+        skipSpaces();
+
+        // Element name must be copied before reading the value, that may reuse decoding buffer
+        elementName.assign(name, nameLength);
+        Element* element = readValue();
+        parent->add(elementName, element);
+    }
+    m_pos++;
+}
+
+void JsonReader::readRoot(Element& root)
+{
+    skipSpaces();
+
+    if (root.m_type != JDT_NULL)
+        throwError("Can't execute on non-null JSON element", m_json);
+
+    switch (*m_pos) {
+        case '{':
+            root.m_type = JDT_OBJECT;
+            root.m_data.m_object = new ObjectData(root.getDocument(), &root);
+            readObjectData(&root);
+            break;
+        case '[':
+            root.m_type = JDT_ARRAY;
+            root.m_data.m_array = new ArrayData(root.getDocument(), &root);
+            readArrayData(&root);
             break;
+        default:
+            throwUnexpectedCharacterError(0);
+    }
+}
 
-            case ',':
-                readPosition++;
-                skipSpaces(json, readPosition);
-                break;
+}}
 
-            default:
-                throwUnexpectedCharacterError(*readPosition, 0, json, readPosition - json);
+void Parser::parse(Element& jsonElement, const char* json, size_t length)
+{
+    JsonReader reader(jsonElement.getDocument(), json, length);
+    reader.readRoot(jsonElement);
+}
+
+StreamReader::StreamReader(const char* json, size_t length)
+: m_start(json), m_pos(json), m_end(json + length)
+{
+}
+
+StreamReader::StreamReader(istream& stream, size_t blockSize)
+: m_stream(&stream), m_blockSize(blockSize), m_buffer(blockSize + 1)
+{
+    m_start = m_pos = m_end = m_buffer.c_str();
+}
+
+StreamReader::StreamReader(BaseSocket& socket, chrono::milliseconds timeout, size_t blockSize)
+: m_socket(&socket), m_timeout(timeout), m_blockSize(blockSize), m_buffer(blockSize + 1)
+{
+    m_start = m_pos = m_end = m_buffer.c_str();
+}
+
+bool StreamReader::fill()
+{
+    if (m_stream == nullptr && m_socket == nullptr)
+        return false;
+
+    // Keep unread data at the start of the window
+    auto remaining = size_t(m_end - m_pos);
+    m_offset += size_t(m_pos - m_start);
+    if (remaining != 0 && m_pos != m_buffer.c_str())
+        memmove(m_buffer.data(), m_pos, remaining);
+    m_buffer.checkSize(remaining + m_blockSize + 1);
+
+    char* destination = m_buffer.data() + remaining;
+    size_t bytes = 0;
+    if (m_stream != nullptr) {
+        m_stream->read(destination, (streamsize) m_blockSize);
+        bytes = (size_t) m_stream->gcount();
+    } else {
+        if (!m_socket->readyToRead(m_timeout))
+            throw TimeoutException("Can't read JSON data: timeout");
+        size_t available = m_socket->socketBytes();
+        if (available != 0) // Otherwise, connection is closed
+            bytes = m_socket->read(destination, min(available, m_blockSize));
+    }
+
+    m_buffer.bytes(remaining + bytes);
+    m_start = m_pos = m_buffer.c_str();
+    m_end = m_start + remaining + bytes;
+
+    return bytes != 0;
+}
+
+bool StreamReader::ensure(size_t size)
+{
+    while (size_t(m_end - m_pos) < size) {
+        if (!fill())
+            return false;
+    }
+    return true;
+}
+
+int StreamReader::nextChar()
+{
+    for (;;) {
+        while (m_pos < m_end && (unsigned char) *m_pos <= 32)
+            m_pos++;
+        if (m_pos < m_end)
+            return (unsigned char) *m_pos;
+        if (!fill())
+            return -1;
+    }
+}
+
+void StreamReader::throwError(const String& message) const
+{
+    stringstream error;
+    error << message << ", in position " << m_offset + size_t(m_pos - m_start);
+    throw Exception(error.str());
+}
+
+void StreamReader::throwUnexpectedCharacterError(char expected) const
+{
+    stringstream msg;
+    if (m_pos < m_end)
+        msg << "Unexpected character '" << *m_pos << "'";
+    else
+        msg << "Premature end of data";
+    if (expected != 0)
+        msg << " while expected '" << expected << "'";
+    throwError(msg.str());
+}
+
+void StreamReader::readString(String& output)
+{
+    m_pos++;
+    output.clear();
+    for (;;) {
+        if (m_pos == m_end && !fill())
+            throwError("Premature end of data, expecting '\"'");
+
+        const char* start = m_pos;
+        while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\')
+            m_pos++;
+        output.append(start, size_t(m_pos - start));
+        if (m_pos == m_end)
+            continue;
+
+        if (*m_pos == '"') {
+            m_pos++;
+            return;
+        }
+
+        if (!ensure(2))
+            throwError("Premature end of data, expecting '\"'");
+        switch (m_pos[1]) {
+            case '"':  output += '"'; break;
+            case '\\': output += '\\'; break;
+            case '/':  output += '/'; break;
+            case 'b':  output += '\b'; break;
+            case 'f':  output += '\f'; break;
+            case 'n':  output += '\n'; break;
+            case 'r':  output += '\r'; break;
+            case 't':  output += '\t'; break;
+            case 'u': {
+                if (!ensure(6))
+                    throwError("Premature end of data, expecting Unicode character code");
+                char ucharCodeStr[5] = {};
+                memcpy(ucharCodeStr, m_pos + 2, 4);
+                char* codeEnd;
+                auto ucharCode = (unsigned) strtoul(ucharCodeStr, &codeEnd, 16);
+                if (codeEnd != ucharCodeStr + 4)
+                    throwError("Invalid Unicode character code");
+                m_pos += 4;
+                // Surrogate pair
+                if (ucharCode >= 0xD800 && ucharCode <= 0xDBFF && ensure(8) && m_pos[2] == '\\' && m_pos[3] == 'u') {
+                    memcpy(ucharCodeStr, m_pos + 4, 4);
+                    auto lowSurrogate = (unsigned) strtoul(ucharCodeStr, &codeEnd, 16);
+                    if (codeEnd == ucharCodeStr + 4 && lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) {
+                        ucharCode = 0x10000 + ((ucharCode - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                        m_pos += 6;
+                    }
+                }
+                appendUTF8(output, ucharCode);
                 break;
+            }
+            default:
+                m_pos++;
+                throwError("Unknown escape character");
         }
+        m_pos += 2;
     }
-    readPosition++;
 }
 
-void readObjectData(Element* parent, const char* json, const char*& readPosition)
+void StreamReader::readNumber()
 {
-    if (*readPosition != '{')
-        throwUnexpectedCharacterError(*readPosition, '{', json, readPosition - json);
+    char number[64];
+    size_t length = 0;
+    for (;;) {
+        if (m_pos == m_end && !fill())
+            break;
+        char ch = *m_pos;
+        if (!isdigit((unsigned char) ch) && ch != '-' && ch != '+' && ch != '.' && ch != 'e' && ch != 'E')
+            break;
+        if (length == sizeof(number) - 1)
+            throwError("Invalid value");
+        number[length++] = ch;
+        m_pos++;
+    }
+    number[length] = 0;
 
-    readPosition++;
+    char* numberEnd;
+    errno = 0;
+    m_number = strtod(number, &numberEnd);
+    if (errno != 0 || numberEnd != number + length)
+        throwError("Invalid value");
+}
 
-    while (*readPosition != '}') {
-        skipSpaces(json, readPosition);
-        if (*readPosition == ',') {
-            readPosition++;
-            continue;
+void StreamReader::readLiteral(const char* literal, size_t length)
+{
+    if (!ensure(length) || memcmp(m_pos, literal, length) != 0)
+        throwError("Unexpected value, expecting '" + string(literal) + "'");
+    m_pos += length;
+}
+
+StreamReader::Event StreamReader::readValue(int firstChar)
+{
+    m_state = AFTER_VALUE;
+    switch (firstChar) {
+        case '{':
+            m_pos++;
+            m_scopes.push_back('{');
+            m_state = FIRST_ITEM;
+            return m_event = BEGIN_OBJECT;
+
+        case '[':
+            m_pos++;
+            m_scopes.push_back('[');
+            m_state = FIRST_ITEM;
+            return m_event = BEGIN_ARRAY;
+
+        case '"':
+            readString(m_string);
+            return m_event = STRING;
+
+        case 't':
+            readLiteral("true", 4);
+            m_boolean = true;
+            return m_event = BOOLEAN;
+
+        case 'f':
+            readLiteral("false", 5);
+            m_boolean = false;
+            return m_event = BOOLEAN;
+
+        case 'n':
+            readLiteral("null", 4);
+            return m_event = NULL_VALUE;
+
+        default:
+            if (firstChar != '-' && !isdigit((unsigned char) firstChar))
+                throwUnexpectedCharacterError(0);
+            readNumber();
+            return m_event = NUMBER;
+    }
+}
+
+StreamReader::Event StreamReader::next()
+{
+    int ch = nextChar();
+
+    if (m_scopes.empty()) {
+        if (m_state == AFTER_VALUE) {
+            if (ch >= 0)
+                throwError("Unexpected data after the end of JSON value");
+            return m_event = END_OF_DATA;
         }
+        if (ch < 0)
+            throwError("Premature end of data");
+        return readValue(ch);
+    }
 
-        if (*readPosition == '}')
-            continue;
+    if (ch < 0)
+        throwError("Premature end of data");
 
-        string elementName = readJsonName(json, readPosition);
+    char scope = m_scopes.back();
+    if (m_state == FIRST_ITEM || m_state == AFTER_VALUE) {
+        if (ch == (scope == '{' ? '}' : ']')) {
+            m_pos++;
+            m_scopes.pop_back();
+            m_state = AFTER_VALUE;
+            return m_event = (scope == '{' ? END_OBJECT : END_ARRAY);
+        }
+        if (m_state == AFTER_VALUE) {
+            if (ch != ',')
+                throwUnexpectedCharacterError(',');
+            m_pos++;
+            ch = nextChar();
+        }
+    }
 
-        char firstChar = *readPosition;
-        if (isdigit(firstChar))
-            firstChar = '0';
+    if (scope == '{' && m_state != OBJECT_VALUE) {
+        if (ch != '"')
+            throwUnexpectedCharacterError('"');
+        readString(m_name);
+        if (nextChar() != ':')
+            throwUnexpectedCharacterError(':');
+        m_pos++;
+        m_state = OBJECT_VALUE;
+        return m_event = KEY;
+    }
 
-        switch (firstChar) {
-            case '}':
-                // Close bracket
-                break;
+    if (ch < 0)
+        throwError("Premature end of data");
+
+    return readValue(ch);
+}
 
-            case '[':
-            {
-                auto jsonArrayElement = parent->set_array(elementName);
-                readArrayData(jsonArrayElement, json, readPosition);
+void StreamReader::skip()
+{
+    if (m_event != BEGIN_OBJECT && m_event != BEGIN_ARRAY)
+        return;
+    size_t depth = m_scopes.size();
+    while (m_scopes.size() >= depth)
+        next();
+}
+
+void StreamReader::readElement(Element& element)
+{
+    Document* document = element.getDocument();
+
+    switch (m_event) {
+        case BEGIN_OBJECT: {
+            element.m_type = JDT_OBJECT;
+            element.m_data.m_object = new ObjectData(document, &element);
+            String elementName; // Reused for all the elements of this object
+            while (next() == KEY) {
+                elementName = m_name;
+                next();
+                auto* child = new (document) Element(document);
+                try {
+                    readElement(*child);
+                }
+                catch (...) {
+                    document->destroyElement(child);
+                    throw;
+                }
+                element.add(elementName, child);
             }
             break;
+        }
 
-            case '{':
-            {
-                auto jsonObjectElement = parent->set_object(elementName);
-                readObjectData(jsonObjectElement, json, readPosition);
+        case BEGIN_ARRAY:
+            element.m_type = JDT_ARRAY;
+            element.m_data.m_array = new ArrayData(document, &element);
+            while (next() != END_ARRAY) {
+                auto* child = new (document) Element(document);
+                try {
+                    readElement(*child);
+                }
+                catch (...) {
+                    document->destroyElement(child);
+                    throw;
+                }
+                element.add(child);
             }
             break;
 
-            case '0':
-            case '-':
-            {
-                // Number
-                double number = readJsonNumber(json, readPosition);
-                parent->set(elementName, number);
-            }
+        case STRING:
+            element.m_type = JDT_STRING;
+            element.setString(m_string.c_str(), m_string.length());
             break;
 
-            case 't':
-            case 'f':
-            {
-                // Boolean
-                bool value = readJsonBoolean(json, readPosition);
-                parent->set(elementName, value);
-            }
+        case NUMBER:
+            element.m_type = JDT_NUMBER;
+            element.m_data.m_number = m_number;
             break;
 
-            case 'n':
-            {
-                // Null
-                readJsonNull(json, readPosition);
-                parent->set(elementName);
-            }
+        case BOOLEAN:
+            element.m_type = JDT_BOOLEAN;
+            element.m_data.m_boolean = m_boolean;
             break;
 
-            case '"':
-            {
-                // String
-                string str = readJsonString(json, readPosition);
-                parent->set(elementName, str);
-            }
+        case NULL_VALUE:
             break;
 
-            default:
-                throwUnexpectedCharacterError(*readPosition, 0, json, readPosition - json);
-                break;
+        default:
+            throwError("JSON value is expected");
+    }
+}
+
+void StreamReader::read(Element& element)
+{
+    element.clear();
+    readElement(element);
+}
+
+bool StreamReader::readArrayItem(Document& document)
+{
+    if (m_event == NONE && next() != BEGIN_ARRAY)
+        throwError("JSON array is expected");
+
+    if (m_scopes.empty() || m_scopes.back() != '[')
+        throwError("Reader is not positioned inside JSON array");
+
+    if (next() == END_ARRAY)
+        return false;
+
+    document.clear();
+    read(document.root());
+    return true;
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_JsonParser, parseInPlace)
+{
+    // Not zero-terminated JSON text, followed by garbage
+    const char text[] = R"({"name":"Jo\"hn","n":-12,"d":2.5e1,"u":"\u00e9\ud83d\ude00","a":[true,false,null]}XXX)";
+
+    json::Document document;
+    document.load(text, sizeof(text) - 4);
+
+    json::Element& root = document.root();
+    EXPECT_STREQ("Jo\"hn", root.getString("name").c_str());
+    EXPECT_DOUBLE_EQ(-12, root.getNumber("n"));
+    EXPECT_DOUBLE_EQ(25, root.getNumber("d"));
+    EXPECT_STREQ("\xC3\xA9\xF0\x9F\x98\x80", root.getString("u").c_str());
+    EXPECT_EQ(size_t(3), root.getArray("a").size());
+    EXPECT_TRUE(root.getArray("a")[0].getBoolean());
+    EXPECT_TRUE(root.getArray("a")[2].isNull());
+}
+
+TEST(SPTK_JsonParser, errors)
+{
+    json::Document document;
+    EXPECT_THROW(document.load(R"({"name":"John)"), Exception);
+    EXPECT_THROW(document.load(R"({"name":)"), Exception);
+    EXPECT_THROW(document.load(R"({"value":12x})"), Exception);
+    EXPECT_THROW(document.load(R"({"value":truth})"), Exception);
+    EXPECT_THROW(document.load(R"("text")"), Exception);
+
+    const char text[] = R"({"value":123})";
+    EXPECT_THROW(document.load(text, 11), Exception);
+}
+
+TEST(SPTK_JsonParser, loadBuffer)
+{
+    Buffer buffer;
+    buffer.append("[");
+    for (int i = 0; i < 1000; i++)
+        buffer.append(String(i ? "," : "") + "{\"id\":" + int2string(i) + ",\"name\":\"Item " + int2string(i) + "\"}");
+    buffer.append("]");
+
+    json::Document document;
+    document.load(buffer);
+    json::ArrayData& items = document.root().getArray();
+    EXPECT_EQ(size_t(1000), items.size());
+    EXPECT_DOUBLE_EQ(999, items[999].getNumber("id"));
+    EXPECT_STREQ("Item 999", items[999].getString("name").c_str());
+}
+
+TEST(SPTK_JsonStreamReader, events)
+{
+    const char text[] = R"({"name":"John \"J\" Smith","age":33,"skills":["C++",true,null],"address":{}})";
+
+    json::StreamReader reader(text, strlen(text));
+    typedef json::StreamReader SR;
+    SR::Event expected[] = { SR::BEGIN_OBJECT, SR::KEY, SR::STRING, SR::KEY, SR::NUMBER, SR::KEY, SR::BEGIN_ARRAY,
+                             SR::STRING, SR::BOOLEAN, SR::NULL_VALUE, SR::END_ARRAY, SR::KEY, SR::BEGIN_OBJECT,
+                             SR::END_OBJECT, SR::END_OBJECT, SR::END_OF_DATA };
+    for (auto event: expected) {
+        EXPECT_EQ(event, reader.next());
+        if (event == SR::STRING && reader.name() == "name") {
+            EXPECT_STREQ("John \"J\" Smith", reader.getString().c_str());
+        } else if (event == SR::NUMBER) {
+            EXPECT_DOUBLE_EQ(33, reader.getNumber());
         }
     }
-    readPosition++;
+
+    json::StreamReader badReader(R"({"name" "John"})", 15);
+    badReader.next();
+    EXPECT_THROW(badReader.next(), Exception);
 }
 
-}}
+TEST(SPTK_JsonStreamReader, readArrayItems)
+{
+    stringstream stream;
+    stream << "[";
+    for (int i = 0; i < 1000; i++)
+        stream << (i ? "," : "") << "{\"id\":" << i << ",\"name\":\"Item\\t" << i << "\u00e9\",\"tags\":[1,2.5,-3e2]}\n";
+    stream << "]";
+
+    // Small blocks, so values span block boundaries
+    json::StreamReader reader(stream, 7);
+    json::Document item;
+    int count = 0;
+    while (reader.readArrayItem(item)) {
+        EXPECT_DOUBLE_EQ(count, item.root().getNumber("id"));
+        EXPECT_STREQ(("Item\t" + int2string(count) + "\xC3\xA9").c_str(), item.root().getString("name").c_str());
+        EXPECT_DOUBLE_EQ(-300, item.root().getArray("tags")[2].getNumber());
+        count++;
+    }
+    EXPECT_EQ(1000, count);
+    EXPECT_EQ(json::StreamReader::END_OF_DATA, reader.next());
+}
+
+TEST(SPTK_JsonStreamReader, nestedArray)
+{
+    const char text[] = R"({"header":{"count":2},"records":[{"id":1},{"id":2}],"footer":"end"})";
+
+    json::StreamReader reader(text, strlen(text));
+    json::Document item;
+    int count = 0;
+    while (reader.next() == json::StreamReader::KEY || reader.event() != json::StreamReader::END_OBJECT) {
+        if (reader.event() != json::StreamReader::KEY)
+            continue;
+        reader.next();
+        if (reader.name() == "records") {
+            while (reader.readArrayItem(item))
+                count++;
+        } else
+            reader.skip();
+    }
+    EXPECT_EQ(2, count);
+    EXPECT_EQ(2.0, item.root().getNumber("id"));
+}
+
+#endif
@@ -0,0 +1,417 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       JsonWriter.cpp - description                           ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/json/JsonWriter.h>
+#include <sptk5/json/JsonArrayData.h>
+#include <sptk5/net/BaseSocket.h>
+#include <charconv>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+using namespace sptk;
+using namespace sptk::json;
+
+#define INDENT_SIZE 4
+
+static const char indentSpaces[] = "                                                                ";
+
+Writer::Writer(Buffer& output, bool formatted)
+: m_output(output), m_formatted(formatted)
+{
+}
+
+Writer::Writer(BaseSocket& socket, bool formatted, size_t flushSize)
+: m_output(m_buffer), m_socket(&socket), m_flushSize(flushSize), m_formatted(formatted)
+{
+    m_buffer.reserve(flushSize + 1024);
+}
+
+void Writer::newLine(size_t depth)
+{
+    m_output.append('\n');
+    size_t indent = depth * INDENT_SIZE;
+    while (indent > 0) {
+        size_t portion = min(indent, sizeof(indentSpaces) - 1);
+        m_output.append(indentSpaces, portion);
+        indent -= portion;
+    }
+}
+
+void Writer::beforeValue()
+{
+    if (m_scopes.empty())
+        return;
+
+    Scope& scope = m_scopes.back();
+    if (scope.isObject) {
+        if (!m_expectingValue)
+            throw Exception("JSON object element name is expected");
+        m_expectingValue = false;
+        return;
+    }
+
+    if (scope.count != 0)
+        m_output.append(',');
+    scope.count++;
+    if (m_formatted)
+        newLine(m_scopes.size());
+}
+
+void Writer::endScope(bool isObject, char bracket)
+{
+    if (m_scopes.empty() || m_scopes.back().isObject != isObject || m_expectingValue)
+        throw Exception(isObject ? "Unexpected end of JSON object" : "Unexpected end of JSON array");
+    size_t count = m_scopes.back().count;
+    m_scopes.pop_back();
+    if (m_formatted && count != 0)
+        newLine(m_scopes.size());
+    m_output.append(&bracket, 1);
+    checkFlush();
+}
+
+void Writer::beginObject()
+{
+    beforeValue();
+    m_output.append('{');
+    m_scopes.push_back({true, 0});
+}
+
+void Writer::endObject()
+{
+    endScope(true, '}');
+}
+
+void Writer::beginArray()
+{
+    beforeValue();
+    m_output.append('[');
+    m_scopes.push_back({false, 0});
+}
+
+void Writer::endArray()
+{
+    endScope(false, ']');
+}
+
+void Writer::key(const char* name, size_t length)
+{
+    if (m_scopes.empty() || !m_scopes.back().isObject || m_expectingValue)
+        throw Exception("Unexpected JSON object element name");
+
+    Scope& scope = m_scopes.back();
+    if (scope.count != 0)
+        m_output.append(',');
+    scope.count++;
+    if (m_formatted)
+        newLine(m_scopes.size());
+
+    appendString(m_output, name, length);
+    if (m_formatted)
+        m_output.append(": ", 2);
+    else
+        m_output.append(':');
+    m_expectingValue = true;
+}
+
+void Writer::value(const char* str, size_t length)
+{
+    beforeValue();
+    appendString(m_output, str, length);
+    checkFlush();
+}
+
+void Writer::value(double number)
+{
+    beforeValue();
+    appendNumber(m_output, number);
+    checkFlush();
+}
+
+void Writer::value(int64_t number)
+{
+    beforeValue();
+    appendNumber(m_output, number);
+    checkFlush();
+}
+
+void Writer::value(uint64_t number)
+{
+    beforeValue();
+    char buffer[32];
+    auto result = to_chars(buffer, buffer + sizeof(buffer), number);
+    m_output.append(buffer, size_t(result.ptr - buffer));
+    checkFlush();
+}
+
+void Writer::value(bool boolean)
+{
+    beforeValue();
+    if (boolean)
+        m_output.append("true", 4);
+    else
+        m_output.append("false", 5);
+    checkFlush();
+}
+
+void Writer::null()
+{
+    beforeValue();
+    m_output.append("null", 4);
+    checkFlush();
+}
+
+void Writer::value(const Element& element)
+{
+    switch (element.m_type) {
+        case JDT_NUMBER:
+            value(element.m_data.m_number);
+            break;
+
+        case JDT_STRING:
+            value(element.m_data.m_string, element.m_stringLength);
+            break;
+
+        case JDT_BOOLEAN:
+            value(element.m_data.m_boolean);
+            break;
+
+        case JDT_ARRAY:
+            beginArray();
+            if (element.m_data.m_array) {
+                for (const Element* item: *element.m_data.m_array)
+                    value(*item);
+            }
+            endArray();
+            break;
+
+        case JDT_OBJECT:
+            beginObject();
+            if (element.m_data.m_object) {
+                for (auto& itor: *element.m_data.m_object) {
+                    key(*itor.first);
+                    value(*itor.second);
+                }
+            }
+            endObject();
+            break;
+
+        case JDT_NULL:
+            null();
+            break;
+    }
+}
+
+void Writer::flush()
+{
+    if (m_socket == nullptr || m_output.bytes() == 0)
+        return;
+    m_socket->write(m_output);
+    m_output.bytes(0);
+}
+
+/**
+ * Characters that must be escaped in JSON strings.
+ * Control characters without short escape sequence are written as \u00XX.
+ */
+static const char* escapeSequence(unsigned char ch)
+{
+    static const char* const controlEscapes[32] = {
+        "\\u0000", "\\u0001", "\\u0002", "\\u0003", "\\u0004", "\\u0005", "\\u0006", "\\u0007",
+        "\\b",     "\\t",     "\\n",     "\\u000B", "\\f",     "\\r",     "\\u000E", "\\u000F",
+        "\\u0010", "\\u0011", "\\u0012", "\\u0013", "\\u0014", "\\u0015", "\\u0016", "\\u0017",
+        "\\u0018", "\\u0019", "\\u001A", "\\u001B", "\\u001C", "\\u001D", "\\u001E", "\\u001F"
+    };
+    if (ch < 32)
+        return controlEscapes[ch];
+    switch (ch) {
+        case '"':
+            return "\\\"";
+        case '\\':
+            return "\\\\";
+        case '/':
+            return "\\/";
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * Find the first character that must be escaped
+ * @param str                   String
+ * @param end                   End of string
+ * @return position of the first character that must be escaped, or end
+ */
+static inline const char* findEscapedCharacter(const char* str, const char* end)
+{
+#ifdef __SSE2__
+    // Checks 16 characters at a time
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i maxControl = _mm_set1_epi8(0x1F);
+    while (end - str >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*) str);
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, slash),
+                         _mm_cmpeq_epi8(_mm_max_epu8(chunk, maxControl), maxControl)));
+        auto mask = (unsigned) _mm_movemask_epi8(matches);
+        if (mask != 0)
+            return str + __builtin_ctz(mask);
+        str += 16;
+    }
+#endif
+    while (str < end && escapeSequence((unsigned char) *str) == nullptr)
+        str++;
+    return str;
+}
+
+void Writer::appendString(Buffer& output, const char* str, size_t length)
+{
+    const char* end = str + length;
+    output.checkSize(output.bytes() + length + 3);
+    output.append('"');
+    while (str < end) {
+        const char* escaped = findEscapedCharacter(str, end);
+        if (escaped != str)
+            output.append(str, size_t(escaped - str));
+        if (escaped == end)
+            break;
+        const char* sequence = escapeSequence((unsigned char) *escaped);
+        output.append(sequence, strlen(sequence));
+        str = escaped + 1;
+    }
+    output.append("\"", 1);
+}
+
+void Writer::appendNumber(Buffer& output, double number)
+{
+    if (!isfinite(number)) {
+        // JSON doesn't support NaN and infinity
+        output.append("null", 4);
+        return;
+    }
+
+    // Integer fast path
+    if (number >= -9.2E18 && number <= 9.2E18 && number == trunc(number)) {
+        appendNumber(output, int64_t(number));
+        return;
+    }
+
+    char buffer[32];
+    auto result = to_chars(buffer, buffer + sizeof(buffer), number);
+    output.append(buffer, size_t(result.ptr - buffer));
+}
+
+void Writer::appendNumber(Buffer& output, int64_t number)
+{
+    char buffer[32];
+    auto result = to_chars(buffer, buffer + sizeof(buffer), number);
+    output.append(buffer, size_t(result.ptr - buffer));
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+#include <sptk5/json/JsonDocument.h>
+
+TEST(SPTK_JsonWriter, streaming)
+{
+    Buffer output;
+    json::Writer writer(output);
+    writer.beginObject();
+    writer.key("name");
+    writer.value("John \"Johnny\" Smith\n");
+    writer.key("age");
+    writer.value(33);
+    writer.key("height");
+    writer.value(1.85);
+    writer.key("skills");
+    writer.beginArray();
+    writer.value("C++");
+    writer.value(true);
+    writer.null();
+    writer.endArray();
+    writer.key("empty");
+    writer.beginObject();
+    writer.endObject();
+    writer.endObject();
+
+    EXPECT_STREQ(R"({"name":"John \"Johnny\" Smith\n","age":33,"height":1.85,"skills":["C++",true,null],"empty":{}})", output.c_str());
+
+    EXPECT_THROW(writer.endArray(), Exception);
+    writer.beginObject();
+    EXPECT_THROW(writer.value(1), Exception);
+}
+
+TEST(SPTK_JsonWriter, formatted)
+{
+    Buffer output;
+    json::Writer writer(output, true);
+    writer.beginObject();
+    writer.key("a");
+    writer.beginArray();
+    writer.value(1);
+    writer.value(2);
+    writer.endArray();
+    writer.endObject();
+
+    EXPECT_STREQ("{\n    \"a\": [\n        1,\n        2\n    ]\n}", output.c_str());
+}
+
+TEST(SPTK_JsonWriter, numbers)
+{
+    double numbers[] = { 0, -1, 1519005758000, 33.6, 0.1, 1.0 / 3, -2.5e-10, 1e300 };
+    for (double number: numbers) {
+        Buffer output;
+        json::Writer::appendNumber(output, number);
+        EXPECT_DOUBLE_EQ(number, strtod(output.c_str(), nullptr));
+    }
+
+    Buffer output;
+    json::Writer::appendNumber(output, 33.6);
+    EXPECT_STREQ("33.6", output.c_str());
+}
+
+TEST(SPTK_JsonWriter, escape)
+{
+    // Long enough to use vectorized scanning
+    String text = "Plain text before special characters: \"quoted\", back\\slash, a/b, tab\t, bell\x07 end";
+    Buffer output;
+    json::Writer::appendString(output, text.c_str(), text.length());
+    EXPECT_STREQ("\"Plain text before special characters: \\\"quoted\\\", back\\\\slash, a\\/b, tab\\t, bell\\u0007 end\"", output.c_str());
+
+    json::Document document;
+    document.load("[" + string(output.c_str()) + "]");
+    EXPECT_STREQ(text.c_str(), document.root()[size_t(0)].getString().c_str());
+}
+
+#endif
@@ -39,6 +39,8 @@ static bool  m_inited(false);
 #else
 
 #include <sys/poll.h>
+#include <sys/uio.h>
+#include <climits>
 
 #endif
 
@@ -167,7 +169,12 @@ size_t BaseSocket::recv(void* buffer, size_t len)
 
 size_t BaseSocket::send(const void* buffer, size_t len)
 {
+#ifdef MSG_NOSIGNAL
+    // Writing to the socket, closed by peer, shouldn't raise SIGPIPE
+    return (size_t) ::send(m_sockfd, (char*) buffer, (int32_t) len, MSG_NOSIGNAL);
+#else
     return (size_t) ::send(m_sockfd, (char*) buffer, (int32_t) len, 0);
+#endif
 }
 
 int32_t BaseSocket::control(int flag, const uint32_t* check)
@@ -185,7 +192,13 @@ void BaseSocket::host(const Host& host)
 }
 
 // Connect & disconnect
-void BaseSocket::open_addr(CSocketOpenMode openMode, const sockaddr_in* addr, std::chrono::milliseconds timeout)
+void BaseSocket::open_addr(CSocketOpenMode openMode, const sockaddr_in* addr, std::chrono::milliseconds timeout, int backlog)
+{
+    open_addr(openMode, (const sockaddr*) addr, sizeof(sockaddr_in), timeout, backlog);
+}
+
+void BaseSocket::open_addr(CSocketOpenMode openMode, const sockaddr* addr, socklen_t addrLength, std::chrono::milliseconds timeout,
+                           int backlog)
 {
     auto timeoutMS = (int) timeout.count();
 
@@ -193,7 +206,8 @@ void BaseSocket::open_addr(CSocketOpenMode openMode, const sockaddr_in* addr, st
         close();
 
     // Create a new socket
-    m_sockfd = socket(m_domain, m_type, m_protocol);
+    int domain = addr != nullptr && openMode != SOM_CREATE ? addr->sa_family : m_domain;
+    m_sockfd = socket(domain, m_type, m_protocol);
     if (m_sockfd == INVALID_SOCKET)
         THROW_SOCKET_ERROR("Can't create socket");
 
@@ -205,7 +219,7 @@ void BaseSocket::open_addr(CSocketOpenMode openMode, const sockaddr_in* addr, st
             currentOperation = "connect";
             if (timeoutMS != 0) {
                 blockingMode(false);
-                rc = connect(m_sockfd, (sockaddr*) addr, sizeof(sockaddr_in));
+                rc = connect(m_sockfd, addr, addrLength);
                 switch (rc) {
                     case ENETUNREACH:
                         throw Exception("Network unreachable");
@@ -222,10 +236,18 @@ void BaseSocket::open_addr(CSocketOpenMode openMode, const sockaddr_in* addr, st
                     close();
                     throw;
                 }
+                // Failed connection is also reported as ready to write, with the socket error
+                int socketError = 0;
+                getOption(SOL_SOCKET, SO_ERROR, socketError);
+                if (socketError != 0) {
+                    errno = socketError;
+                    rc = -1;
+                    break;
+                }
                 rc = 0;
                 blockingMode(true);
             } else
-                rc = connect(m_sockfd, (sockaddr*) addr, sizeof(sockaddr_in));
+                rc = connect(m_sockfd, addr, addrLength);
             break;
         case SOM_BIND:
             if (m_type != SOCK_DGRAM) {
@@ -236,9 +258,9 @@ void BaseSocket::open_addr(CSocketOpenMode openMode, const sockaddr_in* addr, st
 #endif
             }
             currentOperation = "bind";
-            rc = ::bind(m_sockfd, (sockaddr*) addr, sizeof(sockaddr_in));
+            rc = ::bind(m_sockfd, addr, addrLength);
             if (rc == 0 && m_type != SOCK_DGRAM) {
-                rc = ::listen(m_sockfd, SOMAXCONN);
+                rc = ::listen(m_sockfd, backlog);
                 currentOperation = "listen";
             }
             break;
@@ -282,7 +304,7 @@ void BaseSocket::bind(const char* address, uint32_t portNumber)
         THROW_SOCKET_ERROR("Can't bind socket to port " + int2string(portNumber));
 }
 
-void BaseSocket::listen(uint16_t portNumber)
+void BaseSocket::listen(uint16_t portNumber, const String& bindAddress, int backlog)
 {
     if (portNumber != 0)
         m_host.port(portNumber);
@@ -290,11 +312,21 @@ void BaseSocket::listen(uint16_t portNumber)
     sockaddr_in addr = {};
 
     memset(&addr, 0, sizeof(addr));
+    if (bindAddress.empty())
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    else
+        Host(bindAddress, 0).getAddress(addr);
     addr.sin_family = (SOCKET_ADDRESS_FAMILY) m_domain;
-    addr.sin_addr.s_addr = htonl(INADDR_ANY);
     addr.sin_port = htons(m_host.port());
 
-    open_addr(SOM_BIND, &addr);
+    open_addr(SOM_BIND, &addr, std::chrono::milliseconds(0), backlog);
+
+    if (m_host.port() == 0) {
+        // Port selected by the system
+        socklen_t len = sizeof(addr);
+        if (getsockname(m_sockfd, (sockaddr*) &addr, &len) == 0)
+            m_host.port(ntohs(addr.sin_port));
+    }
 }
 
 void BaseSocket::close() noexcept
@@ -349,6 +381,45 @@ size_t BaseSocket::read(String& buffer, size_t size, sockaddr_in* from)
     return bytes;
 }
 
+size_t BaseSocket::read(const vector<Buffer*>& buffers)
+{
+#ifdef _WIN32
+    size_t total = 0;
+    for (auto* buffer: buffers) {
+        size_t bytes = read(buffer->data(), buffer->capacity());
+        buffer->bytes(bytes);
+        total += bytes;
+        if (bytes < buffer->capacity())
+            break;
+    }
+    return total;
+#else
+    vector<iovec> iov(buffers.size());
+    for (size_t i = 0; i < buffers.size(); i++) {
+        iov[i].iov_base = buffers[i]->data();
+        iov[i].iov_len = buffers[i]->capacity();
+    }
+
+    ssize_t bytes;
+    do {
+        bytes = ::readv(m_sockfd, iov.data(), (int) (iov.size() < IOV_MAX ? iov.size() : IOV_MAX));
+    } while (bytes == -1 && errno == EINTR);
+
+    if (bytes == -1)
+        THROW_SOCKET_ERROR("Can't read from socket");
+
+    auto remaining = (size_t) bytes;
+    for (auto* buffer: buffers) {
+        size_t received = remaining < buffer->capacity() ? remaining : buffer->capacity();
+        buffer->bytes(received);
+        buffer->data()[received] = 0;
+        remaining -= received;
+    }
+
+    return (size_t) bytes;
+#endif
+}
+
 size_t BaseSocket::write(const char* buffer, size_t size, const sockaddr_in* peer)
 {
     int bytes;
@@ -382,6 +453,52 @@ size_t BaseSocket::write(const String& buffer, const sockaddr_in* peer)
     return write(buffer.c_str(), buffer.length(), peer);
 }
 
+size_t BaseSocket::write(const BufferChain& chain)
+{
+#ifdef _WIN32
+    for (auto& segment: chain)
+        write(segment.data(), segment.bytes());
+#else
+    vector<iovec> iov;
+    iov.reserve(chain.size());
+    for (auto& segment: chain)
+        iov.push_back({ (void*) segment.data(), segment.bytes() });
+
+    size_t first = 0;
+    while (first < iov.size()) {
+        size_t count = iov.size() - first;
+        if (count > IOV_MAX)
+            count = IOV_MAX;
+
+#ifdef MSG_NOSIGNAL
+        msghdr message = {};
+        message.msg_iov = iov.data() + first;
+        message.msg_iovlen = count;
+        ssize_t bytes = ::sendmsg(m_sockfd, &message, MSG_NOSIGNAL);
+#else
+        ssize_t bytes = ::writev(m_sockfd, iov.data() + first, (int) count);
+#endif
+        if (bytes == -1) {
+            if (errno == EINTR)
+                continue;
+            THROW_SOCKET_ERROR("Can't write to socket");
+        }
+
+        // Skip the segments that are written completely, and adjust partially written one
+        auto written = (size_t) bytes;
+        while (first < iov.size() && written >= iov[first].iov_len) {
+            written -= iov[first].iov_len;
+            first++;
+        }
+        if (written > 0) {
+            iov[first].iov_base = (char*) iov[first].iov_base + written;
+            iov[first].iov_len -= written;
+        }
+    }
+#endif
+    return chain.bytes();
+}
+
 #if (__FreeBSD__ | __OpenBSD__)
 #define CONNCLOSED (POLLHUP)
 #else
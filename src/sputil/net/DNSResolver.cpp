@@ -0,0 +1,221 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       DNSResolver.cpp - description                          ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/net/DNSResolver.h>
+#include <sptk5/net/BaseSocket.h>
+#include <sptk5/Exception.h>
+
+#ifndef _WIN32
+#include <netdb.h>
+#endif
+
+using namespace std;
+using namespace sptk;
+
+DNSResolver::DNSResolver(chrono::seconds positiveTTL, chrono::seconds negativeTTL)
+: m_positiveTTL(positiveTTL), m_negativeTTL(negativeTTL)
+{
+}
+
+DNSResolver& DNSResolver::global()
+{
+    static DNSResolver resolver;
+    return resolver;
+}
+
+DNSResolver::Addresses DNSResolver::getAddresses(const String& hostname)
+{
+    String name(hostname);
+    if (name.length() > 1 && name[0] == '[' && name[name.length() - 1] == ']')
+        name = name.substr(1, name.length() - 2);
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;        // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM;    // Socket type, to receive every address once
+    hints.ai_protocol = 0;
+
+    struct addrinfo* result = nullptr;
+    int rc = getaddrinfo(name.c_str(), nullptr, &hints, &result);
+    if (rc != 0)
+        throw Exception("Can't resolve " + hostname + ": " + gai_strerror(rc));
+
+    Addresses addresses;
+    for (auto* info = result; info != nullptr; info = info->ai_next) {
+        if (info->ai_family != AF_INET && info->ai_family != AF_INET6)
+            continue;
+        sockaddr_storage address = {};
+        memcpy(&address, info->ai_addr, info->ai_addrlen);
+        addresses.push_back(address);
+    }
+
+    freeaddrinfo(result);
+
+    if (addresses.empty())
+        throw Exception("Can't resolve " + hostname + ": no IPv4 or IPv6 addresses");
+
+    return addresses;
+}
+
+DNSResolver::Addresses DNSResolver::resolve(const String& hostname)
+{
+    String key = lowerCase(hostname);
+    promise<Addresses> lookup;
+    shared_future<Addresses> addresses;
+    uint64_t id = 0;
+    chrono::seconds positiveTTL;
+    chrono::seconds negativeTTL;
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        positiveTTL = m_positiveTTL;
+        negativeTTL = m_negativeTTL;
+        auto itor = m_cache.find(key);
+        if (itor != m_cache.end() && itor->second.expires > chrono::steady_clock::now())
+            addresses = itor->second.addresses;
+        else {
+            if (m_cache.size() >= MaxCacheSize)
+                purge();
+            id = ++m_lookupId;
+            addresses = lookup.get_future().share();
+            // Lookup in progress doesn't expire
+            m_cache[key] = { addresses, chrono::steady_clock::time_point::max(), id };
+        }
+    }
+
+    if (id != 0) {
+        try {
+            lookup.set_value(getAddresses(hostname));
+            expire(key, id, positiveTTL);
+        }
+        catch (const Exception&) {
+            lookup.set_exception(current_exception());
+            expire(key, id, negativeTTL);
+        }
+        catch (...) {
+            // Not a resolver error, so it isn't cached: waiting threads get it, next lookup retries
+            lookup.set_exception(current_exception());
+            forget(key, id);
+        }
+    }
+
+    return addresses.get();
+}
+
+shared_future<DNSResolver::Addresses> DNSResolver::resolveAsync(const String& hostname)
+{
+    return async(launch::async, [this, hostname]() {
+        return resolve(hostname);
+    }).share();
+}
+
+void DNSResolver::expire(const String& hostname, uint64_t id, chrono::seconds ttl)
+{
+    lock_guard<mutex> lock(m_mutex);
+    auto itor = m_cache.find(hostname);
+    if (itor != m_cache.end() && itor->second.id == id)
+        itor->second.expires = chrono::steady_clock::now() + ttl;
+}
+
+void DNSResolver::forget(const String& hostname, uint64_t id)
+{
+    lock_guard<mutex> lock(m_mutex);
+    auto itor = m_cache.find(hostname);
+    if (itor != m_cache.end() && itor->second.id == id)
+        m_cache.erase(itor);
+}
+
+void DNSResolver::purge()
+{
+    auto now = chrono::steady_clock::now();
+    for (auto itor = m_cache.begin(); itor != m_cache.end();) {
+        if (itor->second.expires <= now)
+            itor = m_cache.erase(itor);
+        else
+            ++itor;
+    }
+}
+
+void DNSResolver::setTTL(chrono::seconds positiveTTL, chrono::seconds negativeTTL)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_positiveTTL = positiveTTL;
+    m_negativeTTL = negativeTTL;
+}
+
+void DNSResolver::clear()
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_cache.clear();
+}
+
+size_t DNSResolver::size() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_cache.size();
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_DNSResolver, resolve)
+{
+    DNSResolver resolver;
+
+    auto addresses = resolver.resolve("127.0.0.1");
+    ASSERT_EQ(size_t(1), addresses.size());
+    EXPECT_EQ(AF_INET, addresses[0].ss_family);
+
+    addresses = resolver.resolve("[::1]");
+    ASSERT_EQ(size_t(1), addresses.size());
+    EXPECT_EQ(AF_INET6, addresses[0].ss_family);
+
+    addresses = resolver.resolveAsync("localhost").get();
+    EXPECT_FALSE(addresses.empty());
+    EXPECT_EQ(size_t(3), resolver.size());
+
+    // Cached lookup
+    resolver.resolve("LocalHost");
+    EXPECT_EQ(size_t(3), resolver.size());
+
+    resolver.clear();
+    EXPECT_EQ(size_t(0), resolver.size());
+}
+
+TEST(SPTK_DNSResolver, negativeCache)
+{
+    DNSResolver resolver(chrono::seconds(60), chrono::seconds(60));
+
+    EXPECT_THROW(resolver.resolve("no such host name"), Exception);
+    EXPECT_EQ(size_t(1), resolver.size());
+
+    // Failed lookup is cached, and reported again
+    EXPECT_THROW(resolver.resolve("no such host name"), Exception);
+    EXPECT_EQ(size_t(1), resolver.size());
+}
+
+#endif
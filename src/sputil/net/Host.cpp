@@ -69,6 +69,7 @@ Host::Host(const Host& other)
 {
     SharedLock(other.m_mutex);
     memcpy(&m_address, &other.m_address, sizeof(m_address));
+    m_addresses = other.m_addresses;
 }
 
 Host::Host(Host&& other) noexcept
@@ -76,24 +77,31 @@ Host::Host(Host&& other) noexcept
 {
     SharedLock(other.m_mutex);
     memcpy(&m_address, &other.m_address, sizeof(m_address));
+    m_addresses = move(other.m_addresses);
 }
 
 Host& Host::operator = (const Host& other)
 {
+    if (&other == this)
+        return *this;
     SharedLockInt lock1(other.m_mutex);
     UniqueLockInt lock2(m_mutex);
     m_hostname = other.m_hostname;
     m_port = other.m_port;
     memcpy(&m_address, &other.m_address, sizeof(m_address));
+    m_addresses = other.m_addresses;
     return *this;
 }
 
 Host& Host::operator = (Host&& other) noexcept
 {
+    if (&other == this)
+        return *this;
     CopyLock(m_mutex, other.m_mutex);
     m_hostname = other.m_hostname;
     m_port = other.m_port;
     memcpy(&m_address, &other.m_address, sizeof(m_address));
+    m_addresses = move(other.m_addresses);
     return *this;
 }
 
@@ -109,69 +117,49 @@ bool Host::operator != (const Host& other) const
     return toString(true) != other.toString(true);
 }
 
-void Host::setPort(uint16_t p)
+static void setAddressPort(sockaddr* address, uint16_t port)
 {
-    UniqueLock(m_mutex);
-	m_port = p;
-	switch (m_address.any.sa_family) {
+	switch (address->sa_family) {
 	case AF_INET:
-		m_address.ip_v4.sin_port = htons(uint16_t(m_port));
+		((sockaddr_in*) address)->sin_port = htons(port);
 		break;
 	case AF_INET6:
-		m_address.ip_v6.sin6_port = htons(uint16_t(m_port));
+		((sockaddr_in6*) address)->sin6_port = htons(port);
 		break;
     default:
         break;
 	}
 }
 
-void Host::getHostAddress()
+void Host::setPort(uint16_t p)
 {
-    static SharedMutex getaddrinfoMutex;
-
-#ifdef _WIN32
-    struct hostent* host_info = gethostbyname(m_hostname.c_str());
-	if (host_info == nullptr)
-		BaseSocket::throwSocketError("Can't get host info for " + m_hostname, __FILE__, __LINE__);
-
     UniqueLock(m_mutex);
-    memset(&m_address, 0, sizeof(m_address));
-	m_address.any.sa_family = host_info->h_addrtype;
-
-	switch (m_address.any.sa_family) {
-	case AF_INET:
-		memcpy(&m_address.ip_v4.sin_addr, host_info->h_addr, size_t(host_info->h_length));
-		break;
-	case AF_INET6:
-		memcpy(&m_address.ip_v6.sin6_addr, host_info->h_addr, size_t(host_info->h_length));
-		break;
-	}
-
-#else
-    struct addrinfo hints = {};
-    memset(&hints, 0, sizeof(struct addrinfo));
-    hints.ai_family = AF_INET;          // IPv4 or IPv6
-    hints.ai_socktype = SOCK_STREAM;    // Socket type
-    //hints.ai_flags = AI_PASSIVE;      /* For wildcard IP address */
-    hints.ai_protocol = 0;
-
-    struct addrinfo* result;
-    {
-        UniqueLock(getaddrinfoMutex);
-
-        int rc = getaddrinfo(m_hostname.c_str(), nullptr, &hints, &result);
-        if (rc != 0)
-            throw Exception(gai_strerror(rc));
-    }
+	m_port = p;
+    setAddressPort(&m_address.any, m_port);
+    for (auto& address: m_addresses)
+        setAddressPort((sockaddr*) &address, m_port);
+}
 
-    {
-        UniqueLock(m_mutex);
-        memset(&m_address, 0, sizeof(m_address));
-        memcpy(&m_address, (struct sockaddr_in*) result->ai_addr, result->ai_addrlen);
+void Host::getHostAddress()
+{
+    DNSResolver::Addresses addresses = DNSResolver::global().resolve(m_hostname);
+
+    // Sockets are connected over IPv4, so IPv4 address is preferred
+    const sockaddr_storage* preferred = &addresses[0];
+    for (auto& address: addresses) {
+        if (address.ss_family == AF_INET) {
+            preferred = &address;
+            break;
+        }
     }
 
-    freeaddrinfo(result);
-#endif
+    UniqueLock(m_mutex);
+    memset(&m_address, 0, sizeof(m_address));
+    if (preferred->ss_family == AF_INET)
+        memcpy(&m_address.ip_v4, preferred, sizeof(m_address.ip_v4));
+    else
+        memcpy(&m_address.ip_v6, preferred, sizeof(m_address.ip_v6));
+    m_addresses = move(addresses);
 }
 
 String Host::toString(bool forceAddress) const
@@ -185,27 +173,20 @@ String Host::toString(bool forceAddress) const
     String address;
     if (forceAddress) {
         char buffer[128];
-#ifdef _WIN32
-		void *addr;
+		const void *addr;
 		// Get the pointer to the address itself, different fields in IPv4 and IPv6
-		if (m_address.any.sa_family == AF_INET) {
-			struct sockaddr_in *ipv4 = (struct sockaddr_in *) &m_address;
-			addr = &(ipv4->sin_addr);
-		} else {
-			struct sockaddr_in6 *ipv6 = (struct sockaddr_in6 *) &m_address;
-			addr = &(ipv6->sin6_addr);
-		}
+		if (m_address.any.sa_family == AF_INET)
+			addr = &m_address.ip_v4.sin_addr;
+		else
+			addr = &m_address.ip_v6.sin6_addr;
 		if (inet_ntop(m_address.any.sa_family, addr, buffer, sizeof(buffer) - 1) == nullptr)
-#else
-		if (inet_ntop(m_address.any.sa_family, &m_address, buffer, sizeof(buffer) - 1) == nullptr)
-#endif
             throw SystemException("Can't print IP address");
         address = buffer;
     } else {
         address = m_hostname;
     }
 
-    if (m_address.any.sa_family == AF_INET6 && m_hostname.find(':') != std::string::npos)
+    if (m_address.any.sa_family == AF_INET6 && address.find(':') != std::string::npos && address[0] != '[')
         str << "[" << address << "]:" << m_port;
     else
         str << address << ":" << m_port;
@@ -235,6 +216,23 @@ TEST(SPTK_Host, ctorAddress)
     Host host("11.22.33.44", 22);
     EXPECT_STREQ("11.22.33.44", host.hostname().c_str());
     EXPECT_EQ(22, host.port());
+    EXPECT_STREQ("11.22.33.44:22", host.toString(true).c_str());
+}
+
+TEST(SPTK_Host, ipv6)
+{
+    Host host("[::1]:8080");
+    EXPECT_STREQ("[::1]", host.hostname().c_str());
+    EXPECT_STREQ("[::1]:8080", host.toString(true).c_str());
+
+    sockaddr_in6 address = {};
+    host.getAddress(address);
+    EXPECT_EQ(AF_INET6, address.sin6_family);
+    EXPECT_EQ(8080, ntohs(address.sin6_port));
+
+    auto addresses = host.addresses();
+    ASSERT_EQ(size_t(1), addresses.size());
+    EXPECT_EQ(8080, ntohs(((sockaddr_in6*) &addresses[0])->sin6_port));
 }
 
 #endif
@@ -0,0 +1,423 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       HttpClientPool.cpp - description                       ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/net/HttpClientPool.h>
+#include <sptk5/net/SSLSocket.h>
+#include <thread>
+
+using namespace std;
+using namespace sptk;
+
+namespace {
+
+class HttpRequestTask : public Runable
+{
+    HttpClientPool&         m_pool;
+    const std::atomic_bool& m_poolClosing;
+    Host                    m_host;
+    bool                    m_https;
+    HttpClientPool::Request m_request;
+    promise<int>            m_result;
+    atomic_bool             m_completed {false};
+
+protected:
+    void run() override
+    {
+        try {
+            if (m_poolClosing)
+                throw Exception("HTTP client pool is destroyed");
+            AutoHttpConnection connection(m_pool, m_host, m_https);
+            m_result.set_value(m_request(connection.http()));
+        }
+        catch (...) {
+            m_result.set_exception(current_exception());
+        }
+        m_completed = true;
+    }
+
+public:
+    HttpRequestTask(HttpClientPool& pool, const std::atomic_bool& poolClosing, const Host& host, bool https,
+                    const HttpClientPool::Request& request)
+    : m_pool(pool), m_poolClosing(poolClosing), m_host(host), m_https(https), m_request(request)
+    {
+    }
+
+    future<int> result()
+    {
+        return m_result.get_future();
+    }
+
+    bool completed() const
+    {
+        return m_completed;
+    }
+
+    /**
+     * Fails the task that wasn't executed
+     */
+    void cancel()
+    {
+        m_result.set_exception(make_exception_ptr(Exception("HTTP client pool is destroyed")));
+        m_completed = true;
+    }
+};
+
+}
+
+HttpClientPool::HttpClientPool(size_t maxConnectionsPerHost, chrono::milliseconds idleTimeout,
+                               chrono::milliseconds connectTimeout)
+: m_maxConnectionsPerHost(maxConnectionsPerHost == 0 ? 1 : maxConnectionsPerHost),
+  m_idleTimeout(idleTimeout),
+  m_connectTimeout(connectTimeout)
+{
+}
+
+HttpClientPool::~HttpClientPool()
+{
+    // Queued tasks that start after this point fail without executing request.
+    // Stopping thread pool waits only for running tasks, the rest of the queue is dropped.
+    m_closing = true;
+    if (m_threadPool)
+        m_threadPool->stop();
+    m_threadPool.reset();
+
+    for (auto& task: m_tasks) {
+        auto* requestTask = (HttpRequestTask*) task.get();
+        if (!requestTask->completed())
+            requestTask->cancel();
+    }
+    m_tasks.clear();
+
+    lock_guard<mutex> lock(m_mutex);
+    for (auto& itor: m_hosts) {
+        for (auto* connection: itor.second.idle)
+            delete connection;
+    }
+    m_hosts.clear();
+}
+
+String HttpClientPool::key(const Host& host, bool https)
+{
+    return (https ? "https://" : "http://") + host.toString(false).toLowerCase();
+}
+
+bool HttpClientPool::stale(const Connection& connection, chrono::steady_clock::time_point now) const
+{
+    if (!connection.socket->active() || now - connection.idleSince >= m_idleTimeout)
+        return true;
+    // Idle connection becomes readable only if server closed it, or sent unexpected data
+    return connection.socket->readyToRead(chrono::milliseconds(0));
+}
+
+HttpClientPool::Connection* HttpClientPool::openConnection(const Host& host, bool https, const String& key)
+{
+    auto* connection = new Connection;
+    connection->key = key;
+    try {
+        if (https)
+            connection->socket.reset(new SSLSocket);
+        else
+            connection->socket.reset(new TCPSocket);
+        connection->socket->open(host, BaseSocket::SOM_CONNECT, true, m_connectTimeout);
+    }
+    catch (...) {
+        closeConnection(connection);
+        throw;
+    }
+    return connection;
+}
+
+void HttpClientPool::closeConnection(Connection* connection)
+{
+    String key = move(connection->key);
+    delete connection;
+
+    lock_guard<mutex> lock(m_mutex);
+    auto itor = m_hosts.find(key);
+    if (itor != m_hosts.end())
+        itor->second.connections--;
+    m_connectionReleased.notify_all();
+}
+
+HttpClientPool::Connection* HttpClientPool::getConnection(const Host& host, bool https, chrono::milliseconds timeout)
+{
+    String poolKey = key(host, https);
+    auto deadline = chrono::steady_clock::now() + timeout;
+
+    for (;;) {
+        Connection* connection;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            auto& hostConnections = m_hosts[poolKey];
+            while (hostConnections.idle.empty()) {
+                if (hostConnections.connections < m_maxConnectionsPerHost) {
+                    hostConnections.connections++;
+                    lock.unlock();
+                    return openConnection(host, https, poolKey);
+                }
+
+                if (m_connectionReleased.wait_until(lock, deadline) == cv_status::timeout && hostConnections.idle.empty() &&
+                    hostConnections.connections >= m_maxConnectionsPerHost)
+                    throw TimeoutException("Timeout waiting for connection to " + poolKey);
+            }
+            connection = hostConnections.idle.back();
+            hostConnections.idle.pop_back();
+        }
+
+        // Connection taken from the pool is checked, and closed if stale, without blocking other callers
+        if (!stale(*connection, chrono::steady_clock::now())) {
+            connection->reuses++;
+            return connection;
+        }
+        closeConnection(connection);
+    }
+}
+
+void HttpClientPool::releaseConnection(Connection* connection, bool reusable)
+{
+    if (!reusable || !connection->socket->active()) {
+        closeConnection(connection);
+        return;
+    }
+
+    lock_guard<mutex> lock(m_mutex);
+    connection->idleSince = chrono::steady_clock::now();
+    m_hosts[connection->key].idle.push_back(connection);
+    m_connectionReleased.notify_all();
+}
+
+future<int> HttpClientPool::submit(const Host& host, bool https, const Request& request)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    // Remove completed tasks
+    for (auto itor = m_tasks.begin(); itor != m_tasks.end();) {
+        if (((HttpRequestTask*) itor->get())->completed()) {
+            (*itor)->waitCompleted();
+            itor = m_tasks.erase(itor);
+        } else
+            ++itor;
+    }
+
+    if (!m_threadPool)
+        m_threadPool.reset(new ThreadPool(uint32_t(m_maxConnectionsPerHost * 4), chrono::seconds(60), "HttpClientPool"));
+
+    auto* task = new HttpRequestTask(*this, m_closing, host, https, request);
+    m_tasks.emplace_back(task);
+    auto result = task->result();
+    m_threadPool->execute(task);
+    return result;
+}
+
+size_t HttpClientPool::idleConnections() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    size_t count = 0;
+    for (auto& itor: m_hosts)
+        count += itor.second.idle.size();
+    return count;
+}
+
+size_t HttpClientPool::connections(const Host& host, bool https) const
+{
+    lock_guard<mutex> lock(m_mutex);
+    auto itor = m_hosts.find(key(host, https));
+    if (itor == m_hosts.end())
+        return 0;
+    return itor->second.connections;
+}
+
+AutoHttpConnection::AutoHttpConnection(HttpClientPool& pool, const Host& host, bool https)
+: m_pool(pool), m_connection(pool.getConnection(host, https))
+{
+    m_http.reset(new HttpConnect(*m_connection->socket));
+}
+
+AutoHttpConnection::~AutoHttpConnection()
+{
+    bool reusable = m_http->keepAlive();
+    m_http.reset();
+    m_pool.releaseConnection(m_connection, reusable);
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+#include <sptk5/test/TestListener.h>
+
+namespace {
+
+/**
+ * Minimal keep-alive HTTP server, counting accepted connections
+ */
+class TestHttpServer
+{
+    TestListener        m_listener;
+    std::thread         m_thread;
+    std::atomic<int>    m_connections {0};
+
+    void serve(SOCKET client)
+    {
+        string request;
+        char buffer[1024];
+        for (;;) {
+            auto bytes = ::recv(client, buffer, sizeof(buffer), 0);
+            if (bytes <= 0)
+                break;
+            request.append(buffer, size_t(bytes));
+            size_t headEnd;
+            while ((headEnd = request.find("\r\n\r\n")) != string::npos) {
+                request.erase(0, headEnd + 4);
+                const char* response = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nHello";
+                ::send(client, response, strlen(response), 0);
+            }
+        }
+        ::close(client);
+    }
+
+    void acceptConnections()
+    {
+        vector<std::thread> clients;
+        for (;;) {
+            SOCKET client;
+            try {
+                client = m_listener.accept();
+            }
+            catch (const TimeoutException&) {
+                continue;
+            }
+            catch (const Exception&) {
+                // Listener is shut down
+                break;
+            }
+            m_connections++;
+            clients.emplace_back(&TestHttpServer::serve, this, client);
+        }
+        for (auto& client: clients)
+            client.join();
+    }
+
+public:
+    TestHttpServer()
+    {
+        m_thread = std::thread(&TestHttpServer::acceptConnections, this);
+    }
+
+    ~TestHttpServer()
+    {
+        m_listener.shutdown();
+        m_thread.join();
+    }
+
+    Host host() const
+    {
+        return m_listener.host();
+    }
+
+    int connections() const
+    {
+        return m_connections;
+    }
+};
+
+}
+
+TEST(SPTK_HttpClientPool, keepAlive)
+{
+    TestHttpServer server;
+    Host host(server.host());
+    HttpClientPool pool(2);
+
+    for (int i = 0; i < 3; i++) {
+        AutoHttpConnection connection(pool, host);
+        Buffer output;
+        EXPECT_EQ(200, connection->cmd_get("/", HttpParams(), output));
+        EXPECT_STREQ("Hello", output.c_str());
+        EXPECT_EQ(i != 0, connection.reused());
+    }
+
+    EXPECT_EQ(1, server.connections());
+    EXPECT_EQ(size_t(1), pool.idleConnections());
+    EXPECT_EQ(size_t(1), pool.connections(host));
+}
+
+TEST(SPTK_HttpClientPool, submit)
+{
+    TestHttpServer server;
+    Host host(server.host());
+    HttpClientPool pool(2);
+
+    vector<future<int>> results;
+    for (int i = 0; i < 8; i++) {
+        results.push_back(pool.submit(host, false, [](HttpConnect& http) {
+            Buffer output;
+            return http.cmd_get("/", HttpParams(), output);
+        }));
+    }
+
+    for (auto& result: results)
+        EXPECT_EQ(200, result.get());
+
+    EXPECT_LE(server.connections(), 2);
+    EXPECT_LE(pool.connections(host), size_t(2));
+}
+
+TEST(SPTK_HttpClientPool, destroyWithQueuedRequests)
+{
+    TestHttpServer server;
+    Host host(server.host());
+
+    vector<future<int>> results;
+    DateTime started = DateTime::Now();
+    {
+        // Thread pool executes four requests at a time, the rest are queued
+        HttpClientPool pool(1);
+        for (int i = 0; i < 12; i++) {
+            results.push_back(pool.submit(host, false, [](HttpConnect& http) {
+                this_thread::sleep_for(chrono::milliseconds(100));
+                Buffer output;
+                return http.cmd_get("/", HttpParams(), output);
+            }));
+        }
+    }
+    EXPECT_LT(DateTime::Now() - started, chrono::seconds(3));
+
+    // Requests that were not executed fail
+    size_t failed = 0;
+    for (auto& result: results) {
+        ASSERT_EQ(future_status::ready, result.wait_for(chrono::seconds(0)));
+        try {
+            EXPECT_EQ(200, result.get());
+        }
+        catch (const Exception&) {
+            failed++;
+        }
+    }
+    EXPECT_GT(failed, size_t(0));
+}
+
+#endif
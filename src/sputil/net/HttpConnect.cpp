@@ -30,6 +30,7 @@
 #include <sptk5/net/HttpConnect.h>
 
 #include <sptk5/ZLib.h>
+#include <sptk5/json/JsonDocument.h>
 
 using namespace std;
 using namespace sptk;
@@ -145,6 +146,40 @@ int HttpConnect::cmd_post(const sptk::String& pageName, const HttpParams& parame
     return getResponse(output, timeout);
 }
 
+int HttpConnect::cmd_post(const sptk::String& pageName, const HttpParams& parameters, const json::Document& content,
+                          json::Document& output, bool messagePack, std::chrono::milliseconds timeout)
+{
+    Buffer postData;
+    if (messagePack)
+        content.exportMessagePack(postData);
+    else
+        content.exportTo(postData, false);
+
+    // Content type headers only apply to this request
+    HttpHeaders savedHeaders(m_requestHeaders);
+    const char* contentType = messagePack ? json::MessagePack::ContentType : "application/json";
+    m_requestHeaders["Content-Type"] = contentType;
+    m_requestHeaders["Accept"] = contentType;
+
+    Buffer response;
+    int statusCode;
+    try {
+        statusCode = cmd_post(pageName, parameters, postData, false, response, timeout);
+    }
+    catch (...) {
+        m_requestHeaders = move(savedHeaders);
+        throw;
+    }
+    m_requestHeaders = move(savedHeaders);
+
+    if (json::MessagePack::isContentType(responseHeader("Content-Type")))
+        output.loadMessagePack(move(response));
+    else
+        output.load(response);
+
+    return statusCode;
+}
+
 int HttpConnect::cmd_put(const sptk::String& pageName, const HttpParams& requestParameters, const Buffer& putData,
                          Buffer& output, std::chrono::milliseconds timeout)
 {
@@ -178,6 +213,11 @@ int HttpConnect::cmd_delete(const sptk::String& pageName, const HttpParams& requ
     return getResponse(output, timeout);
 }
 
+bool HttpConnect::keepAlive() const
+{
+    return m_socket.active() && (!m_reader || m_reader->getReaderState() == HttpReader::COMPLETED);
+}
+
 int HttpConnect::statusCode() const
 {
     return m_reader->getStatusCode();
@@ -190,6 +230,7 @@ String HttpConnect::statusText() const
 
 #if USE_GTEST
 #include <gtest/gtest.h>
+#include <sptk5/test/TestListener.h>
 
 TEST(SPTK_HttpConnect, get)
 {
@@ -218,4 +259,69 @@ TEST(SPTK_HttpConnect, get)
 	delete socket;
 }
 
+TEST(SPTK_HttpConnect, postJsonHeaders)
+{
+    TestListener listener;
+
+    // Serve two requests on one connection, storing request headers
+    vector<String> requests;
+    thread server([&listener, &requests]() {
+        SOCKET client = listener.accept();
+        string data;
+        char buffer[1024];
+        while (requests.size() < 2) {
+            size_t headEnd = data.find("\r\n\r\n");
+            if (headEnd == string::npos) {
+                auto bytes = ::recv(client, buffer, sizeof(buffer), 0);
+                if (bytes <= 0)
+                    break;
+                data.append(buffer, size_t(bytes));
+                continue;
+            }
+            String head(data.substr(0, headEnd));
+            size_t contentLength = 0;
+            size_t pos = head.toLowerCase().find("content-length: ");
+            if (pos != string::npos)
+                contentLength = (size_t) string2int(head.substr(pos + 16));
+            if (data.length() < headEnd + 4 + contentLength) {
+                auto bytes = ::recv(client, buffer, sizeof(buffer), 0);
+                if (bytes <= 0)
+                    break;
+                data.append(buffer, size_t(bytes));
+                continue;
+            }
+            data.erase(0, headEnd + 4 + contentLength);
+            requests.push_back(head);
+            const char* response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 11\r\n\r\n{\"ok\":true}";
+            ::send(client, response, strlen(response), 0);
+        }
+        ::close(client);
+    });
+
+    TCPSocket socket;
+    socket.open(listener.host());
+    HttpConnect http(socket);
+    http.requestHeaders()["Accept"] = "text/plain";
+
+    json::Document request;
+    request.root()["name"] = "test";
+    json::Document response;
+    EXPECT_EQ(200, http.cmd_post("/", HttpParams(), request, response));
+    EXPECT_TRUE(response.root().getBoolean("ok"));
+
+    // Content type headers of JSON request aren't left for the next requests
+    EXPECT_EQ(size_t(1), http.requestHeaders().size());
+    EXPECT_STREQ("text/plain", http.requestHeaders()["Accept"].c_str());
+
+    Buffer output;
+    EXPECT_EQ(200, http.cmd_get("/", HttpParams(), output));
+
+    server.join();
+
+    ASSERT_EQ(size_t(2), requests.size());
+    EXPECT_NE(string::npos, requests[0].find("Content-Type: application/json"));
+    EXPECT_EQ(string::npos, requests[1].find("Content-Type"));
+    EXPECT_NE(string::npos, requests[1].find("Accept: text/plain"));
+}
+
 #endif
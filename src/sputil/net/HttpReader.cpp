@@ -29,7 +29,6 @@
 #include <sptk5/sptk.h>
 #include <sptk5/net/TCPSocket.h>
 #include <sptk5/ZLib.h>
-#include <thread>
 #include "sptk5/net/HttpReader.h"
 
 using namespace std;
@@ -40,195 +39,266 @@ HttpReader::HttpReader(Buffer& output)
   m_statusCode(0),
   m_contentLength(0),
   m_contentReceivedLength(0),
-  m_currentChunkSize(0),
-  m_contentIsChunked(false),
-  m_matchProtocolAndResponseCode("^(HTTP/1.\\d)\\s+(\\d+)\\s+(\\S.*)?\r"),
+  m_remaining(0),
+  m_dataState(IDENTITY),
   m_output(output)
 {
     output.reset(128);
 }
 
-bool HttpReader::readStatus(TCPSocket& socket)
-{
-    string status;
-    while (socket.readLine(status) < 3) {
-        if (status.empty())
-            return false;
-        socket.readyToRead(chrono::seconds(1));
-    }
+HttpReader::~HttpReader() = default;
 
-    Strings matches;
-    if (!m_matchProtocolAndResponseCode.m(status, matches)) {
-        m_readerState = READ_ERROR;
-        throw Exception("Broken HTTP version header: [" + status + "]");
+void HttpReader::appendContent(const char* data, size_t size)
+{
+#if HAVE_ZLIB
+    if (m_decompressor) {
+        m_decompressor->write(m_output, data, size);
+        return;
     }
-    m_statusCode = string2int(matches[1]);
-    if (matches.size() > 2)
-        m_statusText = matches[2];
-
-    return true;
+#endif
+    m_output.append(data, size);
 }
 
-bool HttpReader::readHeaders(TCPSocket& socket)
+void HttpReader::readError(const String& message)
 {
-    /// Reading HTTP headers
-    Strings matches;
-    for (;;) {
-        string header;
-
-        socket.readLine(header);
-
-        if (header.empty())
-            return false;
+    m_readerState = READ_ERROR;
+    throw Exception(message);
+}
 
-        size_t pos = header.find(':');
-        if (pos != string::npos) {
-            m_responseHeaders[lowerCase(header.substr(0, pos))] = trim(header.substr(pos + 1));
+size_t HttpReader::processData(const char* data, size_t size)
+{
+    size_t consumed = 0;
+
+    while (m_readerState < COMPLETED) {
+        const char* position = data + consumed;
+        size_t available = size - consumed;
+
+        if (m_readerState == READING_DATA &&
+            (m_dataState == IDENTITY || m_dataState == UNTIL_CLOSE || m_dataState == CHUNK_DATA)) {
+            if (available == 0)
+                break;
+            size_t bytes = available;
+            if (m_dataState != UNTIL_CLOSE && bytes > m_remaining)
+                bytes = m_remaining;
+            appendContent(position, bytes);
+            consumed += bytes;
+            contentReceived(bytes);
             continue;
         }
 
-        if (header[0] == '\r')
+        auto* lineEnd = (const char*) memchr(position, '\n', available);
+        if (lineEnd == nullptr) {
+            if (available > MaxLineLength)
+                readError("HTTP response line is too long");
             break;
+        }
+
+        auto length = size_t(lineEnd - position);
+        consumed += length + 1;
+        if (length != 0 && position[length - 1] == '\r')
+            length--;
+        processLine(position, length);
     }
 
-    m_contentLength = 0;
-    m_contentIsChunked = false;
+    return consumed;
+}
 
-    auto itor = m_responseHeaders.find("content-length");
-    if (itor != m_responseHeaders.end())
-        m_contentLength = (size_t) string2int(itor->second);
+void HttpReader::processLine(const char* line, size_t length)
+{
+    switch (m_readerState) {
+        case READY:
+            // Empty lines before status line are ignored
+            if (length != 0) {
+                parseStatus(line, length);
+                m_readerState = READING_HEADERS;
+            }
+            break;
 
-    itor = m_responseHeaders.find("transfer-encoding");
-    if (itor != m_responseHeaders.end())
-        m_contentIsChunked = itor->second.find("chunked") != string::npos;
+        case READING_HEADERS:
+            if (length == 0)
+                headersCompleted();
+            else
+                parseHeader(line, length);
+            break;
 
-    m_contentReceivedLength = 0;
-    m_currentChunkSize = 0;
+        case READING_DATA:
+            switch (m_dataState) {
+                case CHUNK_SIZE:
+                    parseChunkSize(line, length);
+                    break;
+                case CHUNK_DATA_END:
+                    if (length != 0)
+                        readError("Invalid chunk data end");
+                    m_dataState = CHUNK_SIZE;
+                    break;
+                case TRAILERS:
+                    if (length == 0)
+                        complete();
+                    else
+                        parseHeader(line, length);
+                    break;
+                default:
+                    break;
+            }
+            break;
 
-    return true;
+        default:
+            break;
+    }
 }
 
-bool HttpReader::readData(TCPSocket& socket)
+void HttpReader::parseStatus(const char* line, size_t length)
 {
-    if (!socket.readyToRead(chrono::seconds(10)))
-        throw TimeoutException("Connection timeout");
-    auto readBytes = (int) socket.socketBytes();
-    if (readBytes == 0) {
-        if (m_contentLength != 0)
-            throw Exception("Server closed connection");
-        return true; // Server closed connection
+    // HTTP-version SP status-code SP reason-phrase
+    const char* end = line + length;
+    auto* space = (const char*) memchr(line, ' ', length);
+    if (length < 12 || strncmp(line, "HTTP/1.", 7) != 0 || space == nullptr || end - space < 4)
+        readError("Broken HTTP version header: [" + String(line, length) + "]");
+
+    const char* code = space + 1;
+    int statusCode = 0;
+    for (int i = 0; i < 3; i++) {
+        if (code[i] < '0' || code[i] > '9')
+            readError("Broken HTTP version header: [" + String(line, length) + "]");
+        statusCode = statusCode * 10 + (code[i] - '0');
     }
+    m_statusCode = statusCode;
 
-    while (socket.readyToRead(chrono::seconds(10))) {
-        size_t bytesToRead;
-        if (m_contentLength > 0) {
-            bytesToRead = m_contentLength - m_contentReceivedLength;
-            if (bytesToRead == 0)
-                return true;
-        } else {
-            bytesToRead = socket.socketBytes();
-        }
+    const char* text = code + 3;
+    while (text < end && *text == ' ')
+        text++;
+    m_statusText.assign(text, size_t(end - text));
+}
 
-        if (!m_contentIsChunked) {
-            if (readBytes > (int) bytesToRead) // 0 bytes case is a workaround for OpenSSL
-                readBytes = (int) bytesToRead;
-            if (!socket.readyToRead(chrono::seconds(30)))
-                throw TimeoutException("Read timeout");
-            readBytes = (int) socket.read(m_read_buffer, (size_t) readBytes);
-            if (readBytes == 0) // 0 bytes case is a workaround for OpenSSL
-                readBytes = (int) socket.read(m_read_buffer, (size_t) readBytes);
-            m_output.append(m_read_buffer);
-            m_contentReceivedLength += readBytes;
-            if (m_contentLength > 0 && m_contentReceivedLength >= m_contentLength) // No more data
-                return true;
-        } else {
-            if (m_currentChunkSize == 0) {
-                // Starting next chunk
-                String chunkSizeStr;
-                while (chunkSizeStr.empty()) {
-                    if (socket.readLine(chunkSizeStr) == 0) {
-                        this_thread::sleep_for(chrono::milliseconds(10));
-                        continue;
-                    }
-                    chunkSizeStr = trim(chunkSizeStr);
-                }
-
-                errno = 0;
-                m_currentChunkSize = (size_t) strtol(chunkSizeStr.c_str(), nullptr, 16);
-                if (errno != 0)
-                    throw Exception("Strange chunk size: '" + chunkSizeStr + "'");
-
-                if (m_currentChunkSize == 0)
-                    return true; // Last chunk
-            }
+void HttpReader::parseHeader(const char* line, size_t length)
+{
+    auto* colon = (const char*) memchr(line, ':', length);
+    if (colon == nullptr || colon == line)
+        readError("Invalid HTTP header: [" + String(line, length) + "]");
+
+    const char* value = colon + 1;
+    const char* valueEnd = line + length;
+    while (value < valueEnd && (*value == ' ' || *value == '\t'))
+        value++;
+    while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t'))
+        valueEnd--;
+
+    m_responseHeaders[String(line, size_t(colon - line))].assign(value, size_t(valueEnd - value));
+}
 
-            m_output.checkSize(m_output.bytes() + m_currentChunkSize + 16384);
-            char* appendPtr = m_output.data() + m_output.bytes();
-            if (!socket.readyToRead(chrono::seconds(30)))
-                throw TimeoutException("Read timeout");
-            readBytes = (int) socket.read(appendPtr, m_currentChunkSize, nullptr);
-            if (readBytes > 0) {
-                m_contentReceivedLength += readBytes;
-                appendPtr[readBytes] = 0;
-                m_currentChunkSize = 0;
-                m_output.bytes(m_output.bytes() + readBytes);
-                return false; // Not the last chunk
-            }
-        }
-        readBytes = (int) socket.socketBytes();
-        if (readBytes == 0 && m_output.bytes() > 13) {
-            size_t tailOffset = m_output.bytes() - 13;
-			String tail(m_output.c_str() + tailOffset);
-            if (tail.toLowerCase().find("</html>") != string::npos)
-				break;
-            if (!socket.readyToRead(chrono::seconds(30)))
-                throw TimeoutException("Read timeout");
-            readBytes = (int) socket.socketBytes();
-        }
+void HttpReader::parseChunkSize(const char* line, size_t length)
+{
+    size_t chunkSize = 0;
+    size_t i = 0;
+    for (; i < length; i++) {
+        char ch = line[i];
+        unsigned digit;
+        if (ch >= '0' && ch <= '9')
+            digit = unsigned(ch - '0');
+        else if (ch >= 'a' && ch <= 'f')
+            digit = unsigned(ch - 'a' + 10);
+        else if (ch >= 'A' && ch <= 'F')
+            digit = unsigned(ch - 'A' + 10);
+        else
+            break;
+        if (i >= 15)
+            break;
+        chunkSize = chunkSize * 16 + digit;
     }
-    return true;
+
+    // Chunk extensions are ignored
+    if (i == 0 || (i < length && line[i] != ';' && line[i] != ' ' && line[i] != '\t'))
+        readError("Strange chunk size: '" + String(line, length) + "'");
+
+    m_remaining = chunkSize;
+    m_dataState = chunkSize != 0 ? CHUNK_DATA : TRAILERS;
 }
 
-void HttpReader::read(TCPSocket& socket)
+void HttpReader::headersCompleted()
 {
-    lock_guard<mutex> lock(m_mutex);
-
-    if (m_readerState == READY) {
-        m_output.bytes(0);
+    if (m_statusCode >= 100 && m_statusCode < 200 && m_statusCode != 101) {
+        // Interim response, such as 100 Continue: the final response follows
         m_responseHeaders.clear();
         m_statusCode = 0;
         m_statusText = "";
-        if (!readStatus(socket))
-            throw Exception("Can't read server response");
-        m_readerState = READING_HEADERS;
-        m_contentReceivedLength = 0;
+        m_readerState = READY;
+        return;
     }
 
-    if (m_readerState == READING_HEADERS) {
-        if (!readHeaders(socket))
-            return;
-        m_readerState = READING_DATA;
-    }
+    m_readerState = READING_DATA;
+    m_contentLength = 0;
+    m_contentReceivedLength = 0;
+    m_remaining = 0;
 
-    if (m_readerState == READING_DATA) {
-        if (!readData(socket))
-            return;
+    bool contentIsChunked = false;
+    auto itor = m_responseHeaders.find("Transfer-Encoding");
+    if (itor != m_responseHeaders.end())
+        contentIsChunked = itor->second.toLowerCase().find("chunked") != string::npos;
+
+    bool hasContentLength = false;
+    itor = m_responseHeaders.find("Content-Length");
+    if (itor != m_responseHeaders.end() && !contentIsChunked) {
+        // Content-Length is 1*DIGIT (RFC 7230, 3.3.2): signs, spaces, or garbage aren't accepted
+        String contentLength = trim(itor->second);
+        if (contentLength.empty() || contentLength.length() > 18)
+            readError("Invalid Content-Length: '" + itor->second + "'");
+        for (char ch: contentLength) {
+            if (ch < '0' || ch > '9')
+                readError("Invalid Content-Length: '" + itor->second + "'");
+            m_contentLength = m_contentLength * 10 + size_t(ch - '0');
+        }
+        hasContentLength = true;
     }
 
-    auto itor = m_responseHeaders.find("content-encoding");
-    if (itor != m_responseHeaders.end() && itor->second == "gzip") {
 #if HAVE_ZLIB
-        Buffer unzipBuffer;
-        ZLib::decompress(unzipBuffer, m_output);
-        *(Buffer*)this = move(unzipBuffer);
+    m_decompressor.reset();
+#endif
+    itor = m_responseHeaders.find("Content-Encoding");
+    if (itor != m_responseHeaders.end() && (itor->second == "gzip" || itor->second == "deflate")) {
+#if HAVE_ZLIB
+        // Content is decompressed as it arrives, rather than after it's received completely
+        m_decompressor = make_unique<ZLibStream>(ZLibStream::DECOMPRESS, ZLibStream::AUTO);
 #else
-        throw Exception("Content-Encoding is 'gzip', but zlib support is not enabled in SPTK");
+        readError("Content-Encoding is '" + itor->second + "', but zlib support is not enabled in SPTK");
 #endif
     }
 
-    itor = m_responseHeaders.find("Connection");
-    if (itor != m_responseHeaders.end() && itor->second == "close")
-        socket.close();
+    if (m_statusCode == 101 || m_statusCode == 204 || m_statusCode == 304)
+        complete();                 // No content
+    else if (contentIsChunked)
+        m_dataState = CHUNK_SIZE;
+    else if (hasContentLength) {
+        m_dataState = IDENTITY;
+        m_remaining = m_contentLength;
+        if (m_remaining == 0)
+            complete();
+    }
+    else
+        m_dataState = UNTIL_CLOSE;
+}
+
+void HttpReader::contentReceived(size_t size)
+{
+    m_contentReceivedLength += size;
+    if (m_dataState == UNTIL_CLOSE)
+        return;
+    m_remaining -= size;
+    if (m_remaining == 0) {
+        if (m_dataState == IDENTITY)
+            complete();
+        else
+            m_dataState = CHUNK_DATA_END;
+    }
+}
+
+void HttpReader::complete()
+{
+#if HAVE_ZLIB
+    if (m_decompressor) {
+        m_decompressor->finish(m_output);
+        m_decompressor.reset();
+    }
+#endif
 
     if (m_statusCode >= 400) {
         if (m_statusText.empty()) {
@@ -242,6 +312,86 @@ void HttpReader::read(TCPSocket& socket)
     m_readerState = COMPLETED;
 }
 
+void HttpReader::endOfData()
+{
+    if (m_readerState == READING_DATA && m_dataState == UNTIL_CLOSE)
+        complete();
+    else if (m_readerState < COMPLETED)
+        readError(m_readerState == READY ? "Can't read server response" : "Server closed connection");
+}
+
+size_t HttpReader::directReadSize() const
+{
+    if (m_readerState != READING_DATA)
+        return 0;
+#if HAVE_ZLIB
+    if (m_decompressor)
+        return 0;
+#endif
+    switch (m_dataState) {
+        case IDENTITY:
+        case CHUNK_DATA:
+            return m_remaining < MaxDirectReadSize ? m_remaining : MaxDirectReadSize;
+        case UNTIL_CLOSE:
+            return MaxDirectReadSize;
+        default:
+            return 0;
+    }
+}
+
+void HttpReader::processBuffered(TCPSocketReader& reader)
+{
+    if (reader.availableBytes() != 0)
+        reader.consume(processData(reader.readPosition(), reader.availableBytes()));
+}
+
+void HttpReader::read(TCPSocket& socket)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    TCPSocketReader& reader = socket.reader();
+
+    processBuffered(reader);
+
+    if (m_readerState < COMPLETED) {
+        size_t received;
+        size_t directSize = directReadSize();
+        if (directSize != 0 && reader.availableBytes() == 0) {
+            // Content is received directly into output buffer
+            size_t bytes = m_output.bytes();
+            m_output.checkSize(bytes + directSize + 1);
+            received = reader.readSome(m_output.data() + bytes, directSize);
+            m_output.bytes(bytes + received);
+            m_output.data()[bytes + received] = 0;
+            if (received != 0)
+                contentReceived(received);
+        } else {
+            received = reader.readMore();
+            processBuffered(reader);
+        }
+        if (received == 0)
+            endOfData();
+    }
+
+    if (m_readerState == COMPLETED) {
+        auto itor = m_responseHeaders.find("Connection");
+        if (itor != m_responseHeaders.end() && itor->second.toLowerCase() == "close")
+            socket.close();
+    }
+}
+
+size_t HttpReader::feed(const char* data, size_t size)
+{
+    lock_guard<mutex> lock(m_mutex);
+    return processData(data, size);
+}
+
+void HttpReader::connectionClosed()
+{
+    lock_guard<mutex> lock(m_mutex);
+    endOfData();
+}
+
 const HttpHeaders& HttpReader::getResponseHeaders() const
 {
     lock_guard<mutex> lock(m_mutex);
@@ -270,8 +420,128 @@ String HttpReader::responseHeader(const String& headerName) const
 {
     lock_guard<mutex> lock(m_mutex);
 
-    auto itor = m_responseHeaders.find(lowerCase(headerName));
+    auto itor = m_responseHeaders.find(headerName);
     if (itor == m_responseHeaders.end())
         return "";
     return itor->second;
 }
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_HttpReader, feedContentLength)
+{
+    const char* response =
+        "HTTP/1.1 100 Continue\r\n\r\n"
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 12\r\n"
+        "\r\n"
+        "Hello, World";
+
+    Buffer output;
+    HttpReader reader(output);
+
+    // Feed the response in small pieces, passing unconsumed data again
+    string pending;
+    for (const char* ptr = response; *ptr != 0; ptr += 5) {
+        pending.append(ptr, strnlen(ptr, 5));
+        pending.erase(0, reader.feed(pending.c_str(), pending.length()));
+    }
+
+    EXPECT_EQ(HttpReader::COMPLETED, reader.getReaderState());
+    EXPECT_EQ(200, reader.getStatusCode());
+    EXPECT_STREQ("OK", reader.getStatusText().c_str());
+    EXPECT_STREQ("text/plain", reader.responseHeader("content-type").c_str());
+    EXPECT_STREQ("Hello, World", output.c_str());
+}
+
+TEST(SPTK_HttpReader, feedInvalidContentLength)
+{
+    for (const char* contentLength: {"-1", "12abc", "", "1 2", "1234567890123456789"}) {
+        String response = String("HTTP/1.1 200 OK\r\nContent-Length: ") + contentLength + "\r\n\r\nHello, World";
+        Buffer output;
+        HttpReader reader(output);
+        EXPECT_THROW(reader.feed(response.c_str(), response.length()), Exception) << contentLength;
+        EXPECT_EQ(HttpReader::READ_ERROR, reader.getReaderState()) << contentLength;
+    }
+}
+
+TEST(SPTK_HttpReader, feedChunked)
+{
+    const char* response =
+        "HTTP/1.1 404 \r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5;name=value\r\nHello\r\n"
+        "7\r\n, World\r\n"
+        "0\r\n"
+        "Checksum: none\r\n"
+        "\r\n";
+
+    Buffer output;
+    HttpReader reader(output);
+    EXPECT_EQ(strlen(response), reader.feed(response, strlen(response)));
+    EXPECT_EQ(HttpReader::COMPLETED, reader.getReaderState());
+    EXPECT_EQ(404, reader.getStatusCode());
+    EXPECT_STREQ("Unknown client error", reader.getStatusText().c_str());
+    EXPECT_STREQ("none", reader.responseHeader("Checksum").c_str());
+    EXPECT_STREQ("Hello, World", output.c_str());
+
+    Buffer output2;
+    HttpReader reader2(output2);
+    EXPECT_THROW(reader2.feed("HTTP/1.1 OK\r\n", 13), Exception);
+    EXPECT_EQ(HttpReader::READ_ERROR, reader2.getReaderState());
+}
+
+TEST(SPTK_HttpReader, feedUntilClose)
+{
+    const char* response = "HTTP/1.0 200 OK\r\n\r\n<html></html>";
+
+    Buffer output;
+    HttpReader reader(output);
+    EXPECT_EQ(strlen(response), reader.feed(response, strlen(response)));
+    EXPECT_EQ(HttpReader::READING_DATA, reader.getReaderState());
+    reader.connectionClosed();
+    EXPECT_EQ(HttpReader::COMPLETED, reader.getReaderState());
+    EXPECT_STREQ("<html></html>", output.c_str());
+}
+
+#if HAVE_ZLIB
+TEST(SPTK_HttpReader, feedGzipChunked)
+{
+    Buffer content;
+    for (int i = 0; i < 1000; i++)
+        content.append("Line " + int2string(i) + "\n");
+    Buffer compressed;
+    ZLib::compress(compressed, content);
+
+    // Split compressed content into chunks of 1000 bytes
+    Buffer response("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nContent-Encoding: gzip\r\n\r\n");
+    for (size_t offset = 0; offset < compressed.bytes(); offset += 1000) {
+        size_t chunkSize = min(size_t(1000), compressed.bytes() - offset);
+        char chunkHeader[16];
+        snprintf(chunkHeader, sizeof(chunkHeader), "%zx\r\n", chunkSize);
+        response.append(chunkHeader);
+        response.append(compressed.c_str() + offset, chunkSize);
+        response.append("\r\n", 2);
+    }
+    response.append("0\r\n\r\n", 5);
+
+    Buffer output;
+    HttpReader reader(output);
+    size_t consumed = 0;
+    for (size_t end = 700; consumed < response.bytes(); end += 700) {
+        if (end > response.bytes())
+            end = response.bytes();
+        consumed += reader.feed(response.c_str() + consumed, end - consumed);
+        if (end == response.bytes())
+            break;
+    }
+    EXPECT_EQ(HttpReader::COMPLETED, reader.getReaderState());
+    EXPECT_EQ(content.bytes(), output.bytes());
+    EXPECT_STREQ(content.c_str(), output.c_str());
+}
+#endif
+
+#endif
@@ -0,0 +1,504 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       HttpRequestParser.cpp - description                    ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/net/HttpRequestParser.h>
+#include <cstring>
+
+using namespace std;
+using namespace sptk;
+
+namespace {
+
+/// Maximum length of chunk size line, including chunk extensions
+constexpr size_t MaxChunkLineLength = 1024;
+
+bool equalsNoCase(string_view str, const char* pattern, size_t patternLength)
+{
+    return str.length() == patternLength && strncasecmp(str.data(), pattern, patternLength) == 0;
+}
+
+bool isSpace(char ch)
+{
+    return ch == ' ' || ch == '\t';
+}
+
+}
+
+void HttpRequestParser::reset()
+{
+    m_state = REQUEST_LINE;
+    m_data = nullptr;
+    m_scanOffset = 0;
+    m_method = m_url = m_version = Span();
+    m_headers.clear();
+    m_contentLength = 0;
+    m_remaining = 0;
+    m_bodySize = 0;
+    m_chunked = false;
+    m_transferEncoding = false;
+    m_otherCodings = false;
+    m_expectContinue = false;
+}
+
+size_t HttpRequestParser::parseHead(const char* data, size_t length)
+{
+    m_data = data;
+
+    while (m_state <= HEADERS) {
+        auto* lineStart = data + m_scanOffset;
+        auto* lineEnd = (const char*) memchr(lineStart, '\n', length - m_scanOffset);
+        if (lineEnd == nullptr) {
+            if (length > MaxHeadSize)
+                throw Exception("HTTP request head is too large");
+            return 0;
+        }
+
+        size_t start = m_scanOffset;
+        size_t end = size_t(lineEnd - data);
+        m_scanOffset = end + 1;
+        if (m_scanOffset > MaxHeadSize)
+            throw Exception("HTTP request head is too large");
+        if (end > start && data[end - 1] == '\r')
+            end--;
+
+        if (m_state == REQUEST_LINE) {
+            // Empty lines before request line should be ignored (RFC 7230, 3.5)
+            if (end == start)
+                continue;
+            parseRequestLine(start, end);
+            m_state = HEADERS;
+        }
+        else if (end == start)
+            headParsed();
+        else
+            parseHeaderLine(start, end);
+    }
+
+    return m_scanOffset;
+}
+
+void HttpRequestParser::parseRequestLine(size_t start, size_t end)
+{
+    auto* line = m_data + start;
+    size_t length = end - start;
+
+    auto* methodEnd = (const char*) memchr(line, ' ', length);
+    if (methodEnd == nullptr || methodEnd == line)
+        throw Exception("Invalid HTTP request line");
+
+    auto* url = methodEnd + 1;
+    auto* urlEnd = (const char*) memchr(url, ' ', size_t(line + length - url));
+    if (urlEnd == nullptr || urlEnd == url)
+        throw Exception("Invalid HTTP request line");
+
+    auto* version = urlEnd + 1;
+    size_t versionLength = size_t(line + length - version);
+    if (versionLength < 6 || strncmp(version, "HTTP/", 5) != 0)
+        throw Exception("Invalid HTTP request line");
+
+    m_method = { uint32_t(start), uint32_t(methodEnd - line) };
+    m_url = { uint32_t(url - m_data), uint32_t(urlEnd - url) };
+    m_version = { uint32_t(version - m_data), uint32_t(versionLength) };
+}
+
+void HttpRequestParser::parseHeaderLine(size_t start, size_t end)
+{
+    auto* line = m_data + start;
+    auto* lineEnd = m_data + end;
+
+    if (isSpace(*line))
+        throw Exception("Obsolete HTTP header line folding isn't supported");
+
+    auto* colon = (const char*) memchr(line, ':', end - start);
+    if (colon == nullptr || colon == line || isSpace(colon[-1]))
+        throw Exception("Invalid HTTP header");
+
+    auto* value = colon + 1;
+    while (value < lineEnd && isSpace(*value))
+        value++;
+    auto* valueEnd = lineEnd;
+    while (valueEnd > value && isSpace(valueEnd[-1]))
+        valueEnd--;
+
+    HeaderSpan headerSpan;
+    headerSpan.name = { uint32_t(start), uint32_t(colon - line) };
+    headerSpan.value = { uint32_t(value - m_data), uint32_t(valueEnd - value) };
+    m_headers.push_back(headerSpan);
+
+    string_view name = view(headerSpan.name);
+    string_view headerValue = view(headerSpan.value);
+    switch (name.length()) {
+        case 6:
+            if (equalsNoCase(name, "Expect", 6))
+                m_expectContinue = equalsNoCase(headerValue, "100-continue", 12);
+            break;
+        case 14:
+            if (equalsNoCase(name, "Content-Length", 14)) {
+                if (headerValue.empty() || headerValue.length() > 18)
+                    throw Exception("Invalid Content-Length");
+                size_t contentLength = 0;
+                for (char ch: headerValue) {
+                    if (ch < '0' || ch > '9')
+                        throw Exception("Invalid Content-Length");
+                    contentLength = contentLength * 10 + size_t(ch - '0');
+                }
+                m_contentLength = contentLength;
+            }
+            break;
+        case 17:
+            if (equalsNoCase(name, "Transfer-Encoding", 17))
+                parseTransferEncoding(headerValue);
+            break;
+        default:
+            break;
+    }
+}
+
+void HttpRequestParser::parseTransferEncoding(string_view value)
+{
+    // Multiple Transfer-Encoding headers form a single list of transfer codings.
+    // Chunked must be applied once, and must be the last transfer coding (RFC 7230, 3.3.1)
+    m_transferEncoding = true;
+    while (!value.empty()) {
+        auto separator = value.find(',');
+        string_view coding = value.substr(0, separator);
+        value.remove_prefix(separator == string_view::npos ? value.length() : separator + 1);
+
+        // Transfer coding parameters are ignored
+        coding = coding.substr(0, coding.find(';'));
+        while (!coding.empty() && isSpace(coding.front()))
+            coding.remove_prefix(1);
+        while (!coding.empty() && isSpace(coding.back()))
+            coding.remove_suffix(1);
+        if (coding.empty())
+            continue;
+
+        if (m_chunked)
+            throw HTTPException(400, "Chunked transfer coding isn't the last one");
+        m_chunked = equalsNoCase(coding, "chunked", 7);
+        if (!m_chunked)
+            m_otherCodings = true;
+    }
+}
+
+void HttpRequestParser::headParsed()
+{
+    if (m_transferEncoding) {
+        // Otherwise request body length can't be determined (RFC 7230, 3.3.3)
+        if (!m_chunked)
+            throw HTTPException(400, "Chunked transfer coding isn't the last one");
+        if (m_otherCodings)
+            throw HTTPException(501, "Unsupported transfer coding");
+    }
+
+    if (m_chunked) {
+        // Transfer-Encoding overrides Content-Length (RFC 7230, 3.3.3)
+        m_contentLength = 0;
+        m_state = CHUNK_SIZE;
+    }
+    else if (m_contentLength != 0) {
+        if (m_contentLength > m_maxBodySize)
+            throw HTTPException(413, "HTTP request body is too large");
+        m_remaining = m_contentLength;
+        m_state = BODY;
+    }
+    else
+        m_state = COMPLETE;
+}
+
+HttpRequestParser::Header HttpRequestParser::header(size_t index) const
+{
+    const auto& headerSpan = m_headers[index];
+    return { view(headerSpan.name), view(headerSpan.value) };
+}
+
+string_view HttpRequestParser::header(string_view name) const
+{
+    for (const auto& headerSpan: m_headers) {
+        if (headerSpan.name.length == name.length() &&
+            strncasecmp(m_data + headerSpan.name.offset, name.data(), name.length()) == 0)
+            return view(headerSpan.value);
+    }
+    return string_view();
+}
+
+void HttpRequestParser::exportHeaders(HttpHeaders& headers) const
+{
+    for (const auto& headerSpan: m_headers) {
+        String name(m_data + headerSpan.name.offset, size_t(headerSpan.name.length));
+        headers[name].assign(m_data + headerSpan.value.offset, headerSpan.value.length);
+    }
+}
+
+size_t HttpRequestParser::parseBody(const char* data, size_t length, Buffer& body)
+{
+    size_t consumed = 0;
+
+    while (consumed < length && m_state != COMPLETE) {
+        auto* position = data + consumed;
+        size_t available = length - consumed;
+
+        switch (m_state) {
+            case BODY:
+            case CHUNK_DATA: {
+                size_t bytes = available < m_remaining ? available : m_remaining;
+                body.append(position, bytes);
+                consumed += bytes;
+                m_remaining -= bytes;
+                if (m_remaining == 0)
+                    m_state = m_state == BODY ? COMPLETE : CHUNK_DATA_END;
+                break;
+            }
+
+            case CHUNK_SIZE: {
+                auto* lineEnd = (const char*) memchr(position, '\n', available);
+                if (lineEnd == nullptr) {
+                    if (available > MaxChunkLineLength)
+                        throw Exception("Invalid chunk size");
+                    return consumed;
+                }
+                size_t chunkSize = 0;
+                auto* ptr = position;
+                for (; ptr < lineEnd; ptr++) {
+                    char ch = *ptr;
+                    unsigned digit;
+                    if (ch >= '0' && ch <= '9')
+                        digit = unsigned(ch - '0');
+                    else if (ch >= 'a' && ch <= 'f')
+                        digit = unsigned(ch - 'a' + 10);
+                    else if (ch >= 'A' && ch <= 'F')
+                        digit = unsigned(ch - 'A' + 10);
+                    else
+                        break;
+                    if (ptr - position >= 15)
+                        throw Exception("Invalid chunk size");
+                    chunkSize = chunkSize * 16 + digit;
+                }
+                // Chunk extensions are ignored
+                if (ptr == position || (ptr < lineEnd && *ptr != ';' && *ptr != '\r' && !isSpace(*ptr)))
+                    throw Exception("Invalid chunk size");
+                if (chunkSize > m_maxBodySize - m_bodySize)
+                    throw HTTPException(413, "HTTP request body is too large");
+                m_bodySize += chunkSize;
+                consumed += size_t(lineEnd - position) + 1;
+                m_remaining = chunkSize;
+                m_state = chunkSize != 0 ? CHUNK_DATA : TRAILERS;
+                break;
+            }
+
+            case CHUNK_DATA_END:
+                if (*position == '\r') {
+                    if (available < 2)
+                        return consumed;
+                    if (position[1] != '\n')
+                        throw Exception("Invalid chunk data end");
+                    consumed += 2;
+                }
+                else if (*position == '\n')
+                    consumed++;
+                else
+                    throw Exception("Invalid chunk data end");
+                m_state = CHUNK_SIZE;
+                break;
+
+            case TRAILERS: {
+                // Trailer headers are skipped
+                auto* lineEnd = (const char*) memchr(position, '\n', available);
+                if (lineEnd == nullptr) {
+                    if (available > MaxHeadSize)
+                        throw Exception("HTTP request trailer is too large");
+                    return consumed;
+                }
+                bool emptyLine = lineEnd == position || (lineEnd == position + 1 && *position == '\r');
+                consumed += size_t(lineEnd - position) + 1;
+                if (emptyLine)
+                    m_state = COMPLETE;
+                break;
+            }
+
+            default:
+                throw Exception("HTTP request head isn't parsed yet");
+        }
+    }
+
+    return consumed;
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+static const char* gtestHttpRequest =
+    "POST /api/login HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "Content-Type:  application/json \r\n"
+    "Content-Length: 13\r\n"
+    "\r\n"
+    "{\"id\":\"1234\"}";
+
+TEST(SPTK_HttpRequestParser, parseHead)
+{
+    HttpRequestParser parser;
+    size_t headLength = parser.parseHead(gtestHttpRequest, strlen(gtestHttpRequest));
+    EXPECT_EQ(strstr(gtestHttpRequest, "{") - gtestHttpRequest, (long) headLength);
+    EXPECT_EQ(HttpRequestParser::BODY, parser.state());
+    EXPECT_EQ("POST", parser.method());
+    EXPECT_EQ("/api/login", parser.url());
+    EXPECT_EQ("HTTP/1.1", parser.version());
+    EXPECT_EQ(size_t(3), parser.headerCount());
+    EXPECT_EQ("Host", parser.header(0).name);
+    EXPECT_EQ("application/json", parser.header("content-type"));
+    EXPECT_EQ(size_t(13), parser.contentLength());
+    EXPECT_FALSE(parser.expectContinue());
+
+    HttpHeaders headers;
+    parser.exportHeaders(headers);
+    EXPECT_STREQ("localhost:8080", headers["HOST"].c_str());
+
+    Buffer body;
+    const char* bodyData = gtestHttpRequest + headLength;
+    EXPECT_EQ(size_t(13), parser.parseBody(bodyData, strlen(bodyData), body));
+    EXPECT_TRUE(parser.complete());
+    EXPECT_STREQ("{\"id\":\"1234\"}", body.c_str());
+}
+
+TEST(SPTK_HttpRequestParser, parsePartial)
+{
+    HttpRequestParser parser;
+    string request(gtestHttpRequest);
+
+    // Feed the request one byte at a time, moving data into a new buffer each time
+    size_t headLength = 0;
+    for (size_t length = 1; length <= request.length() && headLength == 0; length++) {
+        string data(request.c_str(), length);
+        headLength = parser.parseHead(data.c_str(), data.length());
+        if (headLength != 0) {
+            EXPECT_EQ("/api/login", parser.url());
+            EXPECT_EQ("localhost:8080", parser.header("Host"));
+        }
+    }
+    EXPECT_EQ(HttpRequestParser::BODY, parser.state());
+
+    parser.reset();
+    EXPECT_THROW(parser.parseHead("GET /\r\n\r\n", 9), Exception);
+    parser.reset();
+    EXPECT_THROW(parser.parseHead("GET / HTTP/1.1\r\nHost : x\r\n\r\n", 28), Exception);
+}
+
+TEST(SPTK_HttpRequestParser, chunked)
+{
+    const char* request =
+        "POST /upload HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "Expect: 100-Continue\r\n"
+        "\r\n";
+    const char* chunks = "5;name=value\r\nHello\r\n7\r\n, World\r\n0\r\nChecksum: none\r\n\r\n";
+
+    HttpRequestParser parser;
+    EXPECT_EQ(strlen(request), parser.parseHead(request, strlen(request)));
+    EXPECT_TRUE(parser.chunked());
+    EXPECT_TRUE(parser.expectContinue());
+    EXPECT_EQ(HttpRequestParser::CHUNK_SIZE, parser.state());
+
+    // Feed chunks in small pieces, passing unconsumed data again
+    Buffer body;
+    string pending;
+    for (const char* ptr = chunks; *ptr != 0 && !parser.complete(); ptr += 3) {
+        pending.append(ptr, strnlen(ptr, 3));
+        size_t consumed = parser.parseBody(pending.c_str(), pending.length(), body);
+        pending.erase(0, consumed);
+    }
+    EXPECT_TRUE(parser.complete());
+    EXPECT_TRUE(pending.empty());
+    EXPECT_STREQ("Hello, World", body.c_str());
+
+    parser.reset();
+    EXPECT_EQ(strlen(request), parser.parseHead(request, strlen(request)));
+    EXPECT_THROW(parser.parseBody("xyz\r\n", 5, body), Exception);
+}
+
+static size_t transferEncodingStatus(const String& transferEncoding)
+{
+    String request = "POST /upload HTTP/1.1\r\n" + transferEncoding + "\r\n\r\n";
+    HttpRequestParser parser;
+    try {
+        parser.parseHead(request.c_str(), request.length());
+    }
+    catch (const HTTPException& e) {
+        return e.statusCode();
+    }
+    return parser.chunked() && parser.state() == HttpRequestParser::CHUNK_SIZE ? 200 : 0;
+}
+
+TEST(SPTK_HttpRequestParser, transferEncoding)
+{
+    EXPECT_EQ(size_t(200), transferEncodingStatus("Transfer-Encoding: Chunked"));
+    EXPECT_EQ(size_t(200), transferEncodingStatus("Transfer-Encoding: , chunked "));
+
+    // Body length can't be determined
+    EXPECT_EQ(size_t(400), transferEncodingStatus("Transfer-Encoding: gzip"));
+    EXPECT_EQ(size_t(400), transferEncodingStatus("Transfer-Encoding: chunked, gzip"));
+    EXPECT_EQ(size_t(400), transferEncodingStatus("Transfer-Encoding: chunked, chunked"));
+    EXPECT_EQ(size_t(400), transferEncodingStatus("Transfer-Encoding: chunked\r\nTransfer-Encoding: chunked"));
+    EXPECT_EQ(size_t(400), transferEncodingStatus("Transfer-Encoding: "));
+
+    // Only chunked transfer coding is supported
+    EXPECT_EQ(size_t(501), transferEncodingStatus("Transfer-Encoding: gzip, chunked"));
+    EXPECT_EQ(size_t(501), transferEncodingStatus("Transfer-Encoding: gzip\r\nTransfer-Encoding: chunked"));
+}
+
+TEST(SPTK_HttpRequestParser, maxBodySize)
+{
+    HttpRequestParser parser;
+    parser.setMaxBodySize(10);
+
+    const char* request = "POST / HTTP/1.1\r\nContent-Length: 11\r\n\r\n";
+    try {
+        parser.parseHead(request, strlen(request));
+        FAIL() << "Request body exceeds maximum size";
+    }
+    catch (const HTTPException& e) {
+        EXPECT_EQ(size_t(413), e.statusCode());
+    }
+
+    parser.reset();
+    EXPECT_EQ(size_t(10), parser.maxBodySize());
+    request = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    parser.parseHead(request, strlen(request));
+    Buffer body;
+    const char* chunks = "5\r\nHello\r\n5\r\nWorld\r\n1\r\n!\r\n0\r\n\r\n";
+    try {
+        parser.parseBody(chunks, strlen(chunks), body);
+        FAIL() << "Request body exceeds maximum size";
+    }
+    catch (const HTTPException& e) {
+        EXPECT_EQ(size_t(413), e.statusCode());
+    }
+    EXPECT_STREQ("HelloWorld", body.c_str());
+}
+
+#endif
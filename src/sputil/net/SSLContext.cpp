@@ -32,6 +32,10 @@
 
 // This include must be after SSLContext.h, or it breaks Windows compilation
 #include <openssl/err.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
 #include <sptk5/Buffer.h>
 
 using namespace std;
@@ -42,7 +46,8 @@ static int s_server_session_id_context = 1;
 void SSLContext::throwError(const String& humanDescription)
 {
     unsigned long error = ERR_get_error();
-    string errorStr = ERR_func_error_string(error) + string("(): ") + ERR_reason_error_string(error);
+    char errorStr[256] = {};
+    ERR_error_string_n(error, errorStr, sizeof(errorStr));
     throwException(humanDescription + "\n" + errorStr);
 }
 
@@ -52,11 +57,18 @@ SSLContext::SSLContext()
     SSL_CTX_set_cipher_list(m_ctx, "ALL");
     SSL_CTX_set_mode(m_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE);
     SSL_CTX_set_session_id_context(m_ctx, (const unsigned char*) &s_server_session_id_context, sizeof s_server_session_id_context);
+
+    // Server sessions are cached internally, client sessions are cached by host in m_clientSessions
+    SSL_CTX_set_app_data(m_ctx, this);
+    SSL_CTX_set_session_cache_mode(m_ctx, SSL_SESS_CACHE_BOTH);
+    SSL_CTX_sess_set_new_cb(m_ctx, newSessionCallback);
 }
 
 SSLContext::~SSLContext()
 {
     UniqueLock(*this);
+    for (auto& itor: m_clientSessionList)
+        SSL_SESSION_free(itor.second);
     SSL_CTX_free(m_ctx);
 }
 
@@ -103,3 +115,190 @@ void SSLContext::loadKeys(const String& privateKeyFileName, const String& certif
     SSL_CTX_set_verify(m_ctx, verifyMode, nullptr);
     SSL_CTX_set_verify_depth(m_ctx, verifyDepth);
 }
+
+void SSLContext::setSessionCache(size_t cacheSize, chrono::seconds timeout)
+{
+    UniqueLock(*this);
+    SSL_CTX_sess_set_cache_size(m_ctx, long(cacheSize));
+    SSL_CTX_set_timeout(m_ctx, long(timeout.count()));
+}
+
+void SSLContext::setSessionTickets(bool enable)
+{
+    UniqueLock(*this);
+    if (enable)
+        SSL_CTX_clear_options(m_ctx, SSL_OP_NO_TICKET);
+    else
+        SSL_CTX_set_options(m_ctx, SSL_OP_NO_TICKET);
+}
+
+void SSLContext::generateTicketKey()
+{
+    TicketKey key {};
+    if (RAND_bytes(key.name, sizeof(key.name)) != 1 || RAND_bytes(key.hmacKey, sizeof(key.hmacKey)) != 1 ||
+        RAND_bytes(key.aesKey, sizeof(key.aesKey)) != 1)
+        throwError("Can't generate session ticket key");
+
+    m_ticketKeys[1] = m_hasTicketKeys ? m_ticketKeys[0] : key;
+    m_ticketKeys[0] = key;
+    m_ticketKeyCreated = chrono::steady_clock::now();
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    if (!m_hasTicketKeys)
+        SSL_CTX_set_tlsext_ticket_key_evp_cb(m_ctx, ticketKeyCallback);
+#else
+    // Older OpenSSL: only the current key is used, tickets encrypted with the previous key require full handshake
+    unsigned char keys[80];
+    memcpy(keys, key.name, 16);
+    memcpy(keys + 16, key.hmacKey, 32);
+    memcpy(keys + 48, key.aesKey, 32);
+    SSL_CTX_set_tlsext_ticket_keys(m_ctx, keys, sizeof(keys));
+#endif
+    m_hasTicketKeys = true;
+}
+
+void SSLContext::setTicketKeyRotation(chrono::seconds interval)
+{
+    UniqueLock(*this);
+    lock_guard<mutex> lock2(m_sessionMutex);
+    m_ticketKeyLifetime = interval;
+    if (!m_hasTicketKeys)
+        generateTicketKey();
+}
+
+void SSLContext::rotateTicketKeys()
+{
+    UniqueLock(*this);
+    lock_guard<mutex> lock2(m_sessionMutex);
+    generateTicketKey();
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+int SSLContext::ticketKeyCallback(SSL* ssl, unsigned char keyName[16], unsigned char* iv, EVP_CIPHER_CTX* cipherContext,
+                                  EVP_MAC_CTX* macContext, int encrypt)
+{
+    auto* context = (SSLContext*) SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+    lock_guard<mutex> lock(context->m_sessionMutex);
+
+    int rc = 1;
+    const TicketKey* key = &context->m_ticketKeys[0];
+    if (encrypt != 0) {
+        if (context->m_ticketKeyLifetime.count() != 0 &&
+            chrono::steady_clock::now() - context->m_ticketKeyCreated >= context->m_ticketKeyLifetime)
+        {
+            try {
+                context->generateTicketKey();
+            }
+            catch (...) {
+                return -1;
+            }
+        }
+        memcpy(keyName, key->name, sizeof(key->name));
+        if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1 ||
+            EVP_EncryptInit_ex(cipherContext, EVP_aes_256_cbc(), nullptr, key->aesKey, iv) != 1)
+            return -1;
+    } else {
+        if (memcmp(keyName, key->name, sizeof(key->name)) != 0) {
+            key = &context->m_ticketKeys[1];
+            if (memcmp(keyName, key->name, sizeof(key->name)) != 0)
+                return 0;   // Unknown key: full handshake
+            rc = 2;         // Previous key: ticket is accepted, and renewed
+        }
+#ifdef TLS1_3_VERSION
+        // TLS 1.3 client uses a ticket once, so it needs a new ticket for the next resumption
+        if (SSL_version(ssl) >= TLS1_3_VERSION)
+            rc = 2;
+#endif
+        if (EVP_DecryptInit_ex(cipherContext, EVP_aes_256_cbc(), nullptr, key->aesKey, iv) != 1)
+            return -1;
+    }
+
+    char digest[] = "SHA256";
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, (void*) key->hmacKey, sizeof(key->hmacKey)),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+        OSSL_PARAM_construct_end()
+    };
+    if (EVP_MAC_CTX_set_params(macContext, params) != 1)
+        return -1;
+
+    return rc;
+}
+#endif
+
+int SSLContext::newSessionCallback(SSL* ssl, SSL_SESSION* session)
+{
+    // Only client connections define session key
+    auto* sessionKey = (const String*) SSL_get_app_data(ssl);
+    if (sessionKey == nullptr || sessionKey->empty())
+        return 0;
+
+    auto* context = (SSLContext*) SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+    lock_guard<mutex> lock(context->m_sessionMutex);
+    if (context->m_clientSessionCacheSize == 0)
+        return 0;
+
+    auto itor = context->m_clientSessions.find(*sessionKey);
+    if (itor != context->m_clientSessions.end()) {
+        auto& clientSession = itor->second;
+        SSL_SESSION_free(clientSession->second);
+        clientSession->second = session;
+        context->m_clientSessionList.splice(context->m_clientSessionList.begin(), context->m_clientSessionList, clientSession);
+    } else {
+        if (context->m_clientSessions.size() >= context->m_clientSessionCacheSize)
+            context->evictClientSession();
+        context->m_clientSessionList.emplace_front(*sessionKey, session);
+        context->m_clientSessions[*sessionKey] = context->m_clientSessionList.begin();
+    }
+
+    return 1;   // Session reference is kept
+}
+
+void SSLContext::evictClientSession()
+{
+    auto& victim = m_clientSessionList.back();
+    SSL_SESSION_free(victim.second);
+    m_clientSessions.erase(victim.first);
+    m_clientSessionList.pop_back();
+}
+
+void SSLContext::setClientSessionCacheSize(size_t cacheSize)
+{
+    lock_guard<mutex> lock(m_sessionMutex);
+    m_clientSessionCacheSize = cacheSize;
+    while (m_clientSessions.size() > cacheSize)
+        evictClientSession();
+}
+
+SSL_SESSION* SSLContext::getClientSession(const String& sessionKey)
+{
+    lock_guard<mutex> lock(m_sessionMutex);
+    auto itor = m_clientSessions.find(sessionKey);
+    if (itor == m_clientSessions.end())
+        return nullptr;
+
+    auto clientSession = itor->second;
+    SSL_SESSION* session = clientSession->second;
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    if (SSL_SESSION_is_resumable(session) == 0) {
+        SSL_SESSION_free(session);
+        m_clientSessionList.erase(clientSession);
+        m_clientSessions.erase(itor);
+        return nullptr;
+    }
+#endif
+    m_clientSessionList.splice(m_clientSessionList.begin(), m_clientSessionList, clientSession);
+    SSL_SESSION_up_ref(session);
+    return session;
+}
+
+void SSLContext::removeClientSession(const String& sessionKey)
+{
+    lock_guard<mutex> lock(m_sessionMutex);
+    auto itor = m_clientSessions.find(sessionKey);
+    if (itor != m_clientSessions.end()) {
+        SSL_SESSION_free(itor->second->second);
+        m_clientSessionList.erase(itor->second);
+        m_clientSessions.erase(itor);
+    }
+}
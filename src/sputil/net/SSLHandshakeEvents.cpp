@@ -0,0 +1,175 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       SSLHandshakeEvents.cpp - description                   ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/net/SSLHandshakeEvents.h>
+
+using namespace std;
+using namespace sptk;
+
+SSLHandshakeEvents::SSLHandshakeEvents(chrono::milliseconds timeout)
+: Thread("SSL handshakes"), m_socketPool(eventCallback), m_timeout(timeout)
+{
+    run();
+}
+
+SSLHandshakeEvents::~SSLHandshakeEvents()
+{
+    terminate();
+    join();
+    failHandshakes(false, "SSL handshake is interrupted");
+    m_socketPool.close();
+}
+
+void SSLHandshakeEvents::add(SSLSocket& socket, Callback callback)
+{
+    SSLSocket::HandshakeStatus status;
+    try {
+        status = socket.handshake();
+    }
+    catch (const Exception& e) {
+        callback(socket, e.message());
+        return;
+    }
+
+    if (status == SSLSocket::HANDSHAKE_COMPLETED) {
+        callback(socket, "");
+        return;
+    }
+
+    auto* handshake = new Handshake { &socket, callback, DateTime::Now() + m_timeout,
+                                      status == SSLSocket::HANDSHAKE_WANT_WRITE, this };
+
+    unique_lock<mutex> lock(m_mutex);
+    try {
+        m_socketPool.watchSocket(socket, handshake);
+        m_handshakes.insert(handshake);
+        if (handshake->watchWrite)
+            m_socketPool.watchWrite(socket, true);
+    }
+    catch (const Exception& e) {
+        forget(handshake);
+        lock.unlock();
+        notify(handshake, e.message());
+    }
+}
+
+size_t SSLHandshakeEvents::size()
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_handshakes.size();
+}
+
+void SSLHandshakeEvents::eventCallback(void* userData, SocketEventType eventType)
+{
+    auto* handshake = (Handshake*) userData;
+    handshake->owner->processEvent(handshake, eventType);
+}
+
+void SSLHandshakeEvents::processEvent(Handshake* handshake, SocketEventType eventType)
+{
+    String error;
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        if (eventType == ET_CONNECTION_CLOSED)
+            error = "Connection closed during SSL handshake";
+        else {
+            try {
+                SSLSocket::HandshakeStatus status = handshake->socket->handshake();
+                if (status != SSLSocket::HANDSHAKE_COMPLETED) {
+                    bool watchWrite = status == SSLSocket::HANDSHAKE_WANT_WRITE;
+                    if (handshake->watchWrite != watchWrite) {
+                        m_socketPool.watchWrite(*handshake->socket, watchWrite);
+                        handshake->watchWrite = watchWrite;
+                    }
+                    return;
+                }
+            }
+            catch (const Exception& e) {
+                error = e.message();
+            }
+        }
+
+        forget(handshake);
+    }
+
+    notify(handshake, error);
+}
+
+void SSLHandshakeEvents::forget(Handshake* handshake)
+{
+    m_handshakes.erase(handshake);
+    try {
+        m_socketPool.forgetSocket(*handshake->socket);
+    }
+    catch (const Exception& e) {
+        cerr << e.message() << endl;
+    }
+}
+
+void SSLHandshakeEvents::notify(Handshake* handshake, const String& error)
+{
+    try {
+        handshake->callback(*handshake->socket, error);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+    }
+    delete handshake;
+}
+
+void SSLHandshakeEvents::failHandshakes(bool expiredOnly, const String& error)
+{
+    vector<Handshake*> failed;
+    {
+        DateTime now = DateTime::Now();
+        lock_guard<mutex> lock(m_mutex);
+        for (auto* handshake: m_handshakes) {
+            if (!expiredOnly || handshake->expires < now)
+                failed.push_back(handshake);
+        }
+        for (auto* handshake: failed)
+            forget(handshake);
+    }
+
+    for (auto* handshake: failed)
+        notify(handshake, error);
+}
+
+void SSLHandshakeEvents::threadFunction()
+{
+    while (!terminated()) {
+        try {
+            m_socketPool.waitForEvents(chrono::milliseconds(100));
+            failHandshakes(true, "SSL handshake timeout");
+        }
+        catch (const Exception& e) {
+            cerr << e.message() << endl;
+        }
+    }
+}
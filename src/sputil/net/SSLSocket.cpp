@@ -119,8 +119,47 @@ mutex* CSSLLibraryLoader::m_locks;
 
 static CSSLLibraryLoader loader;
 
+#ifdef MSG_NOSIGNAL
+/**
+ * Writes to socket BIO with MSG_NOSIGNAL, same way as OpenSSL socket BIO writes
+ */
+static int socketWrite(BIO* bio, const char* data, int length)
+{
+    int socketHandle = -1;
+    BIO_get_fd(bio, &socketHandle);
+    errno = 0;
+    auto rc = (int) ::send(socketHandle, data, (size_t) length, MSG_NOSIGNAL);
+    BIO_clear_retry_flags(bio);
+    if (rc <= 0 && BIO_sock_should_retry(rc))
+        BIO_set_retry_write(bio);
+    return rc;
+}
+
+/**
+ * Socket BIO method that doesn't raise SIGPIPE, or nullptr if it can't be created
+ */
+static BIO_METHOD* socketMethod()
+{
+    static BIO_METHOD* method = []() {
+        const BIO_METHOD* socket = BIO_s_socket();
+        BIO_METHOD* noSignalSocket = BIO_meth_new(BIO_TYPE_SOCKET, "socket without SIGPIPE");
+        if (noSignalSocket != nullptr) {
+            BIO_meth_set_write(noSignalSocket, socketWrite);
+            BIO_meth_set_read(noSignalSocket, BIO_meth_get_read(socket));
+            BIO_meth_set_puts(noSignalSocket, BIO_meth_get_puts(socket));
+            BIO_meth_set_ctrl(noSignalSocket, BIO_meth_get_ctrl(socket));
+            BIO_meth_set_create(noSignalSocket, BIO_meth_get_create(socket));
+            BIO_meth_set_destroy(noSignalSocket, BIO_meth_get_destroy(socket));
+        }
+        return noSignalSocket;
+    }();
+    return method;
+}
+#endif
+
 void SSLSocket::throwSSLError(const String& function, int rc)
 {
+    m_sslFailed = true;
     int errorCode = SSL_get_error(m_ssl, rc);
     string error = getSSLError(function.c_str(), errorCode);
     throw Exception(error, __FILE__, __LINE__);
@@ -133,8 +172,10 @@ SSLSocket::SSLSocket()
 
 SSLSocket::~SSLSocket()
 {
-    if (m_ssl != nullptr)
+    if (m_ssl != nullptr) {
+        close();
         SSL_free(m_ssl);
+    }
 }
 
 void SSLSocket::loadKeys(const string& keyFileName, const string& certificateFileName, const string& password,
@@ -164,6 +205,10 @@ void SSLSocket::initContextAndSocket()
         SSL_free(m_ssl);
 
     m_ssl = SSL_new(m_sslContext->handle());
+    m_sslFailed = false;
+
+    // Used by SSL context to cache client sessions
+    SSL_set_app_data(m_ssl, &m_sessionKey);
 
     if (!m_sniHostName.empty()) {
         int rc = (int) SSL_set_tlsext_host_name(m_ssl, m_sniHostName.c_str());
@@ -172,99 +217,241 @@ void SSLSocket::initContextAndSocket()
     }
 }
 
-void SSLSocket::_open(const Host& host, CSocketOpenMode openMode, bool _blockingMode, chrono::milliseconds timeout)
+sockaddr_in SSLSocket::setHost(const Host& host)
 {
-    initContextAndSocket();
-
     if (!host.hostname().empty())
         m_host = host;
     if (m_host.hostname().empty())
         throw Exception("Please, define the host name", __FILE__, __LINE__);
 
     sockaddr_in addr = {};
-    host.getAddress(addr);
+    m_host.getAddress(addr);
 
-    _open(addr, openMode, _blockingMode, timeout);
+    m_sessionKey = m_host.toString(false);
+    if (!m_sniHostName.empty())
+        m_sessionKey += "/" + m_sniHostName;
+    m_sessionKeyFromHost = true;
+
+    return addr;
 }
 
-void SSLSocket::_open(const struct sockaddr_in& address, CSocketOpenMode openMode, bool _blockingMode, chrono::milliseconds timeout)
+void SSLSocket::_open(const Host& host, CSocketOpenMode openMode, bool _blockingMode, chrono::milliseconds timeout)
 {
-    DateTime started = DateTime::Now();
-    DateTime timeoutAt(started + timeout);
-    TCPSocket::_open(address, openMode, _blockingMode, timeout);
+    setHost(host);
+    try {
+        // Falls back to the next host address, if connection fails
+        TCPSocket::_open(m_host, openMode, _blockingMode, timeout);
+    }
+    catch (const Exception&) {
+        m_sessionKeyFromHost = false;
+        throw;
+    }
+    m_sessionKeyFromHost = false;
+}
+
+void SSLSocket::openConnection(const struct sockaddr_in& address, CSocketOpenMode openMode, chrono::milliseconds timeout)
+{
+    if (!m_sessionKeyFromHost) {
+        char addressStr[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &address.sin_addr, addressStr, sizeof(addressStr));
+        m_sessionKey = string(addressStr) + ":" + int2string(ntohs(address.sin_port));
+    }
+
+    initContextAndSocket();
+
+    TCPSocket::_open(address, openMode, true, timeout);
+
+    prepareConnect();
+}
+
+void SSLSocket::openConnection(const struct sockaddr_in6& address, CSocketOpenMode openMode, chrono::milliseconds timeout)
+{
+    if (!m_sessionKeyFromHost) {
+        char addressStr[INET6_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET6, &address.sin6_addr, addressStr, sizeof(addressStr));
+        m_sessionKey = "[" + string(addressStr) + "]:" + int2string(ntohs(address.sin6_port));
+    }
+
+    initContextAndSocket();
 
+    TCPSocket::_open(address, openMode, true, timeout);
+
+    prepareConnect();
+}
+
+void SSLSocket::prepareConnect()
+{
     lock_guard<mutex> lock(*this);
 
-    SSL_set_fd(m_ssl, (int) m_sockfd);
-/*
-    int rc = SSL_set1_host(m_ssl, m_host.hostname().c_str());
-    if (rc != 1)
-        throwSSLError("SSL_set1_host", rc);
-*/
-    if (timeout == chrono::milliseconds(0)) {
-        int rc = SSL_connect(m_ssl);
-        if (rc <= 0) {
-            close();
-            throwSSLError("SSL_connect", rc);
-        }
-        return;
+    attachSSL(m_sockfd);
+    SSL_set_connect_state(m_ssl);
+
+    // Resume the previous session with the same host, if any
+    SSL_SESSION* session = m_sslContext->getClientSession(m_sessionKey);
+    if (session != nullptr) {
+        SSL_set_session(m_ssl, session);
+        SSL_SESSION_free(session);
     }
+}
 
-    blockingMode(false);
-    while (true) {
-        int rc = SSL_connect(m_ssl);
-        if (rc == 1)
-            break;
-        if (rc <= 0) {
-            int errorCode = SSL_get_error(m_ssl, rc);
-            if (errorCode == SSL_ERROR_WANT_READ) {
+void SSLSocket::_open(const struct sockaddr_in& address, CSocketOpenMode openMode, bool _blockingMode, chrono::milliseconds timeout)
+{
+    DateTime timeoutAt(DateTime::Now() + timeout);
+
+    openConnection(address, openMode, timeout);
+
+    connectHandshake(timeoutAt, _blockingMode, timeout);
+}
+
+void SSLSocket::_open(const struct sockaddr_in6& address, CSocketOpenMode openMode, bool _blockingMode, chrono::milliseconds timeout)
+{
+    DateTime timeoutAt(DateTime::Now() + timeout);
+
+    openConnection(address, openMode, timeout);
+
+    connectHandshake(timeoutAt, _blockingMode, timeout);
+}
+
+void SSLSocket::connectHandshake(const DateTime& timeoutAt, bool _blockingMode, chrono::milliseconds timeout)
+{
+    try {
+        if (timeout == chrono::milliseconds(0)) {
+            handshake();
+            blockingMode(_blockingMode);
+            return;
+        }
+
+        blockingMode(false);
+        for (;;) {
+            HandshakeStatus status = handshake();
+            if (status == HANDSHAKE_COMPLETED)
+                break;
+            if (status == HANDSHAKE_WANT_READ) {
                 if (!readyToRead(timeoutAt))
-                    throw Exception("SSL handshake read timeout");
-                continue;
-            }
-            else if (errorCode == SSL_ERROR_WANT_WRITE) {
-                if (!readyToWrite(timeoutAt))
-                    throw Exception("SSL handshake write timeout");
-                continue;
+                    throw TimeoutException("SSL handshake read timeout");
             }
+            else if (!readyToWrite(timeoutAt))
+                throw TimeoutException("SSL handshake write timeout");
         }
-        throwSSLError("SSL_connect", rc);
+        blockingMode(_blockingMode);
+    }
+    catch (const Exception&) {
+        close();
+        throw;
     }
-    blockingMode(_blockingMode);
+}
+
+void SSLSocket::startConnect(const Host& host, chrono::milliseconds timeout)
+{
+    sockaddr_in addr = setHost(host);
+    openConnection(addr, SOM_CONNECT, timeout);
+    m_sessionKeyFromHost = false;
+    blockingMode(false);
 }
 
 void SSLSocket::close() noexcept
 {
+    // Orderly closed connection keeps its session resumable,
+    // while session of the connection that had SSL error is dropped
+    if (m_ssl != nullptr) {
+        if (!m_sslFailed && SSL_is_init_finished(m_ssl))
+            SSL_set_shutdown(m_ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        else if (m_sslFailed && !m_sessionKey.empty())
+            m_sslContext->removeClientSession(m_sessionKey);
+    }
     SSL_set_fd(m_ssl, -1);
     TCPSocket::close();
 }
 
-void SSLSocket::attach(SOCKET socketHandle)
+void SSLSocket::prepareAccept(SOCKET socketHandle)
 {
     lock_guard<mutex> lock(*this);
 
+    m_sessionKey.clear();
     initContextAndSocket();
 
-    int rc = 1;
-    if (m_sockfd != socketHandle) {
+    if (m_sockfd != socketHandle)
         TCPSocket::attach(socketHandle);
-        rc = SSL_set_fd(m_ssl, (int) socketHandle);
+
+    attachSSL(socketHandle);
+    SSL_set_accept_state(m_ssl);
+}
+
+void SSLSocket::attachSSL(SOCKET socketHandle)
+{
+#ifdef MSG_NOSIGNAL
+    BIO_METHOD* method = socketMethod();
+    if (method != nullptr) {
+        BIO* bio = BIO_new(method);
+        if (bio != nullptr) {
+            BIO_set_fd(bio, (int) socketHandle, BIO_NOCLOSE);
+            SSL_set_bio(m_ssl, bio, bio);
+            return;
+        }
     }
+#elif defined(SO_NOSIGPIPE)
+    int noSignal = 1;
+    setsockopt(socketHandle, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+#endif
+    SSL_set_fd(m_ssl, (int) socketHandle);
+}
 
-    if (rc > 0)
-        rc = SSL_accept(m_ssl);
+void SSLSocket::attach(SOCKET socketHandle)
+{
+    prepareAccept(socketHandle);
 
-    if (rc <= 0) {
-        int32_t errorCode = SSL_get_error(m_ssl, rc);
-        string error = getSSLError("SSL_accept", errorCode);
+    HandshakeStatus status = handshake();
 
-        // In non-blocking mode we may have incomplete read or write, so the function call should be repeated
-        if (errorCode == SSL_ERROR_WANT_READ || errorCode == SSL_ERROR_WANT_WRITE)
-            throw TimeoutException(error, __FILE__, __LINE__);
+    // In non-blocking mode we may have incomplete read or write, so the function call should be repeated
+    if (status != HANDSHAKE_COMPLETED) {
+        int errorCode = status == HANDSHAKE_WANT_READ ? SSL_ERROR_WANT_READ : SSL_ERROR_WANT_WRITE;
+        throw TimeoutException(getSSLError("SSL_accept", errorCode), __FILE__, __LINE__);
+    }
+}
 
-        // The serious problem - can't accept, and it's final
-        throw Exception(error, __FILE__, __LINE__);
+void SSLSocket::startAccept(SOCKET socketHandle)
+{
+    prepareAccept(socketHandle);
+    blockingMode(false);
+}
+
+SSLSocket::HandshakeStatus SSLSocket::handshake()
+{
+    lock_guard<mutex> lock(*this);
+
+    if (m_ssl == nullptr)
+        throw Exception("SSL socket isn't attached or connected");
+
+    int rc = SSL_do_handshake(m_ssl);
+    if (rc == 1) {
+        m_sslContext->handshakeCompleted(SSL_session_reused(m_ssl) != 0);
+        return HANDSHAKE_COMPLETED;
     }
+
+    int32_t errorCode = SSL_get_error(m_ssl, rc);
+    if (errorCode == SSL_ERROR_WANT_READ)
+        return HANDSHAKE_WANT_READ;
+    if (errorCode == SSL_ERROR_WANT_WRITE)
+        return HANDSHAKE_WANT_WRITE;
+
+    // The serious problem - can't complete handshake, and it's final
+    m_sslFailed = true;
+    bool server = SSL_is_server(m_ssl) != 0;
+    string error = getSSLError(server ? "SSL_accept" : "SSL_connect", errorCode);
+    if (!server)
+        m_sslContext->removeClientSession(m_sessionKey);
+
+    throw Exception(error, __FILE__, __LINE__);
+}
+
+bool SSLSocket::handshakePending() const
+{
+    return m_ssl != nullptr && m_sockfd != INVALID_SOCKET && !SSL_is_init_finished(m_ssl);
+}
+
+bool SSLSocket::sessionReused() const
+{
+    return m_ssl != nullptr && SSL_session_reused(m_ssl) != 0;
 }
 
 string SSLSocket::getSSLError(const string& function, int32_t openSSLError) const
@@ -292,7 +479,10 @@ string SSLSocket::getSSLError(const string& function, int32_t openSSLError) cons
             return error + "System call or protocol error";
     }
 
-    return error + ERR_func_error_string(unknownError) + string(": ") + ERR_reason_error_string(unknownError);
+    // Function and reason strings may be undefined, for instance function strings aren't defined in OpenSSL 3
+    char errorString[256];
+    ERR_error_string_n(unknownError, errorString, sizeof(errorString));
+    return error + errorString;
 }
 
 size_t SSLSocket::socketBytes()
@@ -309,23 +499,24 @@ size_t SSLSocket::socketBytes()
 
 size_t SSLSocket::recv(void* buffer, size_t size)
 {
-    int rc;
-    for (;;) {
-        rc = SSL_read(m_ssl, buffer, (int) size);
-        if (rc >= 0)
-            break;
-        int error = SSL_get_error(m_ssl, rc);
-        switch(error) {
-        case SSL_ERROR_WANT_READ:
-        case SSL_ERROR_WANT_WRITE:
-            break;
-        default:
-            close();
-            throwSSLError("SSL_read", rc);
-            break;
-        }
+    int rc = SSL_read(m_ssl, buffer, (int) size);
+    if (rc >= 0)
+        return (size_t) rc;
+
+    int error = SSL_get_error(m_ssl, rc);
+    switch(error) {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_WRITE:
+        // Non-blocking socket has no complete SSL record yet: report it as a plain socket would
+        errno = EAGAIN;
+        return size_t(-1);
+    default:
+        m_sslFailed = true;
+        close();
+        throwSSLError("SSL_read", rc);
+        break;
     }
-    return (size_t) rc;
+    return 0;
 }
 #define WRITE_BLOCK 16384
 
@@ -348,8 +539,424 @@ size_t SSLSocket::send(const void* buffer, size_t len)
             continue;
         }
         int32_t errorCode = SSL_get_error(m_ssl, rc);
-        if (errorCode != SSL_ERROR_WANT_READ && errorCode != SSL_ERROR_WANT_WRITE)
+        if (errorCode == SSL_ERROR_WANT_WRITE)
+            readyToWrite(chrono::seconds(1));
+        else if (errorCode == SSL_ERROR_WANT_READ)
+            BaseSocket::readyToRead(chrono::seconds(1));
+        else {
+            m_sslFailed = true;
             throw Exception(getSSLError("writing to SSL connection", errorCode));
-        this_thread::sleep_for(chrono::milliseconds(10));
+        }
+    }
+}
+
+size_t SSLSocket::write(const BufferChain& chain)
+{
+    char record[WRITE_BLOCK];
+    size_t recordBytes = 0;
+
+    for (auto& segment: chain) {
+        if (recordBytes + segment.bytes() <= WRITE_BLOCK) {
+            memcpy(record + recordBytes, segment.data(), segment.bytes());
+            recordBytes += segment.bytes();
+            continue;
+        }
+        if (recordBytes != 0) {
+            send(record, recordBytes);
+            recordBytes = 0;
+        }
+        if (segment.bytes() >= WRITE_BLOCK)
+            send(segment.data(), segment.bytes());
+        else {
+            memcpy(record, segment.data(), segment.bytes());
+            recordBytes = segment.bytes();
+        }
+    }
+
+    if (recordBytes != 0)
+        send(record, recordBytes);
+
+    return chain.bytes();
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+#include <sptk5/net/TCPServer.h>
+#include <sptk5/net/SSLHandshakeEvents.h>
+#include <sptk5/SystemException.h>
+#include <sptk5/test/TestCounter.h>
+#include <sptk5/test/TestListener.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <future>
+#include <poll.h>
+
+static String testKeyFileName;
+static String testCertificateFileName;
+
+/**
+ * Removes test key and certificate files, and their directory, at process exit
+ */
+static void removeTestCertificate()
+{
+    unlink(testKeyFileName.c_str());
+    unlink(testCertificateFileName.c_str());
+    rmdir(testKeyFileName.substr(0, testKeyFileName.rfind('/')).c_str());
+}
+
+/**
+ * Creates private key and self-signed certificate for test server, once per process.
+ * Files are created in a new temporary directory, so concurrent test processes don't share them.
+ */
+static void createTestCertificate()
+{
+    static once_flag created;
+    call_once(created, []() {
+        char directory[] = "/tmp/gtest_sptk5_ssl_XXXXXX";
+        if (mkdtemp(directory) == nullptr)
+            throw SystemException("Can't create temporary directory");
+        testKeyFileName = String(directory) + "/key.pem";
+        testCertificateFileName = String(directory) + "/certificate.pem";
+        atexit(removeTestCertificate);
+
+        EVP_PKEY* key = nullptr;
+        EVP_PKEY_CTX* keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+        EVP_PKEY_keygen_init(keyContext);
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1);
+        EVP_PKEY_keygen(keyContext, &key);
+        EVP_PKEY_CTX_free(keyContext);
+
+        X509* certificate = X509_new();
+        X509_set_version(certificate, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+        X509_gmtime_adj(X509_getm_notAfter(certificate), 86400);
+        X509_set_pubkey(certificate, key);
+        X509_NAME* name = X509_get_subject_name(certificate);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*) "localhost", -1, -1, 0);
+        X509_set_issuer_name(certificate, name);
+        X509_sign(certificate, key, EVP_sha256());
+
+        FILE* file = fopen(testKeyFileName.c_str(), "w");
+        PEM_write_PrivateKey(file, key, nullptr, nullptr, 0, nullptr, nullptr);
+        fclose(file);
+
+        file = fopen(testCertificateFileName.c_str(), "w");
+        PEM_write_X509(file, certificate);
+        fclose(file);
+
+        X509_free(certificate);
+        EVP_PKEY_free(key);
+    });
+}
+
+static TestCounter sslEchoConnections;
+
+/**
+ * Encrypted echo connection, that replies with a single line
+ */
+class SSLEchoConnection : public ServerConnection
+{
+public:
+    explicit SSLEchoConnection(SOCKET connectionSocket)
+    : ServerConnection(connectionSocket, "SSLEchoConnection")
+    {
+        auto* socket = new SSLSocket;
+        m_socket = socket;
+        socket->loadKeys(testKeyFileName, testCertificateFileName, "");
+        socket->startAccept(connectionSocket);
+        ++sslEchoConnections;
+    }
+
+    ~SSLEchoConnection() override
+    {
+        --sslEchoConnections;
+    }
+
+    void threadFunction() override
+    {
+        try {
+            string line;
+            if (m_socket->readyToRead(chrono::seconds(3)) && m_socket->readLine(line) > 0)
+                m_socket->write(line + "\n");
+        }
+        catch (const exception& e) {
+            cerr << e.what() << endl;
+        }
+        m_socket->close();
     }
+};
+
+class SSLEchoServer : public TCPServer
+{
+protected:
+    ServerConnection* createConnection(SOCKET connectionSocket, sockaddr_in*) override
+    {
+        return new SSLEchoConnection(connectionSocket);
+    }
+};
+
+TEST(SPTK_SSLSocket, serverHandshake)
+{
+    createTestCertificate();
+
+    SSLEchoServer server;
+    ASSERT_NO_THROW(server.listen(0, "127.0.0.1"));
+    Host host("127.0.0.1", server.port());
+
+    // Silent client holds neither the listener, nor a connection thread
+    TCPSocket silentClient;
+    silentClient.open(host);
+
+    // Connection of the client that disconnects during the handshake is deleted
+    SSLSocket quittingClient;
+    quittingClient.startConnect(host);
+    quittingClient.handshake();
+    quittingClient.close();
+
+    SSLSocket client;
+    ASSERT_NO_THROW(client.open(host, BaseSocket::SOM_CONNECT, true, chrono::seconds(3)));
+    client.write(string("Hello\n"));
+    string line;
+    client.readLine(line);
+    EXPECT_STREQ("Hello", line.c_str());
+    client.close();
+
+    // Only the silent client's connection remains, with pending handshake
+    EXPECT_TRUE(sslEchoConnections.waitFor(1));
+
+    // Pending handshake is failed when server stops
+    server.stop();
+    EXPECT_EQ(0, long(sslEchoConnections));
+}
+
+TEST(SPTK_SSLSocket, handshakeTimeout)
+{
+    createTestCertificate();
+
+    TestListener listener;
+    TCPSocket silentClient;
+    silentClient.open(listener.host());
+
+    SSLSocket server;
+    server.loadKeys(testKeyFileName, testCertificateFileName, "");
+    server.startAccept(listener.accept());
+
+    SSLHandshakeEvents handshakeEvents(chrono::milliseconds(300));
+    promise<String> result;
+    DateTime started = DateTime::Now();
+    handshakeEvents.add(server, [&result](SSLSocket&, const String& error) {
+        result.set_value(error);
+    });
+    EXPECT_EQ(size_t(1), handshakeEvents.size());
+
+    auto error = result.get_future();
+    ASSERT_EQ(future_status::ready, error.wait_for(chrono::seconds(3)));
+    EXPECT_STREQ("SSL handshake timeout", error.get().c_str());
+    EXPECT_GE(DateTime::Now() - started, chrono::milliseconds(300));
+    EXPECT_EQ(size_t(0), handshakeEvents.size());
+}
+
+TEST(SPTK_SSLSocket, handshakeDisconnect)
+{
+    createTestCertificate();
+
+    TestListener listener;
+    SSLSocket client;
+    client.startConnect(listener.host());
+    EXPECT_EQ(SSLSocket::HANDSHAKE_WANT_READ, client.handshake());
+
+    SSLSocket server;
+    server.loadKeys(testKeyFileName, testCertificateFileName, "");
+    server.startAccept(listener.accept());
+
+    SSLHandshakeEvents handshakeEvents(chrono::seconds(10));
+    promise<String> result;
+    handshakeEvents.add(server, [&result](SSLSocket&, const String& error) {
+        result.set_value(error);
+    });
+
+    // Client disconnects after server replied to client hello
+    ASSERT_TRUE(client.readyToRead(chrono::seconds(3)));
+    client.close();
+
+    auto error = result.get_future();
+    ASSERT_EQ(future_status::ready, error.wait_for(chrono::seconds(3)));
+    EXPECT_FALSE(error.get().empty());
+    EXPECT_EQ(size_t(0), handshakeEvents.size());
+}
+
+TEST(SPTK_SSLSocket, handshakeEvents)
+{
+    createTestCertificate();
+
+    TestListener listener;
+    SSLSocket client;
+    client.startConnect(listener.host());
+
+    SSLSocket server;
+    server.loadKeys(testKeyFileName, testCertificateFileName, "");
+    server.startAccept(listener.accept());
+
+    // Both sides of the handshake are completed by events
+    SSLHandshakeEvents handshakeEvents(chrono::seconds(3));
+    promise<String> clientResult;
+    promise<String> serverResult;
+    handshakeEvents.add(server, [&serverResult](SSLSocket&, const String& error) {
+        serverResult.set_value(error);
+    });
+    handshakeEvents.add(client, [&clientResult](SSLSocket&, const String& error) {
+        clientResult.set_value(error);
+    });
+
+    auto clientError = clientResult.get_future();
+    auto serverError = serverResult.get_future();
+    ASSERT_EQ(future_status::ready, clientError.wait_for(chrono::seconds(3)));
+    ASSERT_EQ(future_status::ready, serverError.wait_for(chrono::seconds(3)));
+    EXPECT_STREQ("", clientError.get().c_str());
+    EXPECT_STREQ("", serverError.get().c_str());
+    EXPECT_FALSE(client.handshakePending());
+    EXPECT_FALSE(server.handshakePending());
+
+    client.blockingMode(true);
+    server.blockingMode(true);
+    client.write(string("Hello\n"));
+    string line;
+    server.readLine(line);
+    EXPECT_STREQ("Hello", line.c_str());
+}
+
+/**
+ * Connects client to the loopback listener, and completes handshake on both sides
+ */
+static void connectLoopback(TestListener& listener, SSLSocket& client, SSLSocket& server)
+{
+    client.startConnect(listener.host());
+    server.loadKeys(testKeyFileName, testCertificateFileName, "");
+    server.startAccept(listener.accept());
+
+    DateTime timeoutAt(DateTime::Now() + chrono::seconds(3));
+    while (client.handshakePending() || server.handshakePending()) {
+        if (DateTime::Now() > timeoutAt)
+            throw TimeoutException("SSL handshake timeout");
+        if (client.handshakePending())
+            client.handshake();
+        if (server.handshakePending())
+            server.handshake();
+    }
+
+    // TLS 1.3 client receives session tickets after the handshake
+    client.blockingMode(true);
+    server.blockingMode(true);
+    client.write(string("Hello\n"));
+    string line;
+    server.readLine(line);
+    server.write(line + "\n");
+    client.readLine(line);
+}
+
+TEST(SPTK_SSLSocket, sessionResumption)
+{
+    createTestCertificate();
+
+    // Tickets, issued by other tests, are expired
+    SSLContext* serverContext = CachedSSLContext::get(testKeyFileName, testCertificateFileName, "");
+    serverContext->rotateTicketKeys();
+    serverContext->rotateTicketKeys();
+
+    TestListener listener;
+    size_t fullHandshakes = serverContext->fullHandshakes();
+    size_t resumedHandshakes = serverContext->resumedHandshakes();
+
+    auto connect = [&listener](bool& clientReused, bool& serverReused) {
+        SSLSocket client;
+        SSLSocket server;
+        connectLoopback(listener, client, server);
+        clientReused = SSL_session_reused(client.handle()) != 0;
+        serverReused = server.sessionReused();
+        client.close();
+        server.close();
+    };
+
+    bool clientReused = true;
+    bool serverReused = true;
+    ASSERT_NO_THROW(connect(clientReused, serverReused));
+    EXPECT_FALSE(clientReused);
+    EXPECT_FALSE(serverReused);
+    EXPECT_EQ(fullHandshakes + 1, serverContext->fullHandshakes());
+
+    ASSERT_NO_THROW(connect(clientReused, serverReused));
+    EXPECT_TRUE(clientReused);
+    EXPECT_TRUE(serverReused);
+    EXPECT_EQ(resumedHandshakes + 1, serverContext->resumedHandshakes());
+
+    // Ticket encrypted with the previous key is still accepted
+    serverContext->rotateTicketKeys();
+    ASSERT_NO_THROW(connect(clientReused, serverReused));
+    EXPECT_TRUE(clientReused);
+    EXPECT_TRUE(serverReused);
+    EXPECT_EQ(resumedHandshakes + 2, serverContext->resumedHandshakes());
+
+    // Ticket encrypted with the expired key requires full handshake
+    serverContext->rotateTicketKeys();
+    serverContext->rotateTicketKeys();
+    ASSERT_NO_THROW(connect(clientReused, serverReused));
+    EXPECT_FALSE(clientReused);
+    EXPECT_FALSE(serverReused);
+    EXPECT_EQ(fullHandshakes + 2, serverContext->fullHandshakes());
+    EXPECT_EQ(resumedHandshakes + 2, serverContext->resumedHandshakes());
 }
+
+TEST(SPTK_SSLSocket, sessionAfterError)
+{
+    createTestCertificate();
+
+    TestListener listener;
+    bool reused = true;
+    {
+        SSLSocket client;
+        SSLSocket server;
+        connectLoopback(listener, client, server);
+        reused = client.sessionReused();
+        client.close();
+    }
+    EXPECT_FALSE(reused);
+
+    // Connection that failed with SSL error isn't shut down cleanly, so its session isn't resumed
+    {
+        SSLSocket client;
+        SSLSocket server;
+        connectLoopback(listener, client, server);
+        EXPECT_TRUE(client.sessionReused());
+
+        // Server resets connection
+        linger resetOnClose = {1, 0};
+        setsockopt(SSL_get_fd(server.handle()), SOL_SOCKET, SO_LINGER, (const char*) &resetOnClose, sizeof(resetOnClose));
+        server.close();
+        pollfd resetReceived = {SSL_get_fd(client.handle()), POLLIN, 0};
+        EXPECT_EQ(1, ::poll(&resetReceived, 1, 3000));
+
+        EXPECT_THROW(client.write(string("Hello\n")), Exception);
+    }
+
+    SSLSocket client;
+    SSLSocket server;
+    connectLoopback(listener, client, server);
+    EXPECT_FALSE(client.sessionReused());
+}
+
+TEST(SPTK_SSLSocket, writeWithoutSIGPIPE)
+{
+    createTestCertificate();
+
+    TestListener listener;
+    SSLSocket client;
+    SSLSocket server;
+    connectLoopback(listener, client, server);
+
+    // Writing to the socket that can't be written fails, rather than terminates the process
+    ::shutdown(SSL_get_fd(client.handle()), SHUT_WR);
+    EXPECT_THROW(client.write(string("Hello\n")), Exception);
+}
+
+#endif
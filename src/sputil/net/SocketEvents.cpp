@@ -58,6 +58,16 @@ void SocketEvents::remove(BaseSocket& socket)
     m_socketPool.forgetSocket(socket);
 }
 
+void SocketEvents::watchRead(BaseSocket& socket, bool enable)
+{
+    m_socketPool.watchRead(socket, enable);
+}
+
+void SocketEvents::watchWrite(BaseSocket& socket, bool enable)
+{
+    m_socketPool.watchWrite(socket, enable);
+}
+
 void SocketEvents::threadFunction()
 {
     m_socketPool.open();
@@ -68,6 +78,7 @@ void SocketEvents::threadFunction()
         catch (const Exception& e) {
             cerr << e.message() << endl;
         }
+        m_cycles++;
     }
     m_socketPool.close();
 }
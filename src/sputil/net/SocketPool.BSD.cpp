@@ -115,9 +115,57 @@ void SocketPool::forgetSocket(BaseSocket& socket)
     if (rc == -1)
         throw SystemException("Can't remove socket from kqueue");
 
+    // Write filter exists only if write watch was enabled
+    struct kevent writeEvent;
+    EV_SET(&writeEvent, socketFD, EVFILT_WRITE, EV_DELETE, 0, 0, 0);
+    kevent(m_pool, &writeEvent, 1, NULL, 0, NULL);
+
     free(event);
 }
 
+void SocketPool::watchRead(BaseSocket& socket, bool enable)
+{
+    if (!socket.active())
+        throw Exception("Socket is closed");
+
+    lock_guard<mutex> lock(*this);
+
+    map<BaseSocket*,void*>::iterator itor = m_socketData.find(&socket);
+    if (itor == m_socketData.end())
+        throw Exception("Socket is not in the pool");
+
+    struct kevent* event = (struct kevent*) itor->second;
+    struct kevent readEvent;
+    EV_SET(&readEvent, socket.handle(), EVFILT_READ, enable ? EV_ENABLE : EV_DISABLE, 0, 0, event->udata);
+
+    int rc = kevent(m_pool, &readEvent, 1, NULL, 0, NULL);
+    if (rc == -1)
+        throw SystemException("Can't modify socket events in kqueue");
+}
+
+void SocketPool::watchWrite(BaseSocket& socket, bool enable)
+{
+    if (!socket.active())
+        throw Exception("Socket is closed");
+
+    lock_guard<mutex> lock(*this);
+
+    map<BaseSocket*,void*>::iterator itor = m_socketData.find(&socket);
+    if (itor == m_socketData.end())
+        throw Exception("Socket is not in the pool");
+
+    struct kevent* event = (struct kevent*) itor->second;
+    struct kevent writeEvent;
+    if (enable)
+        EV_SET(&writeEvent, socket.handle(), EVFILT_WRITE, EV_ADD | EV_ENABLE, 0, 0, event->udata);
+    else
+        EV_SET(&writeEvent, socket.handle(), EVFILT_WRITE, EV_DELETE, 0, 0, 0);
+
+    int rc = kevent(m_pool, &writeEvent, 1, NULL, 0, NULL);
+    if (rc == -1 && enable)
+        throw SystemException("Can't modify socket events in kqueue");
+}
+
 #define MAXEVENTS 16
 
 void SocketPool::waitForEvents(std::chrono::milliseconds timeoutMS)
@@ -131,8 +179,18 @@ void SocketPool::waitForEvents(std::chrono::milliseconds timeoutMS)
 
     for (int i = 0; i < eventCount; i++) {
         struct kevent& event = events[i];
+
+        // Read and write filters of the same socket are reported once
+        bool reported = false;
+        for (int j = 0; j < i && !reported; j++)
+            reported = events[j].ident == event.ident;
+        if (reported)
+            continue;
+
         if (event.flags & EV_EOF)
             m_eventsCallback(event.udata, ET_CONNECTION_CLOSED);
+        else if (event.filter == EVFILT_WRITE)
+            m_eventsCallback(event.udata, ET_CAN_WRITE);
         else
             m_eventsCallback(event.udata, ET_HAS_DATA);
     }
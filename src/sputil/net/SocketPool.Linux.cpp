@@ -111,6 +111,41 @@ void SocketPool::forgetSocket(BaseSocket& socket)
     free(event);
 }
 
+static void watchEvents(SOCKET pool, map<BaseSocket*,void*>& socketData, BaseSocket& socket, uint32_t events, bool enable)
+{
+    auto itor = socketData.find(&socket);
+    if (itor == socketData.end())
+        throw Exception("Socket is not in the pool");
+
+    auto event = (epoll_event*) itor->second;
+    if (enable)
+        event->events |= events;
+    else
+        event->events &= ~events;
+
+    int rc = epoll_ctl(pool, EPOLL_CTL_MOD, socket.handle(), event);
+    if (rc == -1)
+        throw SystemException("Can't modify socket events in epoll");
+}
+
+void SocketPool::watchRead(BaseSocket& socket, bool enable)
+{
+    if (!socket.active())
+        throw Exception("Socket is closed");
+
+    lock_guard<mutex> lock(*this);
+    watchEvents(m_pool, m_socketData, socket, EPOLLIN | EPOLLRDHUP, enable);
+}
+
+void SocketPool::watchWrite(BaseSocket& socket, bool enable)
+{
+    if (!socket.active())
+        throw Exception("Socket is closed");
+
+    lock_guard<mutex> lock(*this);
+    watchEvents(m_pool, m_socketData, socket, EPOLLOUT, enable);
+}
+
 #define MAXEVENTS 16
 
 void SocketPool::waitForEvents(chrono::milliseconds timeout)
@@ -127,6 +162,8 @@ void SocketPool::waitForEvents(chrono::milliseconds timeout)
         epoll_event& event = events[i];
         if ((event.events & (EPOLLHUP | EPOLLRDHUP)) != 0)
             m_eventsCallback(event.data.ptr, ET_CONNECTION_CLOSED);
+        else if ((event.events & (EPOLLIN | EPOLLOUT)) == EPOLLOUT)
+            m_eventsCallback(event.data.ptr, ET_CAN_WRITE);
         else
             m_eventsCallback(event.data.ptr, ET_HAS_DATA);
     }
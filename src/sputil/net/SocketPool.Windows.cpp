@@ -92,6 +92,9 @@ void EventWindow::eventMessageFunction(UINT uMsg, WPARAM wParam, LPARAM lParam)
         case FD_READ:
             events = ET_HAS_DATA;
             break;
+        case FD_WRITE:
+            events = ET_CAN_WRITE;
+            break;
         case FD_CLOSE:
             events = ET_CONNECTION_CLOSED;
             break;
@@ -152,6 +155,7 @@ void SocketPool::close()
     for (auto itor: m_socketData)
         free(itor.second);
     m_socketData.clear();
+    m_socketEvents.clear();
 }
 
 void SocketPool::watchSocket(BaseSocket& socket, void* userData)
@@ -167,6 +171,7 @@ void SocketPool::watchSocket(BaseSocket& socket, void* userData)
         throw SystemException("Can't add socket to WSAAsyncSelect");
 
     m_socketData[&socket] = userData;
+    m_socketEvents[&socket] = FD_ACCEPT|FD_READ|FD_CLOSE;
 }
 
 void SocketPool::forgetSocket(BaseSocket& socket)
@@ -182,12 +187,46 @@ void SocketPool::forgetSocket(BaseSocket& socket)
             return;
 
         m_socketData.erase(itor);
+        m_socketEvents.erase(&socket);
     }
 
     if (WSAAsyncSelect(socket.handle(), m_pool->handle(), WM_SOCKET_EVENT, 0))
         throw SystemException("Can't remove socket from WSAAsyncSelect");
 }
 
+static void watchEvents(EventWindow* pool, map<BaseSocket*,long>& socketEvents, BaseSocket& socket, long events, bool enable)
+{
+    auto itor = socketEvents.find(&socket);
+    if (itor == socketEvents.end())
+        throw Exception("Socket is not in the pool");
+
+    if (enable)
+        itor->second |= events;
+    else
+        itor->second &= ~events;
+
+    if (WSAAsyncSelect(socket.handle(), pool->handle(), WM_SOCKET_EVENT, itor->second) != 0)
+        throw SystemException("Can't modify WSAAsyncSelect events");
+}
+
+void SocketPool::watchRead(BaseSocket& socket, bool enable)
+{
+    if (!socket.active())
+        throw Exception("Socket is closed");
+
+    lock_guard<mutex> lock(*this);
+    watchEvents(m_pool, m_socketEvents, socket, FD_ACCEPT|FD_READ, enable);
+}
+
+void SocketPool::watchWrite(BaseSocket& socket, bool enable)
+{
+    if (!socket.active())
+        throw Exception("Socket is closed");
+
+    lock_guard<mutex> lock(*this);
+    watchEvents(m_pool, m_socketEvents, socket, FD_WRITE, enable);
+}
+
 void SocketPool::waitForEvents(chrono::milliseconds timeout)
 {
 	size_t timeoutMS = timeout.count();
@@ -28,12 +28,13 @@
 
 #include <sptk5/net/TCPServer.h>
 #include <sptk5/net/TCPServerListener.h>
+#include <sptk5/net/SSLHandshakeEvents.h>
 
 using namespace std;
 using namespace sptk;
 
 TCPServer::TCPServer(Logger* logger)
-: Thread("TCPServer"), m_listenerThread(nullptr), m_logger(logger)
+: Thread("TCPServer"), m_logger(logger), m_handshakeEvents(nullptr)
 {
     run();
 }
@@ -45,22 +46,60 @@ TCPServer::~TCPServer()
 
 uint16_t TCPServer::port() const
 {
-    if (!m_listenerThread)
+    if (m_listenerThreads.empty())
         return 0;
-    return m_listenerThread->port();
+    return m_listenerThreads[0]->port();
 }
 
-void TCPServer::listen(uint16_t port)
+std::vector<size_t> TCPServer::acceptedConnections() const
+{
+    SharedLock(m_mutex);
+    vector<size_t> connections;
+    for (auto* listener: m_listenerThreads)
+        connections.push_back(listener->acceptedConnections());
+    return connections;
+}
+
+void TCPServer::listen(uint16_t port, const String& bindAddress, size_t acceptorCount, int backlog)
 {
     UniqueLock(m_mutex);
-    if (m_listenerThread != nullptr) {
-        m_listenerThread->terminate();
-        m_listenerThread->join();
-        delete m_listenerThread;
-    }
-    m_listenerThread = new TCPServerListener(this, port);
-    m_listenerThread->listen();
-    m_listenerThread->run();
+    stopListeners();
+
+#ifdef _WIN32
+    // Connections aren't balanced between sockets bound to the same port
+    acceptorCount = 1;
+#endif
+    if (acceptorCount == 0)
+        acceptorCount = 1;
+
+    for (size_t i = 0; i < acceptorCount; i++) {
+        auto* listener = new TCPServerListener(this, port, bindAddress, backlog);
+        try {
+            listener->listen();
+        }
+        catch (const exception&) {
+            delete listener;
+            stopListeners();
+            throw;
+        }
+        m_listenerThreads.push_back(listener);
+        // Port selected by the system for the first acceptor is shared by others
+        port = listener->port();
+    }
+
+    for (auto* listener: m_listenerThreads)
+        listener->run();
+}
+
+void TCPServer::stopListeners()
+{
+    for (auto* listener: m_listenerThreads)
+        listener->terminate();
+    for (auto* listener: m_listenerThreads) {
+        listener->join();
+        delete listener;
+    }
+    m_listenerThreads.clear();
 }
 
 bool TCPServer::allowConnection(sockaddr_in*)
@@ -71,6 +110,18 @@ bool TCPServer::allowConnection(sockaddr_in*)
 void TCPServer::stop()
 {
     UniqueLock(m_mutex);
+
+    stopListeners();
+
+    // Fails pending handshakes, and deletes their connections
+    SSLHandshakeEvents* handshakeEvents;
+    {
+        UniqueLock(m_connectionThreadsLock);
+        handshakeEvents = m_handshakeEvents;
+        m_handshakeEvents = nullptr;
+    }
+    delete handshakeEvents;
+
     {
         UniqueLock(m_connectionThreadsLock);
         for (auto connectionThread: m_connectionThreads)
@@ -90,12 +141,6 @@ void TCPServer::stop()
             delete connection;
     }
 
-    if (m_listenerThread != nullptr) {
-        m_listenerThread->terminate();
-        m_listenerThread->join();
-        delete m_listenerThread;
-        m_listenerThread = nullptr;
-    }
     terminate();
     join();
 }
@@ -107,6 +152,35 @@ void TCPServer::registerConnection(ServerConnection* connection)
     connection->m_server = this;
 }
 
+void TCPServer::startConnection(ServerConnection* connection)
+{
+    auto* socket = dynamic_cast<SSLSocket*>(connection->m_socket);
+    if (socket == nullptr || !socket->handshakePending()) {
+        registerConnection(connection);
+        connection->run();
+        return;
+    }
+
+    SSLHandshakeEvents* handshakeEvents;
+    {
+        UniqueLock(m_connectionThreadsLock);
+        if (m_handshakeEvents == nullptr)
+            m_handshakeEvents = new SSLHandshakeEvents;
+        handshakeEvents = m_handshakeEvents;
+    }
+
+    handshakeEvents->add(*socket, [this, connection](SSLSocket& socket, const String& error) {
+        if (!error.empty()) {
+            log(LP_ERROR, error);
+            delete connection;
+            return;
+        }
+        socket.blockingMode(true);
+        registerConnection(connection);
+        connection->run();
+    });
+}
+
 void TCPServer::unregisterConnection(ServerConnection* connection)
 {
     UniqueLock(m_connectionThreadsLock);
@@ -220,4 +294,45 @@ TEST(SPTK_TCPServer, minimal)
     socket.close();
 }
 
+TEST(SPTK_TCPServer, acceptors)
+{
+    EchoServer echoServer;
+    ASSERT_NO_THROW(echoServer.listen(0, "127.0.0.1", 4, 64));
+    ASSERT_NE(0, echoServer.port());
+
+    vector<shared_ptr<TCPSocket>> sockets;
+    for (int i = 0; i < 20; i++) {
+        auto socket = make_shared<TCPSocket>();
+        ASSERT_NO_THROW(socket->open(Host("127.0.0.1", echoServer.port())));
+        sockets.push_back(socket);
+    }
+
+    Buffer buffer;
+    for (auto& socket: sockets) {
+        socket->write(string("Hello\n"));
+        buffer.bytes(0);
+        if (socket->readyToRead(chrono::seconds(3)))
+            socket->readLine(buffer);
+        EXPECT_STREQ("Hello", buffer.c_str());
+        socket->close();
+    }
+
+    auto acceptedConnections = echoServer.acceptedConnections();
+#ifndef _WIN32
+    ASSERT_EQ(size_t(4), acceptedConnections.size());
+#endif
+    size_t total = 0;
+    size_t busyAcceptors = 0;
+    for (auto accepted: acceptedConnections) {
+        total += accepted;
+        if (accepted > 0)
+            busyAcceptors++;
+    }
+    EXPECT_EQ(size_t(20), total);
+#ifndef _WIN32
+    // Connections from different client ports are spread between acceptors by the kernel
+    EXPECT_GT(busyAcceptors, size_t(1));
+#endif
+}
+
 #endif
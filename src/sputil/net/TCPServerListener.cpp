@@ -32,10 +32,74 @@
 using namespace std;
 using namespace sptk;
 
-TCPServerListener::TCPServerListener(TCPServer* server, uint16_t port)
-: Thread("CTCPServer::Listener"), m_server(server)
+TCPServerListener::TCPServerListener(TCPServer* server, uint16_t port, const String& bindAddress, int backlog)
+: Thread("CTCPServer::Listener"), m_server(server), m_port(port), m_bindAddress(bindAddress), m_backlog(backlog)
 {
-    m_listenerSocket.host(Host("localhost", port));
+}
+
+bool TCPServerListener::acceptConnection(SOCKET& connectionFD, sockaddr_in& connectionInfo)
+{
+    for (;;) {
+        socklen_t len = sizeof(connectionInfo);
+#if defined(SOCK_CLOEXEC) && !defined(_WIN32)
+        // Connection threads use blocking sockets, so only close-on-exec flag is set
+        connectionFD = accept4(m_listenerSocket.handle(), (sockaddr*) &connectionInfo, &len, SOCK_CLOEXEC);
+#else
+        connectionFD = accept(m_listenerSocket.handle(), (sockaddr*) &connectionInfo, &len);
+        if ((int) connectionFD != -1) {
+            // Accepted socket may inherit non-blocking mode of the listener socket
+#ifdef _WIN32
+            u_long nonBlocking = 0;
+            ioctlsocket(connectionFD, FIONBIO, &nonBlocking);
+#else
+            int flags = fcntl(connectionFD, F_GETFL);
+            if (flags != -1)
+                fcntl(connectionFD, F_SETFL, flags & ~O_NONBLOCK);
+            fcntl(connectionFD, F_SETFD, FD_CLOEXEC);
+#endif
+        }
+#endif
+        if ((int) connectionFD != -1) {
+            m_acceptedConnections++;
+            return true;
+        }
+
+#ifdef _WIN32
+        if (WSAGetLastError() == WSAEWOULDBLOCK)
+            return false;
+#else
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return false;
+        // Connection aborted by peer before accept, or interrupted accept
+        if (errno == ECONNABORTED || errno == EINTR)
+            continue;
+#endif
+        THROW_SOCKET_ERROR("Error on accept(). ");
+    }
+}
+
+void TCPServerListener::startConnection(SOCKET connectionFD, sockaddr_in& connectionInfo)
+{
+    try {
+        if (m_server->allowConnection(&connectionInfo)) {
+            ServerConnection* connection = m_server->createConnection(connectionFD, &connectionInfo);
+            m_server->startConnection(connection);
+        }
+        else {
+#ifndef _WIN32
+            shutdown(connectionFD,SHUT_RDWR);
+            ::close (connectionFD);
+#else
+            closesocket(connectionFD);
+#endif
+        }
+    }
+    catch (exception& e) {
+        m_server->log(LP_ERROR, e.what());
+    }
+    catch (...) {
+        m_server->log(LP_ERROR, "Unknown exception");
+    }
 }
 
 void TCPServerListener::threadFunction()
@@ -45,23 +109,13 @@ void TCPServerListener::threadFunction()
             lock_guard<mutex> lock(*this);
             if (m_listenerSocket.readyToRead(chrono::milliseconds(1000))) {
                 try {
-                    SOCKET connectionFD;
-                    sockaddr_in connectionInfo = {};
-                    m_listenerSocket.accept(connectionFD, connectionInfo);
-                    if ((int)connectionFD == -1)
-                        continue;
-                    if (m_server->allowConnection(&connectionInfo)) {
-                        ServerConnection* connection = m_server->createConnection(connectionFD, &connectionInfo);
-                        m_server->registerConnection(connection);
-                        connection->run();
-                    }
-                    else {
-#ifndef _WIN32
-                        shutdown(connectionFD,SHUT_RDWR);
-                        ::close (connectionFD);
-#else
-                        closesocket(connectionFD);
-#endif
+                    // Accept pending connections, up to the batch size, per wakeup
+                    for (size_t i = 0; i < AcceptBatchSize && !terminated(); i++) {
+                        SOCKET connectionFD;
+                        sockaddr_in connectionInfo = {};
+                        if (!acceptConnection(connectionFD, connectionInfo))
+                            break;
+                        startConnection(connectionFD, connectionInfo);
                     }
                 }
                 catch (exception& e) {
@@ -79,12 +133,13 @@ void TCPServerListener::threadFunction()
     catch (...) {
         m_server->log(LP_ERROR, "Unknown exception");
     }
+
+    lock_guard<mutex> lock(*this);
+    m_listenerSocket.close();
 }
 
 void TCPServerListener::terminate()
 {
+    // Listener socket is closed by the listener thread, so that listeners sharing the port stop in parallel
     Thread::terminate();
-
-    lock_guard<mutex> lock(*this);
-    m_listenerSocket.close();
 }
@@ -28,6 +28,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 #include <sptk5/net/TCPSocket.h>
 #include <thread>
 
@@ -100,31 +101,45 @@ int32_t TCPSocketReader::bufferedRead(char *destination, size_t sz, char delimit
     }
 
     char *readPosition = m_buffer + m_readOffset;
+    char *cr = nullptr;
+    if (read_line && delimiter != 0) {
+        // Receive more data until the delimiter is found
+        while ((cr = strchr(readPosition, delimiter)) == nullptr) {
+            if (m_readOffset != 0) {
+                memmove(m_buffer, m_buffer + m_readOffset, (size_t) availableBytes);
+                m_readOffset = 0;
+                m_bytes = (size_t) availableBytes;
+            } else {
+                checkSize(m_capacity + 128);
+            }
+            size_t bytes;
+            for (;;) {
+                bytes = m_socket.recv(m_buffer + availableBytes, m_capacity - availableBytes - 2);
+                if ((int) bytes != -1)
+                    break;
+                if (errno != EAGAIN)
+                    THROW_SOCKET_ERROR("Can't read from socket");
+                if (!m_socket.readyToRead(chrono::seconds(1)))
+                    throw TimeoutException("Can't read from socket: timeout");
+            }
+            if (bytes == 0)
+                return 0; // Incomplete line stays in the buffer
+            m_bytes += bytes;
+            m_buffer[m_bytes] = 0;
+            readPosition = m_buffer;
+            availableBytes = int(m_bytes);
+        }
+    }
+
     if (availableBytes < bytesToRead)
         bytesToRead = availableBytes;
 
-    char *cr = nullptr;
     if (read_line) {
         size_t len;
         if (delimiter == 0)
             len = strlen(readPosition);
-        else {
-            cr = strchr(readPosition, delimiter);
-            if (cr != nullptr)
-                len = cr - readPosition + 1;
-            else {
-                if (m_readOffset != 0) {
-                    memmove(m_buffer, m_buffer + m_readOffset, (size_t) availableBytes);
-                    m_readOffset = 0;
-                    m_bytes = (size_t) availableBytes;
-                } else {
-                    checkSize(m_capacity + 128);
-                }
-                size_t bytes = m_socket.recv(m_buffer + availableBytes, m_capacity - availableBytes);
-                m_bytes += bytes;
-                return 0;
-            }
-        }
+        else
+            len = cr - readPosition + 1;
         if (len < sz) {
             eol = true;
             bytesToRead = (int) len;
@@ -148,6 +163,19 @@ int32_t TCPSocketReader::bufferedRead(char *destination, size_t sz, char delimit
     return bytesToRead;
 }
 
+size_t TCPSocketReader::directRead(char* destination, size_t sz)
+{
+    for (;;) {
+        auto bytes = (int) m_socket.recv(destination, sz);
+        if (bytes >= 0)
+            return (size_t) bytes;
+        if (errno != EAGAIN)
+            THROW_SOCKET_ERROR("Can't read from socket");
+        if (!m_socket.readyToRead(chrono::seconds(1)))
+            throw TimeoutException("Can't read from socket: timeout");
+    }
+}
+
 size_t TCPSocketReader::read(char* destination, size_t sz, char delimiter, bool read_line, sockaddr_in* from)
 {
     int total = 0;
@@ -161,7 +189,12 @@ size_t TCPSocketReader::read(char* destination, size_t sz, char delimiter, bool
         if (bytesToRead <= 0)
             return sz;
 
-        int bytes = bufferedRead(destination, size_t(bytesToRead), delimiter, read_line, from);
+        int bytes;
+        if (!read_line && from == nullptr && availableBytes() == 0 && size_t(bytesToRead) >= m_capacity / 2) {
+            // Large read: receive directly into destination, avoiding the copy through the internal buffer
+            bytes = (int) directRead(destination, size_t(bytesToRead));
+        } else
+            bytes = bufferedRead(destination, size_t(bytesToRead), delimiter, read_line, from);
 
         if (bytes == 0) // No more data
             break;
@@ -182,6 +215,58 @@ size_t TCPSocketReader::availableBytes() const
     return m_bytes - m_readOffset;
 }
 
+void TCPSocketReader::consume(size_t bytes)
+{
+    if (bytes > availableBytes())
+        throw Exception("Can't consume more than available bytes");
+    m_readOffset += uint32_t(bytes);
+}
+
+size_t TCPSocketReader::readSome(char* destination, size_t sz)
+{
+    if (m_socket.handle() <= 0)
+        throw Exception("Can't read from closed socket", __FILE__, __LINE__);
+
+    size_t available = availableBytes();
+    if (available == 0)
+        return directRead(destination, sz);
+
+    if (sz > available)
+        sz = available;
+    memcpy(destination, m_buffer + m_readOffset, sz);
+    m_readOffset += uint32_t(sz);
+    return sz;
+}
+
+size_t TCPSocketReader::readMore()
+{
+    if (m_socket.handle() <= 0)
+        throw Exception("Can't read from closed socket", __FILE__, __LINE__);
+
+    size_t available = availableBytes();
+    if (m_readOffset != 0) {
+        if (available != 0)
+            memmove(m_buffer, m_buffer + m_readOffset, available);
+        m_readOffset = 0;
+        m_bytes = available;
+    }
+    if (m_bytes + 2 >= m_capacity)
+        checkSize(m_capacity * 2);
+
+    for (;;) {
+        auto bytes = (int) m_socket.recv(m_buffer + m_bytes, m_capacity - m_bytes - 2);
+        if (bytes >= 0) {
+            m_bytes += size_t(bytes);
+            m_buffer[m_bytes] = 0;
+            return size_t(bytes);
+        }
+        if (errno != EAGAIN)
+            THROW_SOCKET_ERROR("Can't read from socket");
+        if (!m_socket.readyToRead(chrono::seconds(1)))
+            throw TimeoutException("Can't read from socket: timeout");
+    }
+}
+
 size_t TCPSocketReader::readLine(Buffer& destinationBuffer, char delimiter)
 {
     size_t total = 0;
@@ -229,10 +314,33 @@ void TCPSocket::_open(const Host& host, CSocketOpenMode openMode, bool _blocking
     if (m_host.hostname().empty())
         throw Exception("Please, define the host name", __FILE__, __LINE__);
 
-    sockaddr_in address = {};
-    m_host.getAddress(address);
+    if (openMode != SOM_CONNECT) {
+        sockaddr_in address = {};
+        m_host.getAddress(address);
+        _open(address, openMode, _blockingMode, timeout);
+        return;
+    }
 
-    _open(address, openMode, _blockingMode, timeout);
+    // Try every address of the host, IPv4 addresses first, until connection succeeds
+    auto addresses = m_host.addresses();
+    stable_partition(addresses.begin(), addresses.end(), [](const sockaddr_storage& address) {
+        return address.ss_family == AF_INET;
+    });
+
+    String error("Host " + m_host.hostname() + " has no address");
+    for (auto& address: addresses) {
+        try {
+            if (address.ss_family == AF_INET6)
+                _open((const sockaddr_in6&) address, openMode, _blockingMode, timeout);
+            else
+                _open((const sockaddr_in&) address, openMode, _blockingMode, timeout);
+            return;
+        }
+        catch (const Exception& e) {
+            error = e.message();
+        }
+    }
+    throw Exception(error);
 }
 
 void TCPSocket::_open(const struct sockaddr_in& address, CSocketOpenMode openMode, bool _blockingMode,
@@ -245,6 +353,16 @@ void TCPSocket::_open(const struct sockaddr_in& address, CSocketOpenMode openMod
         blockingMode(false);
 }
 
+void TCPSocket::_open(const struct sockaddr_in6& address, CSocketOpenMode openMode, bool _blockingMode,
+                      chrono::milliseconds timeoutMS)
+{
+    open_addr(openMode, (const sockaddr*) &address, sizeof(address), timeoutMS);
+    m_reader.open();
+
+    if (!_blockingMode)
+        blockingMode(false);
+}
+
 void TCPSocket::close() noexcept
 {
     BaseSocket::close();
@@ -310,6 +428,19 @@ size_t TCPSocket::read(Buffer& buffer, size_t size, sockaddr_in* from)
     return rc;
 }
 
+size_t TCPSocket::read(const vector<Buffer*>& buffers)
+{
+    size_t total = 0;
+    for (auto* buffer: buffers) {
+        size_t bytes = read(*buffer, buffer->capacity());
+        buffer->data()[bytes] = 0;
+        total += bytes;
+        if (bytes < buffer->capacity())
+            break;
+    }
+    return total;
+}
+
 size_t TCPSocket::read(String& buffer, size_t size, sockaddr_in* from)
 {
     buffer.resize(size);
@@ -317,3 +448,74 @@ size_t TCPSocket::read(String& buffer, size_t size, sockaddr_in* from)
     buffer.resize(rc);
     return rc;
 }
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+#include <sptk5/test/TestListener.h>
+
+TEST(SPTK_TCPSocket, connectIPv6)
+{
+    unique_ptr<TestListener> listener;
+    try {
+        listener = make_unique<TestListener>(AF_INET6);
+    }
+    catch (const Exception& e) {
+#ifdef GTEST_SKIP
+        GTEST_SKIP() << "IPv6 isn't available: " << e.what();
+#else
+        // Bundled googletest doesn't support skipped tests
+        RecordProperty("skipped", String("IPv6 isn't available: ") + e.what());
+        cout << "[  SKIPPED ] IPv6 isn't available: " << e.what() << endl;
+        return;
+#endif
+    }
+    uint16_t port = listener->port();
+
+    TCPSocket socket;
+    ASSERT_NO_THROW(socket.open(listener->host(), BaseSocket::SOM_CONNECT, true, chrono::seconds(1)));
+    SOCKET accepted = listener->accept();
+    socket.write("x");
+    char data = 0;
+    EXPECT_EQ(1, (int) ::recv(accepted, &data, 1, 0));
+    EXPECT_EQ('x', data);
+    ::close(accepted);
+    socket.close();
+
+    // Host with both IPv4 and IPv6 addresses falls back to IPv6 when IPv4 connection is refused
+    Host localhost("localhost", port);
+    auto addresses = localhost.addresses();
+    bool hasIPv6 = any_of(addresses.begin(), addresses.end(), [](const sockaddr_storage& address) {
+        return address.ss_family == AF_INET6;
+    });
+    if (hasIPv6) {
+        EXPECT_NO_THROW(socket.open(localhost, BaseSocket::SOM_CONNECT, true, chrono::seconds(1)));
+        socket.close();
+    }
+}
+
+TEST(SPTK_TCPSocket, readLineNonBlocking)
+{
+    TestListener listener;
+    TCPSocket socket;
+    socket.open(listener.host(), BaseSocket::SOM_CONNECT, false, chrono::seconds(1));
+    SOCKET accepted = listener.accept();
+
+    // Line arrives in parts, while the socket has no data in between
+    thread sender([accepted]() {
+        ::send(accepted, "abc", 3, 0);
+        this_thread::sleep_for(chrono::milliseconds(200));
+        ::send(accepted, "def\nghi\n", 8, 0);
+    });
+
+    string line;
+    socket.readLine(line);
+    EXPECT_STREQ("abcdef", line.c_str());
+    socket.readLine(line);
+    EXPECT_STREQ("ghi", line.c_str());
+
+    sender.join();
+    socket.close();
+    ::close(accepted);
+}
+
+#endif
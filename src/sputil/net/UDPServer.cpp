@@ -0,0 +1,234 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       UDPServer.cpp - description                            ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/net/UDPServer.h>
+#include <sptk5/threads/Thread.h>
+
+using namespace std;
+using namespace sptk;
+
+namespace sptk {
+
+/**
+ * @brief UDP server worker thread
+ */
+class UDPServerWorker: public Thread
+{
+    /**
+     * UDP server
+     */
+    UDPServer*              m_server;
+
+    /**
+     * Worker socket
+     */
+    UDPSocket               m_socket;
+
+    /**
+     * Preallocated datagrams batch
+     */
+    vector<UDPDatagram>     m_datagrams;
+
+public:
+    /**
+     * @brief Constructor
+     * @param server            UDP server
+     */
+    explicit UDPServerWorker(UDPServer* server)
+    : Thread("UDPServer::Worker"), m_server(server)
+    {
+        size_t datagramSize = server->m_datagramSize;
+        if (server->m_gro && m_socket.enableGRO(true))
+            datagramSize = max(datagramSize, size_t(65536));
+        for (size_t i = 0; i < server->m_batchSize; i++)
+            m_datagrams.emplace_back(datagramSize);
+    }
+
+    /**
+     * @brief Binds worker socket
+     * @param port              Port number, or 0 if selected by the system
+     * @param bindAddress       Local IP address to bind, or empty string if any
+     * @return bound port number
+     */
+    uint16_t bind(uint16_t port, const String& bindAddress)
+    {
+#ifndef _WIN32
+        m_socket.setOption(SOL_SOCKET, SO_REUSEPORT, 1);
+#endif
+        m_socket.bind(bindAddress.empty() ? nullptr : bindAddress.c_str(), port);
+
+        sockaddr_in address = {};
+        socklen_t len = sizeof(address);
+        if (getsockname(m_socket.handle(), (sockaddr*) &address, &len) != 0)
+            THROW_SOCKET_ERROR("Can't get UDP socket address");
+        return ntohs(address.sin_port);
+    }
+
+    /**
+     * @brief Thread function
+     */
+    void threadFunction() override
+    {
+        while (!terminated()) {
+            try {
+                if (!m_socket.readyToRead(chrono::milliseconds(500)))
+                    continue;
+                size_t count = m_socket.readBatch(m_datagrams);
+                if (count > 0)
+                    m_server->datagramsReceived(m_socket, m_datagrams, count);
+            }
+            catch (const exception& e) {
+                m_server->log(LP_ERROR, e.what());
+            }
+        }
+    }
+};
+
+}
+
+UDPServer::UDPServer(Logger* logger, size_t batchSize, size_t datagramSize, bool gro)
+: m_logger(logger), m_batchSize(batchSize == 0 ? 1 : batchSize), m_datagramSize(datagramSize), m_gro(gro)
+{
+}
+
+UDPServer::~UDPServer()
+{
+    stop();
+}
+
+void UDPServer::listen(uint16_t port, const String& bindAddress, size_t workerCount)
+{
+    stop();
+
+    lock_guard<mutex> lock(m_mutex);
+
+#ifdef _WIN32
+    // Datagrams aren't balanced between sockets bound to the same port
+    workerCount = 1;
+#endif
+    if (workerCount == 0)
+        workerCount = 1;
+
+    try {
+        for (size_t i = 0; i < workerCount; i++) {
+            auto* worker = new UDPServerWorker(this);
+            m_workers.push_back(worker);
+            // Port selected by the system for the first worker is shared by others
+            port = worker->bind(port, bindAddress);
+        }
+    }
+    catch (const exception&) {
+        for (auto* worker: m_workers)
+            delete worker;
+        m_workers.clear();
+        throw;
+    }
+
+    m_port = port;
+    for (auto* worker: m_workers)
+        worker->run();
+}
+
+void UDPServer::stop()
+{
+    lock_guard<mutex> lock(m_mutex);
+    for (auto* worker: m_workers)
+        worker->terminate();
+    for (auto* worker: m_workers) {
+        worker->join();
+        delete worker;
+    }
+    m_workers.clear();
+    m_port = 0;
+}
+
+uint16_t UDPServer::port() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_port;
+}
+
+bool UDPServer::active() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return !m_workers.empty();
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+#include <sptk5/test/TestCounter.h>
+#include <atomic>
+
+class CountingUDPServer : public UDPServer
+{
+public:
+    TestCounter     m_datagrams;
+    atomic<size_t>  m_bytes {0};
+
+    ~CountingUDPServer() override
+    {
+        stop();
+    }
+
+protected:
+    void datagramsReceived(UDPSocket& socket, vector<UDPDatagram>& datagrams, size_t count) override
+    {
+        for (size_t i = 0; i < count; i++)
+            m_bytes += datagrams[i].data.bytes();
+        m_datagrams.add(long(count));
+    }
+};
+
+TEST(SPTK_UDPServer, workers)
+{
+    CountingUDPServer server;
+    server.listen(0, "127.0.0.1", 2);
+    ASSERT_NE(0, server.port());
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = inet_addr("127.0.0.1");
+    address.sin_port = htons(server.port());
+
+    vector<UDPDatagram> datagrams(10);
+    for (auto& datagram: datagrams) {
+        datagram.data.set("0123456789");
+        datagram.address = address;
+    }
+
+    UDPSocket client;
+    client.writeBatch(datagrams);
+
+    EXPECT_TRUE(server.m_datagrams.waitFor(10));
+    EXPECT_EQ(10, long(server.m_datagrams));
+    EXPECT_EQ(size_t(100), server.m_bytes);
+    server.stop();
+    EXPECT_FALSE(server.active());
+}
+
+#endif
@@ -28,6 +28,10 @@
 
 #include <sptk5/net/UDPSocket.h>
 
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
+
 using namespace std;
 using namespace sptk;
 
@@ -45,3 +49,277 @@ size_t UDPSocket::read(char *buffer, size_t size, sockaddr_in* from)
         THROW_SOCKET_ERROR("Can't read to socket");
     return (size_t) bytes;
 }
+
+#ifdef __linux__
+
+// Control message space for GRO or GSO segment size
+#define SEGMENT_CONTROL_SIZE CMSG_SPACE(sizeof(int))
+
+void UDPSocket::reserveBatch(size_t count)
+{
+    if (m_messages.size() < count) {
+        m_messages.resize(count);
+        m_vectors.resize(count);
+        m_control.resize(count * SEGMENT_CONTROL_SIZE);
+    }
+}
+
+size_t UDPSocket::readBatch(vector<UDPDatagram>& datagrams)
+{
+    size_t count = datagrams.size();
+    if (count == 0)
+        return 0;
+
+    reserveBatch(count);
+    memset(m_control.data(), 0, count * SEGMENT_CONTROL_SIZE);
+
+    for (size_t i = 0; i < count; i++) {
+        UDPDatagram& datagram = datagrams[i];
+        m_vectors[i].iov_base = datagram.data.data();
+        m_vectors[i].iov_len = datagram.data.capacity();
+
+        msghdr& header = m_messages[i].msg_hdr;
+        header.msg_name = &datagram.address;
+        header.msg_namelen = sizeof(datagram.address);
+        header.msg_iov = &m_vectors[i];
+        header.msg_iovlen = 1;
+        header.msg_control = m_control.data() + i * SEGMENT_CONTROL_SIZE;
+        header.msg_controllen = SEGMENT_CONTROL_SIZE;
+        header.msg_flags = 0;
+    }
+
+    int received = recvmmsg(m_sockfd, m_messages.data(), (unsigned) count, MSG_WAITFORONE, nullptr);
+    if (received == -1)
+        THROW_SOCKET_ERROR("Can't read from socket");
+
+    for (int i = 0; i < received; i++) {
+        UDPDatagram& datagram = datagrams[i];
+        msghdr& header = m_messages[i].msg_hdr;
+        datagram.data.bytes(m_messages[i].msg_len);
+        datagram.data.data()[m_messages[i].msg_len] = 0;
+        datagram.segmentSize = 0;
+        datagram.truncated = (header.msg_flags & MSG_TRUNC) != 0;
+#ifdef UDP_GRO
+        for (cmsghdr* control = CMSG_FIRSTHDR(&header); control != nullptr; control = CMSG_NXTHDR(&header, control)) {
+            if (control->cmsg_level == IPPROTO_UDP && control->cmsg_type == UDP_GRO) {
+                int segmentSize;
+                memcpy(&segmentSize, CMSG_DATA(control), sizeof(segmentSize));
+                datagram.segmentSize = (size_t) segmentSize;
+            }
+        }
+#endif
+    }
+
+    return (size_t) received;
+}
+
+size_t UDPSocket::writeBatch(const vector<UDPDatagram>& datagrams, size_t count)
+{
+    if (count == 0 || count > datagrams.size())
+        count = datagrams.size();
+    if (count == 0)
+        return 0;
+
+    reserveBatch(count);
+    memset(m_control.data(), 0, count * SEGMENT_CONTROL_SIZE);
+
+    for (size_t i = 0; i < count; i++) {
+        const UDPDatagram& datagram = datagrams[i];
+        m_vectors[i].iov_base = (void*) datagram.data.data();
+        m_vectors[i].iov_len = datagram.data.bytes();
+
+        msghdr& header = m_messages[i].msg_hdr;
+        header.msg_name = (void*) &datagram.address;
+        header.msg_namelen = sizeof(datagram.address);
+        header.msg_iov = &m_vectors[i];
+        header.msg_iovlen = 1;
+        header.msg_control = nullptr;
+        header.msg_controllen = 0;
+        header.msg_flags = 0;
+#ifdef UDP_SEGMENT
+        if (datagram.segmentSize != 0 && datagram.segmentSize < datagram.data.bytes()) {
+            // Kernel splits data into datagrams of segment size (GSO)
+            header.msg_control = m_control.data() + i * SEGMENT_CONTROL_SIZE;
+            header.msg_controllen = SEGMENT_CONTROL_SIZE;
+            cmsghdr* control = CMSG_FIRSTHDR(&header);
+            control->cmsg_level = IPPROTO_UDP;
+            control->cmsg_type = UDP_SEGMENT;
+            control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            auto segmentSize = (uint16_t) datagram.segmentSize;
+            memcpy(CMSG_DATA(control), &segmentSize, sizeof(segmentSize));
+        }
+#endif
+    }
+
+    size_t sent = 0;
+    while (sent < count) {
+        int rc = sendmmsg(m_sockfd, m_messages.data() + sent, (unsigned) (count - sent), 0);
+        if (rc == -1) {
+            if (errno == EINTR)
+                continue;
+            if (sent != 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            THROW_SOCKET_ERROR("Can't write to socket");
+        }
+        sent += (size_t) rc;
+    }
+
+    return sent;
+}
+
+bool UDPSocket::enableGRO(bool enable)
+{
+#ifdef UDP_GRO
+    int value = enable ? 1 : 0;
+    return setsockopt(m_sockfd, IPPROTO_UDP, UDP_GRO, &value, sizeof(value)) == 0;
+#else
+    return false;
+#endif
+}
+
+#else
+
+size_t UDPSocket::readBatch(vector<UDPDatagram>& datagrams)
+{
+    if (datagrams.empty())
+        return 0;
+
+    UDPDatagram& datagram = datagrams[0];
+    datagram.truncated = false;
+
+#ifdef _WIN32
+    size_t bytes;
+    try {
+        bytes = read(datagram.data.data(), datagram.data.capacity(), &datagram.address);
+    }
+    catch (const Exception&) {
+        if (WSAGetLastError() != WSAEMSGSIZE)
+            throw;
+        // Buffer is filled with the beginning of the datagram
+        bytes = datagram.data.capacity();
+        datagram.truncated = true;
+    }
+#else
+    iovec vector = {datagram.data.data(), datagram.data.capacity()};
+    msghdr header = {};
+    header.msg_name = &datagram.address;
+    header.msg_namelen = sizeof(datagram.address);
+    header.msg_iov = &vector;
+    header.msg_iovlen = 1;
+
+    auto received = recvmsg(m_sockfd, &header, 0);
+    if (received == -1)
+        THROW_SOCKET_ERROR("Can't read from socket");
+    auto bytes = (size_t) received;
+    datagram.truncated = (header.msg_flags & MSG_TRUNC) != 0;
+#endif
+
+    datagram.data.bytes(bytes);
+    datagram.data.data()[bytes] = 0;
+    datagram.segmentSize = 0;
+
+    return 1;
+}
+
+size_t UDPSocket::writeBatch(const vector<UDPDatagram>& datagrams, size_t count)
+{
+    if (count == 0 || count > datagrams.size())
+        count = datagrams.size();
+
+    for (size_t i = 0; i < count; i++) {
+        const UDPDatagram& datagram = datagrams[i];
+        size_t segmentSize = datagram.segmentSize == 0 ? datagram.data.bytes() : datagram.segmentSize;
+        size_t offset = 0;
+        do {
+            size_t length = min(segmentSize, datagram.data.bytes() - offset);
+            auto rc = sendto(m_sockfd, datagram.data.data() + offset, (int) length, 0,
+                             (const sockaddr*) &datagram.address, sizeof(datagram.address));
+            if (rc == -1)
+                THROW_SOCKET_ERROR("Can't write to socket");
+            offset += length;
+        } while (offset < datagram.data.bytes());
+    }
+
+    return count;
+}
+
+bool UDPSocket::enableGRO(bool)
+{
+    return false;
+}
+
+#endif
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_UDPSocket, batch)
+{
+    UDPSocket receiver;
+    receiver.bind("127.0.0.1", 0);
+    sockaddr_in address = {};
+    socklen_t len = sizeof(address);
+    getsockname(receiver.handle(), (sockaddr*) &address, &len);
+
+    vector<UDPDatagram> datagrams(5);
+    for (size_t i = 0; i < datagrams.size(); i++) {
+        datagrams[i].data.set("datagram " + int2string(uint32_t(i)));
+        datagrams[i].address = address;
+    }
+
+    UDPSocket sender;
+    EXPECT_EQ(size_t(5), sender.writeBatch(datagrams));
+
+    vector<UDPDatagram> received(8);
+    size_t count = 0;
+    while (count < 5 && receiver.readyToRead(chrono::seconds(1))) {
+        vector<UDPDatagram> batch(8);
+        size_t batchCount = receiver.readBatch(batch);
+        for (size_t i = 0; i < batchCount; i++)
+            received[count++] = batch[i];
+    }
+
+    ASSERT_EQ(size_t(5), count);
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_STREQ(("datagram " + int2string(uint32_t(i))).c_str(), received[i].data.c_str());
+        EXPECT_FALSE(received[i].truncated);
+    }
+}
+
+TEST(SPTK_UDPSocket, batchTruncated)
+{
+    UDPSocket receiver;
+    receiver.bind("127.0.0.1", 0);
+    sockaddr_in address = {};
+    socklen_t len = sizeof(address);
+    getsockname(receiver.handle(), (sockaddr*) &address, &len);
+
+    vector<UDPDatagram> datagrams(2);
+    datagrams[0].data.set("A long datagram that doesn't fit");
+    datagrams[1].data.set("Short");
+    for (auto& datagram: datagrams)
+        datagram.address = address;
+
+    UDPSocket sender;
+    EXPECT_EQ(size_t(2), sender.writeBatch(datagrams));
+
+    vector<UDPDatagram> received;
+    while (received.size() < 2 && receiver.readyToRead(chrono::seconds(1))) {
+        // Reused buffer, filled with previous data
+        vector<UDPDatagram> batch(1, UDPDatagram(16));
+        memset(batch[0].data.data(), 'x', batch[0].data.capacity() + 1);
+        if (receiver.readBatch(batch) == 1)
+            received.push_back(batch[0]);
+    }
+    size_t count = received.size();
+
+    ASSERT_EQ(size_t(2), count);
+    EXPECT_TRUE(received[0].truncated);
+    EXPECT_EQ(received[0].data.capacity(), received[0].data.bytes());
+    EXPECT_STREQ(string("A long datagram that doesn't fit", received[0].data.capacity()).c_str(),
+                 received[0].data.c_str());
+    EXPECT_FALSE(received[1].truncated);
+    EXPECT_STREQ("Short", received[1].data.c_str());
+}
+
+#endif
@@ -43,6 +43,11 @@ void Runable::execute()
     run();
 }
 
+void Runable::waitCompleted()
+{
+    lock_guard<mutex> lock(m_running);
+}
+
 void Runable::terminate()
 {
     m_terminated.store(true);
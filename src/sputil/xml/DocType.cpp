@@ -27,6 +27,7 @@
 */
 
 #include <sptk5/cxml>
+#include <string_view>
 
 using namespace std;
 using namespace sptk;
@@ -40,205 +41,248 @@ xml::DocType::DocType(const char *name, const char *public_id, const char *syste
         m_system_id = system_id;
 }
 
-struct entity
+/**
+ * Returns replacement of predefined XML entity, or nullptr.
+ *
+ * Entity name length and the first character form a perfect hash of predefined entities,
+ * so at most two comparisons are made.
+ */
+static inline const char* builtinReplacement(const char* name, size_t length)
 {
-    const char *name;
-    int replacement_len;
-    const char *replacement;
-};
-
-typedef map<std::string, struct entity *> CEntityMap;
-
-static struct entity builtin_ent_xml[] = {
-        { "amp", 1, "&" },
-        { "lt", 1, "<" },
-        { "gt", 1, ">" },
-        { "apos", 1, "'" },
-        { "quot", 1, "\"" },
-        {nullptr, 1, "\"" }
-};
-
-const char xml_shortcut[] = "&<>'\"";
+    switch (length) {
+        case 2:
+            if (name[1] == 't') {
+                if (name[0] == 'l')
+                    return "<";
+                if (name[0] == 'g')
+                    return ">";
+            }
+            break;
+        case 3:
+            if (name[0] == 'a' && name[1] == 'm' && name[2] == 'p')
+                return "&";
+            break;
+        case 4:
+            if (memcmp(name, "quot", 4) == 0)
+                return "\"";
+            if (memcmp(name, "apos", 4) == 0)
+                return "'";
+            break;
+        default:
+            break;
+    }
+    return nullptr;
+}
 
-class CEntityCache
+static uint32_t encodeUTF8(char* output, unsigned cp)
 {
-    CEntityMap              m_hash;
-    map<int, CEntityMap>    m_replacementMaps;
-public:
+    // based on description from http://en.wikipedia.org/wiki/UTF-8
+    if (cp <= 0x7F) {
+        output[0] = char(cp);
+        return 1;
+    }
+    if (cp <= 0x7FF) {
+        output[0] = char(0xC0 | (cp >> 6));
+        output[1] = char(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp <= 0xFFFF) {
+        output[0] = char(0xE0 | (cp >> 12));
+        output[1] = char(0x80 | ((cp >> 6) & 0x3F));
+        output[2] = char(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    if (cp <= 0x10FFFF) {
+        output[0] = char(0xF0 | (cp >> 18));
+        output[1] = char(0x80 | ((cp >> 12) & 0x3F));
+        output[2] = char(0x80 | ((cp >> 6) & 0x3F));
+        output[3] = char(0x80 | (cp & 0x3F));
+        return 4;
+    }
+    return 0;
+}
 
-    explicit CEntityCache(struct entity entities[]) noexcept
-    {
-        struct entity *ent = entities;
-        for (; ent->name != nullptr; ent++) {
-            m_hash[ent->name] = ent;
-            m_replacementMaps[ent->replacement_len][ent->replacement] = ent;
-        }
+/**
+ * Parses character reference code, such as "123" or "x7B", that may be not zero-terminated
+ * @param text              Character code text, after '#'
+ * @param length            Character code text length
+ * @return character code, or 0 if the text isn't a valid XML character code
+ */
+static unsigned parseCharacterCode(const char* text, size_t length)
+{
+    unsigned base = 10;
+    if (length > 0 && (*text == 'x' || *text == 'X')) {
+        base = 16;
+        text++;
+        length--;
     }
+    if (length == 0)
+        return 0;
 
-    const struct entity *find(const std::string &ent) const
-    {
-        auto itor = m_hash.find(ent);
-        if (itor != m_hash.end())
-            return itor->second;
-        return nullptr;
+    unsigned code = 0;
+    for (const char* end = text + length; text < end; text++) {
+        unsigned digit;
+        if (*text >= '0' && *text <= '9')
+            digit = unsigned(*text - '0');
+        else if (base == 16 && *text >= 'a' && *text <= 'f')
+            digit = unsigned(*text - 'a' + 10);
+        else if (base == 16 && *text >= 'A' && *text <= 'F')
+            digit = unsigned(*text - 'A' + 10);
+        else
+            return 0;
+        code = code * base + digit;
+        if (code > 0x10FFFF)
+            return 0;
     }
 
-    const struct entity *encode(const char* str) const;
-};
+    // Surrogate code points aren't characters
+    if (code >= 0xD800 && code <= 0xDFFF)
+        return 0;
 
-const struct entity *CEntityCache::encode(const char* str) const
+    return code;
+}
+
+static inline void appendText(Buffer& output, const char* text, size_t length)
 {
-    auto maps = m_replacementMaps.begin();
-    for (; maps != m_replacementMaps.end(); ++maps) {
-        int len = maps->first;
-        string fragment(str, size_t(len));
-        const CEntityMap& replacements = maps->second;
-        auto itor = replacements.find(fragment);
-        if (itor != replacements.end())
-            return itor->second;
-    }
-    return nullptr;
+    if (length != 0)
+        output.append(text, length);
 }
 
-static const CEntityCache xml_entities(builtin_ent_xml);
+static inline void appendText(String& output, const char* text, size_t length)
+{
+    output.append(text, length);
+}
 
-void xml::DocType::decodeEntities(const char* str, uint32_t sz, Buffer& ret)
+/**
+ * Decode entities, copying runs of text without entities as is
+ */
+template <class Output>
+static void decodeText(xml::DocType& docType, const char* text, size_t length, Output& output)
 {
-    ret.bytes(0);
-
-    const char* start = str;
-    const char* ptr = str;
-    while (*ptr != char(0)) {
-        const char* ent_start = strchr(ptr, '&');
-        if (ent_start != nullptr) {
-            auto ent_end = (char*) strchr(ent_start + 1, ';');
-            if (ent_end != nullptr) {
-                char ch = *ent_end;
-                *ent_end = 0;
-                uint32_t replacementLength = 0;
-                const char* rep = getReplacement(ent_start + 1, replacementLength);
-                *ent_end = ch;
-                if (rep != nullptr) {
-                    auto len = uint32_t(ent_start - start);
-                    if (len != 0)
-                        ret.append(start, len);
-                    ptr = ent_end + 1;
-                    start = ptr;
-                    ret.append(rep, replacementLength);
-                } else
-                    ptr++;
-            } else {
-                ptr++;
-            }
-        } else {
-            sz = (uint32_t) strlen(start);
+    const char* end = text + length;
+    const char* start = text;
+    const char* ptr = text;
+    for (;;) {
+        // memchr() scans many characters at a time
+        auto* entityStart = (const char*) memchr(ptr, '&', size_t(end - ptr));
+        if (entityStart == nullptr)
+            break;
+        auto* entityEnd = (const char*) memchr(entityStart + 1, ';', size_t(end - entityStart - 1));
+        if (entityEnd == nullptr)
             break;
+
+        uint32_t replacementLength = 0;
+        const char* replacement = docType.getReplacement(entityStart + 1, size_t(entityEnd - entityStart - 1),
+                                                         replacementLength);
+        if (replacement == nullptr) {
+            // Not an entity, keep as is
+            ptr = entityStart + 1;
+            continue;
         }
+
+        appendText(output, start, size_t(entityStart - start));
+        appendText(output, replacement, replacementLength);
+        ptr = start = entityEnd + 1;
     }
-    ret.append(start, sz);
+    appendText(output, start, size_t(end - start));
 }
 
-bool xml::DocType::encodeEntities(const char *str, Buffer& ret)
+void xml::DocType::decodeEntities(const char* str, uint32_t sz, Buffer& ret)
 {
-    entity* table = builtin_ent_xml;
+    ret.reset();
+    decodeText(*this, str, sz, ret);
+}
 
-    bool replaced = false;
+void xml::DocType::decodeEntities(const char* str, size_t sz, String& ret)
+{
+    ret.clear();
+    ret.reserve(sz);
+    decodeText(*this, str, sz, ret);
+}
+
+bool xml::DocType::encodeEntities(const char* str, Buffer& ret)
+{
+    return encodeEntities(str, strlen(str), ret);
+}
 
-    const char* ptr = str;
+bool xml::DocType::encodeEntities(const char* str, size_t sz, Buffer& ret)
+{
+    if (m_entities.empty()) {
+        size_t start = ret.bytes();
+        Writer::appendEscaped(ret, str, sz);
+        return ret.bytes() - start != sz;
+    }
+
+    // Predefined entities first, then values of entities declared in DOCTYPE
     Buffer* src = &m_encodeBuffers[0];
     Buffer* dst = &m_encodeBuffers[1];
-    dst->bytes(0);
-    for (;;) {
-        const char* pos = strpbrk(ptr, xml_shortcut);
-        if (pos != nullptr) {
-            auto index = uint32_t(strchr(xml_shortcut, *pos) - xml_shortcut);
-            entity* ent = table + index;
-            auto tailBytes = uint32_t(pos - ptr);
-            if (tailBytes != 0)
-                dst->append(ptr, tailBytes);
+    src->reset();
+    Writer::appendEscaped(*src, str, sz);
+    bool replaced = src->bytes() != sz;
+
+    for (auto& entity: m_entities) {
+        const string& value = entity.second;
+        if (value.empty())
+            continue;
+
+        string_view text(src->c_str(), src->bytes());
+        size_t pos = text.find(value);
+        if (pos == string_view::npos)
+            continue;
+
+        dst->reset();
+        size_t start = 0;
+        for (; pos != string_view::npos; pos = text.find(value, start)) {
+            appendText(*dst, text.data() + start, pos - start);
             dst->append('&');
-            dst->append(ent->name);
+            dst->append(entity.first);
             dst->append(';');
-            replaced = true;
-            ptr = pos + 1;
-        } else {
-            if (ptr != str) {
-                dst->append(ptr);
-                ptr = dst->data();
-                Buffer* tmp = dst;
-                dst = src;
-                src = tmp;
-                dst->bytes(0);
-            }
-            break;
+            start = pos + value.length();
         }
-    }
+        appendText(*dst, text.data() + start, text.length() - start);
 
-    if (!m_entities.empty()) {
-        auto it = m_entities.begin();
-        for (; it != m_entities.end(); ++it) {
-            std::string& val = it->second;
-            auto len = (uint32_t) val.length();
-            const char* pos = strstr(ptr, val.c_str());
-            while (pos != nullptr) {
-                dst->append(ptr, uint32_t(pos - ptr));
-                dst->append('&');
-                dst->append(it->first);
-                dst->append(';');
-                replaced = true;
-                ptr = pos + len;
-                pos = strstr(ptr, val.c_str());
-                if (pos == nullptr) {
-                    dst->append(ptr);
-                    ptr = dst->data();
-                    Buffer* tmp = dst;
-                    dst = src;
-                    src = tmp;
-                    dst->bytes(0);
-                }
-            }
-        }
+        swap(src, dst);
+        replaced = true;
     }
 
-    if (replaced)
-        ret.append(src->data(), src->bytes());
-    else
-        ret.append(ptr);
+    appendText(ret, src->c_str(), src->bytes());
 
     return replaced;
 }
 
-const char* xml::DocType::getReplacement(const char *name, uint32_t& replacementLength)
+const char* xml::DocType::getReplacement(const char* name, uint32_t& replacementLength)
+{
+    return getReplacement(name, strlen(name), replacementLength);
+}
+
+const char* xml::DocType::getReplacement(const char* name, size_t nameLength, uint32_t& replacementLength)
 {
     // &#123; style entity..
-    if (name[0] == '#') {
-        if (isdigit(name[1]) != 0) {
-            m_replacementBuffer[0] = (char) strtol(name + 1, nullptr, 10);
-            m_replacementBuffer[1] = '\0';
-            replacementLength = 1;
-            return m_replacementBuffer;
-        }
-        if (name[1] == 'x' || name[1] == 'X') {
-            m_replacementBuffer[0] = (char) strtol(name + 2, nullptr, 16);
-            m_replacementBuffer[1] = '\0';
-            replacementLength = 1;
-            return m_replacementBuffer;
-        }
+    if (nameLength > 1 && name[0] == '#') {
+        unsigned code = parseCharacterCode(name + 1, nameLength - 1);
+        if (code == 0)
+            return nullptr;
+        replacementLength = encodeUTF8(m_replacementBuffer, code);
+        if (replacementLength == 0)
+            return nullptr;
+        m_replacementBuffer[replacementLength] = '\0';
+        return m_replacementBuffer;
     }
 
-    // Find in built-ins, see entities.h
-    const struct entity *entity = xml_entities.find(name);
-    if (entity != nullptr) {
-        replacementLength = uint32_t(entity->replacement_len);
-        return entity->replacement;
+    const char* replacement = builtinReplacement(name, nameLength);
+    if (replacement != nullptr) {
+        replacementLength = 1;
+        return replacement;
     }
 
-    // Find in custom attributes
-    Entities::const_iterator itor = m_entities.find(name);
-    if (itor != m_entities.end()) {
-        const string& rep = itor->second;
-        replacementLength = (uint32_t) rep.length();
-        return rep.c_str();
+    // Find in custom entities
+    if (!m_entities.empty()) {
+        auto itor = m_entities.find(string(name, nameLength));
+        if (itor != m_entities.end()) {
+            const string& rep = itor->second;
+            replacementLength = (uint32_t) rep.length();
+            return rep.c_str();
+        }
     }
 
     return nullptr;
@@ -250,3 +294,54 @@ bool xml::DocType::hasEntity(const char *name)
     const char* tmp = getReplacement(name, len);
     return tmp != nullptr;
 }
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_XmlDocType, decodeEntities)
+{
+    xml::DocType docType;
+    docType.setEntity("company", "Acme & Co");
+
+    Buffer decoded;
+    const String text("a &lt; b &amp;&amp; c &#65;&#x42; &#1047; &unknown; &company; & end &gt;");
+    docType.decodeEntities(text.c_str(), uint32_t(text.length()), decoded);
+    EXPECT_STREQ("a < b && c AB \xD0\x97 &unknown; Acme & Co & end >", decoded.c_str());
+
+    String decodedString;
+    docType.decodeEntities(text.c_str(), text.length() - 5, decodedString);
+    EXPECT_STREQ("a < b && c AB \xD0\x97 &unknown; Acme & Co & end", decodedString.c_str());
+
+    docType.decodeEntities("", 0, decoded);
+    EXPECT_STREQ("", decoded.c_str());
+
+    // Invalid character references are left as is
+    const String invalid("&#0; &#x110000; &#99999999999; &#xD800; &#12a; &#x; &#65");
+    docType.decodeEntities(invalid.c_str(), uint32_t(invalid.length()), decoded);
+    EXPECT_STREQ(invalid.c_str(), decoded.c_str());
+
+    // Character code is parsed within the reference only
+    uint32_t length = 0;
+    EXPECT_STREQ("A", docType.getReplacement("#65;66", 3, length));
+    EXPECT_EQ(1U, length);
+}
+
+TEST(SPTK_XmlDocType, encodeEntities)
+{
+    xml::DocType docType;
+
+    Buffer encoded;
+    EXPECT_TRUE(docType.encodeEntities("a < b && \"c\"", encoded));
+    EXPECT_STREQ("a &lt; b &amp;&amp; &quot;c&quot;", encoded.c_str());
+
+    encoded.reset();
+    EXPECT_FALSE(docType.encodeEntities("plain text", encoded));
+    EXPECT_STREQ("plain text", encoded.c_str());
+
+    docType.setEntity("company", "Acme");
+    encoded.reset();
+    EXPECT_TRUE(docType.encodeEntities("Acme <Acme>", encoded));
+    EXPECT_STREQ("&company; &lt;&company;&gt;", encoded.c_str());
+}
+
+#endif
@@ -45,6 +45,7 @@ Document::Document()
         m_indentSpaces(2),
         m_matchNumber(MATCH_NUMBER, "i")
 {
+    m_type = DOM_DOCUMENT;
 }
 
 Document::Document(const String& xml)
@@ -53,6 +54,7 @@ Document::Document(const String& xml)
         m_indentSpaces(2),
         m_matchNumber(MATCH_NUMBER, "i")
 {
+    m_type = DOM_DOCUMENT;
     load(xml);
 }
 
@@ -62,6 +64,7 @@ Document::Document(const char* aname, const char* public_id, const char* system_
   m_indentSpaces(2),
   m_matchNumber(MATCH_NUMBER, "i")
 {
+    m_type = DOM_DOCUMENT;
 }
 
 Node* Document::rootNode()
@@ -122,9 +125,12 @@ void Document::processAttributes(Node* node, const char* ptr)
             }
         }
 
-        m_encodeBuffer.bytes(0);
-        m_doctype.decodeEntities(attributeValue, valueLength, m_encodeBuffer);
-        attr.setAttribute(attributeName, m_encodeBuffer.c_str());
+        if (memchr(attributeValue, '&', valueLength) == nullptr)
+            attr.setAttribute(attributeName, attributeValue);
+        else {
+            m_doctype.decodeEntities(attributeValue, valueLength, m_encodeBuffer);
+            attr.setAttribute(attributeName, m_encodeBuffer.c_str());
+        }
 
         if (tokenEnd != nullptr)
             tokenStart = tokenEnd + 1;
@@ -381,9 +387,15 @@ void Document::load(const char* xmlData)
                     if (*textTrail > ' ') {
                         textTrail++;
                         *textTrail = 0;
-                        Buffer& decoded = m_decodeBuffer;
-                        doctype->decodeEntities((char*) textStart, uint32_t(textTrail - textStart), decoded);
-                        new Text(currentNode, decoded.c_str());
+                        auto textLength = size_t(textTrail - textStart);
+                        if (memchr(textStart, '&', textLength) == nullptr)
+                            new Text(currentNode, (char*) textStart);
+                        else {
+                            // Decode directly into the text node value
+                            String decoded;
+                            doctype->decodeEntities((char*) textStart, textLength, decoded);
+                            new Text(currentNode, move(decoded));
+                        }
                         break;
                     }
                 }
@@ -398,47 +410,10 @@ void Document::load(const char* xmlData)
 
 void Document::save(Buffer& buffer, int) const
 {
-    Node* xml_pi = nullptr;
-
     buffer.reset();
 
-    // Write XML PI
-    bool hasXmlPI = false;
-    for (auto node: *this) {
-        if (node->type() == DOM_PI && lowerCase(node->name()) == "xml") {
-            xml_pi = node;
-            xml_pi->save(buffer);
-            hasXmlPI = true;
-            break;
-        }
-    }
-    if (!hasXmlPI)
-        buffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
-
-    if (!docType().name().empty()) {
-        buffer.append("<!DOCTYPE " + docType().name());
-        if (!docType().systemID().empty())
-            buffer.append(" SYSTEM \"" + docType().systemID() + "\"");
-
-        if (!docType().publicID().empty())
-            buffer.append(" PUBLIC \"" + docType().publicID() + "\"");
-
-        if (!docType().entities().empty()) {
-            buffer.append(" [\n", 3);
-            const Entities& entities = docType().entities();
-            for (auto it: entities)
-                buffer.append("<!ENTITY " + it.first + " \"" + it.second + "\">\n");
-            buffer.append("]", 1);
-        }
-        buffer.append(">\n", 2);
-    }
-
-    // call save() method of the first (and hopefully only) node in xml document
-    for (auto node: *this) {
-        if (node == xml_pi)
-            continue;
-        node->save(buffer, 0);
-    }
+    Writer writer(buffer, m_indentSpaces);
+    writer.write(*this);
 }
 
 const std::string& Document::name() const
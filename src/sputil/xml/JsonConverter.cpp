@@ -0,0 +1,931 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       JsonConverter.cpp - description                        ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/cxml>
+#include <sptk5/xml/JsonConverter.h>
+#include <sptk5/json/JsonWriter.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+using namespace std;
+using namespace sptk;
+using namespace sptk::xml;
+
+namespace {
+
+/**
+ * XML pull reader, used for one-pass conversion of XML text.
+ *
+ * Text is trimmed and entity-decoded the same way as in xml::Document::load().
+ */
+class XmlEventReader
+{
+public:
+    /**
+     * XML reader events
+     */
+    enum Event : uint8_t
+    {
+        END_OF_DATA,        ///< End of XML text
+        START_ELEMENT,      ///< Element start tag, name and attributes are available
+        END_ELEMENT,        ///< Element end tag, name is available
+        TEXT,               ///< Text, value is available
+        CDATA,              ///< CDATA section, value is available
+        COMMENT,            ///< Comment, value is available
+        PI                  ///< Processing instruction, name and value are available
+    };
+
+    XmlEventReader(const char* xml, size_t length)
+    : m_pos(xml), m_end(xml + length)
+    {
+    }
+
+    XmlEventReader(istream& stream, size_t blockSize)
+    : m_stream(&stream), m_blockSize(blockSize), m_buffer(blockSize + 1)
+    {
+        m_pos = m_end = m_buffer.c_str();
+    }
+
+    /**
+     * Read next event
+     */
+    Event next();
+
+    const String& name() const
+    {
+        return m_name;
+    }
+
+    const Buffer& value() const
+    {
+        return m_value;
+    }
+
+    /**
+     * True if the last start tag is also an end tag, as in <element/>
+     */
+    bool emptyElement() const
+    {
+        return m_emptyElement;
+    }
+
+    size_t attributeCount() const
+    {
+        return m_attributeCount;
+    }
+
+    const pair<String, String>& attribute(size_t index) const
+    {
+        return m_attributes[index];
+    }
+
+private:
+    istream*                    m_stream {nullptr};     ///< Input stream, if reading from stream
+    size_t                      m_blockSize {0};        ///< Input block size
+    Buffer                      m_buffer;               ///< Input window, if reading from stream
+    const char*                 m_pos;                  ///< Current read position
+    const char*                 m_end;                  ///< End of input window
+    DocType                     m_docType;              ///< Entities declared in DOCTYPE
+    String                      m_name;                 ///< Last element or PI name
+    Buffer                      m_value;                ///< Last text, CDATA, comment, or PI value
+    vector<pair<String,String>> m_attributes;           ///< Last start tag attributes, reused between tags
+    size_t                      m_attributeCount {0};   ///< Number of attributes in the last start tag
+    bool                        m_emptyElement {false}; ///< True if the last start tag is an empty element tag
+
+    bool fill();
+
+    bool ensure(size_t size)
+    {
+        while (size_t(m_end - m_pos) < size) {
+            if (!fill())
+                return false;
+        }
+        return true;
+    }
+
+    bool startsWith(const char* pattern, size_t length)
+    {
+        return ensure(length) && memcmp(m_pos, pattern, length) == 0;
+    }
+
+    /**
+     * Find pattern, reading more input if necessary
+     * @return pattern offset from the current position, or string::npos if not found
+     */
+    size_t find(const char* pattern, size_t length, size_t offset);
+
+    /**
+     * Find the end of tag, skipping quoted attribute values
+     * @return '>' offset from the current position
+     */
+    size_t findTagEnd(size_t offset);
+
+    void decode(const char* text, size_t length, Buffer& output);
+
+    void readStartTag(const char* tag, size_t length);
+
+    void readDocType(size_t end);
+};
+
+bool XmlEventReader::fill()
+{
+    if (m_stream == nullptr)
+        return false;
+
+    // Keep unread data at the start of the window
+    auto remaining = size_t(m_end - m_pos);
+    if (remaining != 0 && m_pos != m_buffer.c_str())
+        memmove(m_buffer.data(), m_pos, remaining);
+    m_buffer.checkSize(remaining + m_blockSize + 1);
+
+    m_stream->read(m_buffer.data() + remaining, (streamsize) m_blockSize);
+    auto bytes = (size_t) m_stream->gcount();
+
+    m_buffer.bytes(remaining + bytes);
+    m_pos = m_buffer.c_str();
+    m_end = m_pos + remaining + bytes;
+
+    return bytes != 0;
+}
+
+size_t XmlEventReader::find(const char* pattern, size_t length, size_t offset)
+{
+    for (;;) {
+        auto available = size_t(m_end - m_pos);
+        while (offset + length <= available) {
+            auto* found = (const char*) memchr(m_pos + offset, *pattern, available - offset - length + 1);
+            if (found == nullptr) {
+                offset = available - length + 1;
+                break;
+            }
+            offset = size_t(found - m_pos);
+            if (memcmp(found, pattern, length) == 0)
+                return offset;
+            offset++;
+        }
+        if (!fill())
+            return string::npos;
+    }
+}
+
+size_t XmlEventReader::findTagEnd(size_t offset)
+{
+    char quote = 0;
+    for (;;) {
+        auto available = size_t(m_end - m_pos);
+        for (; offset < available; offset++) {
+            char ch = m_pos[offset];
+            if (quote != 0) {
+                if (ch == quote)
+                    quote = 0;
+            } else if (ch == '>')
+                return offset;
+            else if (ch == '"' || ch == '\'')
+                quote = ch;
+        }
+        if (!fill())
+            throw Exception("Invalid tag (started, not closed)");
+    }
+}
+
+void XmlEventReader::decode(const char* text, size_t length, Buffer& output)
+{
+    if (memchr(text, '&', length) == nullptr) {
+        output.set(text, length);
+        return;
+    }
+    m_docType.decodeEntities(text, uint32_t(length), output);
+}
+
+void XmlEventReader::readStartTag(const char* tag, size_t length)
+{
+    m_emptyElement = length != 0 && tag[length - 1] == '/';
+    if (m_emptyElement)
+        length--;
+
+    const char* end = tag + length;
+    const char* ptr = tag;
+    while (ptr < end && (unsigned char) *ptr > ' ' && *ptr != '/')
+        ptr++;
+    m_name.assign(tag, size_t(ptr - tag));
+
+    m_attributeCount = 0;
+    for (;;) {
+        while (ptr < end && (unsigned char) *ptr <= ' ')
+            ptr++;
+        if (ptr == end)
+            break;
+
+        const char* attributeName = ptr;
+        while (ptr < end && *ptr != '=' && (unsigned char) *ptr > ' ')
+            ptr++;
+        size_t nameLength = size_t(ptr - attributeName);
+        while (ptr < end && (*ptr == '=' || *ptr == ' '))
+            ptr++;
+        if (ptr == end)
+            throw Exception("Incorrect attribute - missing '='");
+
+        const char* attributeValue;
+        size_t valueLength;
+        if (*ptr == '"' || *ptr == '\'') {
+            attributeValue = ptr + 1;
+            ptr = (const char*) memchr(attributeValue, *ptr, size_t(end - attributeValue));
+            if (ptr == nullptr)
+                throw Exception("Incorrect attribute format - missing quote");
+            valueLength = size_t(ptr - attributeValue);
+            ptr++;
+        } else {
+            attributeValue = ptr;
+            while (ptr < end && *ptr != ' ')
+                ptr++;
+            valueLength = size_t(ptr - attributeValue);
+        }
+
+        if (m_attributeCount == m_attributes.size())
+            m_attributes.emplace_back();
+        auto& attribute = m_attributes[m_attributeCount++];
+        attribute.first.assign(attributeName, nameLength);
+        decode(attributeValue, valueLength, m_value);
+        attribute.second.assign(m_value.c_str(), m_value.bytes());
+    }
+}
+
+void XmlEventReader::readDocType(size_t end)
+{
+    // Only entity declarations are used, for decoding text
+    String docType(m_pos, end);
+    size_t pos = 0;
+    while ((pos = docType.find("<!ENTITY", pos)) != string::npos) {
+        pos += 8;
+        size_t nameStart = docType.find_first_not_of(" \t\r\n", pos);
+        if (nameStart == string::npos)
+            break;
+        size_t nameEnd = docType.find_first_of(" \t\r\n", nameStart);
+        if (nameEnd == string::npos)
+            break;
+        size_t valueStart = docType.find_first_of("\"'", nameEnd);
+        if (valueStart == string::npos)
+            break;
+        size_t valueEnd = docType.find(docType[valueStart], valueStart + 1);
+        if (valueEnd == string::npos)
+            break;
+        m_docType.setEntity(docType.substr(nameStart, nameEnd - nameStart).c_str(),
+                            docType.substr(valueStart + 1, valueEnd - valueStart - 1).c_str());
+        pos = valueEnd + 1;
+    }
+}
+
+XmlEventReader::Event XmlEventReader::next()
+{
+    for (;;) {
+        // Text before the next tag
+        size_t tagStart = find("<", 1, 0);
+        bool endOfData = tagStart == string::npos;
+        if (endOfData)
+            tagStart = size_t(m_end - m_pos);
+
+        const char* textStart = m_pos;
+        const char* textEnd = m_pos + tagStart;
+        while (textStart < textEnd && (unsigned char) *textStart <= ' ')
+            textStart++;
+        while (textEnd > textStart && (unsigned char) textEnd[-1] <= ' ')
+            textEnd--;
+        if (textStart != textEnd) {
+            decode(textStart, size_t(textEnd - textStart), m_value);
+            m_pos += tagStart;
+            return TEXT;
+        }
+
+        m_pos += tagStart;
+        if (endOfData)
+            return END_OF_DATA;
+
+        size_t end;
+        if (startsWith("<!--", 4)) {
+            end = find("-->", 3, 4);
+            if (end == string::npos)
+                throw Exception("Invalid end of the comment tag");
+            m_value.set(m_pos + 4, end - 4);
+            m_pos += end + 3;
+            return COMMENT;
+        }
+
+        if (startsWith("<![CDATA[", 9)) {
+            end = find("]]>", 3, 9);
+            if (end == string::npos)
+                throw Exception("Invalid CDATA section");
+            m_value.set(m_pos + 9, end - 9);
+            m_pos += end + 3;
+            return CDATA;
+        }
+
+        if (!ensure(2))
+            throw Exception("Tag started but not closed");
+
+        switch (m_pos[1]) {
+            case '!':
+                end = findTagEnd(2);
+                if (startsWith("<!DOCTYPE", 9)) {
+                    size_t subsetStart = find("[", 1, 9);
+                    if (subsetStart != string::npos && subsetStart < end) {
+                        end = find("]", 1, subsetStart);
+                        if (end != string::npos)
+                            end = find(">", 1, end);
+                        if (end == string::npos)
+                            throw Exception("Invalid DOCTYPE section");
+                        readDocType(end);
+                    }
+                }
+                m_pos += end + 1;
+                break;
+
+            case '?': {
+                end = find("?>", 2, 2);
+                if (end == string::npos)
+                    throw Exception("Invalid PI section");
+                const char* name = m_pos + 2;
+                const char* value = name;
+                const char* valueEnd = m_pos + end;
+                while (value < valueEnd && (unsigned char) *value > ' ')
+                    value++;
+                m_name.assign(name, size_t(value - name));
+                while (value < valueEnd && (unsigned char) *value <= ' ')
+                    value++;
+                m_value.set(value, size_t(valueEnd - value));
+                m_pos += end + 2;
+                return PI;
+            }
+
+            case '/': {
+                end = findTagEnd(2);
+                const char* nameEnd = m_pos + end;
+                while (nameEnd > m_pos + 2 && (unsigned char) nameEnd[-1] <= ' ')
+                    nameEnd--;
+                m_name.assign(m_pos + 2, size_t(nameEnd - m_pos - 2));
+                m_pos += end + 1;
+                return END_ELEMENT;
+            }
+
+            default:
+                end = findTagEnd(1);
+                readStartTag(m_pos + 1, end - 1);
+                m_pos += end + 1;
+                return START_ELEMENT;
+        }
+    }
+}
+
+inline bool isDigit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+/**
+ * Returns true if text is a number, matching "^[+\-]?(\d|[1-9]\d*)(\.\d+)?(e-?\d+)?$"
+ * that is used by xml::Document for the same purpose
+ */
+bool isNumber(const char* text, size_t length)
+{
+    const char* ptr = text;
+    const char* end = text + length;
+
+    if (ptr < end && (*ptr == '+' || *ptr == '-'))
+        ptr++;
+    if (ptr == end || !isDigit(*ptr))
+        return false;
+    if (*ptr == '0')
+        ptr++;
+    else
+        while (ptr < end && isDigit(*ptr))
+            ptr++;
+
+    if (ptr < end && *ptr == '.') {
+        ptr++;
+        if (ptr == end || !isDigit(*ptr))
+            return false;
+        while (ptr < end && isDigit(*ptr))
+            ptr++;
+    }
+
+    if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+        ptr++;
+        if (ptr < end && *ptr == '-')
+            ptr++;
+        if (ptr == end || !isDigit(*ptr))
+            return false;
+        while (ptr < end && isDigit(*ptr))
+            ptr++;
+    }
+
+    return ptr == end;
+}
+
+/**
+ * Converts XML events to JSON text.
+ *
+ * JSON text is written directly to output. Element value is written as an object, and is
+ * rewritten in place when the element turns out to be a string, a number, or has repeated members.
+ */
+class XmlToJson
+{
+public:
+    explicit XmlToJson(Buffer& output)
+    : m_output(output)
+    {
+    }
+
+    void convert(XmlEventReader& reader)
+    {
+        m_output.bytes(0);
+        convertRoot(reader);
+        // Output is mostly written by single characters, that don't zero-terminate the buffer
+        m_output.checkSize(m_output.bytes() + 1);
+        m_output.data()[m_output.bytes()] = 0;
+    }
+
+private:
+    /**
+     * State of the element being converted
+     */
+    struct Level
+    {
+        /**
+         * Written object member
+         */
+        struct Member
+        {
+            size_t  nameIndex;              ///< Index of member name in names
+            size_t  start;                  ///< Offset of member in output, starting from '{' or ','
+            size_t  valueStart;             ///< Offset of member value in output
+        };
+
+        String  name;                       ///< Element name
+        String  text;                       ///< Element text
+        size_t  valueStart {0};             ///< Offset of element value in output
+        size_t  childrenStart {0};          ///< Offset of the first child element member in output
+        size_t  childCount {0};             ///< Number of child nodes
+        bool    hasAttributes {false};      ///< True if element has attributes
+        bool    firstChildIsNull {false};   ///< True if the first child node is element <null>
+        bool    repeatedMembers {false};    ///< True if some member names are repeated
+        vector<Member>                  members;        ///< Written object members
+        vector<String>                  names;          ///< Distinct member names
+        unordered_map<string, size_t>   nameIndexes;    ///< Member name to index in names
+    };
+
+    Buffer&         m_output;               ///< Output JSON text
+    vector<Level>   m_levels;               ///< Open elements, reused between elements
+    size_t          m_depth {0};            ///< Number of open elements
+
+    void beginMember(Level& level, const char* name, size_t length);
+
+    void beginMember(Level& level, const String& name)
+    {
+        beginMember(level, name.c_str(), name.length());
+    }
+
+    void beginElement(const XmlEventReader& reader);
+
+    void endElement(Level& level);
+
+    void mergeRepeatedMembers(Level& level);
+
+    void convertRoot(XmlEventReader& reader);
+};
+
+void XmlToJson::beginMember(Level& level, const char* name, size_t length)
+{
+    size_t start = m_output.bytes();
+    m_output.append(level.members.empty() ? '{' : ',');
+    json::Writer::appendString(m_output, name, length);
+    m_output.append(':');
+
+    auto inserted = level.nameIndexes.emplace(string(name, length), level.names.size());
+    if (inserted.second)
+        level.names.push_back(inserted.first->first);
+    else
+        level.repeatedMembers = true;
+
+    level.members.push_back({inserted.first->second, start, m_output.bytes()});
+}
+
+void XmlToJson::mergeRepeatedMembers(Level& level)
+{
+    // Repeated members are merged into array, placed as json::Element::add() does it:
+    // at the position of the second member with the same name.
+    struct MergedMember
+    {
+        size_t          position {0};       ///< Position of merged member in object
+        vector<size_t>  members;            ///< Indexes of members with the same name
+    };
+
+    vector<MergedMember> merged(level.names.size());
+    for (size_t i = 0; i < level.members.size(); i++) {
+        auto& mergedMember = merged[level.members[i].nameIndex];
+        if (mergedMember.members.size() < 2)
+            mergedMember.position = i;
+        mergedMember.members.push_back(i);
+    }
+
+    vector<size_t> order(merged.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    sort(order.begin(), order.end(), [&merged](size_t a, size_t b) {
+        return merged[a].position < merged[b].position;
+    });
+
+    size_t start = level.members[0].start;
+    size_t end = m_output.bytes();
+    auto memberValue = [&level, end](size_t member, size_t& valueEnd) {
+        valueEnd = member + 1 < level.members.size() ? level.members[member + 1].start : end;
+        return level.members[member].valueStart;
+    };
+
+    // Object with the only "item" array is replaced with the array
+    bool itemArray = merged.size() == 1 && merged[0].members.size() > 1 && level.names[0] == "item";
+
+    Buffer output(end - start + merged.size() * 2 + 2);
+    if (!itemArray)
+        output.append('{');
+    for (size_t index: order) {
+        auto& mergedMember = merged[index];
+        if (!itemArray) {
+            if (output.bytes() > 1)
+                output.append(',');
+            json::Writer::appendString(output, level.names[index].c_str(), level.names[index].length());
+            output.append(':');
+        }
+        bool isArray = mergedMember.members.size() > 1;
+        if (isArray)
+            output.append('[');
+        for (size_t member: mergedMember.members) {
+            size_t valueEnd;
+            size_t valueStart = memberValue(member, valueEnd);
+            if (member != mergedMember.members[0])
+                output.append(',');
+            output.append(m_output.data() + valueStart, valueEnd - valueStart);
+        }
+        if (isArray)
+            output.append(']');
+    }
+    if (!itemArray)
+        output.append('}');
+
+    m_output.bytes(start);
+    m_output.append(output);
+}
+
+void XmlToJson::beginElement(const XmlEventReader& reader)
+{
+    Level& parent = m_levels[m_depth - 1];
+    parent.childCount++;
+    if (parent.childCount == 1)
+        parent.firstChildIsNull = reader.name() == "null";
+    beginMember(parent, reader.name());
+
+    if (m_depth == m_levels.size())
+        m_levels.emplace_back();
+    Level& level = m_levels[m_depth++];
+    level.name = reader.name();
+    level.text.clear();
+    level.childCount = 0;
+    level.repeatedMembers = false;
+    level.members.clear();
+    level.names.clear();
+    level.nameIndexes.clear();
+    level.valueStart = m_output.bytes();
+    level.hasAttributes = reader.attributeCount() != 0;
+
+    if (level.hasAttributes) {
+        beginMember(level, "attributes", 10);
+        m_output.append('{');
+        for (size_t i = 0; i < reader.attributeCount(); i++) {
+            auto& attribute = reader.attribute(i);
+            if (i != 0)
+                m_output.append(',');
+            json::Writer::appendString(m_output, attribute.first.c_str(), attribute.first.length());
+            m_output.append(':');
+            json::Writer::appendString(m_output, attribute.second.c_str(), attribute.second.length());
+        }
+        m_output.append('}');
+    }
+    level.childrenStart = m_output.bytes();
+
+    if (reader.emptyElement()) {
+        m_depth--;
+        endElement(level);
+    }
+}
+
+void XmlToJson::endElement(Level& level)
+{
+    if (m_depth == 0) {
+        // Root element: only child elements are exported
+        if (level.members.empty()) {
+            m_output.append("{}", 2);
+            return;
+        }
+    } else if (level.childCount == 0) {
+        m_output.bytes(level.valueStart);
+        m_output.append("\"\"", 2);
+        return;
+    } else if (level.childCount == 1 && level.firstChildIsNull) {
+        m_output.bytes(level.childrenStart);
+        if (level.hasAttributes)
+            m_output.append('}');
+        else
+            m_output.append("{}", 2);
+        return;
+    } else if (level.members.empty()) {
+        if (isNumber(level.text.c_str(), level.text.length()))
+            json::Writer::appendNumber(m_output, string2double(level.text));
+        else
+            json::Writer::appendString(m_output, level.text.c_str(), level.text.length());
+        return;
+    }
+
+    if (level.repeatedMembers)
+        mergeRepeatedMembers(level);
+    else
+        m_output.append('}');
+}
+
+void XmlToJson::convertRoot(XmlEventReader& reader)
+{
+    // Skip everything before root element
+    XmlEventReader::Event event;
+    while ((event = reader.next()) != XmlEventReader::START_ELEMENT) {
+        if (event == XmlEventReader::END_OF_DATA) {
+            m_output.append("{}", 2);
+            return;
+        }
+    }
+
+    m_levels.resize(1);
+    Level& root = m_levels[0];
+    root.name = reader.name();
+    root.valueStart = m_output.bytes();
+    m_depth = 1;
+    if (reader.emptyElement()) {
+        m_depth = 0;
+        endElement(root);
+        return;
+    }
+
+    while (m_depth != 0) {
+        event = reader.next();
+        Level& level = m_levels[m_depth - 1];
+        switch (event) {
+            case XmlEventReader::START_ELEMENT:
+                beginElement(reader);
+                break;
+
+            case XmlEventReader::END_ELEMENT:
+                if (reader.name() != level.name)
+                    throw Exception("Closing tag <" + reader.name() + "> doesn't match opening <" + level.name + ">");
+                m_depth--;
+                endElement(level);
+                break;
+
+            case XmlEventReader::TEXT:
+                level.childCount++;
+                level.text.append(reader.value().c_str(), reader.value().bytes());
+                break;
+
+            case XmlEventReader::CDATA:
+                level.childCount++;
+                beginMember(level, "#cdata-section", 14);
+                json::Writer::appendString(m_output, reader.value().c_str(), reader.value().bytes());
+                break;
+
+            case XmlEventReader::COMMENT:
+                level.childCount++;
+                beginMember(level, "#comment", 8);
+                m_output.append("{\"comments\":", 12);
+                json::Writer::appendString(m_output, reader.value().c_str(), reader.value().bytes());
+                m_output.append('}');
+                break;
+
+            case XmlEventReader::PI:
+                level.childCount++;
+                beginMember(level, reader.name());
+                json::Writer::appendString(m_output, reader.value().c_str(), reader.value().bytes());
+                break;
+
+            case XmlEventReader::END_OF_DATA:
+                throw Exception("Tag started but not closed");
+        }
+    }
+}
+
+}
+
+void JsonConverter::toJSON(Buffer& output, const char* xml, size_t length)
+{
+    XmlEventReader reader(xml, length);
+    XmlToJson(output).convert(reader);
+}
+
+void JsonConverter::toJSON(Buffer& output, istream& xml, size_t blockSize)
+{
+    XmlEventReader reader(xml, blockSize);
+    XmlToJson(output).convert(reader);
+}
+
+void JsonConverter::toXML(Writer& output, json::StreamReader& input, const String& rootNodeName)
+{
+    static const String itemName("item");
+
+    // For every open JSON object or array: true if array
+    vector<bool> scopes;
+    String name(rootNodeName);
+    do {
+        const String& elementName = !scopes.empty() && scopes.back() ? itemName : name;
+        switch (input.next()) {
+            case json::StreamReader::KEY:
+                name = input.name();
+                break;
+
+            case json::StreamReader::BEGIN_OBJECT:
+            case json::StreamReader::BEGIN_ARRAY:
+                output.beginElement(elementName);
+                scopes.push_back(input.event() == json::StreamReader::BEGIN_ARRAY);
+                break;
+
+            case json::StreamReader::END_OBJECT:
+            case json::StreamReader::END_ARRAY:
+                output.endElement();
+                scopes.pop_back();
+                break;
+
+            case json::StreamReader::STRING:
+                output.beginElement(elementName);
+                output.text(input.getString());
+                output.endElement();
+                break;
+
+            case json::StreamReader::NUMBER:
+                output.beginElement(elementName);
+                output.text(json::Element::formatNumber(input.getNumber()));
+                output.endElement();
+                break;
+
+            case json::StreamReader::BOOLEAN:
+                output.beginElement(elementName);
+                output.text(input.getBoolean() ? "true" : "false");
+                output.endElement();
+                break;
+
+            case json::StreamReader::NULL_VALUE:
+                output.beginElement(elementName);
+                output.beginElement("null");
+                output.endElement();
+                output.endElement();
+                break;
+
+            default:
+                // End of data
+                scopes.clear();
+                break;
+        }
+    } while (!scopes.empty());
+    output.flush();
+}
+
+void JsonConverter::toXML(Buffer& output, const char* json, size_t length, const String& rootNodeName,
+                          int indentSpaces)
+{
+    output.bytes(0);
+    json::StreamReader input(json, length);
+    Writer writer(output, indentSpaces);
+    writer.processingInstruction("xml", "version=\"1.0\" encoding=\"UTF-8\" ");
+    toXML(writer, input, rootNodeName);
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+#include <sptk5/json/JsonDocument.h>
+#include <sstream>
+
+static const char* testXML =
+    "<data>\n"
+    "  <name>John &amp; Co</name>\n"
+    "  <age>42</age>\n"
+    "  <height>1.85</height>\n"
+    "  <code>007</code>\n"
+    "  <empty/>\n"
+    "  <person id=\"1\" type='admin &lt;A&gt;'><name>Jane</name><!-- manager --></person>\n"
+    "  <nothing><null/></nothing>\n"
+    "  <list><item>1</item><item>two</item><item><x>3</x></item></list>\n"
+    "  <phone>123</phone><phone>456</phone>\n"
+    "  <note><![CDATA[<raw> text]]></note>\n"
+    "</data>\n";
+
+static String exportedJSON(const json::Document& document)
+{
+    Buffer output;
+    document.exportTo(output, false);
+    return String(output.c_str(), output.bytes());
+}
+
+TEST(SPTK_XmlJsonConverter, toJSON)
+{
+    xml::Document xmlDocument;
+    xmlDocument.load(testXML);
+    json::Document expected;
+    xmlDocument.exportTo(expected.root());
+
+    Buffer output;
+    xml::JsonConverter::toJSON(output, testXML, strlen(testXML));
+    json::Document converted;
+    converted.load(output.c_str());
+
+    EXPECT_EQ(exportedJSON(expected), exportedJSON(converted));
+    EXPECT_DOUBLE_EQ(42, converted.root().getNumber("age"));
+    EXPECT_STREQ("007", converted.root().getString("code").c_str());
+    EXPECT_EQ(3U, converted.root().getArray("list").size());
+    EXPECT_STREQ("admin <A>", converted.root()["person"]["attributes"].getString("type").c_str());
+}
+
+TEST(SPTK_XmlJsonConverter, toJSONNonAdjacentRepeats)
+{
+    const String xml("<data>"
+                     "<phone>1</phone><name>John</name><phone>2</phone><age>42</age><phone>3</phone>"
+                     "<list><item>1</item><x>5</x><item>2</item></list>"
+                     "<items><item>a</item><!-- b --><item/><item>c</item></items>"
+                     "<person id=\"1\"><attributes>x</attributes><name>Jane</name></person>"
+                     "<name>Jim</name>"
+                     "</data>");
+
+    xml::Document xmlDocument;
+    xmlDocument.load(xml);
+    json::Document expected;
+    xmlDocument.exportTo(expected.root());
+
+    Buffer output;
+    xml::JsonConverter::toJSON(output, xml.c_str(), xml.length());
+    EXPECT_STREQ(exportedJSON(expected).c_str(), output.c_str());
+}
+
+TEST(SPTK_XmlJsonConverter, toJSONFromStream)
+{
+    String xml = String("<?xml version=\"1.0\"?>\n"
+                        "<!DOCTYPE data [ <!ENTITY company \"Acme\"> ]>\n") + testXML;
+    xml = xml.replace("John", "&company;");
+
+    Buffer expected;
+    xml::JsonConverter::toJSON(expected, testXML, strlen(testXML));
+
+    stringstream stream(xml);
+    Buffer output;
+    xml::JsonConverter::toJSON(output, stream, 16);
+    EXPECT_STREQ(expected.c_str(), String(output.c_str()).replace("Acme", "John").c_str());
+
+    EXPECT_THROW(xml::JsonConverter::toJSON(output, "<data><a></b></data>", 20), Exception);
+    EXPECT_THROW(xml::JsonConverter::toJSON(output, "<data><a>", 9), Exception);
+}
+
+TEST(SPTK_XmlJsonConverter, toXML)
+{
+    const String testJSON(R"({"name":"John & Co","age":42,"height":1.85,"admin":true,"empty":"",)"
+                          R"("nothing":null,"list":[1,"two",{"x":3},[]],"person":{"id":1}})");
+
+    json::Document jsonDocument;
+    jsonDocument.load(testJSON);
+    xml::Document xmlDocument;
+    jsonDocument.exportTo(xmlDocument, "data");
+    Buffer expected;
+    xmlDocument.save(expected, 0);
+
+    Buffer output;
+    xml::JsonConverter::toXML(output, testJSON.c_str(), testJSON.length());
+
+    EXPECT_STREQ(expected.c_str(), output.c_str());
+}
+
+#endif
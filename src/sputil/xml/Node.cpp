@@ -30,6 +30,7 @@
 #include <sptk5/cxml>
 
 #include <sptk5/json/JsonDocument.h>
+#include <unordered_map>
 
 using namespace std;
 using namespace sptk;
@@ -37,7 +38,6 @@ using namespace sptk::xml;
 
 /// An empty string to use as a stub for value()
 static const String emptyString;
-static const String indentsString(1024, ' ');
 
 /// An empty nodes set to emulate a set of stub iterators
 static NodeList emptyNodes;
@@ -320,102 +320,8 @@ void Node::text(const String& txt)
 
 void Node::save(Buffer& buffer, int indent) const
 {
-    // output indendation spaces
-    if (indent > 0)
-        buffer.append(indentsString.c_str(), size_t(indent));
-
-    const string& nodeName = name();
-
-    if (type() == DOM_ELEMENT) {
-        // Output tag name
-        buffer.append('<');
-        buffer.append(nodeName);
-        const Attributes& attributes = this->attributes();
-        if (!attributes.empty()) {
-            // Output attributes
-            Buffer real_id, real_val;
-            for (auto attributeNode: attributes) {
-                real_id.bytes(0);
-                real_val.bytes(0);
-                if (!document()->docType().encodeEntities(attributeNode->name().c_str(), real_id))
-                    real_id = attributeNode->name();
-                if (!document()->docType().encodeEntities(attributeNode->value().c_str(), real_val))
-                    real_val = attributeNode->value();
-
-                buffer.append(' ');
-                buffer.append(real_id);
-                buffer.append("=\"");
-                buffer.append(real_val);
-                buffer.append("\"");
-            }
-        }
-    }
-
-    // depending on the nodetype, do output
-    switch (type()) {
-        case DOM_PI:
-            buffer.append("<?" + std::string(name()) + " " + value() + "?>\n");
-            break;
-
-        case DOM_TEXT:
-            if (value().substr(0, 9) == "<![CDATA[" && value().substr(value().length() - 3) == "]]>")
-                buffer.append(value());
-            else
-                document()->docType().encodeEntities(value().c_str(), buffer);
-            break;
-
-        case DOM_CDATA_SECTION:
-            // output all subnodes
-            buffer.append("<![CDATA[" + value() + "]]>\n");
-            break;
-
-        case DOM_COMMENT:
-            // output all subnodes
-            buffer.append("<!-- " + value() + " -->\n");
-            break;
-
-        case DOM_ELEMENT: {
-            if (!empty()) {
-                bool only_cdata;
-                Node* nd = *begin();
-                if (size() == 1 && nd->type() == DOM_TEXT) {
-                    only_cdata = true;
-                    buffer.append('>');
-                } else {
-                    only_cdata = false;
-                    buffer.append(">\n", 2);
-                }
-
-                // output all subnodes
-                for (auto np: *this) {
-                    if (only_cdata)
-                        np->save(buffer, -1);
-                    else {
-                        np->save(buffer, indent + m_document->indentSpaces());
-                        if (buffer.data()[buffer.bytes() - 1] != '\n')
-                            buffer.append(char('\n'));
-                    }
-                }
-
-                // output indendation spaces
-                if (!only_cdata && indent > 0)
-                    buffer.append(indentsString.c_str(), size_t(indent));
-
-                // output closing tag
-                buffer.append("</", 2);
-                buffer.append(name());
-                buffer.append(">\n", 2);
-
-            } else {
-                //LEAF
-                buffer.append("/>\n", 3);
-            }
-        }
-            break;
-
-        default: // unknown nodetype
-            break;
-    }
+    Writer writer(buffer, m_document->indentSpaces());
+    writer.write(*this, indent);
 }
 
 void Node::save(json::Element& json, string& text) const
@@ -497,12 +403,20 @@ void Node::exportTo(json::Element& element) const
 }
 
 Node* Node::findFirst(const std::string& aname, bool recursively) const
+{
+    const string* sharedName = document()->findString(aname);
+    if (sharedName == nullptr && (aname.empty() || aname[0] != '#'))
+        return nullptr; // Element, attribute, and PI names are shared strings
+    return findFirst(sharedName, aname, recursively);
+}
+
+Node* Node::findFirst(const std::string* sharedName, const std::string& aname, bool recursively) const
 {
     for (auto node: *this) {
-        if (node->name() == aname)
+        if (sharedName != nullptr ? node->nameIs(sharedName) : node->name() == aname)
             return node;
         if (recursively && !node->empty()) {
-            Node* cnode = node->findFirst(aname, true);
+            Node* cnode = node->findFirst(sharedName, aname, true);
             if (cnode != nullptr)
                 return cnode;
         }
@@ -526,27 +440,175 @@ const std::string& BaseTextNode::nodeName() const
 void NamedItem::name(const std::string& name)
 {
     m_name = &document()->shareString(name.c_str());
+    if (m_parent != nullptr && m_parent->isElement())
+        static_cast<Element*>(m_parent)->resetChildIndex();
 }
 
 void NamedItem::name(const char* name)
 {
     m_name = &document()->shareString(name);
+    if (m_parent != nullptr && m_parent->isElement())
+        static_cast<Element*>(m_parent)->resetChildIndex();
+}
+
+struct Element::ChildIndex
+{
+    typedef pair<const string*, const string*> QualifiedName;
+
+    struct QualifiedNameHash
+    {
+        size_t operator()(const QualifiedName& name) const
+        {
+            return hash<const string*>()(name.first) * 31 + hash<const string*>()(name.second);
+        }
+    };
+
+    unordered_map<const string*, Element*>                          byName;      ///< First child element by name
+    unordered_map<QualifiedName, Element*, QualifiedNameHash>       byNameSpace; ///< First child element by namespace URI and local name
+};
+
+Element::~Element()
+{
+    delete m_childIndex;
+}
+
+void Element::resetChildIndex()
+{
+    delete m_childIndex;
+    m_childIndex = nullptr;
+}
+
+const Element::ChildIndex& Element::childIndex() const
+{
+    if (m_childIndex != nullptr)
+        return *m_childIndex;
+
+    m_childIndex = new ChildIndex;
+    ChildIndex& index = *m_childIndex;
+    index.byName.reserve(m_nodes.size());
+    index.byNameSpace.reserve(m_nodes.size());
+
+    // Namespace URIs of prefixes, declared in this element or its ancestors
+    map<string, const string*> nameSpaces;
+    for (auto* node: m_nodes) {
+        if (node->type() != DOM_ELEMENT)
+            continue;
+        auto* element = static_cast<Element*>(node);
+        const string& elementName = element->name();
+        index.byName.emplace(&elementName, element);
+
+        size_t pos = elementName.find(':');
+        string prefix = pos == string::npos ? string() : elementName.substr(0, pos);
+        const string* nameSpaceURI;
+        if (element->hasAttributes()) {
+            // Element may declare its own namespaces
+            nameSpaceURI = &m_document->shareString(element->lookupNamespaceURI(prefix).c_str());
+        } else {
+            auto itor = nameSpaces.find(prefix);
+            if (itor == nameSpaces.end()) {
+                auto* uri = &m_document->shareString(lookupNamespaceURI(prefix).c_str());
+                itor = nameSpaces.emplace(prefix, uri).first;
+            }
+            nameSpaceURI = itor->second;
+        }
+
+        const string* localName = &elementName;
+        if (pos != string::npos)
+            localName = &m_document->shareString(elementName.c_str() + pos + 1, elementName.length() - pos - 1);
+        index.byNameSpace.emplace(ChildIndex::QualifiedName(nameSpaceURI, localName), element);
+    }
+
+    return index;
+}
+
+Element* Element::findChild(const std::string& name) const
+{
+    const string* sharedName = m_document->findString(name);
+    if (sharedName == nullptr)
+        return nullptr;
+
+    if (m_nodes.size() < IndexedChildrenThreshold) {
+        for (auto* node: m_nodes) {
+            if (node->type() == DOM_ELEMENT && node->nameIs(sharedName))
+                return static_cast<Element*>(node);
+        }
+        return nullptr;
+    }
+
+    const auto& byName = childIndex().byName;
+    auto itor = byName.find(sharedName);
+    if (itor == byName.end())
+        return nullptr;
+    return itor->second;
+}
+
+Element* Element::findChild(const std::string& nameSpaceURI, const std::string& localName) const
+{
+    if (m_nodes.size() < IndexedChildrenThreshold) {
+        for (auto* node: m_nodes) {
+            if (node->type() != DOM_ELEMENT)
+                continue;
+            const string& elementName = node->name();
+            if (elementName.length() < localName.length())
+                continue;
+            size_t prefixLength = elementName.length() - localName.length();
+            if (prefixLength == 1 || (prefixLength != 0 && elementName[prefixLength - 1] != ':'))
+                continue;
+            if (elementName.compare(prefixLength, localName.length(), localName) != 0)
+                continue;
+            auto* element = static_cast<Element*>(node);
+            string prefix = prefixLength == 0 ? string() : elementName.substr(0, prefixLength - 1);
+            if (element->lookupNamespaceURI(prefix) == nameSpaceURI)
+                return element;
+        }
+        return nullptr;
+    }
+
+    const ChildIndex& index = childIndex();
+    const string* sharedNameSpaceURI = m_document->findString(nameSpaceURI);
+    const string* sharedLocalName = m_document->findString(localName);
+    if (sharedNameSpaceURI == nullptr || sharedLocalName == nullptr)
+        return nullptr;
+
+    auto itor = index.byNameSpace.find(ChildIndex::QualifiedName(sharedNameSpaceURI, sharedLocalName));
+    if (itor == index.byNameSpace.end())
+        return nullptr;
+    return itor->second;
+}
+
+String Element::lookupNamespaceURI(const std::string& prefix) const
+{
+    string attributeName = prefix.empty() ? string("xmlns") : "xmlns:" + prefix;
+    if (m_document->findString(attributeName) == nullptr)
+        return String(); // Namespace isn't declared anywhere in the document
+
+    for (const Node* node = this; node != nullptr && node->isElement(); node = node->parent()) {
+        const Attributes& attributes = node->attributes();
+        auto itor = attributes.findFirst(attributeName);
+        if (itor != attributes.end())
+            return (*itor)->value();
+    }
+
+    return String();
 }
 
 void Element::insert(iterator itor, Node* node)
 {
+    resetChildIndex();
     m_nodes.insert(itor, node);
     node->m_parent = this;
 }
 
 void Element::push_back(Node* node)
 {
+    resetChildIndex();
     m_nodes.insert(m_nodes.end(), node);
     node->m_parent = this;
 }
 
 void Element::unlink(Node* node)
 {
+    resetChildIndex();
     auto itor = find(begin(), end(), node);
     if (itor == end())
         return;
@@ -555,6 +617,7 @@ void Element::unlink(Node* node)
 
 void Element::remove(Node* node)
 {
+    resetChildIndex();
     auto itor = find(begin(), end(), node);
     if (itor == end())
         return;
@@ -564,11 +627,13 @@ void Element::remove(Node* node)
 
 void Element::clearChildren()
 {
+    resetChildIndex();
     m_nodes.clear();
 }
 
 void Element::clear()
 {
+    resetChildIndex();
     Node::clear();
     m_nodes.clear();
     m_attributes.clear();
@@ -671,4 +736,47 @@ TEST(SPTK_XmlElement, select4)
     EXPECT_STREQ("4", elementSet[0]->text().c_str());
 }
 
+TEST(SPTK_XmlElement, findChild)
+{
+    const String testXML(
+        "<soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\" xmlns:ns=\"urn:test\">"
+        "<soap:Header/><env:Body xmlns:env=\"http://schemas.xmlsoap.org/soap/envelope/\"/>"
+        "</soap:Envelope>");
+
+    xml::Document document(testXML);
+    auto* envelope = document.findChild("soap:Envelope");
+    ASSERT_TRUE(envelope != nullptr);
+    EXPECT_EQ(xml::Node::DOM_ELEMENT, envelope->type());
+    EXPECT_EQ(xml::Node::DOM_DOCUMENT, document.type());
+    EXPECT_STREQ("http://schemas.xmlsoap.org/soap/envelope/", envelope->lookupNamespaceURI("soap").c_str());
+    EXPECT_STREQ("", envelope->lookupNamespaceURI("xxx").c_str());
+
+    // Body uses different prefix for the same namespace
+    auto* body = envelope->findChild("http://schemas.xmlsoap.org/soap/envelope/", "Body");
+    ASSERT_TRUE(body != nullptr);
+    EXPECT_STREQ("env:Body", body->name().c_str());
+    EXPECT_TRUE(envelope->findChild("soap:Body") == nullptr);
+
+    // Add enough children to use index
+    for (int i = 0; i < 100; i++)
+        new xml::Element(envelope, ("ns:item" + to_string(i)).c_str());
+    auto* item = envelope->findChild("urn:test", "item50");
+    ASSERT_TRUE(item != nullptr);
+    EXPECT_STREQ("ns:item50", item->name().c_str());
+    EXPECT_TRUE(envelope->findChild("ns:item99") != nullptr);
+    EXPECT_TRUE(envelope->findChild("urn:test", "item100") == nullptr);
+    body = envelope->findChild("http://schemas.xmlsoap.org/soap/envelope/", "Body");
+    EXPECT_TRUE(body != nullptr);
+
+    // Index is updated when children are changed
+    item->name("ns:renamed");
+    EXPECT_TRUE(envelope->findChild("urn:test", "item50") == nullptr);
+    EXPECT_EQ(item, envelope->findChild("urn:test", "renamed"));
+    envelope->remove(item);
+    EXPECT_TRUE(envelope->findChild("ns:renamed") == nullptr);
+
+    EXPECT_EQ(envelope, document.findFirst("soap:Envelope"));
+    EXPECT_TRUE(document.findFirst("soap:Unknown") == nullptr);
+}
+
 #endif
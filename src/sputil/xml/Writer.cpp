@@ -0,0 +1,459 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       Writer.cpp - description                               ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include <sptk5/cxml>
+#include <sptk5/xml/Writer.h>
+#include <sptk5/xml/Document.h>
+#include <sptk5/net/BaseSocket.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+using namespace sptk;
+using namespace sptk::xml;
+
+static const char indentSpacesString[] = "                                                                ";
+
+Writer::Writer(Buffer& output, int indentSpaces)
+: m_output(output), m_indentSpaces(indentSpaces)
+{
+}
+
+Writer::Writer(BaseSocket& socket, int indentSpaces, size_t flushSize)
+: m_output(m_buffer), m_socket(&socket), m_flushSize(flushSize), m_indentSpaces(indentSpaces)
+{
+    m_buffer.reserve(flushSize + 1024);
+}
+
+void Writer::appendIndent(size_t indent)
+{
+    while (indent > 0) {
+        size_t portion = min(indent, sizeof(indentSpacesString) - 1);
+        m_output.append(indentSpacesString, portion);
+        indent -= portion;
+    }
+}
+
+/**
+ * Returns entity for XML special character, or nullptr
+ */
+static inline const char* entityFor(char ch, size_t& length)
+{
+    switch (ch) {
+        case '&':
+            length = 5;
+            return "&amp;";
+        case '<':
+            length = 4;
+            return "&lt;";
+        case '>':
+            length = 4;
+            return "&gt;";
+        case '\'':
+            length = 6;
+            return "&apos;";
+        case '"':
+            length = 6;
+            return "&quot;";
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * Find the first XML special character
+ * @param text                  Text
+ * @param end                   End of text
+ * @return position of the first special character, or end
+ */
+static inline const char* findSpecialCharacter(const char* text, const char* end)
+{
+#ifdef __SSE2__
+    // Checks 16 characters at a time
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i apos = _mm_set1_epi8('\'');
+    const __m128i quot = _mm_set1_epi8('"');
+    while (end - text >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*) text);
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, amp), _mm_cmpeq_epi8(chunk, lt)),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, gt), _mm_cmpeq_epi8(chunk, apos)),
+                         _mm_cmpeq_epi8(chunk, quot)));
+        auto mask = (unsigned) _mm_movemask_epi8(matches);
+        if (mask != 0)
+            return text + __builtin_ctz(mask);
+        text += 16;
+    }
+#endif
+    size_t length;
+    while (text < end && entityFor(*text, length) == nullptr)
+        text++;
+    return text;
+}
+
+void Writer::appendEscaped(Buffer& output, const char* text, size_t length)
+{
+    const char* end = text + length;
+    output.checkSize(output.bytes() + length + 1);
+    while (text < end) {
+        const char* special = findSpecialCharacter(text, end);
+        if (special != text)
+            output.append(text, size_t(special - text));
+        if (special == end)
+            break;
+        size_t entityLength;
+        const char* entity = entityFor(*special, entityLength);
+        output.append(entity, entityLength);
+        text = special + 1;
+    }
+}
+
+void Writer::appendText(const char* text, size_t length)
+{
+    if (m_docType != nullptr)
+        m_docType->encodeEntities(text, length, m_output);
+    else
+        appendEscaped(m_output, text, length);
+}
+
+void Writer::appendText(const String& text)
+{
+    if (m_docType != nullptr)
+        m_docType->encodeEntities(text.c_str(), text.length(), m_output);
+    else
+        appendEscaped(m_output, text.c_str(), text.length());
+}
+
+void Writer::write(const Node& node, int indent)
+{
+    if (node.type() == Node::DOM_DOCUMENT) {
+        writeDocument(node);
+        return;
+    }
+
+    DocType& docType = node.document()->docType();
+    m_docType = docType.entities().empty() ? nullptr : &docType;
+
+    // output indentation spaces
+    if (indent > 0)
+        appendIndent(size_t(indent));
+
+    switch (node.type()) {
+        case Node::DOM_ELEMENT:
+            writeElement(node, indent);
+            break;
+
+        case Node::DOM_PI:
+            m_output.append("<?", 2);
+            m_output.append(node.name());
+            m_output.append(' ');
+            m_output.append(node.value());
+            m_output.append("?>\n", 3);
+            break;
+
+        case Node::DOM_TEXT: {
+            const String& value = node.value();
+            if (value.length() >= 12 && value.compare(0, 9, "<![CDATA[") == 0
+                && value.compare(value.length() - 3, 3, "]]>") == 0)
+                m_output.append(value);
+            else
+                appendText(value);
+            break;
+        }
+
+        case Node::DOM_CDATA_SECTION:
+            m_output.append("<![CDATA[", 9);
+            m_output.append(node.value());
+            m_output.append("]]>\n", 4);
+            break;
+
+        case Node::DOM_COMMENT:
+            m_output.append("<!-- ", 5);
+            m_output.append(node.value());
+            m_output.append(" -->\n", 5);
+            break;
+
+        default: // unknown node type
+            break;
+    }
+}
+
+void Writer::writeElement(const Node& node, int indent)
+{
+    const string& nodeName = node.name();
+
+    m_output.append('<');
+    m_output.append(nodeName);
+    for (auto* attributeNode: node.attributes()) {
+        m_output.append(' ');
+        m_output.append(attributeNode->name());
+        m_output.append("=\"", 2);
+        appendText(attributeNode->value());
+        m_output.append('"');
+    }
+
+    if (node.empty()) {
+        m_output.append("/>\n", 3);
+        checkFlush();
+        return;
+    }
+
+    const Node* firstChild = *node.begin();
+    if (node.size() == 1 && firstChild->type() == Node::DOM_TEXT) {
+        // Text-only element is written on a single line
+        m_output.append('>');
+        write(*firstChild, -1);
+    } else {
+        m_output.append(">\n", 2);
+        for (auto* child: node) {
+            write(*child, indent + m_indentSpaces);
+            if (!atLineStart())
+                m_output.append('\n');
+        }
+        if (indent > 0)
+            appendIndent(size_t(indent));
+    }
+
+    m_output.append("</", 2);
+    m_output.append(nodeName);
+    m_output.append(">\n", 2);
+    checkFlush();
+}
+
+void Writer::writeDocument(const Node& document)
+{
+    const Node* xmlPI = nullptr;
+
+    // Write XML PI
+    for (auto* node: document) {
+        if (node->type() == Node::DOM_PI && lowerCase(node->name()) == "xml") {
+            xmlPI = node;
+            write(*node);
+            break;
+        }
+    }
+    if (xmlPI == nullptr)
+        m_output.append("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
+
+    const DocType& docType = document.document()->docType();
+    if (!docType.name().empty()) {
+        m_output.append("<!DOCTYPE ", 10);
+        m_output.append(docType.name());
+        if (!docType.systemID().empty()) {
+            m_output.append(" SYSTEM \"", 9);
+            m_output.append(docType.systemID());
+            m_output.append('"');
+        }
+
+        if (!docType.publicID().empty()) {
+            m_output.append(" PUBLIC \"", 9);
+            m_output.append(docType.publicID());
+            m_output.append('"');
+        }
+
+        if (!docType.entities().empty()) {
+            m_output.append(" [\n", 3);
+            for (auto& it: docType.entities()) {
+                m_output.append("<!ENTITY ", 9);
+                m_output.append(it.first);
+                m_output.append(" \"", 2);
+                m_output.append(it.second);
+                m_output.append("\">\n", 3);
+            }
+            m_output.append(']');
+        }
+        m_output.append(">\n", 2);
+    }
+
+    for (auto* node: document) {
+        if (node != xmlPI)
+            write(*node, 0);
+    }
+}
+
+void Writer::beginChildLine()
+{
+    if (m_startTagOpen) {
+        m_output.append(">\n", 2);
+        m_startTagOpen = false;
+    } else if (!atLineStart())
+        m_output.append('\n');
+
+    if (!m_scopes.empty())
+        m_scopes.back().hasChildren = true;
+
+    appendIndent(m_scopes.size() * size_t(m_indentSpaces));
+}
+
+void Writer::beginElement(const String& name)
+{
+    beginChildLine();
+    m_output.append('<');
+    m_output.append(name);
+    m_scopes.push_back({name, false});
+    m_startTagOpen = true;
+}
+
+void Writer::attribute(const String& name, const String& value)
+{
+    if (!m_startTagOpen)
+        throw Exception("XML attribute must follow element start");
+    m_output.append(' ');
+    m_output.append(name);
+    m_output.append("=\"", 2);
+    appendText(value);
+    m_output.append('"');
+}
+
+void Writer::endElement()
+{
+    if (m_scopes.empty())
+        throw Exception("Unexpected end of XML element");
+
+    Scope& scope = m_scopes.back();
+    if (m_startTagOpen) {
+        m_output.append("/>\n", 3);
+        m_startTagOpen = false;
+    } else {
+        if (scope.hasChildren) {
+            if (!atLineStart())
+                m_output.append('\n');
+            appendIndent((m_scopes.size() - 1) * size_t(m_indentSpaces));
+        }
+        m_output.append("</", 2);
+        m_output.append(scope.name);
+        m_output.append(">\n", 2);
+    }
+    m_scopes.pop_back();
+    checkFlush();
+}
+
+void Writer::text(const char* text, size_t length)
+{
+    if (m_startTagOpen) {
+        m_output.append('>');
+        m_startTagOpen = false;
+    }
+    appendText(text, length);
+}
+
+void Writer::cdata(const String& text)
+{
+    beginChildLine();
+    m_output.append("<![CDATA[", 9);
+    m_output.append(text);
+    m_output.append("]]>\n", 4);
+    checkFlush();
+}
+
+void Writer::comment(const String& text)
+{
+    beginChildLine();
+    m_output.append("<!-- ", 5);
+    m_output.append(text);
+    m_output.append(" -->\n", 5);
+    checkFlush();
+}
+
+void Writer::processingInstruction(const String& name, const String& value)
+{
+    beginChildLine();
+    m_output.append("<?", 2);
+    m_output.append(name);
+    m_output.append(' ');
+    m_output.append(value);
+    m_output.append("?>\n", 3);
+    checkFlush();
+}
+
+void Writer::flush()
+{
+    if (m_socket == nullptr || m_output.bytes() == 0)
+        return;
+    m_socket->write(m_output);
+    m_output.bytes(0);
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_XmlWriter, events)
+{
+    Buffer output;
+    xml::Writer writer(output);
+    writer.processingInstruction("xml", "version=\"1.0\" encoding=\"UTF-8\"");
+    writer.beginElement("people");
+    writer.beginElement("person");
+    writer.attribute("id", "1");
+    writer.beginElement("name");
+    writer.text("John <Johnny> & Co");
+    writer.endElement();
+    writer.beginElement("empty");
+    writer.endElement();
+    writer.comment("end of person");
+    writer.endElement();
+    writer.endElement();
+
+    EXPECT_STREQ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                 "<people>\n"
+                 "  <person id=\"1\">\n"
+                 "    <name>John &lt;Johnny&gt; &amp; Co</name>\n"
+                 "    <empty/>\n"
+                 "    <!-- end of person -->\n"
+                 "  </person>\n"
+                 "</people>\n", output.c_str());
+
+    EXPECT_THROW(writer.endElement(), Exception);
+    EXPECT_THROW(writer.attribute("id", "2"), Exception);
+}
+
+TEST(SPTK_XmlWriter, document)
+{
+    const char* xml =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"
+        "<root>\n"
+        "  <item name=\"a &quot;quoted&quot; value\">It&apos;s a text long enough to be scanned in blocks &lt;1&gt;</item>\n"
+        "  <list>\n"
+        "    <item/>\n"
+        "    <![CDATA[<raw>]]>\n"
+        "  </list>\n"
+        "</root>\n";
+
+    xml::Document document;
+    document.load(xml);
+
+    Buffer output;
+    document.save(output, 0);
+    EXPECT_STREQ(xml, output.c_str());
+}
+
+#endif
@@ -44,15 +44,8 @@ WSConnection::WSConnection(SOCKET connectionSocket, sockaddr_in* addr, WSRequest
 
 void WSConnection::threadFunction()
 {
-    RegularExpression parseProtocol("^(GET|POST) (\\S+)", "i");
-    RegularExpression parseHeader("^([^:]+): \"{0,1}(.*)\"{0,1}$", "i");
-
-    Buffer data;
-
-    // Read request data
-    String row;
-    Strings matches;
-    String protocolName, url, requestType;
+    String protocolName, url;
+    Buffer content;
 
     try {
         if (!m_socket->readyToRead(chrono::seconds(30))) {
@@ -62,39 +55,61 @@ void WSConnection::threadFunction()
         }
 
         HttpHeaders headers;
-
-        String request;
+        HttpRequestParser parser;
+        TCPSocketReader& reader = m_socket->reader();
 
         try {
-            while (!terminated()) {
-                if (m_socket->readLine(data) == 0)
+            // Request head is parsed in place, in the socket read buffer
+            size_t headLength = 0;
+            while (headLength == 0) {
+                if (terminated())
                     return;
-                row = trim(data.c_str());
-                if (protocolName.empty()) {
-                    if (row.find("<?xml") == 0) {
+                const char* data = reader.readPosition();
+                size_t length = reader.availableBytes();
+                if (parser.state() == HttpRequestParser::REQUEST_LINE) {
+                    size_t position = 0;
+                    while (position < length && isspace((unsigned char) data[position]))
+                        position++;
+                    if (position < length && data[position] == '<') {
+                        // Plain XML request, without HTTP headers
                         protocolName = "xml";
                         break;
                     }
-                    if (parseProtocol.m(row, matches)) {
-                        request = row;
-                        protocolName = "http";
-                        requestType = matches[0];
-                        url = matches[1];
-                        continue;
-                    }
                 }
-                if (parseHeader.m(row, matches)) {
-                    String header = matches[0];
-                    String value = matches[1];
-                    headers[header] = value;
-                    continue;
-                }
-                if (row.empty()) {
-                    data.reset();
-                    break;
+                if (length != 0)
+                    headLength = parser.parseHead(data, length);
+                if (headLength == 0 && reader.readMore() == 0)
+                    return;
+            }
+
+            if (headLength != 0) {
+                protocolName = "http";
+                url.assign(parser.url().data(), parser.url().length());
+                parser.exportHeaders(headers);
+                reader.consume(headLength);
+
+                if (parser.expectContinue() && !parser.complete())
+                    m_socket->write("HTTP/1.1 100 Continue\r\n\r\n");
+
+                if (parser.chunked()) {
+                    // Chunked request body is decoded here, and passed to protocol as sized content
+                    while (!parser.complete()) {
+                        reader.consume(parser.parseBody(reader.readPosition(), reader.availableBytes(), content));
+                        if (!parser.complete() && reader.readMore() == 0)
+                            throw Exception("Client disconnected");
+                    }
+                    headers.erase("Transfer-Encoding");
+                    headers["Content-Length"] = int2string(content.bytes());
                 }
             }
         }
+        catch (HTTPException& e) {
+            // Request that can't be served is rejected, and connection is closed
+            m_logger.error(e.message());
+            m_socket->write("HTTP/1.1 " + int2string(e.statusCode()) + " " + e.statusText() + "\r\n"
+                            "Connection: close\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
         catch (Exception& e) {
             m_logger.error(e.message());
             return;
@@ -134,7 +149,7 @@ void WSConnection::threadFunction()
             return;
         }
 
-        WSWebServiceProtocol protocol(m_socket, url, headers, m_service);
+        WSWebServiceProtocol protocol(m_socket, url, headers, m_service, move(content));
         protocol.process();
     }
     catch (exception& e) {
@@ -152,11 +167,16 @@ WSSSLConnection::WSSSLConnection(SOCKET connectionSocket, sockaddr_in* addr, WSR
                                  const String& wsRequestPage, bool encrypted)
 : WSConnection(connectionSocket, addr, service, logger, staticFilesDirectory, htmlIndexPage, wsRequestPage)
 {
-    if (encrypted)
-        m_socket = new SSLSocket;
-    else
+    if (encrypted) {
+        auto* socket = new SSLSocket;
+        m_socket = socket;
+
+        // Handshake is completed by the server, before the connection thread starts
+        socket->startAccept(connectionSocket);
+    } else {
         m_socket = new TCPSocket;
-    m_socket->attach(connectionSocket);
+        m_socket->attach(connectionSocket);
+    }
 }
 
 WSSSLConnection::~WSSSLConnection()
@@ -33,6 +33,7 @@
 #include "protocol/WSWebServiceProtocol.h"
 #include "protocol/WSWebSocketsProtocol.h"
 #include <sptk5/wsdl/WSRequest.h>
+#include <sptk5/net/HttpRequestParser.h>
 
 namespace sptk {
 
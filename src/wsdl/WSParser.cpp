@@ -309,6 +309,20 @@ void WSParser::generateImplementation(ostream& serviceImplementation)
     serviceImplementation << "using namespace std;" << endl;
     serviceImplementation << "using namespace sptk;" << endl << endl;
 
+    std::set<String> names;
+    for (auto itor: m_complexTypes)
+        itor.second->collectNames(names);
+    names.erase("");
+
+    serviceImplementation << "// Element and attribute names of the service messages, shared by all XML documents" << endl;
+    serviceImplementation << "static const bool staticNamesRegistered = SharedStrings::registerStaticNames({";
+    bool first = true;
+    for (auto& name: names) {
+        serviceImplementation << (first ? "" : ",") << endl << "    \"" << name << "\"";
+        first = false;
+    }
+    serviceImplementation << endl << "});" << endl << endl;
+
     serviceImplementation << "void " << serviceClassName << "::requestBroker(xml::Element* requestNode, HttpAuthentication* authentication, const WSNameSpace& requestNameSpace)" << endl;
     serviceImplementation << "{" << endl;
     serviceImplementation << "    static const WSMessageIndex messageNames(Strings(\"" << operationNames << "\", \"|\"));" << endl << endl;
@@ -110,6 +110,15 @@ String WSParserComplexType::className() const
     return "C" + m_typeName.substr(pos + 1);
 }
 
+void WSParserComplexType::collectNames(std::set<String>& names) const
+{
+    names.insert(m_name);
+    for (auto itor: m_attributes)
+        names.insert(itor.second->name());
+    for (auto complexType: m_sequence)
+        complexType->collectNames(names);
+}
+
 void WSParserComplexType::parseSequence(xml::Element* sequence)
 {
     for (auto node: *sequence) {
@@ -354,10 +363,10 @@ void WSParserComplexType::generateImplementation(std::ostream& classImplementati
     if (!m_sequence.empty()) {
         classImplementation << endl << "    // Load elements" << endl;
         classImplementation << "    for (auto node: *input) {" << endl;
-        classImplementation << "        auto element = dynamic_cast<xml::Element*>(node);" << endl;
-        classImplementation << "        if (element == nullptr) {" << endl;
+        classImplementation << "        if (node->type() != xml::Node::DOM_ELEMENT) {" << endl;
         classImplementation << "            continue;" << endl;
         classImplementation << "        }" << endl;
+        classImplementation << "        auto element = static_cast<xml::Element*>(node);" << endl;
         Strings requiredElements;
         for (auto complexType: m_sequence) {
             classImplementation << endl;
@@ -46,18 +46,16 @@ static void extractNameSpaces(xml::Node* node, map<String,WSNameSpace>& nameSpac
 
 void WSRequest::processRequest(sptk::xml::Document* request, HttpAuthentication* authentication)
 {
-    WSNameSpace             soapNamespace, requestNameSpace;
+    WSNameSpace             requestNameSpace;
     xml::Element*           soapEnvelope = nullptr;
     map<String,WSNameSpace> allNamespaces;
     for (auto anode: *request) {
-        auto node = dynamic_cast<xml::Element*>(anode);
-        if (node == nullptr)
+        if (anode->type() != xml::Node::DOM_ELEMENT)
             continue;
+        auto node = static_cast<xml::Element*>(anode);
         if (node->tagname() == "Envelope") {
             soapEnvelope = node;
-            String nameSpaceAlias = node->nameSpace();
             extractNameSpaces(soapEnvelope, allNamespaces);
-            soapNamespace = allNamespaces[nameSpaceAlias];
             break;
         }
     }
@@ -68,17 +66,16 @@ void WSRequest::processRequest(sptk::xml::Document* request, HttpAuthentication*
     xml::Element* soapBody;
     {
         lock_guard<mutex> lock(*this);
-        soapBody = dynamic_cast<xml::Element*>(soapEnvelope->findFirst(soapNamespace.getAlias() + ":Body"));
+        soapBody = soapEnvelope->findChild(soapEnvelope->lookupNamespaceURI(soapEnvelope->nameSpace()), "Body");
         if (soapBody == nullptr)
             throwException("Can't find SOAP Body node in incoming request");
     }
 
     xml::Element* requestNode = nullptr;
     for (auto anode: *soapBody) {
-        auto node = dynamic_cast<xml::Element*>(anode);
-        if (node != nullptr) {
+        if (anode->type() == xml::Node::DOM_ELEMENT) {
             std::lock_guard<std::mutex> lock(*this);
-            requestNode = node;
+            requestNode = static_cast<xml::Element*>(anode);
             String nameSpaceAlias = requestNode->nameSpace();
             extractNameSpaces(requestNode, allNamespaces);
             requestNameSpace = allNamespaces[nameSpaceAlias];
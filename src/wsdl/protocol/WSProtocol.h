@@ -29,8 +29,10 @@
 #ifndef __WSPROTOCOL_H__
 #define __WSPROTOCOL_H__
 
+#include <functional>
 #include <sptk5/cnet>
 #include <sptk5/wsdl/WSRequest.h>
+#include <sptk5/ZLib.h>
 
 namespace sptk {
 
@@ -45,6 +47,105 @@ protected:
     TCPSocket&      m_socket;   ///< Connection socket
     HttpHeaders     m_headers;  ///< Connection HTTP headers
 
+    /// @brief Minimal size of response content that is worth compressing
+    static constexpr size_t MinCompressedContentSize = 1024;
+
+    /// @brief Returns quality of the items listed in Accept or Accept-Encoding header
+    /// @param headerName       Header name
+    /// @param matches          Returns true for the listed item (media type or encoding, in lower case) that matches
+    /// @return the highest quality of matching items, 1 if quality isn't specified, or -1 if no item matches
+    double acceptedQuality(const String& headerName, const std::function<bool(const String&)>& matches) const
+    {
+        double result = -1;
+        auto itor = m_headers.find(headerName);
+        if (itor == m_headers.end())
+            return result;
+        for (auto& item: Strings(itor->second, ",")) {
+            Strings parameters(item, ";");
+            if (parameters.empty() || !matches(trim(parameters[0]).toLowerCase()))
+                continue;
+            double quality = 1;
+            for (size_t i = 1; i < parameters.size(); i++) {
+                String parameter = trim(parameters[i]);
+                if (parameter.startsWith("q=")) {
+                    quality = string2double(parameter.substr(2), 1);
+                    break;
+                }
+            }
+            result = std::max(result, quality);
+        }
+        return result;
+    }
+
+    /// @brief Returns true if client accepts gzip-encoded content
+    bool clientAcceptsGzip() const
+    {
+        // gzip;q=0 means gzip is not acceptable
+        return acceptedQuality("accept-encoding", [](const String& encoding) { return encoding == "gzip"; }) > 0;
+    }
+
+    /// @brief Size of the content portion compressed and sent as a single chunk
+    static constexpr size_t CompressedChunkSize = 64 * 1024;
+
+    /// @brief Sends response with content
+    ///
+    /// If client accepts gzip encoding and content is large enough, content is compressed
+    /// in portions that are sent as they are compressed, using chunked transfer encoding.
+    /// @param headers          Response status line and headers, without Content-Length and trailing empty line
+    /// @param content          Response content
+    void sendResponse(const String& headers, Buffer&& content)
+    {
+        BufferChain response;
+        String contentHeaders;
+#if HAVE_ZLIB
+        if (content.bytes() >= MinCompressedContentSize) {
+            // Response depends on Accept-Encoding, that caches must take into account
+            contentHeaders = "Vary: Accept-Encoding\n";
+            if (clientAcceptsGzip()) {
+                response.append(headers + contentHeaders + "Content-Encoding: gzip\nTransfer-Encoding: chunked\n\n");
+                sendCompressed(response, content);
+                return;
+            }
+        }
+#endif
+        response.append(headers + contentHeaders + "Content-Length: " + int2string(content.bytes()) + "\n\n");
+
+        // Send headers and content with a single write, without concatenating them
+        response.append(std::move(content));
+        m_socket.write(response);
+    }
+
+private:
+#if HAVE_ZLIB
+    /// @brief Compresses content and sends it as chunks
+    /// @param response         Response headers, sent with the first chunk
+    /// @param content          Response content
+    void sendCompressed(BufferChain& response, const Buffer& content)
+    {
+        ZLibStream stream(ZLibStream::COMPRESS, ZLibStream::GZIP, ZLibStream::BestSpeed);
+        Buffer chunk(CompressedChunkSize / 2);
+        for (size_t offset = 0; offset < content.bytes(); offset += CompressedChunkSize) {
+            size_t portion = std::min(CompressedChunkSize, content.bytes() - offset);
+            chunk.bytes(0);
+            stream.write(chunk, content.data() + offset, portion);
+            if (offset + portion == content.bytes())
+                stream.finish(chunk);
+            if (chunk.bytes() == 0)
+                continue;
+
+            char chunkSize[32];
+            int length = snprintf(chunkSize, sizeof(chunkSize), "%zx\r\n", chunk.bytes());
+            response.append(chunkSize, size_t(length));
+            response.append(chunk.data(), chunk.bytes());
+            response.append("\r\n", 2);
+            m_socket.write(response);
+            response = BufferChain();
+        }
+        response.append("0\r\n\r\n", 5);
+        m_socket.write(response);
+    }
+#endif
+
 public:
 
     /// @brief Constructor
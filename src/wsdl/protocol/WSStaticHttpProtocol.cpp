@@ -41,10 +41,8 @@ void WSStaticHttpProtocol::process()
     Buffer page;
     try {
         page.loadFromFile(m_staticFilesDirectory + m_url);
-        m_socket.write("HTTP/1.1 200 OK\n");
-        m_socket.write("Content-Type: text/html; charset=utf-8\n");
-        m_socket.write("Content-Length: " + int2string(page.bytes()) + "\n\n");
-        m_socket.write(page);
+        sendResponse("HTTP/1.1 200 OK\n"
+                     "Content-Type: text/html; charset=utf-8\n", move(page));
     }
     catch (...) {
         string text("<html><head><title>Not Found</title></head><body>Sorry, the page " + m_staticFilesDirectory + m_url + " was not found.</body></html>\n");
@@ -31,8 +31,9 @@
 using namespace std;
 using namespace sptk;
 
-WSWebServiceProtocol::WSWebServiceProtocol(TCPSocket* socket, const String& url, const HttpHeaders& headers, WSRequest& service)
-: WSProtocol(socket, headers), m_service(service), m_url(url)
+WSWebServiceProtocol::WSWebServiceProtocol(TCPSocket* socket, const String& url, const HttpHeaders& headers, WSRequest& service,
+                                           Buffer&& content)
+: WSProtocol(socket, headers), m_service(service), m_url(url), m_content(std::move(content))
 {
 }
 
@@ -55,13 +56,24 @@ void WSWebServiceProtocol::process()
         authentication = unique_ptr<HttpAuthentication>(new HttpAuthentication(value));
     }
 
+    bool requestIsMessagePack = false;
+    itor = m_headers.find("Content-Type");
+    if (itor != m_headers.end() && json::MessagePack::isContentType(itor->second)) {
+        if (contentLength == 0)
+            throwException("Content-Length is required for MessagePack request");
+        requestIsMessagePack = true;
+    }
+
     const char* startOfMessage = nullptr;
     const char* endOfMessage = nullptr;
 
     Buffer data;
 
     if (contentLength != 0) {
-        m_socket.read(data, contentLength);
+        if (m_content.bytes() == contentLength)
+            data = std::move(m_content);
+        else
+            m_socket.read(data, contentLength);
         startOfMessage = data.c_str();
         endOfMessage = startOfMessage + data.bytes();
     } else {
@@ -102,14 +114,16 @@ void WSWebServiceProtocol::process()
         endOfMessage += strlen(endOfMessageMark);
     }
 
-    while ((unsigned char)*startOfMessage < 33)
-        startOfMessage++;
+    if (!requestIsMessagePack) {
+        while ((unsigned char)*startOfMessage < 33)
+            startOfMessage++;
+    }
 
     xml::Document message;
     json::Document jsonContent;
 
     bool requestIsJSON = false;
-    if (*startOfMessage == '<') {
+    if (!requestIsMessagePack && *startOfMessage == '<') {
         if (endOfMessage != nullptr)
             *(char*) endOfMessage = 0;
         message.load(startOfMessage);
@@ -120,7 +134,7 @@ void WSWebServiceProtocol::process()
         auto jsonEnvelope = jsonContent.root().set_object(xmlRequest->name());
         xmlRequest->exportTo(*jsonEnvelope);
     }
-    else if (*startOfMessage == '{' || *startOfMessage == '[') {
+    else if (requestIsMessagePack || *startOfMessage == '{' || *startOfMessage == '[') {
         requestIsJSON = true;
         Strings url(m_url, "/");
         if (url.size() < 2)
@@ -130,7 +144,10 @@ void WSWebServiceProtocol::process()
         auto xmlEnvelope = new xml::Element(message, "soap:Envelope");
         xmlEnvelope->setAttribute("xmlns:soap", "http://schemas.xmlsoap.org/soap/envelope/");
         auto xmlBody = new xml::Element(xmlEnvelope, "soap:Body");
-        jsonContent.load(startOfMessage);
+        if (requestIsMessagePack)
+            jsonContent.loadMessagePack(move(data));
+        else
+            jsonContent.load(startOfMessage);
         jsonContent.root().exportTo("ns1:" + method, *xmlBody);
         Buffer buffer;
         message.save(buffer, true);
@@ -140,6 +157,17 @@ void WSWebServiceProtocol::process()
         throw Exception("Request content isn't XML or JSON");
     //cout << startOfMessage << endl << endl;
 
+    // JSON response is encoded as MessagePack if client prefers it, or if request is MessagePack
+    // and client doesn't list MessagePack or JSON as acceptable
+    bool responseIsMessagePack = requestIsMessagePack;
+    double messagePackQuality = acceptedQuality("Accept", json::MessagePack::isContentType);
+    double jsonQuality = acceptedQuality("Accept", [](const String& type) { return type == "application/json"; });
+    if (messagePackQuality == 0)
+        responseIsMessagePack = false;
+    else if (messagePackQuality > 0 || jsonQuality > 0)
+        responseIsMessagePack = messagePackQuality >= jsonQuality;
+    String jsonContentType = responseIsMessagePack ? json::MessagePack::ContentType : "application/json";
+
     Buffer output;
     size_t httpStatusCode = 200;
     String httpStatusText = "OK";
@@ -155,8 +183,11 @@ void WSWebServiceProtocol::process()
             json::Document jsonOutput;
             auto jsonResponse = jsonOutput.root().set_object("response");
             methodElement->exportTo(*jsonResponse);
-            jsonOutput.exportTo(output, false);
-            contentType = "application/json";
+            if (responseIsMessagePack)
+                jsonOutput.exportMessagePack(output);
+            else
+                jsonOutput.exportTo(output, false);
+            contentType = jsonContentType;
         }
         else
             message.save(output, 2);
@@ -164,19 +195,21 @@ void WSWebServiceProtocol::process()
     catch (const HTTPException& e) {
         httpStatusCode = e.statusCode();
         httpStatusText = e.statusText();
-        contentType = "application/json";
+        contentType = jsonContentType;
 
         json::Document error;
         error.root().set("error", e.what());
         error.root().set("status_code", (int) e.statusCode());
         error.root().set("status_text", e.statusText());
-        error.exportTo(output, true);
+        if (responseIsMessagePack)
+            error.exportMessagePack(output);
+        else
+            error.exportTo(output, true);
     }
 
-    stringstream response;
-    response << "HTTP/1.1 " << httpStatusCode << " " << httpStatusText << "\n"
-             << "Content-Type: " << contentType << "\n"
-             << "Content-Length: " << output.bytes() << "\n\n";
-    m_socket.write(response.str());
-    m_socket.write(output);
+    stringstream headers;
+    headers << "HTTP/1.1 " << httpStatusCode << " " << httpStatusText << "\n"
+            << "Content-Type: " << contentType << "\n";
+
+    sendResponse(headers.str(), move(output));
 }
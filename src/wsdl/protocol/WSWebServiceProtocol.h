@@ -45,6 +45,7 @@ class WSWebServiceProtocol : public WSProtocol
 {
     WSRequest&          m_service;
     const sptk::String  m_url;
+    Buffer              m_content;
 public:
 
     /**
@@ -53,8 +54,10 @@ public:
      * @param url               Method URL
      * @param headers           Connection HTTP headers
      * @param service           Web service that handles request
+     * @param content           Optional request content, already received from socket
      */
-    WSWebServiceProtocol(TCPSocket* socket, const String& url, const HttpHeaders& headers, WSRequest& service);
+    WSWebServiceProtocol(TCPSocket* socket, const String& url, const HttpHeaders& headers, WSRequest& service,
+                         Buffer&& content = Buffer());
 
     /// @brief Process method
     ///
@@ -0,0 +1,233 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       Backend.cpp - description                              ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include "Backend.h"
+#include "BalancingStrategy.h"
+#include <sptk5/net/TCPSocket.h>
+
+using namespace std;
+using namespace sptk;
+
+constexpr unsigned Backend::MaxConnectFailures;
+constexpr chrono::seconds Backend::EjectionTime;
+
+Backend::Backend(const Host& host, unsigned weight)
+: m_host(host), m_weight(weight > 0 ? weight : 1)
+{
+}
+
+bool Backend::available() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_healthy && m_ejectedUntil <= chrono::steady_clock::now();
+}
+
+bool Backend::healthChecked(bool healthy)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    if (healthy) {
+        // Backend accepts connections again, no need to wait for ejection to expire
+        m_connectFailures = 0;
+        m_ejectedUntil = chrono::steady_clock::time_point();
+    }
+
+    bool changed = m_healthy != healthy;
+    m_healthy = healthy;
+
+    return changed;
+}
+
+void Backend::connectionOpened()
+{
+    m_activeConnections++;
+    m_connections++;
+
+    lock_guard<mutex> lock(m_mutex);
+    m_connectFailures = 0;
+}
+
+bool Backend::connectFailed()
+{
+    m_failedConnections++;
+
+    lock_guard<mutex> lock(m_mutex);
+    m_connectFailures++;
+    if (m_connectFailures < MaxConnectFailures)
+        return false;
+
+    // Failures counter isn't reset here, so a failure after ejection expires ejects backend again
+    m_ejectedUntil = chrono::steady_clock::now() + EjectionTime;
+
+    return true;
+}
+
+void Backend::connectionClosed()
+{
+    m_activeConnections--;
+}
+
+void Backend::addBytes(uint64_t sent, uint64_t received)
+{
+    if (sent != 0)
+        m_bytesSent += sent;
+    if (received != 0)
+        m_bytesReceived += received;
+}
+
+String Backend::toString() const
+{
+    stringstream output;
+
+    output << m_host.toString() << (available() ? " up" : " down")
+           << ", active " << m_activeConnections
+           << ", connections " << m_connections
+           << ", failed " << m_failedConnections
+           << ", sent " << m_bytesSent
+           << ", received " << m_bytesReceived;
+
+    return output.str();
+}
+
+Backends::Backends(shared_ptr<BalancingStrategy> strategy)
+: m_strategy(strategy), m_healthCheckTimer(healthCheckCallback)
+{
+}
+
+Backends::~Backends()
+{
+    m_healthCheckTimer.cancel();
+}
+
+void Backends::add(const Host& host, unsigned weight)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    m_backends.emplace_back(new Backend(host, weight));
+    m_backendList.push_back(m_backends.back().get());
+    m_strategy->backendsChanged(m_backendList);
+}
+
+Backend* Backends::select(const sockaddr_in& client)
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_strategy->select(m_backendList, client);
+}
+
+void Backends::healthCheckCallback(void* eventData)
+{
+    auto backends = (Backends*) eventData;
+    backends->checkHealth();
+}
+
+void Backends::startHealthChecks(chrono::milliseconds interval, chrono::milliseconds timeout)
+{
+    m_healthCheckTimeout = timeout;
+    if (m_healthCheckEvent)
+        m_healthCheckTimer.cancel(m_healthCheckEvent);
+    m_healthCheckEvent = m_healthCheckTimer.repeat(interval, this);
+}
+
+void Backends::checkHealth()
+{
+    chrono::milliseconds timeout = m_healthCheckTimeout;
+
+    for (auto& backend: m_backends) {
+        bool healthy = true;
+        try {
+            TCPSocket socket;
+            socket.open(backend->host(), BaseSocket::SOM_CONNECT, true, timeout);
+            socket.close();
+        }
+        catch (const exception&) {
+            healthy = false;
+        }
+
+        if (backend->healthChecked(healthy))
+            cout << "Backend " << backend->host().toString() << (healthy ? " is up" : " is down") << endl;
+    }
+}
+
+void Backends::printStatistics(ostream& stream) const
+{
+    for (auto& backend: m_backends)
+        stream << backend->toString() << endl;
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+TEST(SPTK_Backend, ejection)
+{
+    Backend backend(Host("127.0.0.1", 1));
+
+    // Successful connection resets consecutive failures
+    for (unsigned i = 1; i < Backend::MaxConnectFailures; i++)
+        EXPECT_FALSE(backend.connectFailed());
+    backend.connectionOpened();
+    for (unsigned i = 1; i < Backend::MaxConnectFailures; i++)
+        EXPECT_FALSE(backend.connectFailed());
+    EXPECT_TRUE(backend.available());
+
+    EXPECT_TRUE(backend.connectFailed());
+    EXPECT_FALSE(backend.available());
+    EXPECT_EQ(uint64_t(2 * Backend::MaxConnectFailures - 1), backend.failedConnections());
+
+    // Next failure after ejection ejects again
+    EXPECT_TRUE(backend.connectFailed());
+    EXPECT_FALSE(backend.available());
+}
+
+TEST(SPTK_Backends, healthCheck)
+{
+    TCPSocket listener;
+    listener.listen(0, "127.0.0.1");
+
+    Backends backends(BalancingStrategy::create("round-robin"));
+    backends.add(Host("127.0.0.1", listener.host().port()));
+
+    sockaddr_in client = {};
+    Backend* backend = backends.select(client);
+    ASSERT_NE(nullptr, backend);
+
+    for (unsigned i = 0; i < Backend::MaxConnectFailures; i++)
+        backend->connectFailed();
+    EXPECT_EQ(nullptr, backends.select(client));
+
+    // Successful health check ends ejection before ejection time expires
+    backends.checkHealth();
+    EXPECT_TRUE(backend->available());
+    EXPECT_EQ(backend, backends.select(client));
+
+    listener.close();
+    backends.checkHealth();
+    EXPECT_FALSE(backend->available());
+    EXPECT_EQ(nullptr, backends.select(client));
+}
+
+#endif
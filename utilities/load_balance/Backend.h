@@ -0,0 +1,196 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       Backend.h - description                                ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_BACKEND_H__
+#define __SPTK_BACKEND_H__
+
+#include <sptk5/net/Host.h>
+#include <sptk5/threads/Timer.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace sptk {
+
+class BalancingStrategy;
+
+/**
+ * Load balancer destination, with its health state and statistics
+ */
+class Backend
+{
+public:
+    /**
+     * Number of consecutive connection failures that ejects backend
+     */
+    static constexpr unsigned MaxConnectFailures = 3;
+
+    /**
+     * Time the ejected backend isn't used
+     */
+    static constexpr std::chrono::seconds EjectionTime {30};
+
+private:
+    Host                    m_host;
+    unsigned                m_weight;
+
+    mutable std::mutex      m_mutex;
+    bool                    m_healthy {true};           ///< Result of the last health check
+    unsigned                m_connectFailures {0};      ///< Consecutive connection failures
+    std::chrono::steady_clock::time_point m_ejectedUntil;  ///< Passive ejection end time, or zero if not ejected
+
+    std::atomic<size_t>     m_activeConnections {0};
+    std::atomic<uint64_t>   m_connections {0};
+    std::atomic<uint64_t>   m_failedConnections {0};
+    std::atomic<uint64_t>   m_bytesSent {0};
+    std::atomic<uint64_t>   m_bytesReceived {0};
+
+public:
+    /**
+     * Constructor
+     * @param host              Backend host and port
+     * @param weight            Relative backend capacity, used by weighted strategies
+     */
+    explicit Backend(const Host& host, unsigned weight = 1);
+
+    const Host& host() const { return m_host; }
+    unsigned weight() const { return m_weight; }
+
+    /**
+     * @return true if backend passed the last health check and isn't ejected
+     */
+    bool available() const;
+
+    /**
+     * Store the health check result
+     * @param healthy           Health check result
+     * @return true if health state has changed
+     */
+    bool healthChecked(bool healthy);
+
+    /**
+     * Register successfully connected channel
+     */
+    void connectionOpened();
+
+    /**
+     * Register connection failure. Backend is ejected after MaxConnectFailures consecutive failures.
+     * @return true if backend got ejected
+     */
+    bool connectFailed();
+
+    /**
+     * Register closed channel
+     */
+    void connectionClosed();
+
+    /**
+     * Add forwarded bytes to statistics
+     * @param sent              Bytes sent to backend
+     * @param received          Bytes received from backend
+     */
+    void addBytes(uint64_t sent, uint64_t received);
+
+    size_t activeConnections() const { return m_activeConnections; }
+    uint64_t connections() const { return m_connections; }
+    uint64_t failedConnections() const { return m_failedConnections; }
+    uint64_t bytesSent() const { return m_bytesSent; }
+    uint64_t bytesReceived() const { return m_bytesReceived; }
+
+    /**
+     * @return backend state and statistics as a single line of text
+     */
+    String toString() const;
+};
+
+/**
+ * Set of backends, selected with balancing strategy.
+ *
+ * Backends are checked periodically by opening TCP connection to them. Backends that fail
+ * health check, or are ejected after connection failures, aren't selected.
+ * All backends should be added before load balancer starts.
+ */
+class Backends
+{
+    std::vector<std::unique_ptr<Backend>>   m_backends;
+    std::vector<Backend*>                   m_backendList;
+    std::shared_ptr<BalancingStrategy>      m_strategy;
+    std::mutex                              m_mutex;            ///< Serializes strategy calls
+    Timer                                   m_healthCheckTimer;
+    Timer::Event                            m_healthCheckEvent;
+    std::atomic<std::chrono::milliseconds>  m_healthCheckTimeout {std::chrono::milliseconds(1000)};   ///< Read by timer thread
+
+    static void healthCheckCallback(void* eventData);
+
+public:
+    /**
+     * Constructor
+     * @param strategy          Balancing strategy
+     */
+    explicit Backends(std::shared_ptr<BalancingStrategy> strategy);
+
+    ~Backends();
+
+    /**
+     * Add backend
+     * @param host              Backend host and port
+     * @param weight            Relative backend capacity, used by weighted strategies
+     */
+    void add(const Host& host, unsigned weight = 1);
+
+    size_t size() const { return m_backends.size(); }
+
+    /**
+     * Select backend for client connection
+     * @param client            Client address
+     * @return available backend, or nullptr if no backends are available
+     */
+    Backend* select(const sockaddr_in& client);
+
+    /**
+     * Start periodic health checks
+     * @param interval          Health check interval
+     * @param timeout           Health check connection timeout
+     */
+    void startHealthChecks(std::chrono::milliseconds interval, std::chrono::milliseconds timeout);
+
+    /**
+     * Check all backends, by connecting to them
+     */
+    void checkHealth();
+
+    /**
+     * Print backends state and statistics
+     * @param stream            Output stream
+     */
+    void printStatistics(std::ostream& stream) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,286 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       BalancingStrategy.cpp - description                    ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#include "BalancingStrategy.h"
+
+using namespace std;
+using namespace sptk;
+
+constexpr unsigned ConsistentHashStrategy::VirtualNodes;
+
+shared_ptr<BalancingStrategy> BalancingStrategy::create(const String& name)
+{
+    if (name == "round-robin")
+        return make_shared<RoundRobinStrategy>();
+    if (name == "least-connections")
+        return make_shared<LeastConnectionsStrategy>();
+    if (name == "weighted-round-robin")
+        return make_shared<WeightedRoundRobinStrategy>();
+    if (name == "hash")
+        return make_shared<ConsistentHashStrategy>();
+    throw Exception("Unknown balancing strategy '" + name + "'");
+}
+
+Backend* RoundRobinStrategy::select(const vector<Backend*>& backends, const sockaddr_in&)
+{
+    for (size_t i = 0; i < backends.size(); i++) {
+        Backend* backend = backends[m_position++ % backends.size()];
+        if (backend->available())
+            return backend;
+    }
+    return nullptr;
+}
+
+Backend* LeastConnectionsStrategy::select(const vector<Backend*>& backends, const sockaddr_in&)
+{
+    Backend* selected = nullptr;
+    size_t   start = m_position++;
+
+    for (size_t i = 0; i < backends.size(); i++) {
+        Backend* backend = backends[(start + i) % backends.size()];
+        if (!backend->available())
+            continue;
+        // Compare active / weight ratios without division
+        if (selected == nullptr ||
+            backend->activeConnections() * selected->weight() < selected->activeConnections() * backend->weight())
+        {
+            selected = backend;
+        }
+    }
+
+    return selected;
+}
+
+Backend* WeightedRoundRobinStrategy::select(const vector<Backend*>& backends, const sockaddr_in&)
+{
+    Backend* selected = nullptr;
+    int64_t  totalWeight = 0;
+
+    for (auto backend: backends) {
+        if (!backend->available())
+            continue;
+        int64_t& currentWeight = m_currentWeights[backend];
+        currentWeight += backend->weight();
+        totalWeight += backend->weight();
+        if (selected == nullptr || currentWeight > m_currentWeights[selected])
+            selected = backend;
+    }
+
+    if (selected != nullptr)
+        m_currentWeights[selected] -= totalWeight;
+
+    return selected;
+}
+
+/**
+ * FNV-1a hash, with final mixing. Short keys that differ in last bytes, such as client addresses
+ * from the same network, aren't spread around the ring by FNV-1a alone.
+ */
+static uint32_t hash32(const void* data, size_t size)
+{
+    auto     bytes = (const uint8_t*) data;
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+
+    // MurmurHash3 finalizer
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BU;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35U;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+void ConsistentHashStrategy::backendsChanged(const vector<Backend*>& backends)
+{
+    m_ring.clear();
+    for (auto backend: backends) {
+        String name = backend->host().toString();
+        for (unsigned i = 0; i < VirtualNodes * backend->weight(); i++) {
+            String point = name + "#" + int2string(i);
+            m_ring[hash32(point.c_str(), point.length())] = backend;
+        }
+    }
+}
+
+Backend* ConsistentHashStrategy::select(const vector<Backend*>&, const sockaddr_in& client)
+{
+    if (m_ring.empty())
+        return nullptr;
+
+    // Client port is different for every connection, only address is used
+    uint32_t hash = hash32(&client.sin_addr, sizeof(client.sin_addr));
+
+    auto itor = m_ring.lower_bound(hash);
+    for (size_t i = 0; i < m_ring.size(); i++, ++itor) {
+        if (itor == m_ring.end())
+            itor = m_ring.begin();
+        if (itor->second->available())
+            return itor->second;
+    }
+
+    return nullptr;
+}
+
+#if USE_GTEST
+#include <gtest/gtest.h>
+
+namespace {
+
+/**
+ * Backends with distinct ports, and given weights
+ */
+class TestBackends
+{
+    std::vector<std::unique_ptr<Backend>>   m_backends;
+public:
+    std::vector<Backend*>                   list;
+
+    explicit TestBackends(const std::vector<unsigned>& weights)
+    {
+        uint16_t port = 10001;
+        for (auto weight: weights) {
+            m_backends.emplace_back(new Backend(Host("127.0.0.1", port++), weight));
+            list.push_back(m_backends.back().get());
+        }
+    }
+
+    static void eject(Backend* backend)
+    {
+        for (unsigned i = 0; i < Backend::MaxConnectFailures; i++)
+            backend->connectFailed();
+    }
+};
+
+sockaddr_in clientAddress(uint32_t address)
+{
+    sockaddr_in client = {};
+    client.sin_family = AF_INET;
+    client.sin_addr.s_addr = htonl(address);
+    return client;
+}
+
+}
+
+TEST(SPTK_RoundRobinStrategy, select)
+{
+    TestBackends backends({1, 1, 1});
+    RoundRobinStrategy strategy;
+    sockaddr_in client = clientAddress(0x7F000001);
+
+    TestBackends::eject(backends.list[1]);
+
+    String sequence;
+    for (int i = 0; i < 4; i++)
+        sequence += int2string(strategy.select(backends.list, client)->host().port() - 10000);
+    EXPECT_STREQ("1313", sequence.c_str());
+}
+
+TEST(SPTK_LeastConnectionsStrategy, weights)
+{
+    TestBackends backends({2, 1});
+    Backend* a = backends.list[0];
+    Backend* b = backends.list[1];
+    LeastConnectionsStrategy strategy;
+    sockaddr_in client = clientAddress(0x7F000001);
+
+    // Connections are distributed in proportion to weights
+    for (int i = 0; i < 30; i++)
+        strategy.select(backends.list, client)->connectionOpened();
+    EXPECT_EQ(size_t(20), a->activeConnections());
+    EXPECT_EQ(size_t(10), b->activeConnections());
+
+    // Connections per weight unit: a has 20 / 2, b has 9 / 1
+    b->connectionClosed();
+    EXPECT_EQ(b, strategy.select(backends.list, client));
+
+    // a has 19 / 2, b has 10 / 1
+    a->connectionClosed();
+    b->connectionOpened();
+    EXPECT_EQ(a, strategy.select(backends.list, client));
+
+    TestBackends::eject(a);
+    EXPECT_EQ(b, strategy.select(backends.list, client));
+}
+
+TEST(SPTK_WeightedRoundRobinStrategy, smoothSequence)
+{
+    TestBackends backends({5, 1, 1});
+    WeightedRoundRobinStrategy strategy;
+    sockaddr_in client = clientAddress(0x7F000001);
+
+    String sequence;
+    for (int i = 0; i < 14; i++)
+        sequence += char('a' + strategy.select(backends.list, client)->host().port() - 10001);
+    EXPECT_STREQ("aabacaaaabacaa", sequence.c_str());
+}
+
+TEST(SPTK_ConsistentHashStrategy, stability)
+{
+    TestBackends backends({1, 1, 1});
+    ConsistentHashStrategy strategy;
+    strategy.backendsChanged(backends.list);
+
+    constexpr uint32_t clientCount = 3000;
+    std::vector<Backend*> selected;
+    std::map<Backend*, size_t> distribution;
+    for (uint32_t i = 0; i < clientCount; i++) {
+        sockaddr_in client = clientAddress(0x0A000000 + i);
+        Backend* backend = strategy.select(backends.list, client);
+        ASSERT_NE(nullptr, backend);
+        EXPECT_EQ(backend, strategy.select(backends.list, client));
+        selected.push_back(backend);
+        distribution[backend]++;
+    }
+
+    ASSERT_EQ(size_t(3), distribution.size());
+    for (auto& itor: distribution)
+        EXPECT_GT(itor.second, clientCount / 4);
+
+    // Only clients of unavailable backend are moved to other backends
+    Backend* ejected = backends.list[1];
+    TestBackends::eject(ejected);
+    for (uint32_t i = 0; i < clientCount; i++) {
+        Backend* backend = strategy.select(backends.list, clientAddress(0x0A000000 + i));
+        ASSERT_NE(ejected, backend);
+        if (selected[i] != ejected) {
+            EXPECT_EQ(selected[i], backend);
+        }
+    }
+
+    // Clients return to the backend when it's available again
+    ejected->healthChecked(true);
+    for (uint32_t i = 0; i < clientCount; i++)
+        EXPECT_EQ(selected[i], strategy.select(backends.list, clientAddress(0x0A000000 + i)));
+}
+
+#endif
@@ -0,0 +1,119 @@
+/*
+╔══════════════════════════════════════════════════════════════════════════════╗
+║                       SIMPLY POWERFUL TOOLKIT (SPTK)                         ║
+║                       BalancingStrategy.h - description                      ║
+╟──────────────────────────────────────────────────────────────────────────────╢
+║  begin                Monday October 19 2026                                 ║
+║  copyright            (C) 1999-2018 by Alexey Parshin. All rights reserved.  ║
+║  email                alexeyp@gmail.com                                      ║
+╚══════════════════════════════════════════════════════════════════════════════╝
+┌──────────────────────────────────────────────────────────────────────────────┐
+│   This library is free software; you can redistribute it and/or modify it    │
+│   under the terms of the GNU Library General Public License as published by  │
+│   the Free Software Foundation; either version 2 of the License, or (at your │
+│   option) any later version.                                                 │
+│                                                                              │
+│   This library is distributed in the hope that it will be useful, but        │
+│   WITHOUT ANY WARRANTY; without even the implied warranty of                 │
+│   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Library   │
+│   General Public License for more details.                                   │
+│                                                                              │
+│   You should have received a copy of the GNU Library General Public License  │
+│   along with this library; if not, write to the Free Software Foundation,    │
+│   Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.               │
+│                                                                              │
+│   Please report all bugs and problems to alexeyp@gmail.com.                  │
+└──────────────────────────────────────────────────────────────────────────────┘
+*/
+
+#ifndef __SPTK_BALANCINGSTRATEGY_H__
+#define __SPTK_BALANCINGSTRATEGY_H__
+
+#include "Backend.h"
+#include <map>
+
+namespace sptk {
+
+/**
+ * Backend selection strategy.
+ *
+ * Strategy methods are called by Backends serially, so strategy state needs no locking.
+ * Backends that aren't available are never selected.
+ */
+class BalancingStrategy
+{
+public:
+    virtual ~BalancingStrategy() = default;
+
+    /**
+     * Called when backends are added
+     * @param backends          All backends
+     */
+    virtual void backendsChanged(const std::vector<Backend*>& backends) {}
+
+    /**
+     * Select backend for client connection
+     * @param backends          All backends
+     * @param client            Client address
+     * @return available backend, or nullptr if no backends are available
+     */
+    virtual Backend* select(const std::vector<Backend*>& backends, const sockaddr_in& client) = 0;
+
+    /**
+     * Create strategy by name
+     * @param name              One of: round-robin, least-connections, weighted-round-robin, hash
+     */
+    static std::shared_ptr<BalancingStrategy> create(const String& name);
+};
+
+/**
+ * Select backends in turn
+ */
+class RoundRobinStrategy : public BalancingStrategy
+{
+    size_t  m_position {0};
+public:
+    Backend* select(const std::vector<Backend*>& backends, const sockaddr_in& client) override;
+};
+
+/**
+ * Select backend with the least active connections, relative to backend weight
+ */
+class LeastConnectionsStrategy : public BalancingStrategy
+{
+    size_t  m_position {0};     ///< Rotates between backends with equal load
+public:
+    Backend* select(const std::vector<Backend*>& backends, const sockaddr_in& client) override;
+};
+
+/**
+ * Select backends in turn, proportionally to backend weight.
+ * Selections of the same backend are spread evenly, rather than sent in a burst.
+ */
+class WeightedRoundRobinStrategy : public BalancingStrategy
+{
+    std::map<const Backend*, int64_t>   m_currentWeights;
+public:
+    Backend* select(const std::vector<Backend*>& backends, const sockaddr_in& client) override;
+};
+
+/**
+ * Select backend by client address hash, so the same client goes to the same backend.
+ * Uses consistent hashing: if backend becomes unavailable, only its clients move to other backends.
+ */
+class ConsistentHashStrategy : public BalancingStrategy
+{
+    /**
+     * Number of points on the hash ring per backend weight unit
+     */
+    static constexpr unsigned VirtualNodes = 160;
+
+    std::map<uint32_t, Backend*>    m_ring;
+public:
+    void backendsChanged(const std::vector<Backend*>& backends) override;
+    Backend* select(const std::vector<Backend*>& backends, const sockaddr_in& client) override;
+};
+
+}
+
+#endif
@@ -30,67 +30,516 @@
 
 #ifdef _WIN32
 #include <io.h>
+#else
+#include <fcntl.h>
 #endif
 
 using namespace std;
 using namespace sptk;
 
-void Channel::open(SOCKET sourceFD, const String& interfaceAddress, const Host& destination)
+constexpr size_t Channel::MaxForwardBytes;
+constexpr size_t Channel::PipeSize;
+constexpr size_t Channel::BufferSize;
+
+static bool wouldBlock()
 {
-    lock_guard<mutex>   lock(m_mutex);
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
 
-    m_source.attach(sourceFD);
+Channel::Flow::~Flow()
+{
+#ifdef __linux__
+    if (pipe[0] != -1) {
+        ::close(pipe[0]);
+        ::close(pipe[1]);
+    }
+#endif
+}
+
+void Channel::connect(const String& interfaceAddress, Backend& backend, chrono::milliseconds timeout)
+{
+    lock_guard<mutex>   lock(m_mutex);
 
-    m_destination.bind(interfaceAddress.c_str(), 0);
-    m_destination.open(destination, BaseSocket::SOM_CONNECT, false, chrono::seconds(60));
+    m_destination.socket.bind(interfaceAddress.c_str(), 0);
+    try {
+        m_destination.socket.open(backend.host(), BaseSocket::SOM_CONNECT, false, timeout);
+    }
+    catch (const exception&) {
+        if (backend.connectFailed())
+            cerr << "Backend " << backend.host().toString() << " is ejected" << endl;
+        throw;
+    }
 
-    m_sourceEvents.add(m_source, this);
-    m_destinationEvents.add(m_destination, this);
+    backend.connectionOpened();
+    m_backend = &backend;
 }
 
-void Channel::close()
+void Channel::open(SOCKET sourceFD)
 {
     lock_guard<mutex>   lock(m_mutex);
 
-    if (m_source.active()) {
-        m_sourceEvents.remove(m_source);
-        m_source.close();
+    m_source.socket.attach(sourceFD);
+    m_source.socket.blockingMode(false);
+
+    m_source.events.add(m_source.socket, this);
+    m_source.watched = true;
+
+    m_destination.events.add(m_destination.socket, this);
+    m_destination.watched = true;
+}
+
+void Channel::forget(Endpoint& endpoint)
+{
+    if (endpoint.watched) {
+        endpoint.watched = false;
+        endpoint.events.remove(endpoint.socket);
+    }
+}
+
+void Channel::closeSockets()
+{
+    m_closed = true;
+
+    if (m_backend != nullptr) {
+        m_backend->connectionClosed();
+        m_backend = nullptr;
     }
 
-    if (m_destination.active()) {
-        m_destinationEvents.remove(m_destination);
-        m_destination.close();
+    for (Endpoint* endpoint: {&m_source, &m_destination}) {
+        if (endpoint->socket.active()) {
+            try {
+                forget(*endpoint);
+            }
+            catch (const exception& e) {
+                cerr << e.what() << endl;
+            }
+            endpoint->socket.close();
+        }
     }
 }
 
-int Channel::copyData(TCPSocket& source, TCPSocket& destination)
+bool Channel::close()
 {
     lock_guard<mutex>   lock(m_mutex);
+    if (m_closed)
+        return false;
+    closeSockets();
+    return true;
+}
+
+int64_t Channel::receive(Flow& flow)
+{
+    SOCKET from = flow.from.socket.handle();
 
-    char        buffer[1024];
-    uint32_t    totalBytes = 0;
-    size_t      fragmentSize = sizeof(buffer);
-    int         readBytes = (int) fragmentSize;
+#ifdef __linux__
+    if (flow.splice) {
+        if (flow.pipe[0] == -1) {
+            if (pipe2(flow.pipe, O_NONBLOCK | O_CLOEXEC) == 0)
+                fcntl(flow.pipe[1], F_SETPIPE_SZ, (int) PipeSize); // Larger pipe is optional
+            else
+                flow.splice = false;
+        }
 
-    while ((size_t) readBytes == fragmentSize) {
+        if (flow.splice) {
+            ssize_t bytes = ::splice(from, nullptr, flow.pipe[1], nullptr, PipeSize, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (bytes >= 0)
+                return bytes;
+            if (wouldBlock())
+                return -1;
+            if (errno != EINVAL && errno != ENOSYS)
+                THROW_SOCKET_ERROR("Can't read from socket");
 
-#ifdef _WIN32
-        readBytes = _read(source.handle(), buffer, (unsigned) fragmentSize);
-        if (readBytes < 0)
-            throw SystemException("Can't read from socket");
+            // This socket doesn't support splice(), pipe is empty
+            ::close(flow.pipe[0]);
+            ::close(flow.pipe[1]);
+            flow.pipe[0] = flow.pipe[1] = -1;
+            flow.splice = false;
+        }
+    }
+#endif
 
-        if (_write(destination.handle(), buffer, readBytes) < 0)
-            throw SystemException("Can't write to socket");
+    if (flow.buffer.capacity() < BufferSize)
+        flow.buffer.checkSize(BufferSize);
+
+    auto bytes = (int64_t) ::recv(from, flow.buffer.data(), (int) BufferSize, 0);
+    if (bytes < 0) {
+        if (wouldBlock())
+            return -1;
+        THROW_SOCKET_ERROR("Can't read from socket");
+    }
+    flow.offset = 0;
+
+    return bytes;
+}
+
+int64_t Channel::send(Flow& flow)
+{
+    SOCKET to = flow.to.socket.handle();
+    int64_t bytes;
+
+#ifdef __linux__
+    if (flow.pipe[0] != -1)
+        bytes = ::splice(flow.pipe[0], nullptr, to, nullptr, flow.pending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    else
+        bytes = ::send(to, flow.buffer.data() + flow.offset, flow.pending, MSG_NOSIGNAL);
 #else
-        readBytes = ::read(source.handle(), buffer, fragmentSize);
-        if (readBytes < 0)
-            throw SystemException("Can't read from socket");
+    bytes = ::send(to, flow.buffer.data() + flow.offset, (int) flow.pending, 0);
+#endif
+
+    if (bytes < 0) {
+        if (wouldBlock())
+            return -1;
+        THROW_SOCKET_ERROR("Can't write to socket");
+    }
+    flow.offset += (size_t) bytes;
+
+    return bytes;
+}
+
+void Channel::forward(Flow& flow)
+{
+    size_t forwardedBytes = 0;
+
+    while (!flow.shutdown) {
+        if (flow.pending > 0) {
+            int64_t bytes = send(flow);
+            if (bytes < 0)
+                return; // Receiving socket is full, wait until it's writable
+            flow.pending -= (size_t) bytes;
+            flow.bytes += (uint64_t) bytes;
+            forwardedBytes += (size_t) bytes;
+            continue;
+        }
+
+        if (flow.eof) {
+            // Pass half-close to the other side
+#ifdef _WIN32
+            ::shutdown(flow.to.socket.handle(), SD_SEND);
+#else
+            ::shutdown(flow.to.socket.handle(), SHUT_WR);
+#endif
+            flow.shutdown = true;
+            return;
+        }
+
+        // Let other sockets work. If the sending socket is no longer monitored,
+        // nothing else would resume this flow, so drain it completely.
+        if (forwardedBytes >= MaxForwardBytes && flow.from.watched)
+            return;
+
+        int64_t bytes = receive(flow);
+        if (bytes < 0)
+            return; // No data available
+        if (bytes == 0)
+            flow.eof = true;
+        flow.pending = (size_t) bytes;
+    }
+}
+
+void Channel::watch(Endpoint& endpoint, bool reading, bool writing)
+{
+    if (!endpoint.watched)
+        return;
+
+    if (endpoint.reading != reading) {
+        endpoint.events.watchRead(endpoint.socket, reading);
+        endpoint.reading = reading;
+    }
+
+    if (endpoint.writing != writing) {
+        endpoint.events.watchWrite(endpoint.socket, writing);
+        endpoint.writing = writing;
+    }
+}
+
+bool Channel::process(TCPSocket& socket, SocketEventType eventType)
+{
+    lock_guard<mutex>   lock(m_mutex);
+
+    if (m_closed)
+        return false;
+
+    Endpoint& endpoint = &socket == &m_source.socket ? m_source : m_destination;
+    Flow& outbound = &endpoint == &m_source ? m_downstream : m_upstream;
 
-        if (::write(destination.handle(), buffer, (size_t) readBytes) < 0)
-            throw SystemException("Can't write to socket");
+    uint64_t sentBytes = m_upstream.bytes;
+    uint64_t receivedBytes = m_downstream.bytes;
+
+    try {
+        if (eventType == ET_CONNECTION_CLOSED && !endpoint.reading) {
+            // Peer half-close isn't reported while reading is suspended, so this is a hangup:
+            // nothing can be sent to the socket anymore. Remaining data from it is still forwarded.
+            outbound.pending = 0;
+            outbound.shutdown = true;
+            forget(endpoint);
+        }
+
+        forward(m_upstream);
+        forward(m_downstream);
+
+        m_backend->addBytes(m_upstream.bytes - sentBytes, m_downstream.bytes - receivedBytes);
+
+        if (m_upstream.shutdown && m_downstream.shutdown) {
+            closeSockets();
+            return true;
+        }
+
+        // Stop reading from a socket while its data can't be sent
+        watch(m_source,
+              !m_upstream.shutdown && !m_upstream.eof && m_upstream.pending == 0,
+              !m_downstream.shutdown && m_downstream.pending > 0);
+        watch(m_destination,
+              !m_downstream.shutdown && !m_downstream.eof && m_downstream.pending == 0,
+              !m_upstream.shutdown && m_upstream.pending > 0);
+    }
+    catch (const exception&) {
+        m_backend->addBytes(m_upstream.bytes - sentBytes, m_downstream.bytes - receivedBytes);
+        closeSockets();
+        return true;
+    }
+
+    return false;
+}
+
+#if USE_GTEST && !defined(_WIN32)
+#include <gtest/gtest.h>
+#include <sptk5/test/TestCounter.h>
+#include <sptk5/test/TestListener.h>
+#include <poll.h>
+#include <thread>
+#include "BalancingStrategy.h"
+#include "LoadBalance.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
 #endif
-        totalBytes += readBytes;
+
+namespace {
+
+TestCounter completedChannels;
+
+void sourceCallback(void* userData, SocketEventType eventType)
+{
+    auto channel = (Channel*) userData;
+    if (channel->process(channel->source(), eventType))
+        ++completedChannels;
+}
+
+void destinationCallback(void* userData, SocketEventType eventType)
+{
+    auto channel = (Channel*) userData;
+    if (channel->process(channel->destination(), eventType))
+        ++completedChannels;
+}
+
+/**
+ * Channel with access to its forwarding state
+ */
+class TestChannel : public Channel
+{
+public:
+    using Channel::Channel;
+
+    bool spliced() const
+    {
+        return m_upstream.pipe[0] != -1 && m_downstream.pipe[0] != -1;
     }
+};
+
+/**
+ * Channel connecting client socket to backend socket over loopback
+ */
+class ChannelConnection
+{
+    Backends            m_backends {BalancingStrategy::create("round-robin")};
+    Loop<String>        m_interfaces;
+    LoadBalance         m_loadBalance {0, m_backends, m_interfaces};
+    SocketEvents        m_sourceEvents {sourceCallback, chrono::milliseconds(100)};
+    SocketEvents        m_destinationEvents {destinationCallback, chrono::milliseconds(100)};
+
+public:
+    std::unique_ptr<Backend>        backend;
+    std::unique_ptr<TestChannel>    channel;
+    SOCKET                          client {INVALID_SOCKET};    ///< Client side of the source connection
+    SOCKET                          server {INVALID_SOCKET};    ///< Backend side of the destination connection
+
+    ChannelConnection()
+    {
+        completedChannels = 0;
+        m_sourceEvents.run();
+        m_destinationEvents.run();
 
-    return totalBytes;
+        TestListener backendListener;
+        backend = std::make_unique<Backend>(backendListener.host());
+        channel = std::make_unique<TestChannel>(m_loadBalance, m_sourceEvents, m_destinationEvents);
+        channel->connect("127.0.0.1", *backend, chrono::seconds(1));
+        server = backendListener.accept();
+
+        TestListener sourceListener;
+        client = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(sourceListener.port());
+        if (::connect(client, (sockaddr*) &address, sizeof(address)) != 0)
+            THROW_SOCKET_ERROR("Can't connect");
+        timeval timeout = {5, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        channel->open(sourceListener.accept());
+    }
+
+    ~ChannelConnection()
+    {
+        channel->close();
+        m_sourceEvents.terminate();
+        m_destinationEvents.terminate();
+        m_sourceEvents.join();
+        m_destinationEvents.join();
+        ::close(client);
+        ::close(server);
+    }
+
+    bool waitCompleted() const
+    {
+        return completedChannels.waitFor(1);
+    }
+};
+
+char pattern(size_t position)
+{
+    return char(position * 7 % 251);
 }
+
+/**
+ * Send bytes with position-dependent pattern
+ */
+void sendPattern(SOCKET socket, size_t size)
+{
+    Buffer data(size);
+    for (size_t i = 0; i < size; i++)
+        data.data()[i] = pattern(i);
+    for (size_t offset = 0; offset < size;) {
+        auto bytes = ::send(socket, data.data() + offset, size - offset, MSG_NOSIGNAL);
+        if (bytes <= 0)
+            break;
+        offset += (size_t) bytes;
+    }
+}
+
+/**
+ * Receive bytes until end of data, and verify the pattern
+ * @return number of received bytes, or 0 if data doesn't match
+ */
+size_t receivePattern(SOCKET socket, size_t maxSize = SIZE_MAX)
+{
+    char data[16384];
+    size_t received = 0;
+    while (received < maxSize) {
+        auto bytes = ::recv(socket, data, min(sizeof(data), maxSize - received), 0);
+        if (bytes <= 0)
+            break;
+        for (ssize_t i = 0; i < bytes; i++) {
+            if (data[i] != pattern(received + (size_t) i))
+                return 0;
+        }
+        received += (size_t) bytes;
+    }
+    return received;
+}
+
+}
+
+TEST(SPTK_Channel, splice)
+{
+    constexpr size_t dataSize = 32 * 1024 * 1024;
+    ChannelConnection connection;
+
+    // Both directions at the same time
+    thread upstream([&connection]() {
+        sendPattern(connection.client, dataSize);
+        ::shutdown(connection.client, SHUT_WR);
+    });
+    thread downstream([&connection]() {
+        sendPattern(connection.server, dataSize);
+        ::shutdown(connection.server, SHUT_WR);
+    });
+
+    size_t upstreamBytes = receivePattern(connection.server);
+    size_t downstreamBytes = receivePattern(connection.client);
+    upstream.join();
+    downstream.join();
+
+    EXPECT_EQ(dataSize, upstreamBytes);
+    EXPECT_EQ(dataSize, downstreamBytes);
+    EXPECT_TRUE(connection.waitCompleted());
+#ifdef __linux__
+    EXPECT_TRUE(connection.channel->spliced());
+#endif
+    EXPECT_EQ(dataSize, connection.backend->bytesSent());
+    EXPECT_EQ(dataSize, connection.backend->bytesReceived());
+    EXPECT_EQ(size_t(0), connection.backend->activeConnections());
+}
+
+TEST(SPTK_Channel, backpressure)
+{
+    ChannelConnection connection;
+
+    // Backend doesn't read: channel stops reading from client, and client send buffer gets full
+    Buffer data(64 * 1024);
+    memset(data.data(), 0, data.capacity());
+    fcntl(connection.client, F_SETFL, fcntl(connection.client, F_GETFL) | O_NONBLOCK);
+    size_t sentBytes = 0;
+    for (int stalls = 0; stalls < 50 && sentBytes < 256 * 1024 * 1024;) {
+        auto bytes = ::send(connection.client, data.data(), 64 * 1024, MSG_NOSIGNAL);
+        if (bytes > 0) {
+            sentBytes += (size_t) bytes;
+            stalls = 0;
+        } else {
+            ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+            stalls++;
+            pollfd pfd = {connection.client, POLLOUT, 0};
+            ::poll(&pfd, 1, 10);
+        }
+    }
+    EXPECT_LT(sentBytes, size_t(64 * 1024 * 1024));
+    EXPECT_LE(connection.backend->bytesSent(), sentBytes);
+
+    // Forwarding resumes when backend reads
+    size_t receivedBytes = 0;
+    while (receivedBytes < sentBytes) {
+        auto bytes = ::recv(connection.server, data.data(), 64 * 1024, 0);
+        if (bytes <= 0)
+            break;
+        receivedBytes += (size_t) bytes;
+    }
+    EXPECT_EQ(sentBytes, receivedBytes);
+
+    fcntl(connection.client, F_SETFL, fcntl(connection.client, F_GETFL) & ~O_NONBLOCK);
+    sendPattern(connection.client, 1024 * 1024);
+    EXPECT_EQ(size_t(1024 * 1024), receivePattern(connection.server, 1024 * 1024));
+}
+
+TEST(SPTK_Channel, halfClose)
+{
+    ChannelConnection connection;
+
+    // Backend finishes its response first, while client still sends the request
+    sendPattern(connection.server, 1000);
+    ::shutdown(connection.server, SHUT_WR);
+    EXPECT_EQ(size_t(1000), receivePattern(connection.client));
+
+    sendPattern(connection.client, 100000);
+    EXPECT_EQ(size_t(100000), receivePattern(connection.server, 100000));
+    EXPECT_EQ(0, long(completedChannels));
+
+    ::shutdown(connection.client, SHUT_WR);
+    char byte;
+    EXPECT_EQ(0, (int) ::recv(connection.server, &byte, 1, 0));
+    EXPECT_TRUE(connection.waitCompleted());
+}
+
+#endif
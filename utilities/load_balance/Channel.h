@@ -31,25 +31,119 @@
 
 #include <sptk5/net/TCPSocket.h>
 #include <sptk5/net/SocketEvents.h>
+#include "Backend.h"
 
 namespace sptk {
 
+class LoadBalance;
+
+/**
+ * Bidirectional connection between client (source) and backend (destination) sockets.
+ *
+ * Both sockets work in non-blocking mode. On Linux, data is moved between sockets with splice()
+ * through a per-direction pipe, so it never gets copied to user space. Where splice() isn't available,
+ * data is copied through a large per-direction buffer.
+ * If the receiving socket is full, reading from the sending socket is suspended until the receiving
+ * socket becomes writable. Half-closed connections are supported: end of data in one direction
+ * is passed to the other side with shutdown(), while the opposite direction continues to work.
+ */
 class Channel
 {
+public:
+    /**
+     * Maximum number of bytes forwarded in one direction per socket event
+     */
+    static constexpr size_t MaxForwardBytes = 1024 * 1024;
+
+    /**
+     * Requested size of the pipe, used by splice()
+     */
+    static constexpr size_t PipeSize = 256 * 1024;
+
+    /**
+     * Size of the user space buffer, used if splice() isn't available
+     */
+    static constexpr size_t BufferSize = 64 * 1024;
+
 protected:
 
-    TCPSocket       m_source;
-    TCPSocket       m_destination;
+    /**
+     * Socket and its monitoring state
+     */
+    struct Endpoint
+    {
+        TCPSocket       socket;
+        SocketEvents&   events;
+        bool            watched {false};        ///< Socket is monitored by events
+        bool            reading {true};         ///< Socket is monitored for read
+        bool            writing {false};        ///< Socket is monitored for write
+
+        explicit Endpoint(SocketEvents& events) : events(events) {}
+    };
+
+    /**
+     * Data flow in one direction
+     */
+    struct Flow
+    {
+        Endpoint&       from;
+        Endpoint&       to;
+        int             pipe[2] {-1, -1};       ///< Pipe used by splice()
+        bool            splice {true};          ///< Use splice() if available
+        Buffer          buffer;                 ///< User space buffer, used if splice() isn't available
+        size_t          pending {0};            ///< Bytes received but not yet sent
+        size_t          offset {0};             ///< Offset of pending bytes in the buffer
+        bool            eof {false};            ///< No more data from the sending socket
+        bool            shutdown {false};       ///< Flow is completed
+        uint64_t        bytes {0};              ///< Bytes sent
+
+        Flow(Endpoint& from, Endpoint& to) : from(from), to(to) {}
+        ~Flow();
+    };
 
-    SocketEvents&   m_sourceEvents;
-    SocketEvents&   m_destinationEvents;
+    LoadBalance&        m_owner;
+    Backend*            m_backend {nullptr};        ///< Connected backend
+    Endpoint            m_source;
+    Endpoint            m_destination;
+    Flow                m_upstream {m_source, m_destination};
+    Flow                m_downstream {m_destination, m_source};
+    bool                m_closed {false};
 
-    std::mutex      m_mutex;
+    std::mutex          m_mutex;
+
+    /**
+     * Receive data into the flow's pipe or buffer
+     * @return number of bytes received, 0 for end of data, or -1 if no data is available
+     */
+    static int64_t receive(Flow& flow);
+
+    /**
+     * Send pending data of the flow
+     * @return number of bytes sent, or -1 if the receiving socket is full
+     */
+    static int64_t send(Flow& flow);
+
+    /**
+     * Move data in one direction, until there is no data or the receiving socket is full
+     */
+    static void forward(Flow& flow);
+
+    /**
+     * Apply monitoring state to socket events
+     */
+    static void watch(Endpoint& endpoint, bool reading, bool writing);
+
+    /**
+     * Stop monitoring socket events
+     */
+    static void forget(Endpoint& endpoint);
+
+    void closeSockets();
 
 public:
 
-    Channel(SocketEvents& sourceEvents, SocketEvents& destinationEvents)
-    : m_sourceEvents(sourceEvents), m_destinationEvents(destinationEvents)
+    Channel(LoadBalance& owner, SocketEvents& sourceEvents, SocketEvents& destinationEvents)
+    : m_owner(owner), m_source(sourceEvents), m_destination(destinationEvents)
     {}
 
     ~Channel()
@@ -60,12 +154,37 @@ public:
         catch (...) {}
     }
 
-    void open(SOCKET sourceFD, const String& interfaceAddess, const Host& destination);
-    int  copyData(TCPSocket& source, TCPSocket& destination);
-    void close();
+    /**
+     * Connect to backend
+     * @param interfaceAddress  Local address to connect from
+     * @param backend           Backend to connect to, connection result is registered in backend statistics
+     * @param timeout           Connection timeout
+     */
+    void connect(const String& interfaceAddress, Backend& backend, std::chrono::milliseconds timeout);
+
+    /**
+     * Start forwarding data between client and connected backend
+     * @param sourceFD          Client socket, owned by channel after this call
+     */
+    void open(SOCKET sourceFD);
+
+    /**
+     * Process an event for the channel socket
+     * @param socket            Channel socket, source or destination
+     * @param eventType         Socket event type
+     * @return true if channel is completed and sockets are closed
+     */
+    bool process(TCPSocket& socket, SocketEventType eventType);
+
+    /**
+     * Stop monitoring and close both sockets
+     * @return true if channel was closed by this call, false if it was closed already
+     */
+    bool close();
 
-    TCPSocket& source()      { return m_source; }
-    TCPSocket& destination() { return m_destination; }
+    LoadBalance& owner()     { return m_owner; }
+    TCPSocket& source()      { return m_source.socket; }
+    TCPSocket& destination() { return m_destination.socket; }
 };
 
 }
@@ -34,40 +34,98 @@ using namespace sptk;
 
 void LoadBalance::sourceEventCallback(void *userData, SocketEventType eventType)
 {
-    Channel* channel = (Channel*) userData;
+    auto channel = (Channel*) userData;
 
-    if (eventType == ET_CONNECTION_CLOSED) {
-        channel->close();
-        delete channel;
-        return;
-    }
-
-    channel->copyData(channel->source(), channel->destination());
+    if (channel->process(channel->source(), eventType))
+        channel->owner().channelClosed(channel);
 }
 
 void LoadBalance::destinationEventCallback(void *userData, SocketEventType eventType)
 {
-    Channel* channel = (Channel*) userData;
+    auto channel = (Channel*) userData;
 
-    if (eventType == ET_CONNECTION_CLOSED) {
-        //cout << "Destination socket closed" << endl;
-        //cout.flush();
-        channel->close();
-        delete channel;
-        return;
-    }
-
-    channel->copyData(channel->destination(), channel->source());
+    if (channel->process(channel->destination(), eventType))
+        channel->owner().channelClosed(channel);
 }
 
-LoadBalance::LoadBalance(int listenerPort, Loop<Host>& destinations, Loop<String>& interfaces)
+LoadBalance::LoadBalance(int listenerPort, Backends& destinations, Loop<String>& interfaces,
+                         chrono::milliseconds connectTimeout)
 : Thread("load balance"), m_listenerPort(listenerPort), m_destinations(destinations), m_interfaces(interfaces),
-  m_sourceEvents(sourceEventCallback), m_destinationEvents(destinationEventCallback)
+  m_connectTimeout(connectTimeout), m_sourceEvents(sourceEventCallback), m_destinationEvents(destinationEventCallback)
 {
 }
 
 LoadBalance::~LoadBalance()
 {
+    deleteClosedChannels(true);
+}
+
+void LoadBalance::channelClosed(Channel* channel)
+{
+    // Channel sockets are already removed from socket events
+    lock_guard<mutex> lock(m_closedChannelsMutex);
+    m_closedChannels.push_back({channel, m_sourceEvents.cycles(), m_destinationEvents.cycles()});
+}
+
+void LoadBalance::deleteClosedChannels(bool all)
+{
+    list<Channel*> channels;
+
+    {
+        lock_guard<mutex> lock(m_closedChannelsMutex);
+        uint64_t sourceCycle = m_sourceEvents.cycles();
+        uint64_t destinationCycle = m_destinationEvents.cycles();
+        while (!m_closedChannels.empty()) {
+            auto& closedChannel = m_closedChannels.front();
+            if (!all && (closedChannel.sourceCycle == sourceCycle || closedChannel.destinationCycle == destinationCycle))
+                break;
+            channels.push_back(closedChannel.channel);
+            m_closedChannels.pop_front();
+        }
+    }
+
+    for (auto channel: channels)
+        delete channel;
+}
+
+void LoadBalance::openChannel(SOCKET sourceFD, const sockaddr_in& clientAddress)
+{
+    Channel* channel = nullptr;
+
+    for (size_t attempt = 0; attempt < m_destinations.size() && channel == nullptr; attempt++) {
+        Backend* backend = m_destinations.select(clientAddress);
+        if (backend == nullptr)
+            break;
+
+        channel = new Channel(*this, m_sourceEvents, m_destinationEvents);
+        try {
+            channel->connect(m_interfaces.loop(), *backend, m_connectTimeout);
+        }
+        catch (const exception& e) {
+            cerr << backend->host().toString() << ": " << e.what() << endl;
+            delete channel;
+            channel = nullptr;
+        }
+    }
+
+    if (channel == nullptr) {
+        cerr << "No backend is available" << endl;
+        TCPSocket source;
+        source.attach(sourceFD);
+        source.close();
+        return;
+    }
+
+    try {
+        channel->open(sourceFD);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        // Channel sockets may already be monitored, and an event may be in progress:
+        // delete the channel later, unless the event has completed the channel already.
+        if (channel->close())
+            channelClosed(channel);
+    }
 }
 
 void LoadBalance::threadFunction()
@@ -79,21 +137,19 @@ void LoadBalance::threadFunction()
     m_listener.listen(m_listenerPort);
 
     while (!terminated()) {
+        deleteClosedChannels(false);
+
+        if (!m_listener.readyToRead(chrono::seconds(1)))
+            continue;
+
         SOCKET sourceFD;
         m_listener.accept(sourceFD, addr);
-        Channel* channel = new Channel(m_sourceEvents, m_destinationEvents);
-        const Host& destination = m_destinations.loop();
-        const String& interfaceAddress = m_interfaces.loop();
-        try {
-            channel->open(sourceFD, interfaceAddress, destination);
-        }
-        catch (const exception& e) {
-            delete channel;
-            cerr << e.what() << endl;
-        }
+        openChannel(sourceFD, addr);
     }
 
     m_listener.close();
     m_sourceEvents.terminate();
     m_destinationEvents.terminate();
+    m_sourceEvents.join();
+    m_destinationEvents.join();
 }
@@ -30,29 +30,88 @@
 #define __SPTK_LOADBALANCE_H__
 
 #include <vector>
+#include <list>
 #include "Loop.h"
+#include "Backend.h"
 #include <sptk5/net/SocketEvents.h>
 #include <sptk5/net/TCPSocket.h>
 
 namespace sptk {
 
+class Channel;
+
+/**
+ * TCP load balancer.
+ *
+ * The listener thread accepts client connections, and connects each client to a backend
+ * selected by balancing strategy. Data is forwarded by socket event threads.
+ *
+ * Backend connections are made synchronously in the listener thread. While a backend doesn't respond,
+ * new clients wait: up to connect timeout per backend tried for a client, so up to connect timeout
+ * times the number of backends, if all of them are down. Backend that failed Backend::MaxConnectFailures
+ * connections in a row is ejected, and isn't tried until ejection ends or health check succeeds.
+ * Connect timeout should be short, comparing to how long clients may wait.
+ */
 class LoadBalance : public Thread
 {
-    int                   m_listenerPort;
-    Loop<Host>&           m_destinations;
-    Loop<String>&         m_interfaces;
+    int                         m_listenerPort;
+    Backends&                   m_destinations;
+    Loop<String>&               m_interfaces;
+    std::chrono::milliseconds   m_connectTimeout;
     SocketEvents          m_sourceEvents;
     SocketEvents          m_destinationEvents;
 
     TCPSocket             m_listener;
 
+    /**
+     * Closed channel, waiting until socket events already received for it are processed
+     */
+    struct ClosedChannel
+    {
+        Channel*    channel;            ///< Channel with closed sockets
+        uint64_t    sourceCycle;        ///< Source events cycle when channel was closed
+        uint64_t    destinationCycle;   ///< Destination events cycle when channel was closed
+    };
+
+    std::mutex                  m_closedChannelsMutex;
+    std::list<ClosedChannel>    m_closedChannels;
+
     void threadFunction() override;
 
+    /**
+     * Delete closed channels, once both socket event loops completed the cycles
+     * that could still deliver events for them
+     * @param all             Delete all closed channels, event loops should be stopped
+     */
+    void deleteClosedChannels(bool all);
+
+    /**
+     * Connect client to selected backend. If connection fails, other backends are tried.
+     * Blocks accepting new clients for the duration of backend connection attempts.
+     * @param sourceFD        Client socket
+     * @param clientAddress   Client address
+     */
+    void openChannel(SOCKET sourceFD, const sockaddr_in& clientAddress);
+
     static void sourceEventCallback(void *userData, SocketEventType eventType);
     static void destinationEventCallback(void *userData, SocketEventType eventType);
 public:
-    LoadBalance(int listenerPort, Loop<Host>& destinations, Loop<String>& interfaces);
+    /**
+     * Constructor
+     * @param listenerPort    Listener port
+     * @param destinations    Backends
+     * @param interfaces      Local addresses to connect to backends from
+     * @param connectTimeout  Backend connection timeout, delays accepting other clients while backend doesn't respond
+     */
+    LoadBalance(int listenerPort, Backends& destinations, Loop<String>& interfaces,
+                std::chrono::milliseconds connectTimeout = std::chrono::seconds(5));
     ~LoadBalance();
+
+    /**
+     * Schedule closed channel for deletion
+     * @param channel         Channel with closed sockets
+     */
+    void channelClosed(Channel* channel);
 };
 
 }
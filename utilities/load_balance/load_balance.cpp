@@ -27,6 +27,7 @@
 */
 
 #include "LoadBalance.h"
+#include "BalancingStrategy.h"
 #include <signal.h>
 
 using namespace std;
@@ -39,8 +40,12 @@ int main(int argc, const char* argv[])
     signal(SIGPIPE, SIG_IGN);
 #endif
     try {
-        Loop<Host> destinations;
+        // Strategy: round-robin (default), least-connections, weighted-round-robin, or hash
+        String strategy(argc > 1 ? argv[1] : "round-robin");
+
+        Backends destinations(BalancingStrategy::create(strategy));
         destinations.add(Host("localhost", 1883));
+        destinations.startHealthChecks(chrono::seconds(5), chrono::seconds(1));
 
         Loop<String> interfaces;
         interfaces.add(String("127.0.0.1"));
@@ -48,8 +53,10 @@ int main(int argc, const char* argv[])
         LoadBalance loadBalance(1100, destinations, interfaces);
 
         loadBalance.run();
-        while (true)
-            this_thread::sleep_for(chrono::milliseconds(100));
+        while (true) {
+            this_thread::sleep_for(chrono::seconds(60));
+            destinations.printStatistics(cout);
+        }
 
         return 0;
     }